@@ -11,6 +11,7 @@
 
 
 #include <stdlib.h>
+#include <stdio.h>
 #include <string.h>
 #include <assert.h>
 #include <stdbool.h>
@@ -36,25 +37,41 @@ arbiter_tick(void *a_)
 {
 	arbiter_t *a = (arbiter_t *)a_;
 	
-	// Immediately stop if the output is blocked
-	if (buffer_is_full(a->output))
+	// Immediately stop if the output is blocked (counting the inputs left
+	// waiting)
+	if (buffer_is_full(a->output)) {
+		bool blocked = false;
+		for (int i = 0; i < a->num_inputs; i++) {
+			if (!buffer_is_empty(a->inputs[i])) {
+				a->num_waiting[i]++;
+				blocked = true;
+			}
+		}
+		if (blocked)
+			a->num_blocked++;
 		return;
+	}
 	
-	// Iterate over all the inputs
+	// Iterate over all the inputs starting after the last one to be handled
+	size_t first_input = a->last_input + 1;
 	for (int i_ = 0; i_ < a->num_inputs; i_++) {
-		// Starting after the last one to be handled
-		int i = (i_+a->last_input+1)%a->num_inputs;
+		int i = (i_+first_input)%a->num_inputs;
 		
-		if (!buffer_is_empty(a->inputs[i])) {
+		if (buffer_is_empty(a->inputs[i])) {
+			// Nothing ready at this input
+		} else if (!a->handle_input) {
 			// There is a value ready at this input, set it to be forwarded during the
 			// tock phase.
 			a->last_input   = i;
 			a->handle_input = true;
-			return;
+			a->num_granted[i]++;
+		} else {
+			// Another input was chosen, this one must wait
+			a->num_waiting[i]++;
 		}
 	}
 	
-	// No inputs were ready, do nothing!
+	// If no inputs were ready, do nothing!
 }
 
 /**
@@ -72,6 +89,9 @@ arbiter_tock(void *a_)
 		buffer_push(a->output, value);
 		
 		a->handle_input = false;
+		
+		if (a->on_forward != NULL)
+			a->on_forward(a, a->last_input, value, a->on_forward_data);
 	}
 }
 
@@ -105,6 +125,15 @@ arbiter_init( arbiter_t   *a
 	
 	a->handle_input = false;
 	
+	a->on_forward      = NULL;
+	a->on_forward_data = NULL;
+	
+	a->num_granted = calloc(num_inputs, sizeof(unsigned long));
+	a->num_waiting = calloc(num_inputs, sizeof(unsigned long));
+	assert(a->num_granted != NULL);
+	assert(a->num_waiting != NULL);
+	arbiter_reset_counters(a);
+	
 	// Schedule the arbiter tick/tock functions to occur at the specified
 	// interval.
 	scheduler_schedule( s, period
@@ -114,8 +143,74 @@ arbiter_init( arbiter_t   *a
 }
 
 
+void
+arbiter_set_on_forward( arbiter_t *a
+                      , void       (*on_forward)( arbiter_t *arbiter
+                                                , size_t     input
+                                                , void      *value
+                                                , void      *data
+                                                )
+                      , void      *on_forward_data
+                      )
+{
+	a->on_forward      = on_forward;
+	a->on_forward_data = on_forward_data;
+}
+
+
+unsigned long
+arbiter_get_num_granted(arbiter_t *a, size_t input)
+{
+	assert(input < a->num_inputs);
+	return a->num_granted[input];
+}
+
+
+unsigned long
+arbiter_get_num_waiting(arbiter_t *a, size_t input)
+{
+	assert(input < a->num_inputs);
+	return a->num_waiting[input];
+}
+
+
+unsigned long
+arbiter_get_num_blocked(arbiter_t *a)
+{
+	return a->num_blocked;
+}
+
+
+void
+arbiter_reset_counters(arbiter_t *a)
+{
+	for (size_t i = 0; i < a->num_inputs; i++) {
+		a->num_granted[i] = 0;
+		a->num_waiting[i] = 0;
+	}
+	a->num_blocked = 0;
+}
+
+
+bool
+arbiter_save(arbiter_t *a, FILE *f)
+{
+	return fwrite(&(a->last_input), sizeof(a->last_input), 1, f) == 1;
+}
+
+
+bool
+arbiter_restore(arbiter_t *a, FILE *f)
+{
+	return fread(&(a->last_input), sizeof(a->last_input), 1, f) == 1
+	       && a->last_input < a->num_inputs;
+}
+
+
 void
 arbiter_destroy( arbiter_t *a)
 {
 	free(a->inputs);
+	free(a->num_granted);
+	free(a->num_waiting);
 }
@@ -10,6 +10,8 @@
 #define ARBITER_H
 
 #include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
 
 #include "config.h"
 
@@ -46,6 +48,64 @@ void arbiter_init( arbiter_t   *arbiter
                  );
 
 
+/**
+ * Set a callback function to be called when a value is forwarded (called in
+ * the "tock" simulator phase after the value is placed in the output). The
+ * arguments passed are a reference to the arbiter, the index of the input the
+ * value came from, the value and a user-specified value. If NULL, the callback
+ * is disabled (the default).
+ */
+void arbiter_set_on_forward( arbiter_t *arbiter
+                           , void       (*on_forward)( arbiter_t *arbiter
+                                                     , size_t     input
+                                                     , void      *value
+                                                     , void      *data
+                                                     )
+                           , void      *on_forward_data
+                           );
+
+
+/**
+ * Get the number of values forwarded from the given input since the counters
+ * were reset.
+ */
+unsigned long arbiter_get_num_granted(arbiter_t *arbiter, size_t input);
+
+
+/**
+ * Get the number of arbiter cycles since the counters were reset during which
+ * the given input had a value waiting which was not forwarded (because another
+ * input was chosen or the output was full).
+ */
+unsigned long arbiter_get_num_waiting(arbiter_t *arbiter, size_t input);
+
+
+/**
+ * Get the number of arbiter cycles since the counters were reset during which
+ * some input had a value waiting but the output was full.
+ */
+unsigned long arbiter_get_num_blocked(arbiter_t *arbiter);
+
+
+/**
+ * Reset the arbiter's counters to zero.
+ */
+void arbiter_reset_counters(arbiter_t *arbiter);
+
+
+/**
+ * Write the state of the arbiter to a snapshot file. Returns false on failure.
+ */
+bool arbiter_save(arbiter_t *arbiter, FILE *f);
+
+
+/**
+ * Restore the state of an arbiter (initialised with the same inputs) from a
+ * snapshot file. Returns false on failure.
+ */
+bool arbiter_restore(arbiter_t *arbiter, FILE *f);
+
+
 /**
  * Free the resources from an arbiter. Note that the scheduler this was
  * registered with must also be freed as it will be left holding a reference to
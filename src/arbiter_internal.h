@@ -24,5 +24,22 @@ struct arbiter {
 	size_t last_input;
 	
 	bool handle_input;
+	
+	// Counters for each input of the number of values forwarded and the number
+	// of arbiter cycles a value was waiting but another input was chosen or the
+	// output was full.
+	unsigned long *num_granted;
+	unsigned long *num_waiting;
+	
+	// The number of arbiter cycles a value was waiting but the output was full.
+	unsigned long num_blocked;
+	
+	// Value-forwarded callback (or NULL if none)
+	void (*on_forward)( arbiter_t *arbiter
+	                  , size_t     input
+	                  , void      *value
+	                  , void      *data
+	                  );
+	void *on_forward_data;
 };
 
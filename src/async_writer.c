@@ -0,0 +1,222 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * async_writer.c -- Double-buffered writing of a file by a background thread.
+ */
+
+// Required for fopencookie
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+
+#include <pthread.h>
+#include <sys/types.h>
+
+#include "config.h"
+
+#include "async_writer.h"
+
+
+/******************************************************************************
+ * Internal: Utilities
+ ******************************************************************************/
+
+/**
+ * Exchange the front and back buffers (the back buffer must be empty) and wake
+ * the writer thread. Must be called with the lock held.
+ */
+static void
+swap_buffers(async_writer_t *w)
+{
+	async_writer_buffer_t tmp = w->back;
+	w->back  = w->front;
+	w->front = tmp;
+	
+	w->back_full = true;
+	pthread_cond_broadcast(&(w->cond));
+}
+
+
+/**
+ * The writer thread: write the back buffer whenever it is filled until the
+ * writer is closed.
+ */
+static void *
+writer_thread(void *w_)
+{
+	async_writer_t *w = (async_writer_t *)w_;
+	
+	pthread_mutex_lock(&(w->lock));
+	while (true) {
+		while (!w->back_full && !w->closing)
+			pthread_cond_wait(&(w->cond), &(w->lock));
+		
+		if (!w->back_full)
+			break;
+		
+		// The back buffer is not touched by anyone else while it is full
+		pthread_mutex_unlock(&(w->lock));
+		bool ok = fwrite(w->back.data, 1, w->back.length, w->file) == w->back.length
+		          && fflush(w->file) == 0;
+		pthread_mutex_lock(&(w->lock));
+		
+		w->error = w->error || !ok;
+		w->back.length = 0;
+		w->back_full   = false;
+		
+		// Pass on any output which arrived in the meantime
+		if (w->front.length > 0)
+			swap_buffers(w);
+		else
+			pthread_cond_broadcast(&(w->cond));
+	}
+	pthread_mutex_unlock(&(w->lock));
+	
+	return NULL;
+}
+
+
+/**
+ * Stream write function: append to the front buffer.
+ */
+static ssize_t
+cookie_write(void *w_, const char *data, size_t length)
+{
+	async_writer_t *w = (async_writer_t *)w_;
+	
+	pthread_mutex_lock(&(w->lock));
+	
+	// Has the writer fallen behind?
+	if (w->back_full && w->front.length + length > w->buffer_size) {
+		w->num_overflows++;
+		if (w->policy == ASYNC_WRITER_BLOCK) {
+			w->num_stalls++;
+			while (w->back_full && w->front.length + length > w->buffer_size)
+				pthread_cond_wait(&(w->cond), &(w->lock));
+		}
+	}
+	
+	if (w->front.length + length > w->front.size) {
+		while (w->front.length + length > w->front.size)
+			w->front.size = (w->front.size == 0) ? length : w->front.size * 2;
+		w->front.data = realloc(w->front.data, w->front.size);
+		assert(w->front.data != NULL);
+	}
+	memcpy(w->front.data + w->front.length, data, length);
+	w->front.length += length;
+	
+	if (w->front.length > w->peak_length)
+		w->peak_length = w->front.length;
+	
+	// Hand the output straight to the writer thread if it is idle
+	if (!w->back_full)
+		swap_buffers(w);
+	
+	pthread_mutex_unlock(&(w->lock));
+	
+	return length;
+}
+
+
+/**
+ * Stream close function: write everything, stop the thread and close the file.
+ */
+static int
+cookie_close(void *w_)
+{
+	async_writer_t *w = (async_writer_t *)w_;
+	
+	pthread_mutex_lock(&(w->lock));
+	while (w->back_full)
+		pthread_cond_wait(&(w->cond), &(w->lock));
+	if (w->front.length > 0)
+		swap_buffers(w);
+	w->closing = true;
+	pthread_cond_broadcast(&(w->cond));
+	pthread_mutex_unlock(&(w->lock));
+	
+	pthread_join(w->thread, NULL);
+	
+	bool ok = !w->error;
+	if (fclose(w->file) != 0)
+		ok = false;
+	
+	free(w->front.data);
+	free(w->back.data);
+	pthread_mutex_destroy(&(w->lock));
+	pthread_cond_destroy(&(w->cond));
+	
+	return ok ? 0 : EOF;
+}
+
+
+/******************************************************************************
+ * Public functions
+ ******************************************************************************/
+
+FILE *
+async_writer_open( async_writer_t        *w
+                 , FILE                  *file
+                 , size_t                 buffer_size
+                 , async_writer_policy_t  policy
+                 )
+{
+	memset(w, 0, sizeof(async_writer_t));
+	w->file        = file;
+	w->buffer_size = buffer_size;
+	w->policy      = policy;
+	
+	pthread_mutex_init(&(w->lock), NULL);
+	pthread_cond_init(&(w->cond), NULL);
+	
+	if (pthread_create(&(w->thread), NULL, writer_thread, w) != 0) {
+		pthread_mutex_destroy(&(w->lock));
+		pthread_cond_destroy(&(w->cond));
+		return NULL;
+	}
+	
+	cookie_io_functions_t functions = { .read  = NULL
+	                                  , .write = cookie_write
+	                                  , .seek  = NULL
+	                                  , .close = cookie_close
+	                                  };
+	w->stream = fopencookie(w, "w", functions);
+	if (w->stream == NULL) {
+		pthread_mutex_lock(&(w->lock));
+		w->closing = true;
+		pthread_cond_broadcast(&(w->cond));
+		pthread_mutex_unlock(&(w->lock));
+		pthread_join(w->thread, NULL);
+		
+		pthread_mutex_destroy(&(w->lock));
+		pthread_cond_destroy(&(w->cond));
+		return NULL;
+	}
+	
+	return w->stream;
+}
+
+
+unsigned long
+async_writer_get_num_overflows(async_writer_t *w)
+{
+	return w->num_overflows;
+}
+
+
+unsigned long
+async_writer_get_num_stalls(async_writer_t *w)
+{
+	return w->num_stalls;
+}
+
+
+size_t
+async_writer_get_peak_length(async_writer_t *w)
+{
+	return w->peak_length;
+}
@@ -0,0 +1,86 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * async_writer.h -- Double-buffered writing of a file by a background thread.
+ *
+ * An async writer wraps an open file in a stdio stream whose output is appended
+ * to an in-memory (front) buffer. A dedicated writer thread repeatedly swaps
+ * the front buffer with a second (back) buffer and writes the back buffer to
+ * the file, so writes to the stream only ever copy data into memory and the
+ * writing thread never waits for the disk.
+ *
+ * If the front buffer reaches the given size while the writer thread is still
+ * busy writing the back buffer, the writer has fallen behind and the policy
+ * decides what happens: ASYNC_WRITER_GROW lets the front buffer grow without
+ * limit (never blocking) while ASYNC_WRITER_BLOCK waits for the writer thread
+ * to catch up (bounding memory use). Either way the event is counted.
+ *
+ * Closing the stream (with fclose) writes all remaining output, stops the
+ * writer thread and closes the underlying file. The counters are only updated
+ * by writes to the stream and so may be read by the thread writing to it
+ * without locking, even after the stream is closed.
+ */
+
+#ifndef ASYNC_WRITER_H
+#define ASYNC_WRITER_H
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "config.h"
+
+/**
+ * What to do when the front buffer is full and the writer thread is busy.
+ */
+typedef enum async_writer_policy {
+	// Keep appending to the front buffer beyond its size
+	ASYNC_WRITER_GROW,
+	
+	// Wait for the writer thread to finish writing the back buffer
+	ASYNC_WRITER_BLOCK,
+} async_writer_policy_t;
+
+
+/**
+ * A file being written by a background thread.
+ */
+typedef struct async_writer async_writer_t;
+
+
+// Concrete definitions of the above types
+#include "async_writer_internal.h"
+
+
+/**
+ * Start writing the given file in the background, returning the stream to
+ * which output should be written. The writer takes ownership of the file.
+ * Returns NULL (leaving the file open) if the stream or thread could not be
+ * created.
+ */
+FILE *async_writer_open( async_writer_t        *w
+                       , FILE                  *file
+                       , size_t                 buffer_size
+                       , async_writer_policy_t  policy
+                       );
+
+
+/**
+ * Get the number of times the front buffer became full while the writer
+ * thread was busy.
+ */
+unsigned long async_writer_get_num_overflows(async_writer_t *w);
+
+
+/**
+ * Get the number of times writing to the stream waited for the writer thread
+ * (only with ASYNC_WRITER_BLOCK).
+ */
+unsigned long async_writer_get_num_stalls(async_writer_t *w);
+
+
+/**
+ * Get the largest amount of output (in bytes) ever held in the front buffer.
+ */
+size_t async_writer_get_peak_length(async_writer_t *w);
+
+#endif
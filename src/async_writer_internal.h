@@ -0,0 +1,59 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * async_writer_internal.h -- Concrete definitions of internal datastrucutres.
+ * This is provided to allow the creation of these types. Users should not
+ * access the fields directly. This file should only be included by
+ * async_writer.h
+ */
+
+#include <stdbool.h>
+#include <pthread.h>
+
+
+/**
+ * An in-memory buffer of output.
+ */
+typedef struct async_writer_buffer {
+	char   *data;
+	size_t  length;
+	
+	// The allocated size of data
+	size_t  size;
+} async_writer_buffer_t;
+
+
+struct async_writer {
+	// The file being written and the stream given to the user
+	FILE *file;
+	FILE *stream;
+	
+	size_t                buffer_size;
+	async_writer_policy_t policy;
+	
+	pthread_t thread;
+	
+	// Protects all of the following fields. The condition is signalled whenever
+	// the back buffer is filled or emptied or the writer is closed.
+	pthread_mutex_t lock;
+	pthread_cond_t  cond;
+	
+	// The buffer being appended to by the user
+	async_writer_buffer_t front;
+	
+	// The buffer being written by the writer thread (when back_full is set)
+	async_writer_buffer_t back;
+	bool                  back_full;
+	
+	// Set when the stream is closed: the thread exits once the back buffer is
+	// empty
+	bool closing;
+	
+	// Set if writing the file failed
+	bool error;
+	
+	// Counters (only written by the thread writing to the stream)
+	unsigned long num_overflows;
+	unsigned long num_stalls;
+	size_t        peak_length;
+};
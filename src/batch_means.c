@@ -0,0 +1,139 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * batch_means.c -- Online confidence intervals using the method of batch means.
+ */
+
+#include <stdbool.h>
+#include <math.h>
+#include <assert.h>
+
+#include "config.h"
+
+#include "batch_means.h"
+
+
+/**
+ * The quantile function of the standard normal distribution using Acklam's
+ * rational approximation (relative error below 1.2e-9).
+ */
+static double
+normal_quantile(double p)
+{
+	static const double a[] = { -3.969683028665376e+01,  2.209460984245205e+02
+	                          , -2.759285104469687e+02,  1.383577518672690e+02
+	                          , -3.066479806614716e+01,  2.506628277459239e+00
+	                          };
+	static const double b[] = { -5.447609879822406e+01,  1.615858368580409e+02
+	                          , -1.556989798598866e+02,  6.680131188771972e+01
+	                          , -1.328068155288572e+01
+	                          };
+	static const double c[] = { -7.784894002430293e-03, -3.223964580411365e-01
+	                          , -2.400758277161838e+00, -2.549732539343734e+00
+	                          ,  4.374664141464968e+00,  2.938163982698783e+00
+	                          };
+	static const double d[] = {  7.784695709041462e-03,  3.224671290700398e-01
+	                          ,  2.445134137142996e+00,  3.754408661907416e+00
+	                          };
+	
+	assert(p > 0.0 && p < 1.0);
+	
+	if (p < 0.02425) {
+		double q = sqrt(-2.0 * log(p));
+		return (((((c[0]*q + c[1])*q + c[2])*q + c[3])*q + c[4])*q + c[5])
+		       / ((((d[0]*q + d[1])*q + d[2])*q + d[3])*q + 1.0);
+	} else if (p > 1.0 - 0.02425) {
+		double q = sqrt(-2.0 * log(1.0 - p));
+		return -(((((c[0]*q + c[1])*q + c[2])*q + c[3])*q + c[4])*q + c[5])
+		        / ((((d[0]*q + d[1])*q + d[2])*q + d[3])*q + 1.0);
+	} else {
+		double q = p - 0.5;
+		double r = q * q;
+		return (((((a[0]*r + a[1])*r + a[2])*r + a[3])*r + a[4])*r + a[5])*q
+		       / (((((b[0]*r + b[1])*r + b[2])*r + b[3])*r + b[4])*r + 1.0);
+	}
+}
+
+
+double
+batch_means_t_critical(double confidence, int dof)
+{
+	assert(dof >= 1);
+	
+	double p = 0.5 + (confidence / 2.0);
+	
+	// Exact forms for one and two degrees of freedom
+	if (dof == 1)
+		return tan(M_PI * (p - 0.5));
+	if (dof == 2)
+		return (2.0*p - 1.0) / sqrt(2.0 * p * (1.0 - p));
+	
+	// Cornish-Fisher expansion about the normal quantile
+	double z  = normal_quantile(p);
+	double z2 = z * z;
+	double n  = (double)dof;
+	return z
+	       + (z * (z2 + 1.0)) / (4.0 * n)
+	       + (z * ((5.0*z2 + 16.0)*z2 + 3.0)) / (96.0 * n*n)
+	       + (z * (((3.0*z2 + 19.0)*z2 + 17.0)*z2 - 15.0)) / (384.0 * n*n*n)
+	       + (z * ((((79.0*z2 + 776.0)*z2 + 1482.0)*z2 - 1920.0)*z2 - 945.0)) / (92160.0 * n*n*n*n)
+	       ;
+}
+
+
+void
+batch_means_init(batch_means_t *bm, double confidence)
+{
+	assert(confidence > 0.0 && confidence < 1.0);
+	
+	bm->confidence  = confidence;
+	bm->num_batches = 0;
+	bm->mean        = 0.0;
+	bm->m2          = 0.0;
+}
+
+
+void
+batch_means_add(batch_means_t *bm, double batch_mean)
+{
+	bm->num_batches++;
+	double delta = batch_mean - bm->mean;
+	bm->mean += delta / (double)bm->num_batches;
+	bm->m2   += delta * (batch_mean - bm->mean);
+}
+
+
+int
+batch_means_get_num_batches(batch_means_t *bm)
+{
+	return bm->num_batches;
+}
+
+
+double
+batch_means_get_mean(batch_means_t *bm)
+{
+	return (bm->num_batches > 0) ? bm->mean : NAN;
+}
+
+
+double
+batch_means_get_half_width(batch_means_t *bm)
+{
+	if (bm->num_batches < 2)
+		return INFINITY;
+	
+	double variance = bm->m2 / (double)(bm->num_batches - 1);
+	return batch_means_t_critical(bm->confidence, bm->num_batches - 1)
+	       * sqrt(variance / (double)bm->num_batches);
+}
+
+
+bool
+batch_means_precise(batch_means_t *bm, double relative_precision)
+{
+	if (bm->num_batches < 2)
+		return false;
+	
+	return batch_means_get_half_width(bm) <= relative_precision * fabs(bm->mean);
+}
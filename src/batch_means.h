@@ -0,0 +1,77 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * batch_means.h -- Online confidence intervals for the mean of a (possibly
+ * autocorrelated) quantity using the method of batch means.
+ *
+ * A simulation run is split into batches and the mean of the quantity of
+ * interest during each batch is added to the estimator. If the batches are long
+ * enough, the batch means are approximately independent and normally
+ * distributed and so a Student-t confidence interval for their mean gives a
+ * confidence interval for the quantity's steady-state mean.
+ */
+
+#ifndef BATCH_MEANS_H
+#define BATCH_MEANS_H
+
+#include <stdbool.h>
+
+#include "config.h"
+
+/**
+ * A data structure accumulating batch means.
+ */
+typedef struct batch_means batch_means_t;
+
+
+// Concrete definitions of the above types
+#include "batch_means_internal.h"
+
+
+/**
+ * Initialise an estimator with no batches.
+ *
+ * @param confidence The confidence level of the intervals produced, e.g. 0.95.
+ */
+void batch_means_init(batch_means_t *bm, double confidence);
+
+
+/**
+ * Add the mean of a batch.
+ */
+void batch_means_add(batch_means_t *bm, double batch_mean);
+
+
+/**
+ * Get the number of batches added.
+ */
+int batch_means_get_num_batches(batch_means_t *bm);
+
+
+/**
+ * Get the mean of the batch means (NaN if no batches have been added).
+ */
+double batch_means_get_mean(batch_means_t *bm);
+
+
+/**
+ * Get the half-width of the confidence interval for the mean (infinite if fewer
+ * than two batches have been added).
+ */
+double batch_means_get_half_width(batch_means_t *bm);
+
+
+/**
+ * Test whether the half-width of the confidence interval is no more than the
+ * given fraction of the magnitude of the mean.
+ */
+bool batch_means_precise(batch_means_t *bm, double relative_precision);
+
+
+/**
+ * Get the two-sided critical value of Student's t-distribution with the given
+ * number of degrees of freedom, i.e. the t such that P(|T| <= t) = confidence.
+ */
+double batch_means_t_critical(double confidence, int dof);
+
+#endif
@@ -0,0 +1,19 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * batch_means_internal.h -- Concrete definitions of internal datastrucutres.
+ * This is provided to allow the creation of these types. Users should not
+ * access the fields directly. This file should only be included by
+ * batch_means.h
+ */
+
+struct batch_means {
+	// The confidence level of the intervals produced
+	double confidence;
+	
+	// Number of batches added and Welford's running mean and sum of squared
+	// differences from the mean of the batch means.
+	int    num_batches;
+	double mean;
+	double m2;
+};
@@ -8,14 +8,36 @@
  */
 
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
 #include <assert.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "config.h"
 
+#include "scheduler.h"
 #include "buffer.h"
 
 
+/******************************************************************************
+ * Internal: Utilities
+ ******************************************************************************/
+
+/**
+ * Credit the time since the occupancy last changed to the current occupancy.
+ * Called before every change in occupancy when statistics are enabled.
+ */
+static void
+buffer_update_stats(buffer_t *b)
+{
+	ticks_t now = scheduler_get_ticks(b->stats->scheduler);
+	size_t occupancy = (b->head + (b->size + 1) - b->tail) % (b->size + 1);
+	b->stats->ticks[occupancy] += now - b->stats->last_change;
+	b->stats->last_change = now;
+}
+
+
 /******************************************************************************
  * Public Functions
  ******************************************************************************/
@@ -28,6 +50,8 @@ buffer_init(buffer_t *b, size_t size)
 	b->size = size;
 	b->head = 0;
 	b->tail = 0;
+	
+	b->stats = NULL;
 }
 
 
@@ -35,6 +59,18 @@ void
 buffer_destroy(buffer_t *b)
 {
 	free(b->values);
+	
+	if (b->stats != NULL) {
+		free(b->stats->ticks);
+		free(b->stats);
+	}
+}
+
+
+size_t
+buffer_get_size(buffer_t *b)
+{
+	return b->size;
 }
 
 
@@ -57,6 +93,9 @@ buffer_push(buffer_t *b, void *value)
 {
 	assert(!buffer_is_full(b));
 	
+	if (b->stats != NULL)
+		buffer_update_stats(b);
+	
 	b->values[b->head] = value;
 	b->head = (b->head+1)%(b->size + 1);
 }
@@ -67,6 +106,9 @@ buffer_pop(buffer_t *b)
 {
 	assert(!buffer_is_empty(b));
 	
+	if (b->stats != NULL)
+		buffer_update_stats(b);
+	
 	void *value = b->values[b->tail];
 	b->tail = (b->tail+1)%(b->size + 1);
 	
@@ -82,3 +124,76 @@ buffer_peek(buffer_t *b)
 	return b->values[b->tail];
 }
 
+
+void
+buffer_enable_stats(buffer_t *b, scheduler_t *s)
+{
+	if (b->stats == NULL) {
+		b->stats = malloc(sizeof(struct buffer_stats));
+		assert(b->stats != NULL);
+		b->stats->ticks = malloc((b->size + 1) * sizeof(uint64_t));
+		assert(b->stats->ticks != NULL);
+	}
+	
+	b->stats->scheduler   = s;
+	b->stats->last_change = scheduler_get_ticks(s);
+	memset(b->stats->ticks, 0, (b->size + 1) * sizeof(uint64_t));
+}
+
+
+uint64_t
+buffer_get_stats_ticks(buffer_t *b, size_t occupancy)
+{
+	assert(occupancy <= b->size);
+	
+	if (b->stats == NULL)
+		return 0;
+	
+	// Include the time spent at the current occupancy so far
+	buffer_update_stats(b);
+	return b->stats->ticks[occupancy];
+}
+
+
+bool
+buffer_save( buffer_t            *b
+           , FILE                *f
+           , buffer_save_value_t  save_value
+           , void                *data
+           )
+{
+	size_t num_values = (b->head + (b->size + 1) - b->tail) % (b->size + 1);
+	if (fwrite(&num_values, sizeof(num_values), 1, f) != 1)
+		return false;
+	
+	for (size_t i = 0; i < num_values; i++)
+		if (!save_value(f, b->values[(b->tail + i) % (b->size + 1)], data))
+			return false;
+	
+	return true;
+}
+
+
+bool
+buffer_restore( buffer_t               *b
+              , FILE                   *f
+              , buffer_restore_value_t  restore_value
+              , void                   *data
+              )
+{
+	assert(buffer_is_empty(b));
+	
+	size_t num_values;
+	if (fread(&num_values, sizeof(num_values), 1, f) != 1 || num_values > b->size)
+		return false;
+	
+	for (size_t i = 0; i < num_values; i++) {
+		void *value;
+		if (!restore_value(f, &value, data))
+			return false;
+		buffer_push(b, value);
+	}
+	
+	return true;
+}
+
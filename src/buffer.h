@@ -9,9 +9,13 @@
 
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
 
 #include "config.h"
 
+#include "scheduler.h"
+
 /**
  * An instance of a buffer.
  */
@@ -30,6 +34,11 @@ void buffer_init(buffer_t *buffer, size_t size);
  */
 void buffer_destroy(buffer_t *buffer);
 
+/**
+ * Get the number of values the buffer can hold.
+ */
+size_t buffer_get_size(buffer_t *buffer);
+
 /**
  * Test whether the buffer is full.
  */
@@ -57,4 +66,49 @@ void *buffer_pop(buffer_t *buffer);
 void *buffer_peek(buffer_t *buffer);
 
 
+/**
+ * Start recording the time the buffer spends holding each number of values,
+ * discarding any statistics recorded so far. Until this is called no statistics
+ * are kept and pushing and popping cost nothing extra. The scheduler gives the
+ * current time.
+ */
+void buffer_enable_stats(buffer_t *buffer, scheduler_t *scheduler);
+
+/**
+ * Get the number of ticks the buffer has held the given number of values
+ * (0..size) since its statistics were enabled. Returns 0 if statistics are not
+ * enabled.
+ */
+uint64_t buffer_get_stats_ticks(buffer_t *buffer, size_t occupancy);
+
+
+/**
+ * Callbacks which write/read a single value held by a buffer (or other
+ * component) to/from a snapshot file. Should return false on failure.
+ */
+typedef bool (*buffer_save_value_t)(FILE *f, void *value, void *data);
+typedef bool (*buffer_restore_value_t)(FILE *f, void **value, void *data);
+
+/**
+ * Write the values held in the buffer to a snapshot file, oldest first, using
+ * save_value. Returns false if writing failed.
+ */
+bool buffer_save( buffer_t            *buffer
+                , FILE                *f
+                , buffer_save_value_t  save_value
+                , void                *data
+                );
+
+/**
+ * Fill an empty buffer with the values written by buffer_save using
+ * restore_value. Returns false if the snapshot could not be read or holds more
+ * values than the buffer can.
+ */
+bool buffer_restore( buffer_t               *buffer
+                   , FILE                   *f
+                   , buffer_restore_value_t  restore_value
+                   , void                   *data
+                   );
+
+
 #endif
@@ -41,5 +41,27 @@ struct buffer {
 	size_t   size;
 	int      head;
 	int      tail;
+	
+	// Occupancy statistics (NULL unless enabled by buffer_enable_stats)
+	struct buffer_stats *stats;
+};
+
+
+/**
+ * *** Do not access these fields directly. ***
+ *
+ * The time a buffer has spent at each occupancy since its statistics were
+ * enabled. Updated whenever the occupancy changes.
+ */
+struct buffer_stats {
+	// The scheduler giving the current time
+	scheduler_t *scheduler;
+	
+	// The time the occupancy last changed (or the statistics were enabled)
+	ticks_t last_change;
+	
+	// The number of ticks spent with each number of values (0..size) in the
+	// buffer, excluding the time since last_change.
+	uint64_t *ticks;
 };
 
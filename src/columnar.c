@@ -0,0 +1,210 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * columnar.c -- Binary columnar tables of integers written in blocks.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <assert.h>
+
+#include "config.h"
+
+#include "columnar.h"
+
+
+/******************************************************************************
+ * Internal: Utilities
+ ******************************************************************************/
+
+/**
+ * Convert a value to little-endian byte order.
+ */
+static uint32_t
+to_le32(uint32_t value)
+{
+	uint8_t bytes[4] = { (uint8_t)(value      ), (uint8_t)(value >>  8)
+	                   , (uint8_t)(value >> 16), (uint8_t)(value >> 24)
+	                   };
+	uint32_t le;
+	memcpy(&le, bytes, sizeof(le));
+	return le;
+}
+
+
+/**
+ * The number of bytes of padding needed after length bytes.
+ */
+static size_t
+padding(size_t length)
+{
+	return (8 - (length % 8)) % 8;
+}
+
+
+/**
+ * Write the given number of zero bytes of padding.
+ */
+static void
+write_padding(FILE *f, size_t length)
+{
+	static const char zeros[8] = {0};
+	fwrite(zeros, 1, length, f);
+}
+
+
+/**
+ * Write a NUL-terminated string for each of the given strings (without
+ * padding) returning the number of bytes written.
+ */
+static size_t
+write_strings(FILE *f, int num_strings, const char **strings)
+{
+	size_t length = 0;
+	for (int i = 0; i < num_strings; i++) {
+		size_t string_length = strlen(strings[i]) + 1;
+		fwrite(strings[i], 1, string_length, f);
+		length += string_length;
+	}
+	return length;
+}
+
+
+/**
+ * Get the total length of NUL-terminated copies of the given strings.
+ */
+static size_t
+strings_length(int num_strings, const char **strings)
+{
+	size_t length = 0;
+	for (int i = 0; i < num_strings; i++)
+		length += strlen(strings[i]) + 1;
+	return length;
+}
+
+
+/**
+ * Write a record header.
+ */
+static void
+write_record(FILE *f, const char *tag, size_t length, int num_rows)
+{
+	columnar_record_t record;
+	memset(&record, 0, sizeof(record));
+	memcpy(record.tag, tag, sizeof(record.tag));
+	record.length   = to_le32(length);
+	record.num_rows = to_le32(num_rows);
+	fwrite(&record, sizeof(record), 1, f);
+}
+
+
+/******************************************************************************
+ * Public functions
+ ******************************************************************************/
+
+void
+columnar_init( columnar_t  *c
+             , int          num_labels
+             , const char **label_names
+             , int          num_columns
+             , const char **column_names
+             )
+{
+	c->num_labels  = num_labels;
+	c->label_names = calloc(num_labels + 1, sizeof(char *));
+	assert(c->label_names != NULL);
+	for (int i = 0; i < num_labels; i++) {
+		c->label_names[i] = strdup(label_names[i]);
+		assert(c->label_names[i] != NULL);
+	}
+	
+	c->num_columns  = num_columns;
+	c->column_names = calloc(num_columns + 1, sizeof(char *));
+	assert(c->column_names != NULL);
+	for (int i = 0; i < num_columns; i++) {
+		c->column_names[i] = strdup(column_names[i]);
+		assert(c->column_names[i] != NULL);
+	}
+	
+	c->block = calloc((size_t)num_columns * COLUMNAR_BLOCK_ROWS + 1, sizeof(int32_t));
+	assert(c->block != NULL);
+	c->num_rows = 0;
+}
+
+
+void
+columnar_write_header(columnar_t *c, FILE *f)
+{
+	size_t names_length = strings_length(c->num_labels,  (const char **)c->label_names)
+	                    + strings_length(c->num_columns, (const char **)c->column_names);
+	
+	columnar_header_t header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, COLUMNAR_MAGIC, sizeof(header.magic));
+	header.version      = to_le32(COLUMNAR_VERSION);
+	header.num_labels   = to_le32(c->num_labels);
+	header.num_columns  = to_le32(c->num_columns);
+	header.block_rows   = to_le32(COLUMNAR_BLOCK_ROWS);
+	header.names_length = to_le32(names_length + padding(names_length));
+	fwrite(&header, sizeof(header), 1, f);
+	
+	write_strings(f, c->num_labels,  (const char **)c->label_names);
+	write_strings(f, c->num_columns, (const char **)c->column_names);
+	write_padding(f, padding(names_length));
+}
+
+
+void
+columnar_set_labels(columnar_t *c, FILE *f, const char **label_values)
+{
+	columnar_flush(c, f);
+	
+	size_t length = strings_length(c->num_labels, label_values);
+	write_record(f, COLUMNAR_TAG_LABELS, length + padding(length), 0);
+	write_strings(f, c->num_labels, label_values);
+	write_padding(f, padding(length));
+}
+
+
+void
+columnar_append(columnar_t *c, FILE *f, const int32_t *row)
+{
+	for (int i = 0; i < c->num_columns; i++)
+		c->block[(i * COLUMNAR_BLOCK_ROWS) + c->num_rows] = (int32_t)to_le32((uint32_t)row[i]);
+	
+	if (++c->num_rows == COLUMNAR_BLOCK_ROWS)
+		columnar_flush(c, f);
+}
+
+
+void
+columnar_flush(columnar_t *c, FILE *f)
+{
+	if (c->num_rows == 0)
+		return;
+	
+	size_t length = (size_t)c->num_rows * c->num_columns * sizeof(int32_t);
+	write_record(f, COLUMNAR_TAG_BLOCK, length + padding(length), c->num_rows);
+	for (int i = 0; i < c->num_columns; i++)
+		fwrite(c->block + (i * COLUMNAR_BLOCK_ROWS), sizeof(int32_t), c->num_rows, f);
+	write_padding(f, padding(length));
+	
+	c->num_rows = 0;
+}
+
+
+void
+columnar_destroy(columnar_t *c)
+{
+	for (int i = 0; i < c->num_labels; i++)
+		free(c->label_names[i]);
+	free(c->label_names);
+	
+	for (int i = 0; i < c->num_columns; i++)
+		free(c->column_names[i]);
+	free(c->column_names);
+	
+	free(c->block);
+}
@@ -0,0 +1,97 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * columnar.h -- Binary columnar tables of integers written in blocks.
+ *
+ * A table has a fixed set of integer columns and a fixed set of string labels
+ * (e.g. the group, sample and independent variables of an experiment) which
+ * apply to every row until they are next changed. A table file consists of a
+ * header giving the names of the labels and columns followed by a sequence of
+ * records, each starting with a columnar_record_t:
+ *
+ * - A labels record holds the (NUL-terminated) value of every label and applies
+ *   to the rows of all following blocks.
+ * - A block record holds up to COLUMNAR_BLOCK_ROWS rows stored column by
+ *   column: the value of the first column for every row, then the second and
+ *   so on.
+ *
+ * All integers are 32-bit little-endian and the header and every record are
+ * padded to a multiple of 8 bytes so that the columns of a memory-mapped file
+ * can be accessed in-place as arrays. Since the records are self-contained, the
+ * records of several tables with the same header may be concatenated.
+ *
+ * The writer does not hold the file being written but is given it by every
+ * call which may write to it. This allows the caller to redirect output between
+ * calls (as parallel runs do).
+ */
+
+#ifndef COLUMNAR_H
+#define COLUMNAR_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "config.h"
+
+/**
+ * The (maximum) number of rows in each block.
+ */
+#define COLUMNAR_BLOCK_ROWS 4096
+
+/**
+ * A writer of a columnar table.
+ */
+typedef struct columnar columnar_t;
+
+
+// Concrete definitions of the above types
+#include "columnar_internal.h"
+
+
+/**
+ * Initialise a writer for a table with the given labels and columns. The names
+ * are copied.
+ */
+void columnar_init( columnar_t  *c
+                  , int          num_labels
+                  , const char **label_names
+                  , int          num_columns
+                  , const char **column_names
+                  );
+
+
+/**
+ * Write the header of the table to the given file.
+ */
+void columnar_write_header(columnar_t *c, FILE *f);
+
+
+/**
+ * Set the value of every label for the rows which follow, writing any rows
+ * appended so far to the given file first. The values are written immediately
+ * and need not remain valid.
+ */
+void columnar_set_labels(columnar_t *c, FILE *f, const char **label_values);
+
+
+/**
+ * Append a row of num_columns values to the table. If this completes a block,
+ * the block is written to the given file.
+ */
+void columnar_append(columnar_t *c, FILE *f, const int32_t *row);
+
+
+/**
+ * Write any rows appended but not yet written to the given file (as a partial
+ * block).
+ */
+void columnar_flush(columnar_t *c, FILE *f);
+
+
+/**
+ * Free the resources used by the writer. Rows not yet written are discarded.
+ */
+void columnar_destroy(columnar_t *c);
+
+#endif
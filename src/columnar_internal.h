@@ -0,0 +1,68 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * columnar_internal.h -- Concrete definitions of internal datastrucutres.
+ * This is provided to allow the creation of these types. Users should not
+ * access the fields directly. This file should only be included by
+ * columnar.h
+ */
+
+
+/**
+ * The start of a columnar table file. Followed by the names of the labels and
+ * then the columns (NUL-terminated), padded to a multiple of 8 bytes.
+ */
+typedef struct columnar_header {
+	// Always COLUMNAR_MAGIC
+	char magic[8];
+	
+	// Always COLUMNAR_VERSION
+	uint32_t version;
+	
+	uint32_t num_labels;
+	uint32_t num_columns;
+	
+	// Always COLUMNAR_BLOCK_ROWS
+	uint32_t block_rows;
+	
+	// The number of bytes of names (including padding) which follow
+	uint32_t names_length;
+	
+	uint32_t reserved;
+} columnar_header_t;
+
+
+/**
+ * The start of every record. Followed by length bytes of data.
+ */
+typedef struct columnar_record {
+	// Either COLUMNAR_TAG_LABELS or COLUMNAR_TAG_BLOCK
+	char tag[4];
+	
+	// The number of bytes (including padding) which follow
+	uint32_t length;
+	
+	// The number of rows in a block (0 for a labels record)
+	uint32_t num_rows;
+	
+	uint32_t reserved;
+} columnar_record_t;
+
+#define COLUMNAR_MAGIC      "TICKYCOL"
+#define COLUMNAR_VERSION    1
+#define COLUMNAR_TAG_LABELS "LBLS"
+#define COLUMNAR_TAG_BLOCK  "BLCK"
+
+
+struct columnar {
+	int    num_labels;
+	char **label_names;
+	
+	int    num_columns;
+	char **column_names;
+	
+	// The rows appended but not yet written stored column by column, each column
+	// having space for COLUMNAR_BLOCK_ROWS values (already little-endian).
+	int32_t *block;
+	int      num_rows;
+};
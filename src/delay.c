@@ -8,6 +8,7 @@
 
 
 #include <stdlib.h>
+#include <stdio.h>
 #include <string.h>
 #include <assert.h>
 #include <stdbool.h>
@@ -45,6 +46,9 @@ delay_tick(void *d_)
 			d->forward = true;
 			d->time_elapsed = 0;
 		}
+	} else if (!buffer_is_empty(d->input)) {
+		// A value is waiting but the output is full
+		d->num_blocked++;
 	}
 }
 
@@ -60,8 +64,10 @@ delay_tock(void *d_)
 {
 	delay_t *d = (delay_t *)d_;
 	
-	if (d->forward)
+	if (d->forward) {
 		buffer_push(d->output, buffer_pop(d->input));
+		d->num_forwarded++;
+	}
 }
 
 
@@ -85,6 +91,8 @@ delay_init( delay_t     *d
 	d->delay    = delay;
 	d->time_elapsed = 0;
 	
+	delay_reset_counters(d);
+	
 	// Schedule the arbiter tick/tock functions to occur at the specified
 	// interval.
 	scheduler_schedule( s, period
@@ -101,6 +109,42 @@ delay_set_delay(delay_t *d, int delay)
 }
 
 
+unsigned long
+delay_get_num_forwarded(delay_t *d)
+{
+	return d->num_forwarded;
+}
+
+
+unsigned long
+delay_get_num_blocked(delay_t *d)
+{
+	return d->num_blocked;
+}
+
+
+void
+delay_reset_counters(delay_t *d)
+{
+	d->num_forwarded = 0;
+	d->num_blocked   = 0;
+}
+
+
+bool
+delay_save(delay_t *d, FILE *f)
+{
+	return fwrite(&(d->time_elapsed), sizeof(d->time_elapsed), 1, f) == 1;
+}
+
+
+bool
+delay_restore(delay_t *d, FILE *f)
+{
+	return fread(&(d->time_elapsed), sizeof(d->time_elapsed), 1, f) == 1;
+}
+
+
 void
 delay_destroy( delay_t *d)
 {
@@ -10,6 +10,8 @@
 #define DELAY_H
 
 #include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
 
 #include "config.h"
 
@@ -53,6 +55,39 @@ void delay_set_delay(delay_t *d, int delay);
 
 
 
+/**
+ * Get the number of values forwarded since the counters were reset.
+ */
+unsigned long delay_get_num_forwarded(delay_t *d);
+
+
+/**
+ * Get the number of periods since the counters were reset during which a value
+ * was waiting to be forwarded but the output buffer was full.
+ */
+unsigned long delay_get_num_blocked(delay_t *d);
+
+
+/**
+ * Reset the forwarded and blocked counters to zero.
+ */
+void delay_reset_counters(delay_t *d);
+
+
+
+/**
+ * Write the state of the delay to a snapshot file. Returns false on failure.
+ */
+bool delay_save(delay_t *d, FILE *f);
+
+
+/**
+ * Restore the state of a delay from a snapshot file. Returns false on failure.
+ */
+bool delay_restore(delay_t *d, FILE *f);
+
+
+
 /**
  * Free the resources from an delay. Note that the scheduler this was registered
  * with must also be freed as it will be left holding a reference to invalid
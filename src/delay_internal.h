@@ -22,4 +22,9 @@ struct delay {
 	// Should the value in the first buffer be popped and placed in the next
 	// buffer? (Set in the tick phase and read in the tock phase).
 	bool forward;
+	
+	// Counters of the number of values forwarded and the number of periods a
+	// value was waiting while the output buffer was full.
+	unsigned long num_forwarded;
+	unsigned long num_blocked;
 };
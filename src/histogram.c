@@ -0,0 +1,210 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * histogram.c -- Log-linear (HDR-style) histograms of non-negative integers.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+
+#include "config.h"
+
+#include "histogram.h"
+
+
+/******************************************************************************
+ * Internal: Utilities
+ ******************************************************************************/
+
+/**
+ * Get the bucket containing the given value.
+ */
+static size_t
+bucket_of(int precision, uint64_t value)
+{
+	// Small values are stored exactly
+	if (value < (UINT64_C(2) << precision))
+		return (size_t)value;
+	
+	// Otherwise keep the precision most significant bits (after the leading one)
+	int msb   = 63 - __builtin_clzll(value);
+	int shift = msb - precision;
+	return ((size_t)(shift + 1) << precision)
+	       + (size_t)((value >> shift) - (UINT64_C(1) << precision));
+}
+
+
+/**
+ * Get the (inclusive) range of values in a bucket.
+ */
+static void
+bucket_range(int precision, size_t bucket, uint64_t *lower, uint64_t *upper)
+{
+	if (bucket < ((size_t)2 << precision)) {
+		*lower = *upper = bucket;
+		return;
+	}
+	
+	int      shift = (int)(bucket >> precision) - 1;
+	uint64_t top   = (bucket & (((size_t)1 << precision) - 1)) + ((size_t)1 << precision);
+	*lower = top << shift;
+	*upper = *lower + (UINT64_C(1) << shift) - 1;
+}
+
+
+/******************************************************************************
+ * Public functions
+ ******************************************************************************/
+
+void
+histogram_init(histogram_t *h, int precision)
+{
+	assert(precision >= 0 && precision < 32);
+	h->precision   = precision;
+	h->counts      = NULL;
+	h->num_buckets = 0;
+	
+	histogram_reset(h);
+}
+
+
+void
+histogram_add(histogram_t *h, uint64_t value)
+{
+	size_t bucket = bucket_of(h->precision, value);
+	
+	// Allocate buckets up to the end of the power-of-two range of the value
+	if (bucket >= h->num_buckets) {
+		size_t num_buckets = (bucket | (((size_t)1 << h->precision) - 1)) + 1;
+		h->counts = realloc(h->counts, num_buckets * sizeof(uint64_t));
+		assert(h->counts != NULL);
+		memset(h->counts + h->num_buckets, 0, (num_buckets - h->num_buckets) * sizeof(uint64_t));
+		h->num_buckets = num_buckets;
+	}
+	
+	h->counts[bucket]++;
+	h->count++;
+	h->sum += (double)value;
+	if (value > h->max)
+		h->max = value;
+}
+
+
+void
+histogram_merge(histogram_t *h, histogram_t *other)
+{
+	assert(h->precision == other->precision);
+	
+	if (other->count == 0)
+		return;
+	
+	// Allocate buckets for the largest value in the other histogram
+	if (other->num_buckets > h->num_buckets) {
+		h->counts = realloc(h->counts, other->num_buckets * sizeof(uint64_t));
+		assert(h->counts != NULL);
+		memset(h->counts + h->num_buckets, 0, (other->num_buckets - h->num_buckets) * sizeof(uint64_t));
+		h->num_buckets = other->num_buckets;
+	}
+	
+	for (size_t bucket = 0; bucket < other->num_buckets; bucket++)
+		h->counts[bucket] += other->counts[bucket];
+	
+	h->count += other->count;
+	h->sum   += other->sum;
+	if (other->max > h->max)
+		h->max = other->max;
+}
+
+
+uint64_t
+histogram_get_count(histogram_t *h)
+{
+	return h->count;
+}
+
+
+uint64_t
+histogram_get_max(histogram_t *h)
+{
+	return h->max;
+}
+
+
+double
+histogram_get_mean(histogram_t *h)
+{
+	return (h->count > 0) ? h->sum / (double)h->count : 0.0;
+}
+
+
+uint64_t
+histogram_get_quantile(histogram_t *h, double q)
+{
+	if (h->count == 0)
+		return 0;
+	
+	// The rank of the value wanted (counting from 1)
+	uint64_t rank = (uint64_t)ceil(q * (double)h->count);
+	if (rank < 1)
+		rank = 1;
+	if (rank > h->count)
+		rank = h->count;
+	
+	uint64_t seen = 0;
+	for (size_t bucket = 0; bucket < h->num_buckets; bucket++) {
+		seen += h->counts[bucket];
+		if (seen >= rank) {
+			uint64_t lower, upper;
+			bucket_range(h->precision, bucket, &lower, &upper);
+			return (upper < h->max) ? upper : h->max;
+		}
+	}
+	
+	// Unreachable: the counts sum to count
+	assert(0);
+	return h->max;
+}
+
+
+size_t
+histogram_get_num_buckets(histogram_t *h)
+{
+	return h->num_buckets;
+}
+
+
+uint64_t
+histogram_get_bucket( histogram_t *h
+                    , size_t       bucket
+                    , uint64_t    *lower
+                    , uint64_t    *upper
+                    )
+{
+	assert(bucket < h->num_buckets);
+	bucket_range(h->precision, bucket, lower, upper);
+	return h->counts[bucket];
+}
+
+
+void
+histogram_reset(histogram_t *h)
+{
+	if (h->num_buckets > 0)
+		memset(h->counts, 0, h->num_buckets * sizeof(uint64_t));
+	
+	h->count = 0;
+	h->max   = 0;
+	h->sum   = 0.0;
+}
+
+
+void
+histogram_destroy(histogram_t *h)
+{
+	free(h->counts);
+	h->counts      = NULL;
+	h->num_buckets = 0;
+}
@@ -0,0 +1,109 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * histogram.h -- Log-linear (HDR-style) histograms of non-negative integers
+ * giving cheap streaming quantile estimates.
+ *
+ * Values below 2^(precision+1) each have their own bucket. Above this, every
+ * power-of-two range of values is split into 2^precision equal-width buckets so
+ * the relative error of any value reported is below 2^-precision. The buckets
+ * are allocated as larger values are added so memory use grows with the
+ * logarithm of the largest value.
+ */
+
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "config.h"
+
+/**
+ * A histogram.
+ */
+typedef struct histogram histogram_t;
+
+
+// Concrete definitions of the above types
+#include "histogram_internal.h"
+
+
+/**
+ * Initialise an empty histogram.
+ *
+ * @param precision The log2 of the number of buckets per power of two, e.g. 5
+ *                  gives a relative error of at most 1/32.
+ */
+void histogram_init(histogram_t *h, int precision);
+
+
+/**
+ * Add a value to the histogram.
+ */
+void histogram_add(histogram_t *h, uint64_t value);
+
+
+/**
+ * Get the number of values added.
+ */
+uint64_t histogram_get_count(histogram_t *h);
+
+
+/**
+ * Get the largest value added (or 0 if none).
+ */
+uint64_t histogram_get_max(histogram_t *h);
+
+
+/**
+ * Get the mean of the values added (or 0 if none).
+ */
+double histogram_get_mean(histogram_t *h);
+
+
+/**
+ * Get an estimate of the q-quantile (0 <= q <= 1) of the values added: the
+ * largest value in the bucket containing the ceil(q*count)-th smallest value
+ * (or the largest value added if smaller). Returns 0 if no values were added.
+ */
+uint64_t histogram_get_quantile(histogram_t *h, double q);
+
+
+/**
+ * Get the number of buckets. Buckets are numbered in ascending order of value
+ * from zero and empty buckets may appear anywhere.
+ */
+size_t histogram_get_num_buckets(histogram_t *h);
+
+
+/**
+ * Get the number of values in a bucket and the (inclusive) range of values it
+ * covers.
+ */
+uint64_t histogram_get_bucket( histogram_t *h
+                             , size_t       bucket
+                             , uint64_t    *lower
+                             , uint64_t    *upper
+                             );
+
+
+/**
+ * Add all of the values in another histogram (which must have the same
+ * precision) to a histogram.
+ */
+void histogram_merge(histogram_t *h, histogram_t *other);
+
+
+/**
+ * Remove all values from the histogram.
+ */
+void histogram_reset(histogram_t *h);
+
+
+/**
+ * Free the resources used by a histogram.
+ */
+void histogram_destroy(histogram_t *h);
+
+#endif
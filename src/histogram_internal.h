@@ -0,0 +1,23 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * histogram_internal.h -- Concrete definitions of internal datastrucutres.
+ * This is provided to allow the creation of these types. Users should not
+ * access the fields directly. This file should only be included by
+ * histogram.h
+ */
+
+struct histogram {
+	int precision;
+	
+	// The count of each bucket. Only enough buckets for the largest value added
+	// so far are allocated.
+	uint64_t *counts;
+	size_t    num_buckets;
+	
+	uint64_t count;
+	uint64_t max;
+	
+	// The sum of all values added (for the mean)
+	double sum;
+};
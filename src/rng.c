@@ -0,0 +1,89 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * rng.c -- A small, fast pseudo-random number generator with independent,
+ * reproducible streams.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "config.h"
+
+#include "rng.h"
+
+
+/**
+ * One step of the splitmix64 generator, used to scramble seeds.
+ */
+static uint64_t
+splitmix64(uint64_t *x)
+{
+	uint64_t z = (*x += 0x9E3779B97F4A7C15ull);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+
+void
+rng_init(rng_t *r, uint64_t seed, uint64_t stream)
+{
+	// Scramble the seed and stream together so that nearby seeds and streams
+	// give unrelated states
+	uint64_t x = seed;
+	x = splitmix64(&x) ^ stream;
+	r->state = splitmix64(&x);
+	
+	// The all-zero state is a fixed point
+	if (r->state == 0)
+		r->state = 0x9E3779B97F4A7C15ull;
+}
+
+
+uint64_t
+rng_next(rng_t *r)
+{
+	r->state ^= r->state >> 12;
+	r->state ^= r->state << 25;
+	r->state ^= r->state >> 27;
+	return r->state * 0x2545F4914F6CDD1Dull;
+}
+
+
+double
+rng_uniform(rng_t *r)
+{
+	if (r == NULL)
+		return ((double)rand())/((double)RAND_MAX+1.0);
+	
+	// The top 53 bits give every representable double in [0, 1) with equal
+	// spacing
+	return (double)(rng_next(r) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+
+double
+rng_uniform_pos(rng_t *r)
+{
+	if (r == NULL)
+		return (((double)rand())+1.0)/((double)RAND_MAX+1.0);
+	
+	return (double)((rng_next(r) >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
+
+
+bool
+rng_save(rng_t *r, FILE *f)
+{
+	return fwrite(&(r->state), sizeof(r->state), 1, f) == 1;
+}
+
+
+bool
+rng_restore(rng_t *r, FILE *f)
+{
+	return fread(&(r->state), sizeof(r->state), 1, f) == 1 && r->state != 0;
+}
@@ -0,0 +1,72 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * rng.h -- A small, fast pseudo-random number generator with independent,
+ * reproducible streams.
+ *
+ * Each generator is identified by a seed and a stream number so that, for
+ * example, every packet generator in a model can draw from its own stream which
+ * is unaffected by the number of random numbers drawn elsewhere in the model.
+ * The generator is xorshift64* seeded via splitmix64.
+ *
+ * Functions which draw random numbers accept a NULL generator in which case the
+ * C library's rand() is used instead (the historical behaviour of the
+ * simulator).
+ */
+
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "config.h"
+
+/**
+ * A random number generator's state.
+ */
+typedef struct rng rng_t;
+
+
+// Concrete definitions of the above types
+#include "rng_internal.h"
+
+
+/**
+ * Initialise a generator to the start of the given stream for the given seed.
+ */
+void rng_init(rng_t *r, uint64_t seed, uint64_t stream);
+
+
+/**
+ * Draw a uniformly distributed 64-bit integer.
+ */
+uint64_t rng_next(rng_t *r);
+
+
+/**
+ * Draw a number uniformly distributed on [0, 1). If r is NULL, rand() is used.
+ */
+double rng_uniform(rng_t *r);
+
+
+/**
+ * Draw a number uniformly distributed on (0, 1]. If r is NULL, rand() is used.
+ */
+double rng_uniform_pos(rng_t *r);
+
+
+/**
+ * Write the state of the generator to a snapshot file. Returns false on failure.
+ */
+bool rng_save(rng_t *r, FILE *f);
+
+
+/**
+ * Restore the state of a generator from a snapshot file. Returns false on
+ * failure.
+ */
+bool rng_restore(rng_t *r, FILE *f);
+
+#endif
@@ -0,0 +1,12 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * rng_internal.h -- Concrete definitions of internal datastrucutres. This is
+ * provided to allow the creation of these types. Users should not access the
+ * fields directly. This file should only be included by rng.h
+ */
+
+struct rng {
+	// The xorshift64* state (never zero)
+	uint64_t state;
+};
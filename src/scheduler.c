@@ -127,6 +127,13 @@ scheduler_get_ticks(scheduler_t *s)
 }
 
 
+void
+scheduler_set_ticks(scheduler_t *s, ticks_t ticks)
+{
+	s->ticks = ticks;
+}
+
+
 void
 scheduler_tick_tock(scheduler_t *s)
 {
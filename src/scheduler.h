@@ -73,6 +73,13 @@ void scheduler_schedule( scheduler_t *scheduler
  */
 ticks_t scheduler_get_ticks(scheduler_t *scheduler);
 
+/**
+ * Set the current simulation time, e.g. when restoring a snapshot. Components
+ * with a period are called when the time is a multiple of their period and so
+ * the phase of each component is also set.
+ */
+void scheduler_set_ticks(scheduler_t *scheduler, ticks_t ticks);
+
 /**
  * Run the simulation for a single time-step.
  */
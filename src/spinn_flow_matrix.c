@@ -0,0 +1,202 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * spinn_flow_matrix.c -- Source-destination matrices of packet flows.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+
+#include "config.h"
+
+#include "spinn.h"
+#include "spinn_flow_matrix.h"
+
+
+/******************************************************************************
+ * Internal: Utilities
+ ******************************************************************************/
+
+/**
+ * Get the number of nodes in the system.
+ */
+static size_t
+num_nodes(spinn_flow_matrix_t *m)
+{
+	return (size_t)m->system_size.x * (size_t)m->system_size.y;
+}
+
+
+/**
+ * Get the index of the matrix element for a flow.
+ */
+static size_t
+element_of(spinn_flow_matrix_t *m, spinn_coord_t source, spinn_coord_t destination)
+{
+	size_t source_node      = (source.y * m->system_size.x) + source.x;
+	size_t destination_node = (destination.y * m->system_size.x) + destination.x;
+	assert(source_node < num_nodes(m));
+	assert(destination_node < num_nodes(m));
+	
+	return (m->source_of[source_node] * num_nodes(m)) + destination_node;
+}
+
+
+/******************************************************************************
+ * Public functions
+ ******************************************************************************/
+
+void
+spinn_flow_matrix_init( spinn_flow_matrix_t *m
+                      , spinn_coord_t        system_size
+                      , size_t               num_sources
+                      , const uint32_t      *source_of
+                      )
+{
+	m->system_size = system_size;
+	m->num_sources = num_sources;
+	
+	m->source_of = calloc(num_nodes(m), sizeof(uint32_t));
+	assert(m->source_of != NULL);
+	for (size_t i = 0; i < num_nodes(m); i++) {
+		assert(source_of[i] < num_sources);
+		m->source_of[i] = source_of[i];
+	}
+	
+	size_t num_elements = num_sources * num_nodes(m);
+	m->num_delivered = calloc(num_elements, sizeof(uint32_t));
+	m->num_dropped   = calloc(num_elements, sizeof(uint32_t));
+	m->latency_sum   = calloc(num_elements, sizeof(uint64_t));
+	m->latency_max   = calloc(num_elements, sizeof(uint32_t));
+	assert(m->num_delivered != NULL);
+	assert(m->num_dropped != NULL);
+	assert(m->latency_sum != NULL);
+	assert(m->latency_max != NULL);
+}
+
+
+void
+spinn_flow_matrix_add_delivered( spinn_flow_matrix_t *m
+                               , spinn_coord_t        source
+                               , spinn_coord_t        destination
+                               , ticks_t              latency
+                               )
+{
+	size_t i = element_of(m, source, destination);
+	
+	m->num_delivered[i]++;
+	m->latency_sum[i] += latency;
+	if (latency > m->latency_max[i])
+		m->latency_max[i] = latency;
+}
+
+
+void
+spinn_flow_matrix_add_dropped( spinn_flow_matrix_t *m
+                             , spinn_coord_t        source
+                             , spinn_coord_t        destination
+                             )
+{
+	m->num_dropped[element_of(m, source, destination)]++;
+}
+
+
+uint32_t
+spinn_flow_matrix_get_num_delivered( spinn_flow_matrix_t *m
+                                   , spinn_coord_t        source
+                                   , spinn_coord_t        destination
+                                   )
+{
+	return m->num_delivered[element_of(m, source, destination)];
+}
+
+
+uint32_t
+spinn_flow_matrix_get_num_dropped( spinn_flow_matrix_t *m
+                                 , spinn_coord_t        source
+                                 , spinn_coord_t        destination
+                                 )
+{
+	return m->num_dropped[element_of(m, source, destination)];
+}
+
+
+uint64_t
+spinn_flow_matrix_get_latency_sum( spinn_flow_matrix_t *m
+                                 , spinn_coord_t        source
+                                 , spinn_coord_t        destination
+                                 )
+{
+	return m->latency_sum[element_of(m, source, destination)];
+}
+
+
+uint32_t
+spinn_flow_matrix_get_latency_max( spinn_flow_matrix_t *m
+                                 , spinn_coord_t        source
+                                 , spinn_coord_t        destination
+                                 )
+{
+	return m->latency_max[element_of(m, source, destination)];
+}
+
+
+void
+spinn_flow_matrix_reset(spinn_flow_matrix_t *m)
+{
+	size_t num_elements = m->num_sources * num_nodes(m);
+	memset(m->num_delivered, 0, num_elements * sizeof(uint32_t));
+	memset(m->num_dropped,   0, num_elements * sizeof(uint32_t));
+	memset(m->latency_sum,   0, num_elements * sizeof(uint64_t));
+	memset(m->latency_max,   0, num_elements * sizeof(uint32_t));
+}
+
+
+bool
+spinn_flow_matrix_write(spinn_flow_matrix_t *m, const char *filename)
+{
+	FILE *f = fopen(filename, "wb");
+	if (f == NULL) {
+		fprintf(stderr, "Couldn't open %s for writing: %s\n", filename, strerror(errno));
+		return false;
+	}
+	
+	spinn_flow_matrix_header_t header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, SPINN_FLOW_MATRIX_MAGIC, sizeof(header.magic));
+	header.version     = SPINN_FLOW_MATRIX_VERSION;
+	header.byte_order  = SPINN_FLOW_MATRIX_BYTE_ORDER;
+	header.width       = m->system_size.x;
+	header.height      = m->system_size.y;
+	header.num_sources = m->num_sources;
+	
+	size_t num_elements = m->num_sources * num_nodes(m);
+	bool success = fwrite(&header, sizeof(header), 1, f) == 1
+	               && fwrite(m->source_of,     sizeof(uint32_t), num_nodes(m), f) == num_nodes(m)
+	               && fwrite(m->num_delivered, sizeof(uint32_t), num_elements, f) == num_elements
+	               && fwrite(m->num_dropped,   sizeof(uint32_t), num_elements, f) == num_elements
+	               && fwrite(m->latency_sum,   sizeof(uint64_t), num_elements, f) == num_elements
+	               && fwrite(m->latency_max,   sizeof(uint32_t), num_elements, f) == num_elements;
+	
+	if (fclose(f) != 0)
+		success = false;
+	if (!success)
+		fprintf(stderr, "Couldn't write %s.\n", filename);
+	
+	return success;
+}
+
+
+void
+spinn_flow_matrix_destroy(spinn_flow_matrix_t *m)
+{
+	free(m->source_of);
+	free(m->num_delivered);
+	free(m->num_dropped);
+	free(m->latency_sum);
+	free(m->latency_max);
+}
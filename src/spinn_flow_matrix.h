@@ -0,0 +1,132 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * spinn_flow_matrix.h -- Source-destination matrices of the packets delivered
+ * and dropped and their latencies accumulated in memory.
+ *
+ * Each matrix has a column for every node (the destination) and a row for every
+ * source where sources may be individual nodes or groups of nodes (e.g. every
+ * node on a board). A flow matrix file consists of a fixed-size header, the row
+ * of each node as a source (a uint32_t per node) and then the matrices of
+ * packets delivered (uint32_t), packets dropped (uint32_t), the sum of the
+ * latencies (uint64_t) and the largest latency (uint32_t) of the delivered
+ * packets, each stored row by row. Nodes are given in the same row-major order
+ * as the nodes of a simulation. All fields are stored in the host's byte order.
+ */
+
+#ifndef SPINN_FLOW_MATRIX_H
+#define SPINN_FLOW_MATRIX_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "config.h"
+
+#include "scheduler.h"
+
+#include "spinn.h"
+
+/**
+ * A set of flow matrices.
+ */
+typedef struct spinn_flow_matrix spinn_flow_matrix_t;
+
+
+// Concrete definitions of the above types
+#include "spinn_flow_matrix_internal.h"
+
+
+/**
+ * Initialise a set of empty flow matrices.
+ *
+ * @param system_size The size of the system.
+ * @param num_sources The number of rows in each matrix.
+ * @param source_of The row (less than num_sources) of each node, in row-major
+ *                  order. This array is copied.
+ */
+void spinn_flow_matrix_init( spinn_flow_matrix_t *m
+                           , spinn_coord_t        system_size
+                           , size_t               num_sources
+                           , const uint32_t      *source_of
+                           );
+
+
+/**
+ * Record the delivery of a packet.
+ */
+void spinn_flow_matrix_add_delivered( spinn_flow_matrix_t *m
+                                    , spinn_coord_t        source
+                                    , spinn_coord_t        destination
+                                    , ticks_t              latency
+                                    );
+
+
+/**
+ * Record a packet being dropped.
+ */
+void spinn_flow_matrix_add_dropped( spinn_flow_matrix_t *m
+                                  , spinn_coord_t        source
+                                  , spinn_coord_t        destination
+                                  );
+
+
+/**
+ * Get the number of packets delivered from the given source node's row to the
+ * given destination.
+ */
+uint32_t spinn_flow_matrix_get_num_delivered( spinn_flow_matrix_t *m
+                                            , spinn_coord_t        source
+                                            , spinn_coord_t        destination
+                                            );
+
+
+/**
+ * Get the number of packets dropped from the given source node's row to the
+ * given destination.
+ */
+uint32_t spinn_flow_matrix_get_num_dropped( spinn_flow_matrix_t *m
+                                          , spinn_coord_t        source
+                                          , spinn_coord_t        destination
+                                          );
+
+
+/**
+ * Get the sum of the latencies of the packets delivered from the given source
+ * node's row to the given destination.
+ */
+uint64_t spinn_flow_matrix_get_latency_sum( spinn_flow_matrix_t *m
+                                          , spinn_coord_t        source
+                                          , spinn_coord_t        destination
+                                          );
+
+
+/**
+ * Get the largest latency of the packets delivered from the given source
+ * node's row to the given destination (or 0 if none).
+ */
+uint32_t spinn_flow_matrix_get_latency_max( spinn_flow_matrix_t *m
+                                          , spinn_coord_t        source
+                                          , spinn_coord_t        destination
+                                          );
+
+
+/**
+ * Reset every matrix to zero.
+ */
+void spinn_flow_matrix_reset(spinn_flow_matrix_t *m);
+
+
+/**
+ * Write the matrices to the named file. Returns false and prints a description
+ * of the problem on stderr on failure.
+ */
+bool spinn_flow_matrix_write(spinn_flow_matrix_t *m, const char *filename);
+
+
+/**
+ * Free the resources used by a set of flow matrices.
+ */
+void spinn_flow_matrix_destroy(spinn_flow_matrix_t *m);
+
+#endif
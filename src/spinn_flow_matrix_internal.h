@@ -0,0 +1,53 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * spinn_flow_matrix_internal.h -- Concrete definitions of internal
+ * datastrucutres. This is provided to allow the creation of these types. Users
+ * should not access the fields directly. This file should only be included by
+ * spinn_flow_matrix.h
+ */
+
+
+/**
+ * The header at the start of every flow matrix file.
+ */
+typedef struct spinn_flow_matrix_header {
+	// Always SPINN_FLOW_MATRIX_MAGIC
+	char magic[8];
+	
+	// Always SPINN_FLOW_MATRIX_VERSION
+	uint32_t version;
+	
+	// Always SPINN_FLOW_MATRIX_BYTE_ORDER when read in the byte order of the
+	// writer
+	uint32_t byte_order;
+	
+	// The size of the system recorded
+	uint32_t width;
+	uint32_t height;
+	
+	// The number of rows (sources) in each matrix
+	uint32_t num_sources;
+} spinn_flow_matrix_header_t;
+
+#define SPINN_FLOW_MATRIX_MAGIC      "TICKYFLM"
+#define SPINN_FLOW_MATRIX_VERSION    1
+#define SPINN_FLOW_MATRIX_BYTE_ORDER 0x01020304u
+
+
+struct spinn_flow_matrix {
+	spinn_coord_t system_size;
+	
+	// The row of the matrices to which each node's packets are added (indexed
+	// in row-major order) and the number of rows.
+	uint32_t *source_of;
+	size_t    num_sources;
+	
+	// The matrices, each with a row per source and a column per destination
+	// node (in row-major order).
+	uint32_t *num_delivered;
+	uint32_t *num_dropped;
+	uint64_t *latency_sum;
+	uint32_t *latency_max;
+};
+
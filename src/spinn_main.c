@@ -7,8 +7,16 @@
 #include "config.h"
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <unistd.h>
+#include <getopt.h>
 
 #include "spinn_sim.h"
+#include "spinn_sim_config.h"
+#include "spinn_sim_parallel.h"
+#include "spinn_sim_cost.h"
 
 
 
@@ -19,13 +27,56 @@
 int
 main(int argc, char *argv[])
 {
-	if (argc < 2) {
-		fprintf(stderr, "Usage: %s config_file [key=value,...]\n", argv[0]);
+	// Number of worker processes to use (0 = one per processor)
+	int num_workers = 1;
+	
+	// Only predict the run time of the experiment?
+	bool plan = false;
+	
+	static const struct option long_options[] = {
+		{"plan", no_argument, NULL, 'p'},
+		{NULL,   0,           NULL, 0},
+	};
+	
+	int opt;
+	while ((opt = getopt_long(argc, argv, "+j:", long_options, NULL)) != -1) {
+		switch (opt) {
+			case 'p':
+				plan = true;
+				break;
+			
+			case 'j':
+				num_workers = atoi(optarg);
+				if (num_workers >= 0)
+					break;
+				// Fall through
+			
+			default:
+				fprintf(stderr, "Usage: %s [-j N] [--plan] config_file [key=value,...]\n", argv[0]);
+				return -1;
+		}
+	}
+	
+	if (argc - optind < 1) {
+		fprintf(stderr, "Usage: %s [-j N] [--plan] config_file [key=value,...]\n", argv[0]);
 		return -1;
 	}
 	
 	spinn_sim_t sim;
-	spinn_sim_init(&sim, argv[1], argc - 2, argv+2);
-	spinn_sim_run(&sim);
+	
+	// Planning must not truncate the result files so only the configuration is
+	// loaded
+	if (plan) {
+		spinn_sim_config_init(&sim, argv[optind], argc - optind - 1, argv + optind + 1);
+		spinn_sim_cost_plan(&sim, num_workers);
+		spinn_sim_config_destroy(&sim);
+		return 0;
+	}
+	
+	spinn_sim_init(&sim, argv[optind], argc - optind - 1, argv + optind + 1);
+	if (num_workers == 1)
+		spinn_sim_run(&sim);
+	else
+		spinn_sim_parallel_run(&sim, num_workers);
 	spinn_sim_destroy(&sim);
 }
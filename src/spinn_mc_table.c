@@ -0,0 +1,347 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * spinn_mc_table.c -- Multicast routing tables with a compiled lookup
+ * structure.
+ */
+
+
+#include "config.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "spinn.h"
+#include "spinn_mc_table.h"
+
+
+/**
+ * Maximum length of a line in a routing table file.
+ */
+#define SPINN_MC_TABLE_MAX_LINE_LENGTH 1024
+
+
+/**
+ * An entry along with its priority, used while compiling.
+ */
+typedef struct {
+	spinn_mc_table_entry_t entry;
+	size_t priority;
+} spinn_mc_table_prioritised_entry_t;
+
+
+static int
+spinn_mc_table_entry_cmp(const void *a_, const void *b_)
+{
+	const spinn_mc_table_prioritised_entry_t *a = (const spinn_mc_table_prioritised_entry_t *)a_;
+	const spinn_mc_table_prioritised_entry_t *b = (const spinn_mc_table_prioritised_entry_t *)b_;
+	if (a->entry.mask != b->entry.mask)
+		return (a->entry.mask < b->entry.mask) ? -1 : 1;
+	if (a->entry.key != b->entry.key)
+		return (a->entry.key < b->entry.key) ? -1 : 1;
+	if (a->priority != b->priority)
+		return (a->priority < b->priority) ? -1 : 1;
+	return 0;
+}
+
+
+static int
+spinn_mc_table_group_cmp(const void *a_, const void *b_)
+{
+	const spinn_mc_table_group_t *a = (const spinn_mc_table_group_t *)a_;
+	const spinn_mc_table_group_t *b = (const spinn_mc_table_group_t *)b_;
+	if (a->first_priority != b->first_priority)
+		return (a->first_priority < b->first_priority) ? -1 : 1;
+	return 0;
+}
+
+
+/**
+ * Free the compiled form of the table.
+ */
+static void
+spinn_mc_table_free_groups(spinn_mc_table_t *table)
+{
+	for (size_t i = 0; i < table->num_groups; i++) {
+		free(table->groups[i].keys);
+		free(table->groups[i].routes);
+		free(table->groups[i].priorities);
+	}
+	free(table->groups);
+	table->groups     = NULL;
+	table->num_groups = 0;
+}
+
+
+void
+spinn_mc_table_init(spinn_mc_table_t *table)
+{
+	table->entries_size = 16;
+	table->num_entries  = 0;
+	table->entries = calloc(table->entries_size, sizeof(spinn_mc_table_entry_t));
+	assert(table->entries != NULL);
+	
+	table->groups     = NULL;
+	table->num_groups = 0;
+}
+
+
+void
+spinn_mc_table_add_entry( spinn_mc_table_t *table
+                        , uint32_t          key
+                        , uint32_t          mask
+                        , uint32_t          route
+                        )
+{
+	// Grow the array as required
+	if (table->num_entries == table->entries_size) {
+		table->entries_size *= 2;
+		table->entries = realloc(table->entries, table->entries_size * sizeof(spinn_mc_table_entry_t));
+		assert(table->entries != NULL);
+	}
+	
+	table->entries[table->num_entries].key   = key;
+	table->entries[table->num_entries].mask  = mask;
+	table->entries[table->num_entries].route = route;
+	table->num_entries++;
+}
+
+
+size_t
+spinn_mc_table_get_num_entries(spinn_mc_table_t *table)
+{
+	return table->num_entries;
+}
+
+
+void
+spinn_mc_table_compile(spinn_mc_table_t *table)
+{
+	spinn_mc_table_free_groups(table);
+	
+	// Sort the entries by mask and then key, keeping the priority order of
+	// entries with the same mask and key.
+	spinn_mc_table_prioritised_entry_t *sorted
+		= calloc(table->num_entries + 1, sizeof(spinn_mc_table_prioritised_entry_t));
+	assert(sorted != NULL);
+	size_t num_sorted = 0;
+	for (size_t i = 0; i < table->num_entries; i++) {
+		// Entries with key bits outside the mask can never match
+		if (table->entries[i].key & ~table->entries[i].mask)
+			continue;
+		
+		sorted[num_sorted].entry    = table->entries[i];
+		sorted[num_sorted].priority = i;
+		num_sorted++;
+	}
+	qsort(sorted, num_sorted, sizeof(spinn_mc_table_prioritised_entry_t), spinn_mc_table_entry_cmp);
+	
+	// Count the groups
+	for (size_t i = 0; i < num_sorted; i++)
+		if (i == 0 || sorted[i].entry.mask != sorted[i-1].entry.mask)
+			table->num_groups++;
+	
+	table->groups = calloc(table->num_groups + 1, sizeof(spinn_mc_table_group_t));
+	assert(table->groups != NULL);
+	
+	// Fill in each group. Entries with the same mask and key as a higher
+	// priority entry are shadowed and so are left out.
+	size_t first = 0;
+	for (size_t g = 0; g < table->num_groups; g++) {
+		spinn_mc_table_group_t *group = &(table->groups[g]);
+		group->mask = sorted[first].entry.mask;
+		
+		size_t last = first;
+		while (last < num_sorted && sorted[last].entry.mask == group->mask)
+			last++;
+		
+		group->keys       = calloc(last - first, sizeof(uint32_t));
+		group->routes     = calloc(last - first, sizeof(uint32_t));
+		group->priorities = calloc(last - first, sizeof(size_t));
+		assert(group->keys != NULL);
+		assert(group->routes != NULL);
+		assert(group->priorities != NULL);
+		
+		group->num_entries    = 0;
+		group->first_priority = sorted[first].priority;
+		for (size_t i = first; i < last; i++) {
+			if (i != first && sorted[i].entry.key == sorted[i-1].entry.key)
+				continue;
+			
+			group->keys[group->num_entries]       = sorted[i].entry.key;
+			group->routes[group->num_entries]     = sorted[i].entry.route;
+			group->priorities[group->num_entries] = sorted[i].priority;
+			group->num_entries++;
+			
+			if (sorted[i].priority < group->first_priority)
+				group->first_priority = sorted[i].priority;
+		}
+		
+		first = last;
+	}
+	
+	free(sorted);
+	
+	// Search the groups containing the highest priority entries first so that
+	// the search can stop as soon as no remaining group could contain a higher
+	// priority match.
+	qsort(table->groups, table->num_groups, sizeof(spinn_mc_table_group_t), spinn_mc_table_group_cmp);
+}
+
+
+bool
+spinn_mc_table_lookup( const spinn_mc_table_t *table
+                     , uint32_t                key
+                     , uint32_t               *route
+                     )
+{
+	bool found = false;
+	size_t best_priority = 0;
+	
+	for (size_t g = 0; g < table->num_groups; g++) {
+		const spinn_mc_table_group_t *group = &(table->groups[g]);
+		
+		// No entry in this or any later group can beat the match found
+		if (found && group->first_priority > best_priority)
+			break;
+		
+		// Binary search for the masked key
+		uint32_t masked_key = key & group->mask;
+		size_t low  = 0;
+		size_t high = group->num_entries;
+		while (low < high) {
+			size_t mid = low + ((high - low) / 2);
+			if (group->keys[mid] < masked_key)
+				low = mid + 1;
+			else
+				high = mid;
+		}
+		
+		if (low < group->num_entries
+		    && group->keys[low] == masked_key
+		    && (!found || group->priorities[low] < best_priority)) {
+			found         = true;
+			best_priority = group->priorities[low];
+			*route        = group->routes[low];
+		}
+	}
+	
+	return found;
+}
+
+
+/**
+ * Parse an unsigned 32-bit number in decimal, hex or octal. Returns false if the
+ * string is not such a number.
+ */
+static bool
+spinn_mc_table_parse_uint32(const char *str, uint32_t *value)
+{
+	char *end;
+	unsigned long long v = strtoull(str, &end, 0);
+	if (*str == '\0' || *str == '-' || *end != '\0' || v > 0xFFFFFFFFull)
+		return false;
+	
+	*value = (uint32_t)v;
+	return true;
+}
+
+
+bool
+spinn_mc_table_load( spinn_mc_table_t *tables
+                   , spinn_coord_t     system_size
+                   , const char       *filename
+                   )
+{
+	FILE *f = fopen(filename, "r");
+	if (f == NULL) {
+		fprintf(stderr, "Couldn't open multicast routing table file %s!\n", filename);
+		return false;
+	}
+	
+	char line[SPINN_MC_TABLE_MAX_LINE_LENGTH];
+	char key_str[SPINN_MC_TABLE_MAX_LINE_LENGTH];
+	char mask_str[SPINN_MC_TABLE_MAX_LINE_LENGTH];
+	char route_str[SPINN_MC_TABLE_MAX_LINE_LENGTH];
+	char extra[SPINN_MC_TABLE_MAX_LINE_LENGTH];
+	int line_num = 0;
+	while (fgets(line, SPINN_MC_TABLE_MAX_LINE_LENGTH, f) != NULL) {
+		line_num++;
+		
+		// Skip blank lines and comments
+		const char *c = line;
+		while (isspace((unsigned char)*c))
+			c++;
+		if (*c == '\0' || *c == '#')
+			continue;
+		
+		spinn_coord_t position;
+		uint32_t key;
+		uint32_t mask;
+		uint32_t route;
+		if (sscanf( line, "%d %d %s %s %s %s"
+		          , &(position.x), &(position.y)
+		          , key_str, mask_str, route_str
+		          , extra
+		          ) != 5
+		    || !spinn_mc_table_parse_uint32(key_str, &key)
+		    || !spinn_mc_table_parse_uint32(mask_str, &mask)
+		    || !spinn_mc_table_parse_uint32(route_str, &route)) {
+			fprintf(stderr, "%s:%d: Expected '<x> <y> <key> <mask> <route>'.\n", filename, line_num);
+			fclose(f);
+			return false;
+		}
+		
+		if (position.x < 0 || position.x >= system_size.x
+		    || position.y < 0 || position.y >= system_size.y) {
+			fprintf(stderr, "%s:%d: Chip (%d,%d) is outside the %dx%d system.\n"
+			              , filename, line_num
+			              , position.x, position.y
+			              , system_size.x, system_size.y
+			              );
+			fclose(f);
+			return false;
+		}
+		
+		if (key & ~mask) {
+			fprintf(stderr, "%s:%d: Key 0x%08x has bits set outside of mask 0x%08x.\n"
+			              , filename, line_num
+			              , key, mask
+			              );
+			fclose(f);
+			return false;
+		}
+		
+		if (route & ~((1u << 7) - 1u)) {
+			fprintf(stderr, "%s:%d: Route 0x%x selects non-existent outputs.\n"
+			              , filename, line_num
+			              , route
+			              );
+			fclose(f);
+			return false;
+		}
+		
+		spinn_mc_table_add_entry( &(tables[(position.y * system_size.x) + position.x])
+		                        , key, mask, route
+		                        );
+	}
+	fclose(f);
+	
+	for (int i = 0; i < system_size.x * system_size.y; i++)
+		spinn_mc_table_compile(&(tables[i]));
+	
+	return true;
+}
+
+
+void
+spinn_mc_table_destroy(spinn_mc_table_t *table)
+{
+	spinn_mc_table_free_groups(table);
+	free(table->entries);
+}
@@ -0,0 +1,104 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * spinn_mc_table.h -- Multicast routing tables. As in SpiNNaker, each entry
+ * consists of a key, a mask and a route. A packet's key matches an entry if
+ * (packet key & mask) == key and the route of the first (highest priority)
+ * matching entry is used. A route is a bit set of router outputs with bit i
+ * set if packets should be sent via the output in direction i (see
+ * spinn_direction_t).
+ *
+ * Entries are added in priority order and then the table is compiled into a
+ * structure which supports fast lookups: entries are grouped by mask and each
+ * group is sorted by key allowing a binary search per distinct mask.
+ */
+
+#ifndef SPINN_MC_TABLE_H
+#define SPINN_MC_TABLE_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "config.h"
+
+#include "spinn.h"
+
+/**
+ * A multicast routing table.
+ */
+typedef struct spinn_mc_table spinn_mc_table_t;
+
+
+// Concrete definitions of the above types
+#include "spinn_mc_table_internal.h"
+
+
+/**
+ * Initialise an empty routing table.
+ */
+void spinn_mc_table_init(spinn_mc_table_t *table);
+
+
+/**
+ * Add an entry to the table with a lower priority than all existing entries.
+ * Entries whose key has bits set outside the mask can never match. Tables must
+ * be (re)compiled after entries are added.
+ */
+void spinn_mc_table_add_entry( spinn_mc_table_t *table
+                             , uint32_t          key
+                             , uint32_t          mask
+                             , uint32_t          route
+                             );
+
+
+/**
+ * Get the number of entries added to the table.
+ */
+size_t spinn_mc_table_get_num_entries(spinn_mc_table_t *table);
+
+
+/**
+ * Compile the table's entries ready for lookups.
+ */
+void spinn_mc_table_compile(spinn_mc_table_t *table);
+
+
+/**
+ * Look up the route for a key in a compiled table. Returns false if no entry
+ * matches.
+ */
+bool spinn_mc_table_lookup( const spinn_mc_table_t *table
+                          , uint32_t                key
+                          , uint32_t               *route
+                          );
+
+
+/**
+ * Load the routing tables of every router in a system from the named file. The
+ * tables argument is an array of already initialised tables, one per chip in
+ * row-major order. Each line of the file adds an entry to a chip's table and
+ * is of the form:
+ *
+ *   <x> <y> <key> <mask> <route>
+ *
+ * Where the key, mask and route may be given in decimal, hex (with a 0x prefix)
+ * or octal (with a 0 prefix). Entries are given in priority order. Blank lines
+ * and lines starting with a '#' are ignored. All tables are compiled once
+ * loaded.
+ *
+ * Returns false and prints a description of the problem on stderr if the file
+ * could not be read or is not valid.
+ */
+bool spinn_mc_table_load( spinn_mc_table_t *tables
+                        , spinn_coord_t     system_size
+                        , const char       *filename
+                        );
+
+
+/**
+ * Free all resources used by the table.
+ */
+void spinn_mc_table_destroy(spinn_mc_table_t *table);
+
+#endif
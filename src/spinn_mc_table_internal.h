@@ -0,0 +1,48 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * spinn_mc_table_internal.h -- Concrete definitions of internal
+ * datastrucutres. This is provided to allow the creation of these types. Users
+ * should not access the fields directly. This file should only be included by
+ * spinn_mc_table.h
+ */
+
+
+/**
+ * An entry in a routing table, as added.
+ */
+typedef struct spinn_mc_table_entry {
+	uint32_t key;
+	uint32_t mask;
+	uint32_t route;
+} spinn_mc_table_entry_t;
+
+
+/**
+ * A group of compiled entries which share a mask.
+ */
+typedef struct spinn_mc_table_group {
+	uint32_t mask;
+	
+	// The (distinct) keys of the entries in the group in ascending order along
+	// with their routes and priorities (their index in the list of entries).
+	size_t    num_entries;
+	uint32_t *keys;
+	uint32_t *routes;
+	size_t   *priorities;
+	
+	// The highest priority (i.e. lowest index) of any entry in the group
+	size_t first_priority;
+} spinn_mc_table_group_t;
+
+
+struct spinn_mc_table {
+	// The entries added to the table in priority order
+	spinn_mc_table_entry_t *entries;
+	size_t                  num_entries;
+	size_t                  entries_size;
+	
+	// The compiled groups of entries, sorted by first_priority
+	spinn_mc_table_group_t *groups;
+	size_t                  num_groups;
+};
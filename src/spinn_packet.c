@@ -9,14 +9,20 @@
 
 #include <assert.h>
 #include <stdlib.h>
+#include <stdio.h>
 #include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
 
 #include "scheduler.h"
 #include "buffer.h"
+#include "rng.h"
 
 #include "spinn.h"
 #include "spinn_packet.h"
 #include "spinn_topology.h"
+#include "spinn_trace.h"
 
 
 /******************************************************************************
@@ -39,6 +45,10 @@ spinn_packet_init_dor( spinn_packet_t *p
 	p->payload      = payload;
 	p->num_hops     = 0;
 	p->num_emg_hops = 0;
+	p->type         = SPINN_PACKET_P2P;
+	p->key          = 0;
+	p->stamp_time   = 0;
+	memset(p->latency, 0, sizeof(p->latency));
 	
 	// Calculate the vector to travel along
 	spinn_full_coord_t v;
@@ -87,6 +97,42 @@ spinn_packet_init_dor( spinn_packet_t *p
 	}
 }
 
+
+void
+spinn_packet_init_mc( spinn_packet_t *p
+                    , spinn_coord_t   source
+                    , uint32_t        key
+                    , void           *payload
+                    )
+{
+	p->type         = SPINN_PACKET_MC;
+	p->key          = key;
+	p->source       = source;
+	p->destination  = source;
+	p->emg_state    = SPINN_EMG_NORMAL;
+	p->payload      = payload;
+	p->num_hops     = 0;
+	p->num_emg_hops = 0;
+	p->stamp_time   = 0;
+	memset(p->latency, 0, sizeof(p->latency));
+	
+	// Multicast packets are not dimension-order routed
+	p->inflection_point     = source;
+	p->inflection_direction = SPINN_LOCAL;
+	p->direction            = SPINN_LOCAL;
+}
+
+
+void
+spinn_packet_stamp( spinn_packet_t         *p
+                  , ticks_t                 now
+                  , spinn_packet_latency_t  component
+                  )
+{
+	p->latency[component] += now - p->stamp_time;
+	p->stamp_time = now;
+}
+
 /******************************************************************************
  * Packet Pool
  ******************************************************************************/
@@ -130,6 +176,18 @@ spinn_packet_pool_get_num_packets(spinn_packet_pool_t *pool)
 }
 
 
+int
+spinn_packet_pool_get_num_in_use(spinn_packet_pool_t *pool)
+{
+	if (pool->free_packets_head == NULL)
+		return 0;
+	
+	// The head points at the top-most free packet (or just below the bottom of
+	// the stack when none are free)
+	return pool->num_packets - ((pool->free_packets_head + 1) - pool->free_packets);
+}
+
+
 spinn_packet_t *
 spinn_packet_pool_palloc(spinn_packet_pool_t *pool)
 {
@@ -159,7 +217,19 @@ spinn_packet_pool_palloc(spinn_packet_pool_t *pool)
 	}
 	
 	// Return a packet from the free-packet stack
-	return *(pool->free_packets_head--);
+	spinn_packet_t *packet = *(pool->free_packets_head--);
+	packet->ref_count = 1;
+	return packet;
+}
+
+
+void
+spinn_packet_pool_pretain( spinn_packet_pool_t *pool
+                         , spinn_packet_t      *packet
+                         )
+{
+	assert(packet->ref_count > 0);
+	packet->ref_count++;
 }
 
 
@@ -168,7 +238,11 @@ spinn_packet_pool_pfree( spinn_packet_pool_t *pool
                        , spinn_packet_t      *packet
                        )
 {
-	*(++pool->free_packets_head) = packet;
+	assert(packet->ref_count > 0);
+	
+	// Only return the packet to the pool once the last reference is released
+	if (--packet->ref_count == 0)
+		*(++pool->free_packets_head) = packet;
 }
 
 
@@ -177,6 +251,339 @@ spinn_packet_pool_pfree( spinn_packet_pool_t *pool
  * Packet generators
  ******************************************************************************/
 
+/**
+ * Pick a destination for a packet using the given spatial distribution. If the
+ * filter rejects the destination, loop until a destination is chosen which
+ * satisfies it. Returns false if the destination picked was (-1,-1) in which
+ * case no packet should be generated.
+ */
+static bool
+spinn_packet_gen_pick_destination( spinn_packet_gen_t                   *g
+                                 , spinn_packet_gen_spatial_dist_t       spatial_dist
+                                 , spinn_packet_gen_spatial_dist_data_t *spatial_dist_data
+                                 , spinn_coord_t                        *destination
+                                 )
+{
+	do {
+		switch (spatial_dist) {
+			case SPINN_GS_DIST_CYCLIC:
+				*destination = spatial_dist_data->cyclic.next_dest;
+				
+				// Move to the next node
+				spatial_dist_data->cyclic.next_dest.x ++;
+				if (spatial_dist_data->cyclic.next_dest.x >= g->system_size.x) {
+					spatial_dist_data->cyclic.next_dest.x = 0;
+					spatial_dist_data->cyclic.next_dest.y ++;
+					if (spatial_dist_data->cyclic.next_dest.y >= g->system_size.y) {
+						spatial_dist_data->cyclic.next_dest.y = 0;
+					}
+				}
+				break;
+			
+			default:
+			case SPINN_GS_DIST_UNIFORM:
+				destination->x = (int)(rng_uniform(g->spatial_rng) * g->system_size.x);
+				destination->y = (int)(rng_uniform(g->spatial_rng) * g->system_size.y);
+				break;
+			
+			case SPINN_GS_DIST_P2P:
+				destination->x = spatial_dist_data->p2p.target.x;
+				destination->y = spatial_dist_data->p2p.target.y;
+				break;
+			
+			case SPINN_GS_DIST_COMPLEMENT:
+				destination->x = g->system_size.x - g->position.x - 1;
+				destination->y = g->system_size.y - g->position.y - 1;
+				break;
+			
+			case SPINN_GS_DIST_TRANSPOSE:
+				destination->x = g->position.y;
+				destination->y = g->position.x;
+				break;
+			
+			case SPINN_GS_DIST_TORNADO:
+				destination->x = ((g->system_size.x/2) + g->position.x) % g->system_size.x;
+				destination->y = g->position.y;
+				break;
+			
+			case SPINN_GS_DIST_MULTICAST:
+				// Multicast packets have no destination to filter
+				*destination = g->position;
+				return true;
+		}
+		
+		// If destination is (-1,-1) then exit early and don't generate a packet
+		if (destination->x == -1 && destination->y == -1)
+			return false;
+	} while (g->dest_filter != NULL
+	         && !g->dest_filter(destination, g->dest_filter_data)
+	        );
+	
+	return true;
+}
+
+
+/**
+ * Produce a packet from this generator to the given destination, setting up its
+ * payload using the callback. If the spatial distribution used was multicast, a
+ * multicast packet is produced instead.
+ */
+static spinn_packet_t *
+spinn_packet_gen_new_packet( spinn_packet_gen_t                         *g
+                           , spinn_packet_gen_spatial_dist_t             spatial_dist
+                           , const spinn_packet_gen_spatial_dist_data_t *spatial_dist_data
+                           , spinn_coord_t                               destination
+                           )
+{
+	spinn_packet_t *p = spinn_packet_pool_palloc(g->pool);
+	if (spatial_dist == SPINN_GS_DIST_MULTICAST)
+		spinn_packet_init_mc(p, g->position, spatial_dist_data->multicast.key, NULL);
+	else
+		spinn_packet_init_dor(p, g->position, destination, g->system_size, g->use_wrap_around_links, NULL);
+	p->sent_time  = scheduler_get_ticks(g->scheduler);
+	p->stamp_time = p->sent_time;
+	
+	// Set up the payload and run the callback
+	if (g->on_packet_gen)
+		p->payload = g->on_packet_gen(p, g->on_packet_gen_data);
+	
+	return p;
+}
+
+
+/**
+ * Free the state of the cores temporal distribution (if allocated). If
+ * free_packets is set, any packets still queued in the cores are returned to
+ * the pool (this must not be done if the pool may already have been
+ * destroyed).
+ */
+static void
+spinn_packet_gen_cores_free(spinn_packet_gen_t *g, bool free_packets)
+{
+	if (g->cores.cores == NULL)
+		return;
+	
+	for (int i = 0; i < g->cores.num_cores; i++) {
+		if (free_packets)
+			while (!buffer_is_empty(&(g->cores.cores[i].queue)))
+				spinn_packet_pool_pfree(g->pool, buffer_pop(&(g->cores.cores[i].queue)));
+		buffer_destroy(&(g->cores.cores[i].queue));
+	}
+	
+	free(g->cores.cores);
+	free(g->cores.num_sending_cdf);
+	free(g->cores.order);
+	g->cores.cores = NULL;
+}
+
+
+/**
+ * Recompute the largest core probability and the distribution of the number of
+ * cores sending a packet at this probability in a given period, i.e.
+ * Binomial(num_cores, max_prob).
+ */
+static void
+spinn_packet_gen_cores_update_dist(spinn_packet_gen_t *g)
+{
+	int    n = g->cores.num_cores;
+	double p = 0.0;
+	for (int i = 0; i < n; i++)
+		if (g->cores.cores[i].prob > p)
+			p = g->cores.cores[i].prob;
+	if (p > 1.0)
+		p = 1.0;
+	g->cores.max_prob = p;
+	
+	if (p >= 1.0) {
+		// Every core always sends
+		for (int k = 0; k < n; k++)
+			g->cores.num_sending_cdf[k] = 0.0;
+	} else {
+		// Build the PMF iteratively using P(k+1) = P(k) * (n-k)/(k+1) * p/(1-p)
+		double pmf = 1.0;
+		for (int i = 0; i < n; i++)
+			pmf *= 1.0 - p;
+		
+		double cdf = 0.0;
+		for (int k = 0; k < n; k++) {
+			cdf += pmf;
+			g->cores.num_sending_cdf[k] = cdf;
+			pmf *= ((double)(n - k) / (double)(k + 1)) * (p / (1.0 - p));
+		}
+	}
+	
+	// Guard against rounding errors: the number of cores can't exceed n
+	g->cores.num_sending_cdf[n] = 1.0;
+}
+
+
+/**
+ * Tick function for the cores temporal distribution. Rather than running a
+ * Bernoulli trial for every core, the number of cores which send a packet at the
+ * largest core probability is drawn from a binomial distribution using a single
+ * random number. That many distinct cores are then selected at random and each
+ * kept with probability prob/max_prob to give each core its own rate.
+ */
+static void
+spinn_packet_gen_cores_tick(spinn_packet_gen_t *g)
+{
+	int n = g->cores.num_cores;
+	int *order = g->cores.order;
+	
+	// Draw the number of cores sending at the maximum probability
+	double u = rng_uniform(g->temporal_rng);
+	int num_sending = 0;
+	while (u >= g->cores.num_sending_cdf[num_sending])
+		num_sending++;
+	
+	// Select that many distinct cores using a partial Fisher-Yates shuffle of the
+	// core order and thin them to their individual rates. Kept cores are moved to
+	// the front of the order.
+	g->cores.num_selected = 0;
+	for (int i = 0; i < num_sending; i++) {
+		int j = i + (int)(rng_uniform(g->temporal_rng) * (n - i));
+		int tmp = order[i]; order[i] = order[j]; order[j] = tmp;
+		
+		double prob = g->cores.cores[order[i]].prob;
+		if (prob < g->cores.max_prob
+		    && rng_uniform(g->temporal_rng) >= prob / g->cores.max_prob)
+			continue;
+		
+		tmp = order[i];
+		order[i] = order[g->cores.num_selected];
+		order[g->cores.num_selected] = tmp;
+		g->cores.num_selected++;
+	}
+}
+
+
+/**
+ * Tock function for the cores temporal distribution. Generate packets from the
+ * cores selected during the tick phase into their queues and forward a single
+ * packet from the core queues (in round-robin order) to the output.
+ */
+static void
+spinn_packet_gen_cores_tock(spinn_packet_gen_t *g)
+{
+	for (int i = 0; i < g->cores.num_selected; i++) {
+		spinn_packet_gen_core_t *core = &(g->cores.cores[g->cores.order[i]]);
+		
+		// If the core's queue is full, the packet is not accepted
+		if (buffer_is_full(&(core->queue))) {
+			if (g->on_packet_gen)
+				g->on_packet_gen(NULL, g->on_packet_gen_data);
+			continue;
+		}
+		
+		spinn_coord_t destination;
+		if (!spinn_packet_gen_pick_destination(g, core->spatial_dist, &(core->spatial_dist_data), &destination))
+			continue;
+		
+		buffer_push( &(core->queue)
+		           , (void *)spinn_packet_gen_new_packet( g
+		                                                , core->spatial_dist
+		                                                , &(core->spatial_dist_data)
+		                                                , destination
+		                                                )
+		           );
+		g->cores.num_queued++;
+	}
+	g->cores.num_selected = 0;
+	
+	// Forward a packet from the next non-empty core queue
+	if (g->output_blocked || g->cores.num_queued == 0)
+		return;
+	
+	for (int i = 0; i < g->cores.num_cores; i++) {
+		int c = (g->cores.next_core + i) % g->cores.num_cores;
+		if (!buffer_is_empty(&(g->cores.cores[c].queue))) {
+			spinn_packet_t *p = (spinn_packet_t *)buffer_pop(&(g->cores.cores[c].queue));
+			buffer_push(g->buffer, (void *)p);
+			if (g->on_packet_inject)
+				g->on_packet_inject(p, g->on_packet_inject_data);
+			g->cores.num_queued--;
+			g->cores.next_core = (c + 1) % g->cores.num_cores;
+			break;
+		}
+	}
+}
+
+
+/**
+ * Draw the number of failures before the first success in a series of Bernoulli
+ * trials with the given probability (i.e. from a geometric distribution) using a
+ * single random number.
+ */
+static unsigned int
+spinn_packet_gen_geometric(double prob, rng_t *rng)
+{
+	if (prob >= 1.0)
+		return 0;
+	if (prob <= 0.0)
+		return UINT_MAX;
+	
+	// Uniform on (0,1]
+	double u = rng_uniform_pos(rng);
+	double n = floor(log(u) / log1p(-prob));
+	return (n >= (double)UINT_MAX) ? UINT_MAX : (unsigned int)n;
+}
+
+
+/**
+ * Draw the time until the next packet in the MMPP distribution's current state.
+ */
+static void
+spinn_packet_gen_mmpp_draw_packet(spinn_packet_gen_t *g)
+{
+	g->temporal_dist_data.mmpp.periods_to_packet
+		= spinn_packet_gen_geometric( g->temporal_dist_data.mmpp.on
+		                              ? g->temporal_dist_data.mmpp.on_prob
+		                              : g->temporal_dist_data.mmpp.off_prob
+		                            , g->temporal_rng
+		                            );
+}
+
+
+/**
+ * Draw the number of periods (at least one) the MMPP distribution will remain in
+ * its current state.
+ */
+static void
+spinn_packet_gen_mmpp_draw_switch(spinn_packet_gen_t *g)
+{
+	double duration = g->temporal_dist_data.mmpp.on
+	                  ? g->temporal_dist_data.mmpp.on_duration
+	                  : g->temporal_dist_data.mmpp.off_duration;
+	unsigned int n = spinn_packet_gen_geometric(duration > 1.0 ? 1.0/duration : 1.0, g->temporal_rng);
+	g->temporal_dist_data.mmpp.periods_to_switch = (n == UINT_MAX) ? n : n + 1;
+}
+
+
+/**
+ * Tick function for the MMPP distribution: count down to the next packet and
+ * state change.
+ */
+static void
+spinn_packet_gen_mmpp_tick(spinn_packet_gen_t *g)
+{
+	if (g->temporal_dist_data.mmpp.periods_to_packet == 0) {
+		g->send_packet = true;
+		spinn_packet_gen_mmpp_draw_packet(g);
+	} else {
+		g->temporal_dist_data.mmpp.periods_to_packet--;
+	}
+	
+	if (--g->temporal_dist_data.mmpp.periods_to_switch == 0) {
+		g->temporal_dist_data.mmpp.on = !g->temporal_dist_data.mmpp.on;
+		spinn_packet_gen_mmpp_draw_switch(g);
+		
+		// The packet process is memoryless so the time until the next packet can
+		// simply be redrawn at the new rate.
+		spinn_packet_gen_mmpp_draw_packet(g);
+	}
+}
+
+
 /**
  * Tick function which decides whether to send a packet (based on the
  * availability of space in the output buffer and then the Bernoulli trial.
@@ -189,7 +596,7 @@ spinn_packet_gen_tick(void *g_)
 	if (g->enabled) {
 		switch (g->temporal_dist) {
 			case SPINN_GT_DIST_BERNOULLI:
-				g->send_packet |= (((double)rand())/((double)RAND_MAX+1.0)) <= g->temporal_dist_data.bernoulli.prob;
+				g->send_packet |= rng_uniform(g->temporal_rng) <= g->temporal_dist_data.bernoulli.prob;
 				break;
 			
 			case SPINN_GT_DIST_PERIODIC:
@@ -205,12 +612,39 @@ spinn_packet_gen_tick(void *g_)
 				}
 				break;
 			
+			case SPINN_GT_DIST_TRACE:
+				// Send once the time of the next record has been reached
+				g->send_packet = g->temporal_dist_data.trace.next < g->temporal_dist_data.trace.end
+				                 && g->temporal_dist_data.trace.next->tick <= scheduler_get_ticks(g->scheduler);
+				break;
+			
+			case SPINN_GT_DIST_CORES:
+				spinn_packet_gen_cores_tick(g);
+				break;
+			
+			case SPINN_GT_DIST_MMPP:
+				spinn_packet_gen_mmpp_tick(g);
+				break;
+			
+			case SPINN_GT_DIST_SNN:
+				// Queue up all spikes which have occurred by now
+				while (g->temporal_dist_data.snn.next_spike <= (double)scheduler_get_ticks(g->scheduler)) {
+					g->temporal_dist_data.snn.num_pending++;
+					g->temporal_dist_data.snn.next_spike
+						+= spinn_snn_chip_next_interval(g->temporal_dist_data.snn.chip, g->temporal_rng);
+				}
+				g->send_packet = g->temporal_dist_data.snn.num_pending > 0;
+				break;
+			
 			default:
 				g->send_packet = false;
 				break;
 		}
 	} else {
 		g->send_packet = false;
+		
+		// Packets already queued in the cores are still forwarded
+		g->cores.num_selected = 0;
 	}
 	
 	g->output_blocked = buffer_is_full(g->buffer);
@@ -224,6 +658,12 @@ spinn_packet_gen_tock(void *g_)
 {
 	spinn_packet_gen_t *g = (spinn_packet_gen_t *)g_;
 	
+	// The cores distribution generates and forwards packets independently
+	if (g->temporal_dist == SPINN_GT_DIST_CORES) {
+		spinn_packet_gen_cores_tock(g);
+		return;
+	}
+	
 	// Do nothing if no packet due to be sent
 	if (!g->send_packet)
 		return;
@@ -236,71 +676,28 @@ spinn_packet_gen_tock(void *g_)
 	}
 	
 	// Determine the packet destination based on the current distribution. If the
-	// filter rejects the packet, loop until a destination is chosen which
-	// satisfies it. If the destination picked was (-1,-1) then don't generate a
-	// packet.
+	// destination picked was (-1,-1) then don't generate a packet. Traces and
+	// neural network workloads dictate the destination of each packet directly.
 	spinn_coord_t destination;
-	do {
-		switch (g->spatial_dist) {
-			case SPINN_GS_DIST_CYCLIC:
-				destination = g->spatial_dist_data.cyclic.next_dest;
-				
-				// Move to the next node
-				g->spatial_dist_data.cyclic.next_dest.x ++;
-				if (g->spatial_dist_data.cyclic.next_dest.x >= g->system_size.x) {
-					g->spatial_dist_data.cyclic.next_dest.x = 0;
-					g->spatial_dist_data.cyclic.next_dest.y ++;
-					if (g->spatial_dist_data.cyclic.next_dest.y >= g->system_size.y) {
-						g->spatial_dist_data.cyclic.next_dest.y = 0;
-					}
-				}
-				break;
-			
-			default:
-			case SPINN_GS_DIST_UNIFORM:
-				destination.x = (int)((((double)rand())/((double)RAND_MAX+1.0)) * g->system_size.x);
-				destination.y = (int)((((double)rand())/((double)RAND_MAX+1.0)) * g->system_size.y);
-				break;
-			
-			case SPINN_GS_DIST_P2P:
-				destination.x = g->spatial_dist_data.p2p.target.x;
-				destination.y = g->spatial_dist_data.p2p.target.y;
-				break;
-			
-			case SPINN_GS_DIST_COMPLEMENT:
-				destination.x = g->system_size.x - g->position.x - 1;
-				destination.y = g->system_size.y - g->position.y - 1;
-				break;
-			
-			case SPINN_GS_DIST_TRANSPOSE:
-				destination.x = g->position.y;
-				destination.y = g->position.x;
-				break;
-			
-			case SPINN_GS_DIST_TORNADO:
-				destination.x = ((g->system_size.x/2) + g->position.x) % g->system_size.x;
-				destination.y = g->position.y;
-				break;
-		}
-		
-		// If destination is (-1,-1) then exit early and don't generate a packet
-		if (destination.x == -1 && destination.y == -1)
-			return;
-	} while (g->dest_filter != NULL
-	         && !g->dest_filter(&destination, g->dest_filter_data)
-	        );
-	
-	// Produce the packet
-	spinn_packet_t *p = spinn_packet_pool_palloc(g->pool);
-	spinn_packet_init_dor(p, g->position, destination, g->system_size, g->use_wrap_around_links, NULL);
-	p->sent_time = scheduler_get_ticks(g->scheduler);
-	
-	// Set up the payload and run the callback
-	if (g->on_packet_gen)
-		p->payload = g->on_packet_gen(p, g->on_packet_gen_data);
+	if (g->temporal_dist == SPINN_GT_DIST_TRACE) {
+		destination.x = g->temporal_dist_data.trace.next->destination_x;
+		destination.y = g->temporal_dist_data.trace.next->destination_y;
+	} else if (g->temporal_dist == SPINN_GT_DIST_SNN) {
+		destination = spinn_snn_chip_pick_destination(g->temporal_dist_data.snn.chip, g->spatial_rng);
+	} else if (!spinn_packet_gen_pick_destination(g, g->spatial_dist, &(g->spatial_dist_data), &destination)) {
+		return;
+	}
 	
-	// Send the packet
+	// Produce and send the packet (traces and neural network workloads only
+	// produce point-to-point packets)
+	spinn_packet_t *p;
+	if (g->temporal_dist == SPINN_GT_DIST_TRACE || g->temporal_dist == SPINN_GT_DIST_SNN)
+		p = spinn_packet_gen_new_packet(g, SPINN_GS_DIST_UNIFORM, NULL, destination);
+	else
+		p = spinn_packet_gen_new_packet(g, g->spatial_dist, &(g->spatial_dist_data), destination);
 	buffer_push(g->buffer, (void *)p);
+	if (g->on_packet_inject)
+		g->on_packet_inject(p, g->on_packet_inject_data);
 	
 	// Clear the flag
 	g->send_packet = false;
@@ -316,6 +713,14 @@ spinn_packet_gen_tock(void *g_)
 			// has now been sent
 			g->temporal_dist_data.fixed_delay.time_elapsed = 0;
 			break;
+		case SPINN_GT_DIST_TRACE:
+			// Move on to the next record in the trace
+			g->temporal_dist_data.trace.next++;
+			break;
+		case SPINN_GT_DIST_SNN:
+			// One fewer spike left to send
+			g->temporal_dist_data.snn.num_pending--;
+			break;
 		
 		default:
 			// Nothing to do for other distributions
@@ -351,7 +756,12 @@ spinn_packet_gen_init( spinn_packet_gen_t  *g
 	g->dest_filter_data      = dest_filter_data;
 	g->on_packet_gen         = on_packet_gen;
 	g->on_packet_gen_data    = on_packet_gen_data;
+	g->on_packet_inject      = NULL;
+	g->on_packet_inject_data = NULL;
 	g->send_packet           = false;
+	g->cores.cores           = NULL;
+	g->temporal_rng          = NULL;
+	g->spatial_rng           = NULL;
 	
 	// Set up tick/tock functions
 	scheduler_schedule( s, period
@@ -363,6 +773,17 @@ spinn_packet_gen_init( spinn_packet_gen_t  *g
 }
 
 
+void
+spinn_packet_gen_set_on_packet_inject( spinn_packet_gen_t *g
+                                     , void (*on_packet_inject)(spinn_packet_t *packet, void *data)
+                                     , void *on_packet_inject_data
+                                     )
+{
+	g->on_packet_inject      = on_packet_inject;
+	g->on_packet_inject_data = on_packet_inject_data;
+}
+
+
 void
 spinn_packet_gen_set_enabled( spinn_packet_gen_t *g
                             , bool                enabled
@@ -372,11 +793,24 @@ spinn_packet_gen_set_enabled( spinn_packet_gen_t *g
 }
 
 
+void
+spinn_packet_gen_set_rngs( spinn_packet_gen_t *g
+                         , rng_t              *temporal_rng
+                         , rng_t              *spatial_rng
+                         )
+{
+	g->temporal_rng = temporal_rng;
+	g->spatial_rng  = spatial_rng;
+}
+
+
 void
 spinn_packet_gen_set_temporal_dist_bernoulli( spinn_packet_gen_t *g
                                             , double              bernoulli_prob
                                             )
 {
+	spinn_packet_gen_cores_free(g, true);
+	
 	g->temporal_dist = SPINN_GT_DIST_BERNOULLI;
 	g->temporal_dist_data.bernoulli.prob = bernoulli_prob;
 }
@@ -387,6 +821,8 @@ spinn_packet_gen_set_temporal_dist_periodic( spinn_packet_gen_t *g
                                            , int                 interval
                                            )
 {
+	spinn_packet_gen_cores_free(g, true);
+	
 	g->temporal_dist = SPINN_GT_DIST_PERIODIC;
 	g->temporal_dist_data.periodic.interval = interval;
 	g->temporal_dist_data.periodic.time_elapsed = 0;
@@ -398,12 +834,153 @@ spinn_packet_gen_set_temporal_dist_fixed_delay( spinn_packet_gen_t *g
                                               , int                 delay
                                               )
 {
+	spinn_packet_gen_cores_free(g, true);
+	
 	g->temporal_dist = SPINN_GT_DIST_FIXED_DELAY;
 	g->temporal_dist_data.fixed_delay.delay = delay;
 	g->temporal_dist_data.fixed_delay.time_elapsed = 0;
 }
 
 
+void
+spinn_packet_gen_set_temporal_dist_mmpp( spinn_packet_gen_t *g
+                                       , double              on_prob
+                                       , double              off_prob
+                                       , double              on_duration
+                                       , double              off_duration
+                                       )
+{
+	spinn_packet_gen_cores_free(g, true);
+	
+	g->temporal_dist = SPINN_GT_DIST_MMPP;
+	g->temporal_dist_data.mmpp.on_prob      = on_prob;
+	g->temporal_dist_data.mmpp.off_prob     = off_prob;
+	g->temporal_dist_data.mmpp.on_duration  = on_duration;
+	g->temporal_dist_data.mmpp.off_duration = off_duration;
+	
+	// Start in each state with its long-run probability
+	g->temporal_dist_data.mmpp.on
+		= rng_uniform(g->temporal_rng) * (on_duration + off_duration) < on_duration;
+	spinn_packet_gen_mmpp_draw_switch(g);
+	spinn_packet_gen_mmpp_draw_packet(g);
+}
+
+
+void
+spinn_packet_gen_set_temporal_dist_trace( spinn_packet_gen_t         *g
+                                        , const spinn_trace_record_t *records
+                                        , size_t                      num_records
+                                        )
+{
+	spinn_packet_gen_cores_free(g, true);
+	
+	g->temporal_dist = SPINN_GT_DIST_TRACE;
+	
+	// Binary search for the first record which is not in the past (e.g. when
+	// switching to a trace part-way through a simulation).
+	ticks_t now = scheduler_get_ticks(g->scheduler);
+	size_t low  = 0;
+	size_t high = num_records;
+	while (low < high) {
+		size_t mid = low + ((high - low) / 2);
+		if (records[mid].tick < now)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	
+	g->temporal_dist_data.trace.next = records + low;
+	g->temporal_dist_data.trace.end  = records + num_records;
+}
+
+
+void
+spinn_packet_gen_set_temporal_dist_snn( spinn_packet_gen_t     *g
+                                      , const spinn_snn_chip_t *chip
+                                      )
+{
+	spinn_packet_gen_cores_free(g, true);
+	
+	g->temporal_dist = SPINN_GT_DIST_SNN;
+	g->temporal_dist_data.snn.chip        = chip;
+	g->temporal_dist_data.snn.num_pending = 0;
+	
+	// Spikes are memoryless so the stream can be started at any time
+	g->temporal_dist_data.snn.next_spike
+		= (double)scheduler_get_ticks(g->scheduler) + spinn_snn_chip_next_interval(chip, g->temporal_rng);
+}
+
+
+void
+spinn_packet_gen_set_temporal_dist_cores( spinn_packet_gen_t *g
+                                        , int                 num_cores
+                                        , int                 queue_length
+                                        )
+{
+	assert(num_cores > 0);
+	assert(queue_length > 0);
+	
+	// Keep the existing cores (and any packets they have queued) unless their
+	// number or size has changed.
+	if (g->cores.cores != NULL
+	    && (g->cores.num_cores != num_cores || g->cores.queue_length != queue_length))
+		spinn_packet_gen_cores_free(g, true);
+	
+	if (g->cores.cores == NULL) {
+		g->cores.num_cores    = num_cores;
+		g->cores.queue_length = queue_length;
+		
+		g->cores.cores = calloc(num_cores, sizeof(spinn_packet_gen_core_t));
+		assert(g->cores.cores != NULL);
+		g->cores.num_sending_cdf = calloc(num_cores + 1, sizeof(double));
+		assert(g->cores.num_sending_cdf != NULL);
+		g->cores.order = calloc(num_cores, sizeof(int));
+		assert(g->cores.order != NULL);
+		
+		for (int i = 0; i < num_cores; i++) {
+			g->cores.cores[i].prob         = 0.0;
+			g->cores.cores[i].spatial_dist = SPINN_GS_DIST_UNIFORM;
+			buffer_init(&(g->cores.cores[i].queue), queue_length);
+			g->cores.order[i] = i;
+		}
+		
+		g->cores.next_core  = 0;
+		g->cores.num_queued = 0;
+		spinn_packet_gen_cores_update_dist(g);
+	}
+	
+	g->temporal_dist = SPINN_GT_DIST_CORES;
+	g->cores.num_selected = 0;
+}
+
+
+void
+spinn_packet_gen_set_core_bernoulli_prob( spinn_packet_gen_t *g
+                                        , int                 core
+                                        , double              bernoulli_prob
+                                        )
+{
+	assert(g->cores.cores != NULL);
+	assert(core >= 0 && core < g->cores.num_cores);
+	
+	g->cores.cores[core].prob = bernoulli_prob;
+	spinn_packet_gen_cores_update_dist(g);
+}
+
+
+void
+spinn_packet_gen_set_core_spatial_dist( spinn_packet_gen_t *g
+                                      , int                 core
+                                      )
+{
+	assert(g->cores.cores != NULL);
+	assert(core >= 0 && core < g->cores.num_cores);
+	
+	g->cores.cores[core].spatial_dist      = g->spatial_dist;
+	g->cores.cores[core].spatial_dist_data = g->spatial_dist_data;
+}
+
+
 void
 spinn_packet_gen_set_spatial_dist_uniform(spinn_packet_gen_t *g)
 {
@@ -451,10 +1028,158 @@ spinn_packet_gen_set_spatial_dist_tornado(spinn_packet_gen_t *g)
 }
 
 
+void
+spinn_packet_gen_set_spatial_dist_multicast( spinn_packet_gen_t *g
+                                           , uint32_t            key
+                                           )
+{
+	g->spatial_dist = SPINN_GS_DIST_MULTICAST;
+	g->spatial_dist_data.multicast.key = key;
+}
+
+
+/**
+ * Write/read a single field of a generator or consumer to/from a snapshot file.
+ */
+#define SNAPSHOT_WRITE(f, field) (fwrite(&(field), sizeof(field), 1, (f)) == 1)
+#define SNAPSHOT_READ(f, field)  (fread(&(field), sizeof(field), 1, (f)) == 1)
+
+
+bool
+spinn_packet_gen_save( spinn_packet_gen_t  *g
+                     , FILE                *f
+                     , buffer_save_value_t  save_value
+                     , void                *data
+                     )
+{
+	if (!SNAPSHOT_WRITE(f, g->temporal_dist)
+	    || !SNAPSHOT_WRITE(f, g->send_packet)
+	    || !SNAPSHOT_WRITE(f, g->spatial_dist_data))
+		return false;
+	
+	switch (g->temporal_dist) {
+		case SPINN_GT_DIST_PERIODIC:
+			return SNAPSHOT_WRITE(f, g->temporal_dist_data.periodic.time_elapsed);
+		
+		case SPINN_GT_DIST_FIXED_DELAY:
+			return SNAPSHOT_WRITE(f, g->temporal_dist_data.fixed_delay.time_elapsed);
+		
+		case SPINN_GT_DIST_TRACE:
+			{
+				// The trace is reloaded on restore so only the number of records left to
+				// send is recorded
+				uint64_t num_remaining = g->temporal_dist_data.trace.end
+				                         - g->temporal_dist_data.trace.next;
+				return SNAPSHOT_WRITE(f, num_remaining);
+			}
+		
+		case SPINN_GT_DIST_MMPP:
+			return SNAPSHOT_WRITE(f, g->temporal_dist_data.mmpp.on)
+			       && SNAPSHOT_WRITE(f, g->temporal_dist_data.mmpp.periods_to_packet)
+			       && SNAPSHOT_WRITE(f, g->temporal_dist_data.mmpp.periods_to_switch);
+		
+		case SPINN_GT_DIST_SNN:
+			return SNAPSHOT_WRITE(f, g->temporal_dist_data.snn.next_spike)
+			       && SNAPSHOT_WRITE(f, g->temporal_dist_data.snn.num_pending);
+		
+		case SPINN_GT_DIST_CORES:
+			if (!SNAPSHOT_WRITE(f, g->cores.num_cores)
+			    || !SNAPSHOT_WRITE(f, g->cores.next_core)
+			    || !SNAPSHOT_WRITE(f, g->cores.num_queued))
+				return false;
+			for (int i = 0; i < g->cores.num_cores; i++) {
+				if (!SNAPSHOT_WRITE(f, g->cores.order[i])
+				    || !SNAPSHOT_WRITE(f, g->cores.cores[i].spatial_dist_data)
+				    || !buffer_save(&(g->cores.cores[i].queue), f, save_value, data))
+					return false;
+			}
+			return true;
+		
+		default:
+			// No state for other distributions
+			return true;
+	}
+}
+
+
+bool
+spinn_packet_gen_restore( spinn_packet_gen_t     *g
+                        , FILE                   *f
+                        , buffer_restore_value_t  restore_value
+                        , void                   *data
+                        )
+{
+	spinn_packet_gen_temporal_dist_t temporal_dist;
+	if (!SNAPSHOT_READ(f, temporal_dist)
+	    || temporal_dist != g->temporal_dist
+	    || !SNAPSHOT_READ(f, g->send_packet)
+	    || !SNAPSHOT_READ(f, g->spatial_dist_data))
+		return false;
+	
+	switch (g->temporal_dist) {
+		case SPINN_GT_DIST_PERIODIC:
+			return SNAPSHOT_READ(f, g->temporal_dist_data.periodic.time_elapsed);
+		
+		case SPINN_GT_DIST_FIXED_DELAY:
+			return SNAPSHOT_READ(f, g->temporal_dist_data.fixed_delay.time_elapsed);
+		
+		case SPINN_GT_DIST_TRACE:
+			{
+				uint64_t num_remaining;
+				if (!SNAPSHOT_READ(f, num_remaining)
+				    || num_remaining > (uint64_t)(g->temporal_dist_data.trace.end
+				                                  - g->temporal_dist_data.trace.next))
+					return false;
+				g->temporal_dist_data.trace.next = g->temporal_dist_data.trace.end - num_remaining;
+				return true;
+			}
+		
+		case SPINN_GT_DIST_MMPP:
+			return SNAPSHOT_READ(f, g->temporal_dist_data.mmpp.on)
+			       && SNAPSHOT_READ(f, g->temporal_dist_data.mmpp.periods_to_packet)
+			       && SNAPSHOT_READ(f, g->temporal_dist_data.mmpp.periods_to_switch);
+		
+		case SPINN_GT_DIST_SNN:
+			return SNAPSHOT_READ(f, g->temporal_dist_data.snn.next_spike)
+			       && SNAPSHOT_READ(f, g->temporal_dist_data.snn.num_pending);
+		
+		case SPINN_GT_DIST_CORES:
+			{
+				int num_cores;
+				if (!SNAPSHOT_READ(f, num_cores)
+				    || num_cores != g->cores.num_cores
+				    || !SNAPSHOT_READ(f, g->cores.next_core)
+				    || g->cores.next_core < 0 || g->cores.next_core >= num_cores
+				    || !SNAPSHOT_READ(f, g->cores.num_queued))
+					return false;
+				
+				for (int i = 0; i < g->cores.num_cores; i++) {
+					spinn_packet_gen_core_t *core = &(g->cores.cores[i]);
+					if (!SNAPSHOT_READ(f, g->cores.order[i])
+					    || g->cores.order[i] < 0 || g->cores.order[i] >= num_cores
+					    || !SNAPSHOT_READ(f, core->spatial_dist_data))
+						return false;
+					
+					// Discard anything queued since the generator was configured
+					while (!buffer_is_empty(&(core->queue)))
+						spinn_packet_pool_pfree(g->pool, buffer_pop(&(core->queue)));
+					if (!buffer_restore(&(core->queue), f, restore_value, data))
+						return false;
+				}
+				return true;
+			}
+		
+		default:
+			return true;
+	}
+}
+
+
 void
 spinn_packet_gen_destroy(spinn_packet_gen_t *g)
 {
-	// Nothing to free!
+	// Any packets still queued belong to the pool which frees them itself
+	spinn_packet_gen_cores_free(g, false);
 }
 
 
@@ -473,7 +1198,7 @@ spinn_packet_con_tick(void *c_)
 	
 	switch (c->temporal_dist) {
 		case SPINN_CT_DIST_BERNOULLI:
-			c->consume_packet |= (((double)rand())/((double)RAND_MAX+1.0)) <= c->temporal_dist_data.bernoulli.prob;
+			c->consume_packet |= rng_uniform(c->rng) <= c->temporal_dist_data.bernoulli.prob;
 			break;
 		
 		case SPINN_CT_DIST_PERIODIC:
@@ -559,6 +1284,7 @@ spinn_packet_con_init( spinn_packet_con_t      *c
 	c->on_packet_con      = on_packet_con;
 	c->on_packet_con_data = on_packet_con_data;
 	c->consume_packet     = false;
+	c->rng                = NULL;
 	
 	// Set up tick/tock functions
 	scheduler_schedule( s, period
@@ -570,6 +1296,15 @@ spinn_packet_con_init( spinn_packet_con_t      *c
 }
 
 
+void
+spinn_packet_con_set_rng( spinn_packet_con_t *c
+                        , rng_t              *rng
+                        )
+{
+	c->rng = rng;
+}
+
+
 void
 spinn_packet_con_set_temporal_dist_bernoulli( spinn_packet_con_t *c
                                             , double              bernoulli_prob
@@ -601,6 +1336,48 @@ spinn_packet_con_set_temporal_dist_fixed_delay( spinn_packet_con_t *c
 }
 
 
+bool
+spinn_packet_con_save(spinn_packet_con_t *c, FILE *f)
+{
+	if (!SNAPSHOT_WRITE(f, c->temporal_dist)
+	    || !SNAPSHOT_WRITE(f, c->consume_packet))
+		return false;
+	
+	switch (c->temporal_dist) {
+		case SPINN_CT_DIST_PERIODIC:
+			return SNAPSHOT_WRITE(f, c->temporal_dist_data.periodic.time_elapsed);
+		
+		case SPINN_CT_DIST_FIXED_DELAY:
+			return SNAPSHOT_WRITE(f, c->temporal_dist_data.fixed_delay.time_elapsed);
+		
+		default:
+			return true;
+	}
+}
+
+
+bool
+spinn_packet_con_restore(spinn_packet_con_t *c, FILE *f)
+{
+	spinn_packet_con_temporal_dist_t temporal_dist;
+	if (!SNAPSHOT_READ(f, temporal_dist)
+	    || temporal_dist != c->temporal_dist
+	    || !SNAPSHOT_READ(f, c->consume_packet))
+		return false;
+	
+	switch (c->temporal_dist) {
+		case SPINN_CT_DIST_PERIODIC:
+			return SNAPSHOT_READ(f, c->temporal_dist_data.periodic.time_elapsed);
+		
+		case SPINN_CT_DIST_FIXED_DELAY:
+			return SNAPSHOT_READ(f, c->temporal_dist_data.fixed_delay.time_elapsed);
+		
+		default:
+			return true;
+	}
+}
+
+
 void
 spinn_packet_con_destroy(spinn_packet_con_t *c)
 {
@@ -7,21 +7,64 @@
 #ifndef SPINN_PACKET_H
 #define SPINN_PACKET_H
 
+#include <stdint.h>
+
 #include "config.h"
 
 #include "scheduler.h"
 #include "buffer.h"
+#include "rng.h"
 
 #include "spinn.h"
+#include "spinn_trace.h"
+#include "spinn_snn.h"
 
 /******************************************************************************
  * SpiNNaker Packets
  ******************************************************************************/
 
+/**
+ * The type of a packet: either point-to-point (routed to a single destination
+ * using dimension-order routing) or multicast (routed by the key-based routing
+ * tables of each router, possibly to many destinations).
+ */
+typedef enum spinn_packet_type {
+	SPINN_PACKET_P2P = 0,
+	SPINN_PACKET_MC,
+} spinn_packet_type_t;
+
+
+/**
+ * The components of a packet's latency which it accumulates as it moves
+ * through the system (see spinn_packet_stamp).
+ */
+typedef enum spinn_packet_latency {
+	// Waiting to enter the network at its source
+	SPINN_PACKET_LATENCY_QUEUE = 0,
+	
+	// Passing through the arbiter trees at the input of each router
+	SPINN_PACKET_LATENCY_ARBITER,
+	
+	// Waiting for and passing through the pipeline of each router
+	SPINN_PACKET_LATENCY_ROUTER,
+	
+	// Traversing the links between (and out of) routers
+	SPINN_PACKET_LATENCY_LINK,
+} spinn_packet_latency_t;
+
+#define SPINN_PACKET_NUM_LATENCIES 4
+
+
 /**
  * A SpiNNaker packet.
  */
 typedef struct spinn_packet {
+	// The type of packet
+	spinn_packet_type_t type;
+	
+	// The routing key of a multicast packet
+	uint32_t key;
+	
 	// The intended inflection point of the packet's route
 	spinn_coord_t     inflection_point;
 	spinn_direction_t inflection_direction;
@@ -46,8 +89,18 @@ typedef struct spinn_packet {
 	ticks_t num_hops;
 	ticks_t num_emg_hops;
 	
+	// The time spent in each latency component and the time at which the
+	// packet entered its current component (starting at sent_time).
+	ticks_t latency[SPINN_PACKET_NUM_LATENCIES];
+	ticks_t stamp_time;
+	
 	// Packet payload
 	void *payload;
+	
+	// The number of references to the packet held by the simulation. Packets
+	// normally have exactly one (each copy of a multicast packet is a separate
+	// packet) but see spinn_packet_pool_pretain.
+	unsigned int ref_count;
 } spinn_packet_t;
 
 
@@ -71,6 +124,36 @@ void spinn_packet_init_dor( spinn_packet_t *packet
                           );
 
 
+/**
+ * Convenience function. Initialise a spinn_packet_t as a multicast packet with
+ * the given key injected at the given source. Multicast packets are routed by
+ * the routing tables of each router they pass through and so have no
+ * destination (the destination is set to the source). Also resets all other
+ * fields to the values expected of a new packet.
+ *
+ * Note: Does not set the sent_time field.
+ */
+void spinn_packet_init_mc( spinn_packet_t *packet
+                         , spinn_coord_t   source
+                         , uint32_t        key
+                         , void           *payload
+                         );
+
+
+/**
+ * Add the time since the packet was last stamped (or sent) to one of its
+ * latency components, i.e. mark the packet as leaving that component at the
+ * given time.
+ *
+ * Note: Each copy of a multicast packet is a separate spinn_packet_t (see
+ * spinn_router_tock) and so is stamped along its own branch of the tree.
+ */
+void spinn_packet_stamp( spinn_packet_t         *packet
+                       , ticks_t                 now
+                       , spinn_packet_latency_t  component
+                       );
+
+
 
 /******************************************************************************
  * Utility function datatypes
@@ -121,13 +204,32 @@ int spinn_packet_pool_get_num_packets(spinn_packet_pool_t *pool);
 
 
 /**
- * Get an uninitialised packet from the pool.
+ * Get the number of packets from the pool currently in use (i.e. allocated and
+ * not yet freed).
+ */
+int spinn_packet_pool_get_num_in_use(spinn_packet_pool_t *pool);
+
+
+/**
+ * Get an uninitialised packet from the pool. The packet starts with a single
+ * reference.
  */
 spinn_packet_t *spinn_packet_pool_palloc(spinn_packet_pool_t *pool);
 
 
 /**
- * Return a packet to the pool.
+ * Add a reference to a packet allocated from the pool. This allows a single
+ * packet to be held by several parts of the simulation, each of which frees it
+ * with spinn_packet_pool_pfree when done. The simulation itself never does this
+ * (multicast copies are allocated separately) but a snapshot restores a packet
+ * found in several buffers as one packet with a reference from each.
+ */
+void spinn_packet_pool_pretain(spinn_packet_pool_t *pool, spinn_packet_t *packet);
+
+
+/**
+ * Release a reference to a packet, returning it to the pool once no references
+ * remain.
  */
 void spinn_packet_pool_pfree(spinn_packet_pool_t *pool, spinn_packet_t *packet);
 
@@ -178,6 +280,19 @@ void spinn_packet_gen_init( spinn_packet_gen_t  *gen
                           );
 
 
+/**
+ * Set a function to be called during the tock phase whenever a packet enters
+ * the network (i.e. is placed in the generator's output buffer). This differs
+ * from on_packet_gen only when using the cores temporal distribution where
+ * packets are created when queued in a core and enter the network later. If
+ * NULL (the default), the callback is disabled.
+ */
+void spinn_packet_gen_set_on_packet_inject( spinn_packet_gen_t *packet_gen
+                                          , void (*on_packet_inject)(spinn_packet_t *packet, void *data)
+                                          , void *on_packet_inject_data
+                                          );
+
+
 /**
  * Enable/disable the packet generator
  *
@@ -189,6 +304,21 @@ void spinn_packet_gen_set_enabled( spinn_packet_gen_t *packet_gen
                                  );
 
 
+/**
+ * Use the given random number generators to draw the generator's packet timings
+ * (temporal_rng) and destinations (spatial_rng). Either may be NULL (the
+ * default) to use the C library's rand(). The generators are not owned by the
+ * packet generator and must outlive it.
+ *
+ * This should be called before setting the temporal distribution since some
+ * distributions draw their initial state when set.
+ */
+void spinn_packet_gen_set_rngs( spinn_packet_gen_t *packet_gen
+                              , rng_t              *temporal_rng
+                              , rng_t              *spatial_rng
+                              );
+
+
 /**
  * Set up the packet generator to use the given Bernoulli distribution to decide
  * when to generate packets.
@@ -228,6 +358,120 @@ void spinn_packet_gen_set_temporal_dist_fixed_delay( spinn_packet_gen_t *packet_
                                                    );
 
 
+/**
+ * Set up the packet generator to use a Markov-modulated on/off process to
+ * decide when to generate packets. The generator alternates between an "on" and
+ * an "off" state, spending a geometrically distributed number of periods in
+ * each with the given means. In each state, packets are generated as a
+ * Bernoulli process with the given probability. As with the Bernoulli
+ * distribution, a packet which can't be sent because the output is blocked is
+ * retried in the following periods.
+ *
+ * Rather than drawing random numbers every period, the times of the next packet
+ * and state change are drawn in advance. The initial state is chosen at random
+ * in proportion to the mean durations.
+ *
+ * This should be called outside of the simulation tick/tock phases for
+ * deterministic behaviour.
+ */
+void spinn_packet_gen_set_temporal_dist_mmpp( spinn_packet_gen_t *packet_gen
+                                            , double              on_prob
+                                            , double              off_prob
+                                            , double              on_duration
+                                            , double              off_duration
+                                            );
+
+
+/**
+ * Set up the packet generator to replay a slice of a packet injection trace.
+ * Each record is sent (to the destination given in the record, ignoring the
+ * spatial distribution and destination filter) during the tick given in the
+ * record. If the output is blocked, sending is retried in the following periods
+ * until it succeeds and subsequent records are delayed accordingly. Records
+ * with times before the current time are skipped.
+ *
+ * The records must be sorted by time and must remain valid while the generator
+ * is using them.
+ *
+ * This should be called outside of the simulation tick/tock phases for
+ * deterministic behaviour.
+ */
+void spinn_packet_gen_set_temporal_dist_trace( spinn_packet_gen_t         *packet_gen
+                                             , const spinn_trace_record_t *records
+                                             , size_t                      num_records
+                                             );
+
+
+/**
+ * Set up the packet generator to send the spikes of a chip in a spiking neural
+ * network workload. Spikes are generated as a Poisson process at the chip's rate
+ * and each is sent to a destination chosen by the workload (ignoring the spatial
+ * distribution and destination filter). Spikes which can't be sent immediately
+ * because the output is blocked are queued and sent as soon as possible.
+ *
+ * The chip's spike stream must remain valid for as long as the generator uses
+ * this distribution.
+ */
+void spinn_packet_gen_set_temporal_dist_snn( spinn_packet_gen_t     *packet_gen
+                                           , const spinn_snn_chip_t *chip
+                                           );
+
+
+/**
+ * Set up the packet generator to model a chip with num_cores application cores
+ * each injecting packets. Each core has its own probability of generating a
+ * packet each period (see spinn_packet_gen_set_core_bernoulli_prob) and its own
+ * spatial distribution (see spinn_packet_gen_set_core_spatial_dist). Rather
+ * than running a trial for every core, the number of cores generating a packet
+ * is drawn from a binomial distribution each period so the cost is largely
+ * independent of the number of cores.
+ *
+ * Packets generated by a core are placed in that core's queue (of length
+ * queue_length). If the queue is full the packet is not accepted (and the
+ * callback is called with a NULL packet). Each period, one packet is forwarded
+ * from the core queues (in round-robin order) to the generator's output buffer.
+ *
+ * Cores are initially idle and use the uniform spatial distribution. If the
+ * generator is already using this distribution with the same number of cores
+ * and queue length, the cores (and their queued packets) are left unchanged.
+ * Switching to another distribution returns any queued packets to the pool.
+ *
+ * This should be called outside of the simulation tick/tock phases for
+ * deterministic behaviour.
+ */
+void spinn_packet_gen_set_temporal_dist_cores( spinn_packet_gen_t *packet_gen
+                                             , int                 num_cores
+                                             , int                 queue_length
+                                             );
+
+
+/**
+ * Set the probability of a core generating a packet each period when using the
+ * cores temporal distribution.
+ *
+ * This should be called outside of the simulation tick/tock phases for
+ * deterministic behaviour.
+ */
+void spinn_packet_gen_set_core_bernoulli_prob( spinn_packet_gen_t *packet_gen
+                                             , int                 core
+                                             , double              bernoulli_prob
+                                             );
+
+
+/**
+ * Set the spatial distribution of a core (when using the cores temporal
+ * distribution) to a copy of the generator's current spatial distribution, i.e.
+ * set the generator's spatial distribution using one of the functions below and
+ * then call this function to give that distribution to the core.
+ *
+ * This should be called outside of the simulation tick/tock phases for
+ * deterministic behaviour.
+ */
+void spinn_packet_gen_set_core_spatial_dist( spinn_packet_gen_t *packet_gen
+                                           , int                 core
+                                           );
+
+
 /**
  * Set up the packet generator to send packets to uniform random destinations.
  *
@@ -279,6 +523,20 @@ void spinn_packet_gen_set_spatial_dist_transpose(spinn_packet_gen_t *packet_gen)
 void spinn_packet_gen_set_spatial_dist_tornado(spinn_packet_gen_t *packet_gen);
 
 
+/**
+ * Set up the packet generator to send multicast packets with the given key. The
+ * packets are routed by the routing tables of the routers they pass through
+ * (see spinn_router_set_mc_table) rather than to a chosen destination and so
+ * the destination filter is not used.
+ *
+ * This should be called outside of the simulation tick/tock phases for
+ * deterministic behaviour.
+ */
+void spinn_packet_gen_set_spatial_dist_multicast( spinn_packet_gen_t *packet_gen
+                                                , uint32_t            key
+                                                );
+
+
 /**
  * Set up the packet generator to send packets to each node of the system in
  * turn, starting with the current node.
@@ -288,6 +546,28 @@ void spinn_packet_gen_set_spatial_dist_tornado(spinn_packet_gen_t *packet_gen);
  */
 void spinn_packet_gen_set_spatial_dist_cyclic(spinn_packet_gen_t *packet_gen);
 
+/**
+ * Write the state of the packet generator (including any packets queued in its
+ * cores, which are written using save_value) to a snapshot file. Returns false
+ * on failure.
+ */
+bool spinn_packet_gen_save( spinn_packet_gen_t  *packet_gen
+                          , FILE                *f
+                          , buffer_save_value_t  save_value
+                          , void                *data
+                          );
+
+/**
+ * Restore the state of a packet generator written by spinn_packet_gen_save. The
+ * generator must already be configured with the same distributions (and trace,
+ * workload or number of cores) as when it was saved. Returns false on failure.
+ */
+bool spinn_packet_gen_restore( spinn_packet_gen_t     *packet_gen
+                             , FILE                   *f
+                             , buffer_restore_value_t  restore_value
+                             , void                   *data
+                             );
+
 /**
  * Free the resources used by a packet generator.
  */
@@ -324,6 +604,16 @@ void spinn_packet_con_init( spinn_packet_con_t  *con
                           );
 
 
+/**
+ * Use the given random number generator to decide when to consume packets, or
+ * the C library's rand() if NULL (the default). The generator is not owned by
+ * the packet consumer and must outlive it.
+ */
+void spinn_packet_con_set_rng( spinn_packet_con_t *packet_con
+                             , rng_t              *rng
+                             );
+
+
 /**
  * Set up the packet consumer to use the given Bernoulli distribution to decide
  * when to consume packets.
@@ -363,6 +653,21 @@ void spinn_packet_con_set_temporal_dist_fixed_delay( spinn_packet_con_t *packet_
                                                    );
 
 
+/**
+ * Write the state of the packet consumer to a snapshot file. Returns false on
+ * failure.
+ */
+bool spinn_packet_con_save(spinn_packet_con_t *packet_con, FILE *f);
+
+
+/**
+ * Restore the state of a packet consumer written by spinn_packet_con_save. The
+ * consumer must already be configured with the same distribution as when it was
+ * saved. Returns false on failure.
+ */
+bool spinn_packet_con_restore(spinn_packet_con_t *packet_con, FILE *f);
+
+
 /**
  * Free the resources used by a packet consumer.
  */
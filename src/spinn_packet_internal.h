@@ -40,17 +40,65 @@ typedef enum spinn_packet_gen_spatial_dist {
 	SPINN_GS_DIST_COMPLEMENT,
 	SPINN_GS_DIST_TRANSPOSE,
 	SPINN_GS_DIST_TORNADO,
+	SPINN_GS_DIST_MULTICAST,
 } spinn_packet_gen_spatial_dist_t;
 
 
 
+/**
+ * State data used by the various spatial distributions.
+ */
+typedef union spinn_packet_gen_spatial_dist_data {
+	
+	// Uniform packet generator data
+	// *No state required*
+	
+	// Cyclic packet generator data
+	struct {
+		spinn_coord_t next_dest;
+	} cyclic;
+	
+	// P2P packet generator data
+	struct {
+		spinn_coord_t target;
+	} p2p;
+	
+	// Multicast packet generator data
+	struct {
+		uint32_t key;
+	} multicast;
+	
+} spinn_packet_gen_spatial_dist_data_t;
+
+
 typedef enum spinn_packet_gen_temporal_dist {
 	SPINN_GT_DIST_BERNOULLI,
 	SPINN_GT_DIST_PERIODIC,
 	SPINN_GT_DIST_FIXED_DELAY,
+	SPINN_GT_DIST_TRACE,
+	SPINN_GT_DIST_CORES,
+	SPINN_GT_DIST_MMPP,
+	SPINN_GT_DIST_SNN,
 } spinn_packet_gen_temporal_dist_t;
 
 
+/**
+ * An application core injecting packets when using the cores temporal
+ * distribution.
+ */
+typedef struct spinn_packet_gen_core {
+	// Probability of the core generating a packet each period
+	double prob;
+	
+	// The spatial distribution (and its state) used by this core
+	spinn_packet_gen_spatial_dist_t      spatial_dist;
+	spinn_packet_gen_spatial_dist_data_t spatial_dist_data;
+	
+	// Packets generated by the core waiting to enter the generator's buffer
+	buffer_t queue;
+} spinn_packet_gen_core_t;
+
+
 struct spinn_packet_gen {
 	// The scheduler which drives the packet generator 
 	scheduler_t *scheduler;
@@ -74,6 +122,11 @@ struct spinn_packet_gen {
 	// Should a packet be sent during the tock phase?
 	bool send_packet;
 	
+	// Random number generators for packet timings and destinations (NULL to use
+	// rand())
+	rng_t *temporal_rng;
+	rng_t *spatial_rng;
+	
 	// Is the output buffer full (i.e. should sending a packet fail?)?
 	bool output_blocked;
 	
@@ -86,22 +139,7 @@ struct spinn_packet_gen {
 	
 	// State data used by the various packet generation schemes
 	// Spatial distribution data
-	union {
-		
-		// Uniform packet generator data
-		// *No state required*
-		
-		// Cyclic packet generator data
-		struct {
-			spinn_coord_t next_dest;
-		} cyclic;
-		
-		// P2P packet generator data
-		struct {
-			spinn_coord_t target;
-		} p2p;
-		
-	} spatial_dist_data;
+	spinn_packet_gen_spatial_dist_data_t spatial_dist_data;
 	
 	// The temporal distribution to use when generating packets.
 	spinn_packet_gen_temporal_dist_t temporal_dist;
@@ -126,11 +164,70 @@ struct spinn_packet_gen {
 			int time_elapsed;
 		} fixed_delay;
 		
+		// Trace-driven injection. The next record to be sent and the end of this
+		// generator's slice of the trace.
+		struct {
+			const spinn_trace_record_t *next;
+			const spinn_trace_record_t *end;
+		} trace;
+		
+		// Markov-modulated (on/off) Bernoulli distribution. Rather than
+		// running trials every period, the number of periods until the next
+		// packet and the next state change are drawn from geometric
+		// distributions and counted down.
+		struct {
+			double on_prob;
+			double off_prob;
+			double on_duration;
+			double off_duration;
+			
+			bool on;
+			unsigned int periods_to_packet;
+			unsigned int periods_to_switch;
+		} mmpp;
+		
+		// Spiking neural network workload. The time (in ticks) of the chip's
+		// next spike and the number of spikes which are yet to be sent.
+		struct {
+			const spinn_snn_chip_t *chip;
+			double next_spike;
+			unsigned int num_pending;
+		} snn;
+		
 	} temporal_dist_data;
 	
+	// State of the cores temporal distribution. This lives outside of
+	// temporal_dist_data as it owns memory which must be freed when the
+	// distribution changes. cores.cores is NULL when not allocated.
+	struct {
+		int num_cores;
+		int queue_length;
+		spinn_packet_gen_core_t *cores;
+		
+		// The largest core probability and the cumulative binomial distribution of
+		// the number of cores with this probability which would send a packet in a
+		// given period (num_cores+1 entries).
+		double  max_prob;
+		double *num_sending_cdf;
+		
+		// A permutation of the core numbers. The first num_selected are the cores
+		// selected to (possibly) send a packet during the current period.
+		int *order;
+		int  num_selected;
+		
+		// The core whose queue will be checked first when forwarding a packet
+		// (round-robin) and the total number of packets queued in all cores.
+		int next_core;
+		int num_queued;
+	} cores;
+	
 	// Callback on packet create/send
 	void *(*on_packet_gen)(spinn_packet_t *packet, void *data);
 	void *on_packet_gen_data;
+	
+	// Callback on packet entering the network
+	void (*on_packet_inject)(spinn_packet_t *packet, void *data);
+	void *on_packet_inject_data;
 };
 
 
@@ -152,6 +249,9 @@ struct spinn_packet_con {
 	// Should a packet be consumed during the tock phase?
 	bool consume_packet;
 	
+	// Random number generator for consumption decisions (NULL to use rand())
+	rng_t *rng;
+	
 	// The temporal distribution to use when generating packets.
 	spinn_packet_con_temporal_dist_t temporal_dist;
 	
@@ -13,16 +13,19 @@
 #include "config.h"
 
 #include <stdlib.h>
+#include <stdio.h>
 #include <string.h>
 #include <assert.h>
 #include <stdbool.h>
 
 #include "scheduler.h"
 #include "buffer.h"
+#include "histogram.h"
 
 #include "spinn.h"
 #include "spinn_topology.h"
 #include "spinn_packet.h"
+#include "spinn_mc_table.h"
 #include "spinn_router.h"
 
 /******************************************************************************
@@ -51,6 +54,93 @@ get_packet_output_direction(spinn_router_t *r, spinn_packet_t *p)
 }
 
 
+/**
+ * Decide whether to forward or drop a point-to-point packet at the end of the
+ * pipeline, and via which output.
+ */
+static void
+spinn_router_tick_p2p(spinn_router_t *r, spinn_packet_t *p)
+{
+	// Find out the intended direction and emergency mode of the packet
+	switch (p->emg_state) {
+		case SPINN_EMG_NORMAL:
+		case SPINN_EMG_SECOND_LEG:
+			r->selected_output_direction = get_packet_output_direction(r, p);
+			if (r->use_emg_routing && r->time_elapsed >= r->first_timeout) {
+				r->cur_packet_emg_state      = SPINN_EMG_FIRST_LEG;
+				r->selected_output_direction = spinn_next_cw(r->selected_output_direction);
+			} else {
+				r->cur_packet_emg_state = SPINN_EMG_NORMAL;
+			}
+			break;
+		
+		case SPINN_EMG_FIRST_LEG:
+			r->cur_packet_emg_state = SPINN_EMG_SECOND_LEG;
+			r->selected_output_direction = spinn_next_cw(spinn_opposite(p->direction));
+			break;
+	}
+	
+	r->forward_packet = false;
+	r->drop_packet    = false;
+	
+	// Count the cycles the packet waits (or is dropped) due to a full output
+	if (buffer_is_full(r->outputs[r->selected_output_direction]))
+		r->num_blocked[r->selected_output_direction]++;
+	
+	if (!buffer_is_full(r->outputs[r->selected_output_direction])) {
+		// Is the output available? Forward the packet to this port!
+		r->forward_packet = true;
+	} else if (!r->use_emg_routing &&
+	           p->emg_state != SPINN_EMG_FIRST_LEG &&
+	           r->time_elapsed >= r->first_timeout) {
+		// Drop the packet as emergency routing is disabled and it has timed out
+		r->drop_packet = true;
+	} else if ( (p->emg_state == SPINN_EMG_FIRST_LEG &&
+	             r->time_elapsed > r->first_timeout) ||
+	           r->time_elapsed >= r->first_timeout + r->final_timeout){
+		// TODO: Drop the timed-out emergency routed packet
+		r->drop_packet = true;
+		r->num_final_timeouts++;
+	}
+}
+
+
+/**
+ * Decide whether to forward or drop a multicast packet at the end of the
+ * pipeline. The packet is forwarded to all of the outputs selected by the
+ * routing table at once, and only when none of them is full. Packets with no
+ * matching routing table entry are dropped.
+ */
+static void
+spinn_router_tick_mc(spinn_router_t *r, spinn_packet_t *p)
+{
+	r->forward_packet = false;
+	r->drop_packet    = false;
+	
+	uint32_t route;
+	if (r->mc_table == NULL
+	    || !spinn_mc_table_lookup(r->mc_table, p->key, &route)
+	    || route == 0) {
+		r->drop_packet = true;
+		return;
+	}
+	r->selected_mc_route = route;
+	
+	r->forward_packet = true;
+	for (int i = 0; i < 7; i++) {
+		if ((route & (1u << i)) && buffer_is_full(r->outputs[i])) {
+			r->forward_packet = false;
+			r->num_blocked[i]++;
+		}
+	}
+	
+	// Multicast packets are not emergency routed: they are dropped once they
+	// time out.
+	if (!r->forward_packet && r->time_elapsed >= r->first_timeout)
+		r->drop_packet = true;
+}
+
+
 void
 spinn_router_tick(void *r_)
 {
@@ -60,42 +150,10 @@ spinn_router_tick(void *r_)
 	if (r->pipeline[r->num_pipeline_stages-1].valid) {
 		spinn_packet_t *p = r->pipeline[r->num_pipeline_stages-1].data;
 		
-		// Find out the intended direction and emergency mode of the packet
-		switch (p->emg_state) {
-			case SPINN_EMG_NORMAL:
-			case SPINN_EMG_SECOND_LEG:
-				r->selected_output_direction = get_packet_output_direction(r, p);
-				if (r->use_emg_routing && r->time_elapsed >= r->first_timeout) {
-					r->cur_packet_emg_state      = SPINN_EMG_FIRST_LEG;
-					r->selected_output_direction = spinn_next_cw(r->selected_output_direction);
-				} else {
-					r->cur_packet_emg_state = SPINN_EMG_NORMAL;
-				}
-				break;
-			
-			case SPINN_EMG_FIRST_LEG:
-				r->cur_packet_emg_state = SPINN_EMG_SECOND_LEG;
-				r->selected_output_direction = spinn_next_cw(spinn_opposite(p->direction));
-				break;
-		}
-		
-		r->forward_packet = false;
-		r->drop_packet    = false;
-		
-		if (!buffer_is_full(r->outputs[r->selected_output_direction])) {
-			// Is the output available? Forward the packet to this port!
-			r->forward_packet = true;
-		} else if (!r->use_emg_routing &&
-		           p->emg_state != SPINN_EMG_FIRST_LEG &&
-		           r->time_elapsed >= r->first_timeout) {
-			// Drop the packet as emergency routing is disabled and it has timed out
-			r->drop_packet = true;
-		} else if ( (p->emg_state == SPINN_EMG_FIRST_LEG &&
-		             r->time_elapsed > r->first_timeout) ||
-		           r->time_elapsed >= r->first_timeout + r->final_timeout){
-			// TODO: Drop the timed-out emergency routed packet
-			r->drop_packet = true;
-		}
+		if (p->type == SPINN_PACKET_MC)
+			spinn_router_tick_mc(r, p);
+		else
+			spinn_router_tick_p2p(r, p);
 	}
 	
 	// If a packet is available it may be possible to add it to the pipeline
@@ -108,37 +166,83 @@ spinn_router_tock(void *r_)
 {
 	spinn_router_t *r = (spinn_router_t *)r_;
 	
+	// Record the state of the pipeline during this cycle
+	r->num_cycles++;
+	for (int i = 0; i < r->num_pipeline_stages; i++)
+		if (r->pipeline[i].valid)
+			r->pipeline_occupancy_sum++;
+	
 	// Deal with sending of packets
 	if (!r->pipeline[r->num_pipeline_stages-1].valid) {
 		// No packet at the end of the pipeline: do nothing
+		r->num_bubble_cycles++;
 	} else if (!r->forward_packet && !r->drop_packet) {
 		// If no forwarding/dropping to do, just advance the clock
 		r->time_elapsed++;
+		r->num_stall_cycles++;
 	} else {
 		// Grab the packet from the end of the pipeline (and invalidate the value
 		// there to allow the pipeline to advance)
 		spinn_packet_t *p = r->pipeline[r->num_pipeline_stages-1].data;
 		r->pipeline[r->num_pipeline_stages-1].valid = false;
 		
-		if (r->forward_packet) {
+		if (r->time_elapsed >= r->first_timeout)
+			r->num_first_timeouts++;
+		if (r->forward_packet && r->wait_histogram != NULL)
+			histogram_add(r->wait_histogram, r->time_elapsed);
+		
+		if (r->forward_packet && p->type == SPINN_PACKET_MC) {
+			p->num_hops++;
+			
+			// Send the packet to the first selected output and a copy to each of the
+			// others so that each branch of the tree counts its own hops and
+			// direction. Copies are made of the packet as it was before being sent
+			// (and so before the forwarding callback sees it).
+			spinn_packet_t original = *p;
+			bool first_output = true;
+			for (int i = 0; i < 7; i++) {
+				if (!(r->selected_mc_route & (1u << i)))
+					continue;
+				
+				if (!first_output) {
+					p = spinn_packet_pool_palloc(r->pool);
+					*p = original;
+					p->ref_count = 1;
+				}
+				first_output = false;
+				
+				p->direction = (spinn_direction_t)i;
+				buffer_push(r->outputs[i], p);
+				r->num_forwarded[i]++;
+				
+				// Raise the forwarding callback for each copy
+				if (r->on_forward != NULL)
+					r->on_forward(r, p, r->on_forward_data);
+			}
+		} else if (r->forward_packet) {
 			// Set the packet flags
 			p->direction = r->selected_output_direction;
 			p->emg_state = r->cur_packet_emg_state;
 			
 			// Update the counters
 			p->num_hops++;
-			if (p->emg_state == SPINN_EMG_FIRST_LEG)
+			if (p->emg_state == SPINN_EMG_FIRST_LEG) {
 				p->num_emg_hops++;
+				r->num_emg_routed++;
+			}
 			
 			// Forward the current packet to the output
 			buffer_push(r->outputs[r->selected_output_direction], p);
+			r->num_forwarded[r->selected_output_direction]++;
 			
 			// Raise the forwarding callback
 			if (r->on_forward != NULL)
 				r->on_forward(r, p, r->on_forward_data);
-		} else if (r->drop_packet && r->on_drop != NULL) {
+		} else if (r->drop_packet) {
 			// Drop the packet (just call the callback)
-			r->on_drop(r, p, r->on_drop_data);
+			r->num_dropped++;
+			if (r->on_drop != NULL)
+				r->on_drop(r, p, r->on_drop_data);
 		}
 		
 		// Reset router state ready for next packet
@@ -191,6 +295,10 @@ spinn_router_init( spinn_router_t *r
 	// Initialise internal fields
 	r->time_elapsed              = 0;
 	
+	// No multicast routing table until one is set
+	r->mc_table = NULL;
+	r->pool     = NULL;
+	
 	// Set up the pipeline
 	r->num_pipeline_stages = num_pipeline_stages;
 	r->pipeline = calloc(r->num_pipeline_stages, sizeof(spinn_router_pipeline_t));
@@ -214,6 +322,9 @@ spinn_router_init( spinn_router_t *r
 	r->on_drop      = on_drop;
 	r->on_drop_data = on_drop_data;
 	
+	r->wait_histogram = NULL;
+	spinn_router_reset_counters(r);
+	
 	// Set up tick/tock callbacks in the scheduler
 	scheduler_schedule( s, period
 	                  , spinn_router_tick, (void *)r
@@ -222,10 +333,186 @@ spinn_router_init( spinn_router_t *r
 }
 
 
+void
+spinn_router_set_mc_table( spinn_router_t         *r
+                         , const spinn_mc_table_t *mc_table
+                         , spinn_packet_pool_t    *pool
+                         )
+{
+	r->mc_table = mc_table;
+	r->pool     = pool;
+}
+
+
+unsigned long
+spinn_router_get_num_forwarded(spinn_router_t *r, spinn_direction_t direction)
+{
+	return r->num_forwarded[direction];
+}
+
+
+unsigned long
+spinn_router_get_num_blocked(spinn_router_t *r, spinn_direction_t direction)
+{
+	return r->num_blocked[direction];
+}
+
+
+unsigned long
+spinn_router_get_num_cycles(spinn_router_t *r)
+{
+	return r->num_cycles;
+}
+
+
+unsigned long
+spinn_router_get_num_stall_cycles(spinn_router_t *r)
+{
+	return r->num_stall_cycles;
+}
+
+
+unsigned long
+spinn_router_get_num_bubble_cycles(spinn_router_t *r)
+{
+	return r->num_bubble_cycles;
+}
+
+
+double
+spinn_router_get_mean_pipeline_occupancy(spinn_router_t *r)
+{
+	if (r->num_cycles == 0)
+		return 0.0;
+	
+	return (double)r->pipeline_occupancy_sum / (double)r->num_cycles;
+}
+
+
+unsigned long
+spinn_router_get_num_first_timeouts(spinn_router_t *r)
+{
+	return r->num_first_timeouts;
+}
+
+
+unsigned long
+spinn_router_get_num_emg_routed(spinn_router_t *r)
+{
+	return r->num_emg_routed;
+}
+
+
+unsigned long
+spinn_router_get_num_final_timeouts(spinn_router_t *r)
+{
+	return r->num_final_timeouts;
+}
+
+
+unsigned long
+spinn_router_get_num_dropped(spinn_router_t *r)
+{
+	return r->num_dropped;
+}
+
+
+void
+spinn_router_enable_wait_histogram(spinn_router_t *r, int precision)
+{
+	if (r->wait_histogram == NULL) {
+		r->wait_histogram = malloc(sizeof(histogram_t));
+		assert(r->wait_histogram != NULL);
+		histogram_init(r->wait_histogram, precision);
+	}
+}
+
+
+histogram_t *
+spinn_router_get_wait_histogram(spinn_router_t *r)
+{
+	return r->wait_histogram;
+}
+
+
+void
+spinn_router_reset_counters(spinn_router_t *r)
+{
+	for (int i = 0; i < 7; i++) {
+		r->num_forwarded[i] = 0;
+		r->num_blocked[i]   = 0;
+	}
+	
+	r->num_cycles             = 0;
+	r->num_stall_cycles       = 0;
+	r->num_bubble_cycles      = 0;
+	r->pipeline_occupancy_sum = 0;
+	
+	r->num_first_timeouts = 0;
+	r->num_emg_routed     = 0;
+	r->num_final_timeouts = 0;
+	r->num_dropped        = 0;
+	
+	if (r->wait_histogram != NULL)
+		histogram_reset(r->wait_histogram);
+}
+
+
+bool
+spinn_router_save( spinn_router_t      *r
+                 , FILE                *f
+                 , buffer_save_value_t  save_value
+                 , void                *data
+                 )
+{
+	if (fwrite(&(r->time_elapsed), sizeof(r->time_elapsed), 1, f) != 1
+	    || fwrite(&(r->num_pipeline_stages), sizeof(r->num_pipeline_stages), 1, f) != 1)
+		return false;
+	
+	for (int i = 0; i < r->num_pipeline_stages; i++) {
+		if (fwrite(&(r->pipeline[i].valid), sizeof(r->pipeline[i].valid), 1, f) != 1)
+			return false;
+		if (r->pipeline[i].valid && !save_value(f, r->pipeline[i].data, data))
+			return false;
+	}
+	
+	return true;
+}
+
+
+bool
+spinn_router_restore( spinn_router_t         *r
+                    , FILE                   *f
+                    , buffer_restore_value_t  restore_value
+                    , void                   *data
+                    )
+{
+	int num_pipeline_stages;
+	if (fread(&(r->time_elapsed), sizeof(r->time_elapsed), 1, f) != 1
+	    || fread(&num_pipeline_stages, sizeof(num_pipeline_stages), 1, f) != 1
+	    || num_pipeline_stages != r->num_pipeline_stages)
+		return false;
+	
+	for (int i = 0; i < r->num_pipeline_stages; i++) {
+		if (fread(&(r->pipeline[i].valid), sizeof(r->pipeline[i].valid), 1, f) != 1)
+			return false;
+		if (r->pipeline[i].valid && !restore_value(f, &(r->pipeline[i].data), data))
+			return false;
+	}
+	
+	return true;
+}
+
+
 void
 spinn_router_destroy(spinn_router_t *r)
 {
 	free(r->pipeline);
+	
+	if (r->wait_histogram != NULL) {
+		histogram_destroy(r->wait_histogram);
+		free(r->wait_histogram);
+	}
 }
 
 
@@ -13,9 +13,11 @@
 
 #include "scheduler.h"
 #include "buffer.h"
+#include "histogram.h"
 
 #include "spinn.h"
 #include "spinn_packet.h"
+#include "spinn_mc_table.h"
 
 /**
  * A model of a SpiNNaker router.
@@ -90,6 +92,144 @@ void spinn_router_init( spinn_router_t *router
                       );
 
 
+/**
+ * Set the multicast routing table used to route multicast packets. Multicast
+ * packets are sent to every output in the route of the first matching entry,
+ * waiting until all of those outputs have space (or dropping the packet after
+ * the first timeout). Packets whose key matches no entry are dropped, as are all
+ * multicast packets if no table is set.
+ *
+ * The packet itself is sent to the first output of its route and a copy (with
+ * its own hop count, direction and latencies) is allocated from the given pool
+ * for each additional output. Each copy is freed independently.
+ *
+ * The table must remain valid (and compiled) until the router is destroyed or
+ * another table is set.
+ */
+void spinn_router_set_mc_table( spinn_router_t         *router
+                              , const spinn_mc_table_t *mc_table
+                              , spinn_packet_pool_t    *pool
+                              );
+
+
+/**
+ * Get the number of packets sent to the given output since the counters were
+ * reset (counting each copy of a multicast packet).
+ */
+unsigned long spinn_router_get_num_forwarded( spinn_router_t    *router
+                                            , spinn_direction_t  direction
+                                            );
+
+
+/**
+ * Get the number of router cycles since the counters were reset during which a
+ * packet waiting at the end of the pipeline could not be sent because the given
+ * output was full.
+ */
+unsigned long spinn_router_get_num_blocked( spinn_router_t    *router
+                                          , spinn_direction_t  direction
+                                          );
+
+
+/**
+ * Get the number of router cycles since the counters were reset.
+ */
+unsigned long spinn_router_get_num_cycles(spinn_router_t *router);
+
+
+/**
+ * Get the number of router cycles since the counters were reset during which
+ * the packet at the end of the pipeline was neither forwarded nor dropped.
+ */
+unsigned long spinn_router_get_num_stall_cycles(spinn_router_t *router);
+
+
+/**
+ * Get the number of router cycles since the counters were reset during which
+ * there was no packet at the end of the pipeline.
+ */
+unsigned long spinn_router_get_num_bubble_cycles(spinn_router_t *router);
+
+
+/**
+ * Get the mean number of pipeline stages holding a packet over the router
+ * cycles since the counters were reset (or 0 if there were none).
+ */
+double spinn_router_get_mean_pipeline_occupancy(spinn_router_t *router);
+
+
+/**
+ * Get the number of packets forwarded or dropped since the counters were reset
+ * which had waited at least first_timeout router cycles.
+ */
+unsigned long spinn_router_get_num_first_timeouts(spinn_router_t *router);
+
+
+/**
+ * Get the number of packets sent on the first leg of an emergency route since
+ * the counters were reset.
+ */
+unsigned long spinn_router_get_num_emg_routed(spinn_router_t *router);
+
+
+/**
+ * Get the number of point-to-point packets dropped since the counters were
+ * reset after also timing out while being emergency routed.
+ */
+unsigned long spinn_router_get_num_final_timeouts(spinn_router_t *router);
+
+
+/**
+ * Get the number of packets dropped (for any reason) since the counters were
+ * reset.
+ */
+unsigned long spinn_router_get_num_dropped(spinn_router_t *router);
+
+
+/**
+ * Start recording a histogram of the number of router cycles each packet
+ * forwarded waited at the end of the pipeline (i.e. time_elapsed when it was
+ * sent). The histogram is cleared when the counters are reset.
+ *
+ * @param precision The precision of the histogram (see histogram_init).
+ */
+void spinn_router_enable_wait_histogram(spinn_router_t *router, int precision);
+
+
+/**
+ * Get the histogram of waiting times or NULL if not enabled.
+ */
+histogram_t *spinn_router_get_wait_histogram(spinn_router_t *router);
+
+
+/**
+ * Reset all of the router's counters (and the waiting time histogram) to zero.
+ */
+void spinn_router_reset_counters(spinn_router_t *router);
+
+
+/**
+ * Write the state of the router (including the packets in its pipeline, which
+ * are written using save_value) to a snapshot file. Returns false on failure.
+ */
+bool spinn_router_save( spinn_router_t      *router
+                      , FILE                *f
+                      , buffer_save_value_t  save_value
+                      , void                *data
+                      );
+
+
+/**
+ * Restore the state of a router written by spinn_router_save. The router must
+ * have the same number of pipeline stages. Returns false on failure.
+ */
+bool spinn_router_restore( spinn_router_t         *router
+                         , FILE                   *f
+                         , buffer_restore_value_t  restore_value
+                         , void                   *data
+                         );
+
+
 /**
  * Free resources used by the router. Callbacks registered with the scheduler
  * will become invalid and so the scheduler should not be used after a call to
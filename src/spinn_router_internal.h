@@ -65,6 +65,14 @@ struct spinn_router {
 	// forwarded
 	spinn_emg_state_t cur_packet_emg_state;
 	
+	// The multicast routing table (or NULL if none is set) and the pool from
+	// which multicast packets were allocated.
+	const spinn_mc_table_t *mc_table;
+	spinn_packet_pool_t    *pool;
+	
+	// The outputs the current multicast packet is being sent to
+	uint32_t selected_mc_route;
+	
 	// Should a packet be accepted into the pipeline (if possible)
 	bool accept_packet;
 	
@@ -79,6 +87,32 @@ struct spinn_router {
 	
 	// A queue of pipeline stages which is advanced on each clock
 	spinn_router_pipeline_t *pipeline;
+	
+	// Counters for each output of the number of packets sent and the number of
+	// router cycles a packet at the end of the pipeline was waiting for that
+	// output while it was full.
+	unsigned long num_forwarded[7];
+	unsigned long num_blocked[7];
+	
+	// Counters of router cycles: in total, those where the packet at the end of
+	// the pipeline waited, those with no packet at the end of the pipeline and
+	// the sum over all cycles of the number of full pipeline stages.
+	unsigned long num_cycles;
+	unsigned long num_stall_cycles;
+	unsigned long num_bubble_cycles;
+	unsigned long pipeline_occupancy_sum;
+	
+	// Counters of packets which left the router after waiting first_timeout,
+	// were emergency routed, were dropped after the emergency routing timeout
+	// and were dropped for any reason.
+	unsigned long num_first_timeouts;
+	unsigned long num_emg_routed;
+	unsigned long num_final_timeouts;
+	unsigned long num_dropped;
+	
+	// A histogram of time_elapsed for each packet forwarded (or NULL if
+	// disabled).
+	histogram_t *wait_histogram;
 };
 
 
@@ -5,18 +5,27 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdbool.h>
 #include <unistd.h>
 #include <string.h>
 #include <assert.h>
 #include <time.h>
 
+#include <sys/time.h>
+
 #include "scheduler.h"
 
 #include "spinn_sim.h"
 #include "spinn_sim_model.h"
 #include "spinn_sim_config.h"
 #include "spinn_sim_stat.h"
+#include "spinn_sim_snapshot.h"
+#include "spinn_sim_cache.h"
+#include "spinn_sim_parallel.h"
+#include "spinn_sim_cost.h"
+
+#include "steady_state.h"
 
 /******************************************************************************
  * Init/Destroy
@@ -29,7 +38,16 @@ spinn_sim_init(spinn_sim_t *sim, const char *config_filename, int argc, char *ar
 	spinn_sim_config_init(sim, config_filename, argc, argv);
 	
 	// Seed the simulation (default to the time as a seed)
-	srand(spinn_sim_config_lookup_int64_default(sim, "experiment.seed", time(NULL)));
+	sim->seed = spinn_sim_config_lookup_int64_default(sim, "experiment.seed", time(NULL));
+	srand(sim->seed);
+	
+	sim->show_progress = true;
+	
+	sim->terminated    = SPINN_SIM_TERMINATED_NONE;
+	sim->stalled_ticks = 0;
+	
+	sim->monitor_limits.interval = 0;
+	sim->monitor_ticks           = 0;
 	
 	// Set up stat counting resources
 	spinn_sim_stat_open(sim);
@@ -48,10 +66,85 @@ spinn_sim_destroy(spinn_sim_t *sim)
  * Experiment/Simulation Control
  ******************************************************************************/
 
+static void
+spinn_sim_monitor_count(spinn_sim_t *sim, spinn_sim_monitor_counts_t *counts)
+{
+	counts->accepted = 0;
+	counts->dropped  = 0;
+	counts->progress = 0;
+	for (int i = 0; i < sim->system_size.x * sim->system_size.y; i++) {
+		counts->accepted += sim->nodes[i].stat_packets_accepted;
+		counts->dropped  += sim->nodes[i].stat_packets_dropped;
+		counts->progress += sim->nodes[i].stat_packets_forwarded
+		                  + sim->nodes[i].stat_packets_arrived;
+	}
+}
+
+
+/**
+ * Start the early termination monitors afresh for a warmup or sample: look up
+ * their limits and take the counts against which the first check is made. Must
+ * be called after the per-node counters are reset.
+ */
+static void
+spinn_sim_monitor_start(spinn_sim_t *sim)
+{
+	spinn_sim_monitor_limits_t *limits = &(sim->monitor_limits);
+	if (spinn_sim_config_lookup_bool(sim, "experiment.early_termination.enabled")) {
+		limits->interval               = spinn_sim_config_lookup_int(sim, "experiment.early_termination.interval");
+		limits->max_in_flight_per_node = spinn_sim_config_lookup_float(sim, "experiment.early_termination.max_in_flight_per_node");
+		limits->max_drop_ratio         = spinn_sim_config_lookup_float(sim, "experiment.early_termination.max_drop_ratio");
+		limits->max_stalled_ticks      = spinn_sim_config_lookup_int(sim, "experiment.early_termination.max_stalled_ticks");
+	} else {
+		limits->interval = 0;
+	}
+	
+	sim->monitor_ticks = 0;
+	spinn_sim_monitor_count(sim, &(sim->monitor_counts));
+}
+
+
+/**
+ * Check for runaway conditions since the last check, setting sim->terminated if
+ * one is found.
+ */
+static void
+spinn_sim_monitor_check(spinn_sim_t *sim)
+{
+	const spinn_sim_monitor_limits_t *limits = &(sim->monitor_limits);
+	spinn_sim_monitor_counts_t       *last   = &(sim->monitor_counts);
+	
+	spinn_sim_monitor_counts_t now;
+	spinn_sim_monitor_count(sim, &now);
+	
+	int in_flight = spinn_packet_pool_get_num_in_use(&(sim->pool));
+	
+	if (now.progress == last->progress && in_flight > 0)
+		sim->stalled_ticks += limits->interval;
+	else
+		sim->stalled_ticks = 0;
+	
+	if (limits->max_in_flight_per_node > 0.0
+	    && in_flight > limits->max_in_flight_per_node * sim->system_size.x * sim->system_size.y)
+		sim->terminated = SPINN_SIM_TERMINATED_IN_FLIGHT;
+	else if (limits->max_drop_ratio > 0.0
+	         && now.accepted > last->accepted
+	         && (double)(now.dropped - last->dropped) / (double)(now.accepted - last->accepted) > limits->max_drop_ratio)
+		sim->terminated = SPINN_SIM_TERMINATED_DROPS;
+	else if (limits->max_stalled_ticks > 0 && sim->stalled_ticks >= limits->max_stalled_ticks)
+		sim->terminated = SPINN_SIM_TERMINATED_STALLED;
+	
+	*last = now;
+}
+
+
 /**
  * Run the simulator for a certain number of ticks producing simulation
  * performance metrics on stderr every second. If running interactively then the
- * status messages are cleared after simulation is completed.
+ * status messages are cleared after simulation is completed. If the early
+ * termination monitors are enabled, they are checked every interval ticks since
+ * spinn_sim_monitor_start (across calls) and the run ends as soon as they find a
+ * runaway condition.
  */
 void
 spinn_sim_run_ticks(spinn_sim_t *sim, int num_ticks)
@@ -65,45 +158,484 @@ spinn_sim_run_ticks(spinn_sim_t *sim, int num_ticks)
 	
 	// Save the position of the cursor to allow cursor to be moved when in a
 	// terminal
-	if (isatty(STDERR_FILENO))
+	if (sim->show_progress && isatty(STDERR_FILENO))
 		fprintf(stderr, "\033[s");
 	
-	// Run the simulation for the requested number of ticks
-	for (ticks_t t = 0; t < num_ticks; t++) {
-		scheduler_tick_tock(&(sim->scheduler));
-		
-		// Show the status line once per cycle
-		time_t now = time(NULL);
-		if (last_debug_time != now) {
-			fprintf(stderr, "%s%3d%% (%6d/%6d, %d ticks/s)%s"
-			              , isatty(STDERR_FILENO) ? "\033[u\033[K" : ""
-			              , (t*100) / num_ticks
-			              , t, num_ticks
-		                , scheduler_get_ticks(&(sim->scheduler)) - last_num_ticks
-			              , isatty(STDERR_FILENO) ? "" : "\n"
-			              );
-			last_debug_time = now;
-			last_num_ticks  = scheduler_get_ticks(&(sim->scheduler));
+	// Run the simulation for the requested number of ticks, stopping at the end
+	// of each time series window to record the counters (so that ticks within a
+	// window cost nothing extra).
+	ticks_t t = 0;
+	while (t < num_ticks && sim->terminated == SPINN_SIM_TERMINATED_NONE) {
+		ticks_t stop = num_ticks;
+		int window_ticks = spinn_sim_stat_ticks_until_window(sim);
+		if (window_ticks > 0 && t + window_ticks < stop)
+			stop = t + window_ticks;
+		
+		for (; t < stop && sim->terminated == SPINN_SIM_TERMINATED_NONE; t++) {
+			scheduler_tick_tock(&(sim->scheduler));
+			
+			if (sim->monitor_limits.interval > 0
+			    && ++sim->monitor_ticks % sim->monitor_limits.interval == 0)
+				spinn_sim_monitor_check(sim);
+			
+			// Show the status line once per cycle
+			time_t now = time(NULL);
+			if (sim->show_progress && last_debug_time != now) {
+				fprintf(stderr, "%s%3d%% (%6d/%6d, %d ticks/s)%s"
+				              , isatty(STDERR_FILENO) ? "\033[u\033[K" : ""
+				              , (t*100) / num_ticks
+				              , t, num_ticks
+			                , scheduler_get_ticks(&(sim->scheduler)) - last_num_ticks
+				              , isatty(STDERR_FILENO) ? "" : "\n"
+				              );
+				last_debug_time = now;
+				last_num_ticks  = scheduler_get_ticks(&(sim->scheduler));
+			}
 		}
+		
+		spinn_sim_stat_end_window(sim);
 	}
 	
 	// Erase the status line (if running in a terminal)
-	if (isatty(STDERR_FILENO))
+	if (sim->show_progress && isatty(STDERR_FILENO))
 		fprintf(stderr, "\033[u\033[K");
 }
 
 
+/**
+ * Count the packets which have arrived at any node.
+ */
+static int
+spinn_sim_count_arrived(spinn_sim_t *sim)
+{
+	int num_arrived = 0;
+	for (int i = 0; i < sim->system_size.x * sim->system_size.y; i++)
+		num_arrived += sim->nodes[i].stat_packets_arrived;
+	return num_arrived;
+}
+
+
+/**
+ * Run a warmup of (at most) max_ticks. If adaptive warmups are enabled, the
+ * warmup ends as soon as the throughput of the network, the number of packets in
+ * flight and the size of the packet pool have all reached steady state
+ * according to the MSER heuristic.
+ */
+static void
+spinn_sim_run_warmup(spinn_sim_t *sim, int max_ticks)
+{
+	spinn_sim_monitor_start(sim);
+	
+	if (!spinn_sim_config_lookup_bool(sim, "experiment.warmup_duration.adaptive.enabled")) {
+		spinn_sim_run_ticks(sim, max_ticks);
+		return;
+	}
+	
+	int window      = spinn_sim_config_lookup_int(sim, "experiment.warmup_duration.adaptive.window");
+	int batch_size  = spinn_sim_config_lookup_int(sim, "experiment.warmup_duration.adaptive.batch_size");
+	int min_windows = spinn_sim_config_lookup_int(sim, "experiment.warmup_duration.adaptive.min_windows");
+	if (window <= 0 || batch_size <= 0) {
+		fprintf(stderr, "Error: experiment.warmup_duration.adaptive.window and batch_size must be positive.\n");
+		exit(-1);
+	}
+	
+	// Throughput, packets in flight and packet pool size
+	steady_state_t ss;
+	steady_state_init(&ss, 3, batch_size);
+	
+	// The status line would be reset for every window
+	bool show_progress = sim->show_progress;
+	sim->show_progress = false;
+	
+	int  last_arrived = spinn_sim_count_arrived(sim);
+	int  ticks        = 0;
+	bool steady       = false;
+	while (!steady && ticks < max_ticks && sim->terminated == SPINN_SIM_TERMINATED_NONE) {
+		int num_ticks = (max_ticks - ticks < window) ? max_ticks - ticks : window;
+		spinn_sim_run_ticks(sim, num_ticks);
+		ticks += num_ticks;
+		
+		int arrived = spinn_sim_count_arrived(sim);
+		double values[3] = { (double)(arrived - last_arrived) / (double)num_ticks
+		                   , (double)spinn_packet_pool_get_num_in_use(&(sim->pool))
+		                   , (double)spinn_packet_pool_get_num_packets(&(sim->pool))
+		                   };
+		last_arrived = arrived;
+		steady_state_add(&ss, values);
+		
+		// Only test once a new batch is complete
+		size_t num_windows = steady_state_get_num_observations(&ss);
+		if ((int)num_windows >= min_windows && num_windows % batch_size == 0)
+			steady = steady_state_reached(&ss, NULL);
+	}
+	
+	steady_state_destroy(&ss);
+	
+	sim->show_progress = show_progress;
+	if (sim->show_progress && steady)
+		fprintf(stderr, "(steady after %d ticks) ", ticks);
+}
+
+
+/**
+ * Run a sample of (at most) max_ticks. If adaptive sampling is enabled or
+ * confidence intervals are being recorded, the sample is run in batches and the
+ * throughput and mean packet latency of each batch are added to the batch means
+ * estimators. With adaptive sampling, the sample ends as soon as the confidence
+ * intervals of both are within the requested precision.
+ */
+static void
+spinn_sim_run_sample(spinn_sim_t *sim, int max_ticks)
+{
+	// The counters were reset at the start of the sample
+	spinn_sim_monitor_start(sim);
+	
+	bool adaptive = spinn_sim_config_lookup_bool(sim, "experiment.adaptive_sample.enabled");
+	if (!adaptive && !spinn_sim_config_lookup_bool(sim, "measurements.simulator.sample_confidence_intervals")) {
+		spinn_sim_run_ticks(sim, max_ticks);
+		return;
+	}
+	
+	int    batch_duration = spinn_sim_config_lookup_int(sim, "experiment.adaptive_sample.batch_duration");
+	int    min_batches    = spinn_sim_config_lookup_int(sim, "experiment.adaptive_sample.min_batches");
+	double precision      = spinn_sim_config_lookup_float(sim, "experiment.adaptive_sample.precision");
+	if (batch_duration <= 0) {
+		fprintf(stderr, "Error: experiment.adaptive_sample.batch_duration must be positive.\n");
+		exit(-1);
+	}
+	
+	// The status line would be reset for every batch
+	bool show_progress = sim->show_progress;
+	sim->show_progress = false;
+	
+	int                last_arrived     = spinn_sim_count_arrived(sim);
+	unsigned long long last_latency_sum = sim->stat_latency_sum;
+	int                ticks            = 0;
+	bool               precise          = false;
+	while (!precise && ticks < max_ticks && sim->terminated == SPINN_SIM_TERMINATED_NONE) {
+		int num_ticks = (max_ticks - ticks < batch_duration) ? max_ticks - ticks : batch_duration;
+		spinn_sim_run_ticks(sim, num_ticks);
+		ticks += num_ticks;
+		
+		// A short final batch would bias the estimates
+		if (num_ticks < batch_duration || sim->terminated != SPINN_SIM_TERMINATED_NONE)
+			break;
+		
+		int arrived = spinn_sim_count_arrived(sim);
+		batch_means_add( &(sim->stat_sample_throughput)
+		               , (double)(arrived - last_arrived) / (double)num_ticks
+		               );
+		if (arrived != last_arrived)
+			batch_means_add( &(sim->stat_sample_latency)
+			               , (double)(sim->stat_latency_sum - last_latency_sum)
+			                 / (double)(arrived - last_arrived)
+			               );
+		last_arrived     = arrived;
+		last_latency_sum = sim->stat_latency_sum;
+		
+		if (adaptive
+		    && batch_means_get_num_batches(&(sim->stat_sample_throughput)) >= min_batches) {
+			// If no packets arrive at all, the latency is irrelevant
+			precise = batch_means_precise(&(sim->stat_sample_throughput), precision)
+			          && (batch_means_get_num_batches(&(sim->stat_sample_latency)) == 0
+			              || batch_means_precise(&(sim->stat_sample_latency), precision));
+		}
+	}
+	
+	sim->show_progress = show_progress;
+	if (sim->show_progress && precise)
+		fprintf(stderr, "(precise after %d ticks) ", ticks);
+}
+
+
+/**
+ * Run a warmup or sample of (at most) max_ticks using the given function,
+ * recording the time taken in the cost model.
+ */
+static void
+spinn_sim_run_timed( spinn_sim_t *sim
+                   , void (*run)(spinn_sim_t *sim, int max_ticks)
+                   , int          max_ticks
+                   )
+{
+	ticks_t start_ticks = scheduler_get_ticks(&(sim->scheduler));
+	struct timeval start_time;
+	gettimeofday(&start_time, NULL);
+	
+	run(sim, max_ticks);
+	
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	spinn_sim_cost_record( sim
+	                     , scheduler_get_ticks(&(sim->scheduler)) - start_ticks
+	                     , (double)(((now.tv_sec - start_time.tv_sec)*1000000L)
+	                               + now.tv_usec - start_time.tv_usec)
+	                       / 1000000.0
+	                     );
+}
+
+
+/**
+ * The duration of a warmup of the model from hot or cold.
+ */
+static int
+spinn_sim_warmup_duration(spinn_sim_t *sim, bool model_hot)
+{
+	return model_hot ? spinn_sim_config_lookup_int(sim, "experiment.warmup_duration.hot")
+	                 : spinn_sim_config_lookup_int(sim, "experiment.warmup_duration.cold")
+	                 ;
+}
+
+
+/**
+ * Warm up the model from hot or cold for (at most) warmup_time ticks, restoring
+ * a snapshot in place of a cold warmup where one is available.
+ */
+static void
+spinn_sim_warmup(spinn_sim_t *sim, bool model_hot, int warmup_time)
+{
+	if (sim->show_progress)
+		fprintf(stderr, "  Warming up %s  "
+		              , model_hot ? "from hot " : "from cold"
+		              );
+	
+	// Give the monitors a fresh start
+	sim->terminated    = SPINN_SIM_TERMINATED_NONE;
+	sim->stalled_ticks = 0;
+	
+	spinn_sim_model_seed_rngs(sim, true);
+	spinn_sim_stat_start_warmup(sim);
+	if (!model_hot && spinn_sim_snapshot_restore(sim)) {
+		// A snapshot of the model after a cold warmup was restored
+		if (sim->show_progress)
+			fprintf(stderr, "(restored snapshot) ");
+	} else {
+		spinn_sim_run_timed(sim, spinn_sim_run_warmup, warmup_time);
+		if (!model_hot)
+			spinn_sim_snapshot_save(sim);
+	}
+	spinn_sim_stat_end_warmup(sim);
+	if (sim->show_progress)
+		fprintf(stderr, "%s\n", (sim->terminated != SPINN_SIM_TERMINATED_NONE) ? "terminated" : "100%");
+}
+
+
+/**
+ * Determine whether the network was saturated during the last sample according
+ * to the criteria in experiment.saturation_search.
+ */
+static bool
+spinn_sim_saturated(spinn_sim_t *sim)
+{
+	double min_acceptance = spinn_sim_config_lookup_float(sim, "experiment.saturation_search.min_acceptance");
+	double max_drop_ratio = spinn_sim_config_lookup_float(sim, "experiment.saturation_search.max_drop_ratio");
+	double max_latency    = spinn_sim_config_lookup_float(sim, "experiment.saturation_search.max_latency");
+	
+	// Runaway conditions found by the early termination monitors
+	if (sim->terminated != SPINN_SIM_TERMINATED_NONE)
+		return true;
+	
+	long long offered  = 0;
+	long long accepted = 0;
+	long long arrived  = 0;
+	long long dropped  = 0;
+	for (int i = 0; i < sim->system_size.x * sim->system_size.y; i++) {
+		offered  += sim->nodes[i].stat_packets_offered;
+		accepted += sim->nodes[i].stat_packets_accepted;
+		arrived  += sim->nodes[i].stat_packets_arrived;
+		dropped  += sim->nodes[i].stat_packets_dropped;
+	}
+	
+	// Packets are being refused by the network
+	if (offered > 0 && (double)accepted / (double)offered < min_acceptance)
+		return true;
+	
+	// Packets are being dropped by the routers
+	if (accepted > 0 && (double)dropped / (double)accepted > max_drop_ratio)
+		return true;
+	
+	// Packets are taking too long to arrive
+	if (max_latency > 0.0 && arrived > 0
+	    && (double)sim->stat_latency_sum / (double)arrived > max_latency)
+		return true;
+	
+	return false;
+}
+
+
+/**
+ * Find the value of the parameter experiment.saturation_search.parameter at
+ * which the network saturates by bisection. Each probe is a sample of the
+ * network with the parameter set to the midpoint of the current bounds. Where
+ * the parameter may be changed while the model is hot (and cold_sample is not
+ * set), the model is kept warm between probes. The results of each probe are
+ * recorded as samples and the final bounds are written to saturation.dat.
+ */
+static void
+spinn_sim_run_saturation_search( spinn_sim_t *sim
+                               , bool        *model_initialised
+                               , bool        *model_hot
+                               )
+{
+	const char *parameter = spinn_sim_config_lookup_string(sim, "experiment.saturation_search.parameter");
+	config_setting_t *setting = config_lookup(&(sim->config), parameter);
+	if (setting == NULL || config_setting_type(setting) != CONFIG_TYPE_FLOAT) {
+		fprintf(stderr, "Error: experiment.saturation_search.parameter '%s' is not a floating point setting.\n"
+		              , parameter
+		              );
+		exit(-1);
+	}
+	
+	double lower     = spinn_sim_config_lookup_float(sim, "experiment.saturation_search.lower");
+	double upper     = spinn_sim_config_lookup_float(sim, "experiment.saturation_search.upper");
+	double tolerance = spinn_sim_config_lookup_float(sim, "experiment.saturation_search.tolerance");
+	int max_probes   = spinn_sim_config_lookup_int(sim, "experiment.saturation_search.max_probes");
+	
+	int sample_duration = spinn_sim_config_lookup_int(sim, "experiment.sample_duration");
+	
+	bool cold = spinn_sim_config_lookup_bool(sim, "experiment.cold_sample")
+	            || !spinn_sim_config_is_hot_param(parameter);
+	
+	int num_probes;
+	for (num_probes = 0; num_probes < max_probes && upper - lower > tolerance; num_probes++) {
+		double value = (lower + upper) / 2.0;
+		config_setting_set_float(setting, value);
+		sim->cur_sample = num_probes;
+		
+		if (cold && *model_initialised) {
+			spinn_sim_model_destroy(sim);
+			*model_initialised = false;
+			*model_hot = false;
+		}
+		
+		if (!*model_initialised) {
+			spinn_sim_model_init(sim);
+			*model_initialised = true;
+		} else {
+			spinn_sim_model_update(sim);
+		}
+		
+		if (sim->show_progress)
+			fprintf(stderr, "  Probe %2d/%2d: %s = %f\n"
+			              , num_probes + 1, max_probes
+			              , parameter, value
+			              );
+		
+		spinn_sim_warmup(sim, *model_hot, spinn_sim_warmup_duration(sim, *model_hot));
+		*model_hot = true;
+		
+		if (sim->show_progress)
+			fprintf(stderr, "  Sample                 ");
+		spinn_sim_model_seed_rngs(sim, false);
+		spinn_sim_stat_start_sample(sim);
+		spinn_sim_run_timed(sim, spinn_sim_run_sample, sample_duration);
+		spinn_sim_stat_end_sample(sim);
+		
+		bool saturated = spinn_sim_saturated(sim);
+		if (saturated)
+			upper = value;
+		else
+			lower = value;
+		
+		if (sim->show_progress)
+			fprintf(stderr, "100%% (%s)\n", saturated ? "saturated" : "not saturated");
+	}
+	
+	// Record the result against the group's own parameter values
+	spinn_sim_config_set_exp_group(sim, sim->cur_group);
+	sim->cur_sample = 0;
+	spinn_sim_stat_saturation(sim, lower, upper, num_probes);
+	
+	if (sim->show_progress)
+		fprintf(stderr, "  Saturates between %f and %f\n", lower, upper);
+}
+
+
+/**
+ * Step the hot parameter experiment.staircase.parameter through the values in
+ * experiment.staircase.levels within a single warm model. The model is warmed up
+ * as usual before the first level and is then given settle_duration ticks to
+ * adjust to each subsequent level. Each level is then measured as a sample of
+ * the group.
+ */
+static void
+spinn_sim_run_staircase( spinn_sim_t *sim
+                       , bool        *model_initialised
+                       , bool        *model_hot
+                       )
+{
+	const char *parameter = spinn_sim_config_lookup_string(sim, "experiment.staircase.parameter");
+	config_setting_t *setting = config_lookup(&(sim->config), parameter);
+	if (setting == NULL || !spinn_sim_config_is_hot_param(parameter)
+	    || (config_setting_type(setting) != CONFIG_TYPE_FLOAT
+	        && config_setting_type(setting) != CONFIG_TYPE_INT)) {
+		fprintf(stderr, "Error: experiment.staircase.parameter '%s' is not a numeric parameter which can be changed while the model is hot.\n"
+		              , parameter
+		              );
+		exit(-1);
+	}
+	
+	config_setting_t *levels = config_lookup(&(sim->config), "experiment.staircase.levels");
+	if (levels == NULL || config_setting_length(levels) == 0) {
+		fprintf(stderr, "Error: experiment.staircase.levels must be a non-empty list of values.\n");
+		exit(-1);
+	}
+	int num_levels = config_setting_length(levels);
+	
+	int settle_duration = spinn_sim_config_lookup_int(sim, "experiment.staircase.settle_duration");
+	int sample_duration = spinn_sim_config_lookup_int(sim, "experiment.sample_duration");
+	
+	for (sim->cur_sample = 0; sim->cur_sample < num_levels; sim->cur_sample++) {
+		config_setting_t *level = config_setting_get_elem(levels, sim->cur_sample);
+		double value = (config_setting_type(level) == CONFIG_TYPE_FLOAT)
+		               ? config_setting_get_float(level)
+		               : (double)config_setting_get_int(level)
+		               ;
+		if (config_setting_type(setting) == CONFIG_TYPE_FLOAT)
+			config_setting_set_float(setting, value);
+		else
+			config_setting_set_int(setting, (int)value);
+		
+		if (!*model_initialised) {
+			spinn_sim_model_init(sim);
+			*model_initialised = true;
+		} else {
+			spinn_sim_model_update(sim);
+		}
+		
+		if (sim->show_progress)
+			fprintf(stderr, "  Level %2d/%2d: %s = %g\n"
+			              , sim->cur_sample + 1, num_levels
+			              , parameter, value
+			              );
+		
+		// Only the first level needs a full warmup
+		spinn_sim_warmup( sim, *model_hot
+		                , (sim->cur_sample == 0) ? spinn_sim_warmup_duration(sim, *model_hot)
+		                                         : settle_duration
+		                );
+		*model_hot = true;
+		
+		if (sim->show_progress)
+			fprintf(stderr, "  Sample                 ");
+		spinn_sim_model_seed_rngs(sim, false);
+		spinn_sim_stat_start_sample(sim);
+		spinn_sim_run_timed(sim, spinn_sim_run_sample, sample_duration);
+		spinn_sim_stat_end_sample(sim);
+		if (sim->show_progress)
+			fprintf(stderr, "%s\n", (sim->terminated != SPINN_SIM_TERMINATED_NONE) ? "terminated" : "100%");
+	}
+	
+	// Restore the group's own parameter values
+	spinn_sim_config_set_exp_group(sim, sim->cur_group);
+}
+
+
 void
-spinn_sim_run(spinn_sim_t *sim)
+spinn_sim_run_groups(spinn_sim_t *sim, int parallel_group, int parallel_sample)
 {
 	int num_groups = spinn_sim_config_get_num_exp_groups(sim);
 	
-	// Find out what group/sample is to be simulated by this parallel run. If the
-	// value isn't set, these numbers will be set to -1. Otherwise they'll be set
-	// to the 0-indexed group/sample numbers.
-	int parallel_group  = spinn_sim_config_lookup_int(sim, "experiment.parallel.group")  - 1;
-	int parallel_sample = spinn_sim_config_lookup_int(sim, "experiment.parallel.sample") - 1;
-	
 	// Has the model been initialised?
 	bool model_initialised = false;
 	
@@ -112,6 +644,16 @@ spinn_sim_run(spinn_sim_t *sim)
 	
 	bool cold_group = spinn_sim_config_lookup_bool(sim, "experiment.cold_group");
 	
+	bool saturation_search = spinn_sim_config_lookup_bool(sim, "experiment.saturation_search.enabled");
+	bool staircase         = spinn_sim_config_lookup_bool(sim, "experiment.staircase.enabled");
+	
+	// Groups with higher loads than a group found to be saturated by the early
+	// termination monitors may be skipped
+	bool        skip_saturated = spinn_sim_config_lookup_bool(sim, "experiment.early_termination.skip_saturated_groups");
+	const char *load_key       = spinn_sim_config_lookup_string(sim, "experiment.early_termination.load_parameter");
+	bool *group_saturated = calloc(num_groups, sizeof(bool));
+	assert(group_saturated != NULL);
+	
 	// Perform experiments for each group
 	for (sim->cur_group = 0; sim->cur_group < num_groups; sim->cur_group++) {
 		// If only one group is to be run, skip the others.
@@ -125,6 +667,21 @@ spinn_sim_run(spinn_sim_t *sim)
 			}
 		}
 		
+		// Skip groups which will certainly saturate
+		bool skip = false;
+		for (int g = 0; skip_saturated && !skip && g < sim->cur_group; g++)
+			skip = group_saturated[g]
+			       && spinn_sim_config_exp_group_dominates(sim, sim->cur_group, g, load_key);
+		if (skip) {
+			group_saturated[sim->cur_group] = true;
+			if (sim->show_progress)
+				fprintf(stderr, "Group %2d/%2d: Skipped (saturated at a lower load)\n"
+				              , sim->cur_group + 1
+				              , num_groups
+				              );
+			continue;
+		}
+		
 		// Set up the parameters ready for this group (this is done here as it may
 		// change e.g. the number of samples as an independent variable)
 		spinn_sim_config_set_exp_group(sim, sim->cur_group);
@@ -147,12 +704,28 @@ spinn_sim_run(spinn_sim_t *sim)
 			model_hot = false;
 		}
 		
-		fprintf(stderr, "Group %2d/%2d:\n"
-		              , sim->cur_group + 1
-		              , num_groups
-		              );
+		if (sim->show_progress)
+			fprintf(stderr, "Group %2d/%2d:\n"
+			              , sim->cur_group + 1
+			              , num_groups
+			              );
+		
+		// Search for the saturation point rather than taking samples
+		if (saturation_search) {
+			spinn_sim_run_saturation_search(sim, &model_initialised, &model_hot);
+			continue;
+		}
 		
 		// Perform samples for this group
+		spinn_sim_stat_start_group(sim);
+		
+		// Sweep the load within the group rather than taking samples
+		if (staircase) {
+			spinn_sim_run_staircase(sim, &model_initialised, &model_hot);
+			spinn_sim_stat_end_group(sim);
+			continue;
+		}
+		
 		for (sim->cur_sample = 0; sim->cur_sample < num_samples; sim->cur_sample++) {
 			// If only one sample is to be run, skip the others.
 			if (parallel_sample >= 0 && sim->cur_sample != parallel_sample) {
@@ -180,34 +753,52 @@ spinn_sim_run(spinn_sim_t *sim)
 			// Warm-up if we're doing cold sampling or if this is the first sample of
 			// a group (and thus we might need to hot-start after the previous group)
 			if (cold_sample || sim->cur_sample == 0) {
-				int warmup_time = model_hot ? spinn_sim_config_lookup_int(sim, "experiment.warmup_duration.hot")
-				                            : spinn_sim_config_lookup_int(sim, "experiment.warmup_duration.cold")
-				                            ;
-				fprintf(stderr, "  Warming up %s  "
-				              , model_hot ? "from hot " : "from cold"
-				              );
-				spinn_sim_stat_start_warmup(sim);
-				spinn_sim_run_ticks(sim, warmup_time);
-				spinn_sim_stat_end_warmup(sim);
-				fprintf(stderr, "100%%\n");
+				spinn_sim_warmup(sim, model_hot, spinn_sim_warmup_duration(sim, model_hot));
 				model_hot = true;
 			}
 			
 			// Perform the sample
-			fprintf(stderr, "  Sample %2d/%2d          "
-			              , sim->cur_sample + 1
-			              , num_samples
-			              );
+			if (sim->show_progress)
+				fprintf(stderr, "  Sample %2d/%2d          "
+				              , sim->cur_sample + 1
+				              , num_samples
+				              );
+			spinn_sim_model_seed_rngs(sim, false);
 			spinn_sim_stat_start_sample(sim);
-			spinn_sim_run_ticks(sim, sample_duration);
+			spinn_sim_run_timed(sim, spinn_sim_run_sample, sample_duration);
 			spinn_sim_stat_end_sample(sim);
-			fprintf(stderr, "100%%\n");
+			if (sim->terminated != SPINN_SIM_TERMINATED_NONE)
+				group_saturated[sim->cur_group] = true;
+			if (sim->show_progress)
+				fprintf(stderr, "%s\n", (sim->terminated != SPINN_SIM_TERMINATED_NONE) ? "terminated" : "100%");
 		}
+		spinn_sim_stat_end_group(sim);
 	}
 	
+	free(group_saturated);
+	
 	// Destroy the last model used
 	if (model_initialised)
 		spinn_sim_model_destroy(sim);
+}
+
+
+void
+spinn_sim_run(spinn_sim_t *sim)
+{
+	// Cached results are handled per job, as in a parallel run
+	if (spinn_sim_cache_enabled(sim)) {
+		spinn_sim_parallel_run(sim, 1);
+		return;
+	}
+	
+	// Find out what group/sample is to be simulated by this parallel run. If the
+	// value isn't set, these numbers will be set to -1. Otherwise they'll be set
+	// to the 0-indexed group/sample numbers.
+	int parallel_group  = spinn_sim_config_lookup_int(sim, "experiment.parallel.group")  - 1;
+	int parallel_sample = spinn_sim_config_lookup_int(sim, "experiment.parallel.sample") - 1;
+	
+	spinn_sim_run_groups(sim, parallel_group, parallel_sample);
 	
 	fprintf(stderr, "Simulation completed.\n");
 }
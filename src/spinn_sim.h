@@ -16,14 +16,95 @@
 #include "buffer.h"
 #include "arbiter.h"
 #include "delay.h"
+#include "batch_means.h"
+#include "rng.h"
+#include "columnar.h"
+#include "time_series.h"
+#include "async_writer.h"
+#include "histogram.h"
 
 #include "spinn.h"
 #include "spinn_packet.h"
 #include "spinn_router.h"
+#include "spinn_trace.h"
+#include "spinn_flow_matrix.h"
+#include "spinn_snn.h"
+#include "spinn_mc_table.h"
 
 typedef struct spinn_sim spinn_sim_t;
+
+/**
+ * The number of metrics compared between groups in paired_differences.dat.
+ */
+#define SPINN_SIM_NUM_PAIRED_METRICS 6
+
+/**
+ * The number of metrics (latency, hops and emergency hops) with histograms in
+ * latency_summary.dat.
+ */
+#define SPINN_SIM_NUM_HISTOGRAM_METRICS 3
+
+/**
+ * The number of roles buffers are grouped by in buffer_occupancy.dat (link
+ * input, link output, each arbiter tree level, generator and consumer).
+ */
+#define SPINN_SIM_NUM_BUFFER_ROLES 7
 typedef struct spinn_node spinn_node_t;
 
+/**
+ * Reasons for which the early termination monitors may end a warmup or sample.
+ */
+typedef enum spinn_sim_terminated {
+	// Not terminated
+	SPINN_SIM_TERMINATED_NONE,
+	
+	// Too many packets in flight
+	SPINN_SIM_TERMINATED_IN_FLIGHT,
+	
+	// Too many packets being dropped
+	SPINN_SIM_TERMINATED_DROPS,
+	
+	// No packets forwarded or delivered for too long (i.e. deadlock)
+	SPINN_SIM_TERMINATED_STALLED,
+} spinn_sim_terminated_t;
+
+
+/**
+ * Totals of the per-node counters used by the early termination monitors.
+ */
+typedef struct spinn_sim_monitor_counts {
+	long long accepted;
+	long long dropped;
+	long long progress;
+} spinn_sim_monitor_counts_t;
+
+
+/**
+ * The limits checked by the early termination monitors (looked up once at the
+ * start of each warmup or sample rather than at every check).
+ */
+typedef struct spinn_sim_monitor_limits {
+	int    interval;
+	double max_in_flight_per_node;
+	double max_drop_ratio;
+	int    max_stalled_ticks;
+} spinn_sim_monitor_limits_t;
+
+
+/**
+ * How the packets delivered are divided between latency histograms.
+ */
+typedef enum spinn_sim_histograms_per {
+	// One set of histograms for the whole system
+	SPINN_SIM_HISTOGRAMS_PER_NONE,
+	
+	// One set of histograms per source node
+	SPINN_SIM_HISTOGRAMS_PER_SOURCE,
+	
+	// One set of histograms per number of hops taken
+	SPINN_SIM_HISTOGRAMS_PER_HOPS,
+} spinn_sim_histograms_per_t;
+
 /**
  * Resources for a single node in the simulation.
  */
@@ -47,6 +128,12 @@ struct spinn_node {
 	spinn_packet_gen_t packet_gen;
 	spinn_packet_con_t packet_con;
 	
+	// The node's random number streams used in common random numbers mode for
+	// the generator's packet timings and destinations and for the consumer
+	rng_t gen_temporal_rng;
+	rng_t gen_spatial_rng;
+	rng_t con_rng;
+	
 	// The arbiters
 	arbiter_t arb_e_s;
 	arbiter_t arb_ne_n;
@@ -66,6 +153,10 @@ struct spinn_node {
 	// (connected up by spinn_sim_init).
 	delay_t delays[6];
 	
+	// Does each link connect to a node on another board? (Set by
+	// configure_links).
+	bool link_is_board_to_board[6];
+	
 	// Packet generator/consumer buffers
 	buffer_t gen_buffer;
 	buffer_t con_buffer;
@@ -123,16 +214,109 @@ struct spinn_sim {
 	// spatial distribution
 	spinn_coord_t *node_packet_gen_p2p_target;
 	
+	// The trace replayed by packet generators using the trace temporal
+	// distribution (only valid if packet_gen_trace_loaded is set)
+	bool          packet_gen_trace_loaded;
+	spinn_trace_t packet_gen_trace;
+	
+	// The neural network workload used by packet generators using the snn
+	// temporal distribution (only valid if packet_gen_snn_loaded is set)
+	bool        packet_gen_snn_loaded;
+	spinn_snn_t packet_gen_snn;
+	
+	// The multicast routing table of every router in the system (or NULL if no
+	// tables have been loaded)
+	spinn_mc_table_t *mc_tables;
+	
 	// Statistic output files
 	FILE *stat_file_global_counters;
 	FILE *stat_file_per_node_counters;
+	FILE *stat_file_per_link_counters;
+	FILE *stat_file_buffer_occupancy;
+	FILE *stat_file_router_stats;
+	FILE *stat_file_arbiter_contention;
+	FILE *stat_file_time_series;
 	FILE *stat_file_packet_details;
 	FILE *stat_file_simulator;
+	FILE *stat_file_saturation;
+	FILE *stat_file_paired_differences;
+	FILE *stat_file_latency_summary;
+	FILE *stat_file_latency_histograms;
+	FILE *stat_file_latency_breakdown;
+	FILE *stat_file_latency_breakdown_histograms;
+	
+	// Report buffer occupancy for each node (rather than the whole system)
+	bool stat_buffer_occupancy_per_node;
+	
+	// Report router statistics for each node (rather than the whole system) and
+	// the precision of the histograms of router waiting times.
+	bool stat_router_stats_per_node;
+	int  stat_router_stats_precision;
+	
+	// Report arbiter contention for each node (rather than the whole system)
+	bool stat_arbiter_contention_per_node;
+	
+	// Histograms of the latency, hops and emergency hops of the packets
+	// delivered during the current sample (only kept if latency_summary.dat is
+	// open). There are SPINN_SIM_NUM_HISTOGRAM_METRICS histograms for each key
+	// (i.e. source node or number of hops) allocated as keys are needed.
+	spinn_sim_histograms_per_t stat_histograms_per;
+	int                        stat_histograms_precision;
+	histogram_t               *stat_histograms;
+	int                        stat_histograms_num_keys;
+	
+	// Histograms of each component of the latency (see spinn_packet_latency_t)
+	// followed by the total latency of the packets delivered during the current
+	// sample (only valid if latency_breakdown.dat is open).
+	histogram_t stat_breakdown_histograms[SPINN_PACKET_NUM_LATENCIES + 1];
+	
+	// The writer of each result file opened when the files are written by
+	// background threads (or NULL if written directly)
+	async_writer_t *stat_writers;
+	int             stat_num_writers;
+	
+	// The trace of packet injections being recorded for the current model and the
+	// name of its file relative to the results directory (only valid if
+	// stat_record_trace is set)
+	bool                 stat_record_trace;
+	spinn_trace_writer_t stat_trace_writer;
+	char                *stat_trace_filename;
 	
 	// Flags as to whether packet arrivals will be monitored
 	bool stat_log_delivered_packets;
 	bool stat_log_dropped_packets;
 	
+	// Are the per-node counters and packet details written as binary columnar
+	// tables (see columnar.h) rather than text? If so, the writers of each table
+	// (only valid when the corresponding file is open).
+	bool       stat_columnar;
+	columnar_t stat_columnar_per_node_counters;
+	columnar_t stat_columnar_packet_details;
+	
+	// The writer of the time series (only valid when time_series.bin is open),
+	// the length of each window (ticks), the number of nodes whose counters are
+	// included (0 unless per-node counters are recorded), the row being built and
+	// the time (since the start of the sample) of the last row written.
+	time_series_t stat_time_series;
+	int           stat_time_series_window;
+	int           stat_time_series_num_nodes;
+	int64_t      *stat_time_series_row;
+	ticks_t       stat_time_series_last;
+	
+	// Are flow matrices recorded, with a row per node (rather than per board)?
+	// The matrices of the current sample are only valid while
+	// stat_flow_matrix_valid is set (i.e. during each sample).
+	bool                stat_flow_matrix_enabled;
+	bool                stat_flow_matrix_per_node;
+	bool                stat_flow_matrix_valid;
+	spinn_flow_matrix_t stat_flow_matrix;
+	
+	// The names (relative to the results directory) of the files written besides
+	// the result files (i.e. packet traces and flow matrices) since the list was
+	// last cleared, allowing them to be stored in the result cache.
+	char **stat_side_files;
+	int    stat_num_side_files;
+	
 	// The time at which the warmup/simulation started
 	struct timeval stat_start_time;
 	
@@ -142,6 +326,45 @@ struct spinn_sim {
 	// Is the stat recording process running
 	bool stat_started;
 	
+	// The sum of the latencies (in ticks) of every packet which has arrived
+	unsigned long long stat_latency_sum;
+	
+	// Batch means estimates of the throughput (packets arriving per tick) and
+	// mean packet latency (ticks) during the current sample
+	batch_means_t stat_sample_throughput;
+	batch_means_t stat_sample_latency;
+	
+	// The metrics measured in each sample of the common random numbers baseline
+	// group (NaN for samples of the baseline which were not run)
+	double (*stat_baseline)[SPINN_SIM_NUM_PAIRED_METRICS];
+	int      stat_baseline_num_samples;
+	
+	// Estimates of each metric and of its difference from the same-numbered
+	// sample of the baseline group over the samples of the current group
+	batch_means_t stat_paired_absolute[SPINN_SIM_NUM_PAIRED_METRICS];
+	batch_means_t stat_paired_difference[SPINN_SIM_NUM_PAIRED_METRICS];
+	
+	// Why (if at all) the current warmup/sample was ended early by the early
+	// termination monitors and the number of ticks for which no packet has been
+	// forwarded or delivered.
+	spinn_sim_terminated_t terminated;
+	int                    stalled_ticks;
+	
+	// The limits of the early termination monitors (an interval of zero when
+	// disabled), the number of ticks since the start of the current warmup or
+	// sample and the counts at the last check. These persist between the
+	// batches of adaptive warmups and samples so that checks are made every
+	// interval regardless of the batch length.
+	spinn_sim_monitor_limits_t monitor_limits;
+	int                        monitor_ticks;
+	spinn_sim_monitor_counts_t monitor_counts;
+	
+	// The seed given to the random number generator at the start of the run
+	unsigned int seed;
+	
+	// Should progress be reported on stderr?
+	bool show_progress;
+	
 	// The experemental group currently being run
 	int cur_group;
 	
@@ -166,11 +389,22 @@ void spinn_sim_init(spinn_sim_t *sim, const char *config_filename, int argc, cha
 
 
 /**
- * Run the given simulation to completion.
+ * Run the given simulation to completion. If the result cache is enabled, the
+ * groups (or samples) are run as independent jobs in a single worker process
+ * (see spinn_sim_parallel.h) and those with cached results are skipped.
  */
 void spinn_sim_run(spinn_sim_t *sim);
 
 
+/**
+ * Run the given simulation for a single group (or every group if group is -1)
+ * and a single sample of each group (or every sample if sample is -1). Running a
+ * single group or sample requires experiment.cold_group or
+ * experiment.cold_sample respectively. Groups and samples are 0-indexed.
+ */
+void spinn_sim_run_groups(spinn_sim_t *sim, int group, int sample);
+
+
 /**
  * Free up resources used by a simulation.
  */
@@ -0,0 +1,369 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * spinn_sim_cache.c -- A content-addressed cache of the results of each group
+ * (or sample) of an experiment.
+ *
+ * A cache entry consists of a header giving the length of the output of each
+ * result file followed by the output itself and then each side file (packet
+ * traces and flow matrices written by the job) as a side file header, its name
+ * and its contents. The simulator binary is identified
+ * by its version, size and modification time so that rebuilding the simulator
+ * invalidates the cache.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "spinn_sim.h"
+#include "spinn_sim_config.h"
+#include "spinn_sim_stat.h"
+#include "spinn_sim_cache.h"
+
+
+#define SPINN_SIM_CACHE_MAGIC   "TSRESULT"
+#define SPINN_SIM_CACHE_VERSION 2
+
+/**
+ * The header at the start of every cache entry.
+ */
+typedef struct spinn_sim_cache_header {
+	// Always SPINN_SIM_CACHE_MAGIC
+	char magic[8];
+	
+	// Always SPINN_SIM_CACHE_VERSION
+	uint32_t version;
+	
+	// The number of result files
+	uint32_t num_files;
+	
+	// The number of side files following the output of the result files
+	uint32_t num_side_files;
+	
+	// The key of the entry (guards against a truncated or misnamed file)
+	uint64_t key;
+	
+	// The length of the output of each result file
+	uint64_t lengths[SPINN_SIM_STAT_MAX_FILES];
+} spinn_sim_cache_header_t;
+
+
+/**
+ * The header preceding the name and contents of each side file.
+ */
+typedef struct spinn_sim_cache_side_file_header {
+	// The length of the name (relative to the results directory)
+	uint64_t name_length;
+	
+	// The length of the contents
+	uint64_t length;
+} spinn_sim_cache_side_file_header_t;
+
+
+/**
+ * The longest side file name accepted from a cache entry.
+ */
+#define SPINN_SIM_CACHE_MAX_NAME_LENGTH 1024
+
+
+/**
+ * Everything identifying a job other than the configuration.
+ */
+typedef struct spinn_sim_cache_salt {
+	char     version[32];
+	int64_t  binary_size;
+	int64_t  binary_mtime;
+	int32_t  group;
+	int32_t  sample;
+} spinn_sim_cache_salt_t;
+
+
+/******************************************************************************
+ * Internal: Utilities
+ ******************************************************************************/
+
+/**
+ * Get the key of the cache entry for the given job.
+ */
+static uint64_t
+spinn_sim_cache_key(spinn_sim_t *sim, int group, int sample)
+{
+	spinn_sim_cache_salt_t salt;
+	memset(&salt, 0, sizeof(salt));
+	strncpy(salt.version, PACKAGE_VERSION, sizeof(salt.version) - 1);
+	
+	struct stat binary;
+	if (stat("/proc/self/exe", &binary) == 0) {
+		salt.binary_size  = binary.st_size;
+		salt.binary_mtime = binary.st_mtime;
+	}
+	
+	salt.group  = group;
+	salt.sample = sample;
+	
+	spinn_sim_config_set_exp_group(sim, group);
+	return spinn_sim_config_hash_results(sim, &salt, sizeof(salt));
+}
+
+
+/**
+ * Get the filename of the cache entry with the given key or NULL if the cache
+ * is disabled. The string must be freed by the caller.
+ */
+static char *
+spinn_sim_cache_filename(spinn_sim_t *sim, uint64_t key)
+{
+	const char *directory = spinn_sim_config_lookup_string_default(sim, "experiment.result_cache.directory", "");
+	if (directory[0] == '\0')
+		return NULL;
+	
+	size_t length = strlen(directory) + 64;
+	char *filename = malloc(length);
+	assert(filename != NULL);
+	snprintf( filename, length, "%s/result_%016llx.bin"
+	        , directory
+	        , (unsigned long long)key
+	        );
+	return filename;
+}
+
+
+/**
+ * Copy length bytes from one file to another. Returns false on failure.
+ */
+static bool
+spinn_sim_cache_copy(FILE *from, FILE *to, uint64_t length)
+{
+	char buf[BUFSIZ];
+	while (length > 0) {
+		size_t chunk = (length < sizeof(buf)) ? (size_t)length : sizeof(buf);
+		if (fread(buf, 1, chunk, from) != chunk || fwrite(buf, 1, chunk, to) != chunk)
+			return false;
+		length -= chunk;
+	}
+	return true;
+}
+
+
+/**
+ * Get the filename of the named side file in the results directory. The string
+ * must be freed by the caller.
+ */
+static char *
+spinn_sim_cache_side_filename(spinn_sim_t *sim, const char *name)
+{
+	const char *result_dir = spinn_sim_config_lookup_string(sim, "measurements.results_directory");
+	char *filename = malloc(strlen(result_dir) + strlen(name) + 1);
+	assert(filename != NULL);
+	sprintf(filename, "%s%s", result_dir, name);
+	return filename;
+}
+
+
+/**
+ * Append the named side file to a cache entry. Returns false on failure.
+ */
+static bool
+spinn_sim_cache_write_side_file(spinn_sim_t *sim, FILE *f, const char *name)
+{
+	char *filename = spinn_sim_cache_side_filename(sim, name);
+	FILE *side = fopen(filename, "rb");
+	free(filename);
+	if (side == NULL)
+		return false;
+	
+	spinn_sim_cache_side_file_header_t header;
+	header.name_length = strlen(name);
+	bool ok = fseek(side, 0, SEEK_END) == 0;
+	long length = ok ? ftell(side) : -1;
+	ok = length >= 0 && fseek(side, 0, SEEK_SET) == 0;
+	header.length = length;
+	
+	ok = ok && fwrite(&header, sizeof(header), 1, f) == 1
+	        && fwrite(name, 1, header.name_length, f) == header.name_length
+	        && spinn_sim_cache_copy(side, f, header.length);
+	
+	fclose(side);
+	return ok;
+}
+
+
+/**
+ * Restore the next side file of a cache entry into the results directory.
+ * Returns false on failure.
+ */
+static bool
+spinn_sim_cache_read_side_file(spinn_sim_t *sim, FILE *f)
+{
+	spinn_sim_cache_side_file_header_t header;
+	if (fread(&header, sizeof(header), 1, f) != 1
+	    || header.name_length == 0
+	    || header.name_length > SPINN_SIM_CACHE_MAX_NAME_LENGTH)
+		return false;
+	
+	char name[SPINN_SIM_CACHE_MAX_NAME_LENGTH + 1];
+	if (fread(name, 1, header.name_length, f) != header.name_length)
+		return false;
+	name[header.name_length] = '\0';
+	
+	// Side files are only ever written directly into the results directory
+	if (strchr(name, '/') != NULL)
+		return false;
+	
+	// Write to a temporary file first so that a partial file never replaces one
+	char *filename = spinn_sim_cache_side_filename(sim, name);
+	size_t tmp_length = strlen(filename) + 32;
+	char *tmp_filename = malloc(tmp_length);
+	assert(tmp_filename != NULL);
+	snprintf(tmp_filename, tmp_length, "%s.%ld.tmp", filename, (long)getpid());
+	
+	FILE *side = fopen(tmp_filename, "wb");
+	bool ok = side != NULL && spinn_sim_cache_copy(f, side, header.length);
+	if (side != NULL && fclose(side) != 0)
+		ok = false;
+	if (ok && rename(tmp_filename, filename) != 0)
+		ok = false;
+	
+	if (!ok)
+		remove(tmp_filename);
+	
+	free(tmp_filename);
+	free(filename);
+	return ok;
+}
+
+
+/******************************************************************************
+ * Public functions
+ ******************************************************************************/
+
+bool
+spinn_sim_cache_enabled(spinn_sim_t *sim)
+{
+	const char *directory = spinn_sim_config_lookup_string_default(sim, "experiment.result_cache.directory", "");
+	return directory[0] != '\0';
+}
+
+
+bool
+spinn_sim_cache_load( spinn_sim_t *sim
+                    , int          group
+                    , int          sample
+                    , int          num_files
+                    , char        *data[]
+                    , size_t       lengths[]
+                    )
+{
+	if (!spinn_sim_cache_enabled(sim))
+		return false;
+	
+	uint64_t key = spinn_sim_cache_key(sim, group, sample);
+	char *filename = spinn_sim_cache_filename(sim, key);
+	
+	FILE *f = fopen(filename, "rb");
+	free(filename);
+	if (f == NULL)
+		return false;
+	
+	spinn_sim_cache_header_t header;
+	bool ok = fread(&header, sizeof(header), 1, f) == 1
+	          && memcmp(header.magic, SPINN_SIM_CACHE_MAGIC, sizeof(header.magic)) == 0
+	          && header.version   == SPINN_SIM_CACHE_VERSION
+	          && header.num_files == (uint32_t)num_files
+	          && header.key       == key;
+	
+	int num_read = 0;
+	for (; ok && num_read < num_files; num_read++) {
+		lengths[num_read] = header.lengths[num_read];
+		data[num_read]    = malloc(lengths[num_read] + 1);
+		assert(data[num_read] != NULL);
+		ok = fread(data[num_read], 1, lengths[num_read], f) == lengths[num_read];
+	}
+	
+	// Restore the side files (a failure part way through leaves any restored so
+	// far to be overwritten when the job is recomputed)
+	for (uint32_t i = 0; ok && i < header.num_side_files; i++)
+		ok = spinn_sim_cache_read_side_file(sim, f);
+	
+	// The entry must end exactly here
+	ok = ok && fgetc(f) == EOF;
+	fclose(f);
+	
+	// A corrupt entry is simply recomputed (and overwritten)
+	if (!ok) {
+		for (int i = 0; i < num_read; i++)
+			free(data[i]);
+		return false;
+	}
+	
+	return true;
+}
+
+
+void
+spinn_sim_cache_save( spinn_sim_t *sim
+                    , int          group
+                    , int          sample
+                    , int          num_files
+                    , char        *data[]
+                    , size_t       lengths[]
+                    )
+{
+	if (!spinn_sim_cache_enabled(sim))
+		return;
+	
+	uint64_t key = spinn_sim_cache_key(sim, group, sample);
+	char *filename = spinn_sim_cache_filename(sim, key);
+	
+	// Write to a temporary file first so that the entry appears atomically
+	size_t tmp_length = strlen(filename) + 32;
+	char *tmp_filename = malloc(tmp_length);
+	assert(tmp_filename != NULL);
+	snprintf(tmp_filename, tmp_length, "%s.%ld.tmp", filename, (long)getpid());
+	
+	FILE *f = fopen(tmp_filename, "wb");
+	bool ok = f != NULL;
+	
+	spinn_sim_cache_header_t header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, SPINN_SIM_CACHE_MAGIC, sizeof(header.magic));
+	header.version   = SPINN_SIM_CACHE_VERSION;
+	header.num_files = num_files;
+	header.key       = key;
+	for (int i = 0; i < num_files; i++)
+		header.lengths[i] = lengths[i];
+	
+	char **side_files;
+	header.num_side_files = spinn_sim_stat_get_side_files(sim, &side_files);
+	
+	ok = ok && fwrite(&header, sizeof(header), 1, f) == 1;
+	
+	for (int i = 0; ok && i < num_files; i++)
+		ok = fwrite(data[i], 1, lengths[i], f) == lengths[i];
+	
+	// An entry missing a side file would not reproduce the job's output
+	for (uint32_t i = 0; ok && i < header.num_side_files; i++)
+		ok = spinn_sim_cache_write_side_file(sim, f, side_files[i]);
+	
+	if (f != NULL && fclose(f) != 0)
+		ok = false;
+	if (ok && rename(tmp_filename, filename) != 0)
+		ok = false;
+	
+	if (!ok) {
+		fprintf(stderr, "Warning: Couldn't write result cache entry %s.\n", filename);
+		remove(tmp_filename);
+	}
+	
+	free(tmp_filename);
+	free(filename);
+}
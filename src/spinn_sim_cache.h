@@ -0,0 +1,69 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * spinn_sim_cache.h -- A content-addressed cache of the results of each group
+ * (or sample) of an experiment.
+ *
+ * When experiment.result_cache.directory is set, the output written to every
+ * result file by each job (see spinn_sim_parallel.h) is stored in that directory
+ * as soon as the job completes, in a file named after a hash of everything
+ * which could affect it: the configuration with the values of the job's group,
+ * the seed, the group and sample numbers and the simulator binary itself. Later
+ * runs splice the cached output into their result files instead of simulating
+ * the job again, so an interrupted experiment resumes where it stopped and an
+ * extended experiment only simulates its new groups.
+ *
+ * The side files written by each job (packet traces and flow matrices, see
+ * spinn_sim_stat_get_side_files) are stored in the entry too and restored into
+ * the results directory when the entry is loaded.
+ */
+
+#ifndef SPINN_SIM_CACHE_H
+#define SPINN_SIM_CACHE_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "spinn_sim.h"
+
+/**
+ * Is the result cache enabled?
+ */
+bool spinn_sim_cache_enabled(spinn_sim_t *sim);
+
+
+/**
+ * Load the cached output of the given group and sample (-1 for a whole group).
+ * On success, returns true, restores the job's side files into the results
+ * directory and sets data and lengths to the output for each of the num_files
+ * result files (the data must be freed by the caller). Returns
+ * false if the cache is disabled or holds no (valid) result for the job.
+ *
+ * Note: selects the configuration of the given group.
+ */
+bool spinn_sim_cache_load( spinn_sim_t *sim
+                         , int          group
+                         , int          sample
+                         , int          num_files
+                         , char        *data[]
+                         , size_t       lengths[]
+                         );
+
+
+/**
+ * Store the output of the given group and sample (-1 for a whole group) in the
+ * cache, if enabled, along with the side files written since
+ * spinn_sim_stat_clear_side_files was last called. Failure to write the cache is not fatal and produces a
+ * warning on stderr.
+ *
+ * Note: selects the configuration of the given group.
+ */
+void spinn_sim_cache_save( spinn_sim_t *sim
+                         , int          group
+                         , int          sample
+                         , int          num_files
+                         , char        *data[]
+                         , size_t       lengths[]
+                         );
+
+#endif
@@ -9,7 +9,9 @@
 #include "config.h"
 
 #include <stdio.h>
+#include <stdint.h>
 #include <string.h>
+#include <math.h>
 #include <assert.h>
 
 #include <libconfig.h>
@@ -31,6 +33,18 @@ static const char *hot_params[] = {
 	"model.packet_generator.temporal.bernoulli_prob",
 	"model.packet_generator.temporal.periodic_interval",
 	"model.packet_generator.temporal.fixed_delay_delay",
+	"model.packet_generator.temporal.mmpp_on_prob",
+	"model.packet_generator.temporal.mmpp_off_prob",
+	"model.packet_generator.temporal.mmpp_on_duration",
+	"model.packet_generator.temporal.mmpp_off_duration",
+	"model.packet_generator.temporal.trace_file",
+	"model.packet_generator.temporal.snn.placement_file",
+	"model.packet_generator.temporal.snn.projection_file",
+	"model.packet_generator.temporal.snn.ticks_per_second",
+	"model.router.multicast_table_file",
+	"model.packet_generator.temporal.cores.bernoulli_probs",
+	"model.packet_generator.temporal.cores.bernoulli_prob_scale",
+	"model.packet_generator.temporal.cores.spatial_dists",
 	"model.packet_generator.spatial.dist",
 	"model.packet_generator.spatial.allow_local",
 	
@@ -45,6 +59,16 @@ static const char *hot_params[] = {
 static const int num_hot_params = sizeof(hot_params)/sizeof(char *);
 
 
+bool
+spinn_sim_config_is_hot_param(const char *key)
+{
+	for (int i = 0; i < num_hot_params; i++)
+		if (strcmp(key, hot_params[i]) == 0)
+			return true;
+	return false;
+}
+
+
 /**
  * Set up the list of independent variables in the experiment.
  */
@@ -92,15 +116,7 @@ spinn_sim_config_init_independent_variables(spinn_sim_t *sim)
 		// Check that if we're doing hot group running the variable can be changed
 		// without a cold-start
 		if (!cold_group) {
-			bool can_hot_group = false;
-			for (int j = 0; j < num_hot_params; j++) {
-				if (strcmp(key, hot_params[j]) == 0) {
-					can_hot_group = true;
-					break;
-				}
-			}
-			
-			if (!can_hot_group) {
+			if (!spinn_sim_config_is_hot_param(key)) {
 				fprintf(stderr, "Changing '%s' with 'cold_group' = false is not possible.\n"
 				              , key
 				              );
@@ -375,3 +391,211 @@ spinn_sim_config_set_exp_group(spinn_sim_t *sim, int group_num)
 		}
 	}
 }
+
+
+/******************************************************************************
+ * Configuration hashing
+ ******************************************************************************/
+
+#define FNV_OFFSET_BASIS 0xcbf29ce484222325ull
+#define FNV_PRIME        0x100000001b3ull
+
+/**
+ * Add a block of bytes to a 64-bit FNV-1a hash.
+ */
+static uint64_t
+fnv1a(uint64_t hash, const void *data, size_t length)
+{
+	const unsigned char *bytes = (const unsigned char *)data;
+	for (size_t i = 0; i < length; i++) {
+		hash ^= bytes[i];
+		hash *= FNV_PRIME;
+	}
+	return hash;
+}
+
+
+/**
+ * Add the name, type and value of a setting (and all of its children) to a
+ * hash.
+ */
+static uint64_t
+hash_setting(uint64_t hash, config_setting_t *setting, config_setting_t **excluded)
+{
+	// Skip excluded settings (the list is NULL terminated)
+	for (config_setting_t **e = excluded; e != NULL && *e != NULL; e++)
+		if (setting == *e)
+			return hash;
+	
+	const char *name = config_setting_name(setting);
+	if (name != NULL)
+		hash = fnv1a(hash, name, strlen(name) + 1);
+	
+	int type = config_setting_type(setting);
+	hash = fnv1a(hash, &type, sizeof(type));
+	
+	switch (type) {
+		case CONFIG_TYPE_INT:
+			{
+				long long value = config_setting_get_int(setting);
+				return fnv1a(hash, &value, sizeof(value));
+			}
+		
+		case CONFIG_TYPE_INT64:
+			{
+				long long value = config_setting_get_int64(setting);
+				return fnv1a(hash, &value, sizeof(value));
+			}
+		
+		case CONFIG_TYPE_FLOAT:
+			{
+				double value = config_setting_get_float(setting);
+				return fnv1a(hash, &value, sizeof(value));
+			}
+		
+		case CONFIG_TYPE_BOOL:
+			{
+				int value = config_setting_get_bool(setting);
+				return fnv1a(hash, &value, sizeof(value));
+			}
+		
+		case CONFIG_TYPE_STRING:
+			{
+				const char *value = config_setting_get_string(setting);
+				return fnv1a(hash, value, strlen(value) + 1);
+			}
+		
+		default:
+			{
+				// Groups, arrays and lists
+				int length = config_setting_length(setting);
+				hash = fnv1a(hash, &length, sizeof(length));
+				for (int i = 0; i < length; i++)
+					hash = hash_setting(hash, config_setting_get_elem(setting, i), excluded);
+				return hash;
+			}
+	}
+}
+
+
+uint64_t
+spinn_sim_config_hash(spinn_sim_t *sim)
+{
+	const char *paths[] = {
+		"model",
+		"experiment.warmup_duration.cold",
+		"experiment.warmup_duration.adaptive",
+		"experiment.common_random_numbers",
+	};
+	
+	uint64_t hash = FNV_OFFSET_BASIS;
+	for (size_t i = 0; i < sizeof(paths)/sizeof(paths[0]); i++) {
+		config_setting_t *setting = config_lookup(&(sim->config), paths[i]);
+		if (setting != NULL)
+			hash = hash_setting(hash, setting, NULL);
+		else
+			hash = fnv1a(hash, paths[i], strlen(paths[i]) + 1);
+	}
+	
+	// The seed may not be in the config when chosen from the time
+	return fnv1a(hash, &(sim->seed), sizeof(sim->seed));
+}
+
+
+uint64_t
+spinn_sim_config_hash_results(spinn_sim_t *sim, const void *salt, size_t salt_length)
+{
+	// Settings which only select what is run (rather than what it produces)
+	const char *excluded_paths[] = {
+		"experiment.groups",
+		"experiment.parallel",
+		"experiment.result_cache",
+	};
+	const int num_excluded_paths = sizeof(excluded_paths)/sizeof(excluded_paths[0]);
+	
+	config_setting_t *excluded[num_excluded_paths + 1];
+	int num_excluded = 0;
+	for (int i = 0; i < num_excluded_paths; i++) {
+		config_setting_t *setting = config_lookup(&(sim->config), excluded_paths[i]);
+		if (setting != NULL)
+			excluded[num_excluded++] = setting;
+	}
+	excluded[num_excluded] = NULL;
+	
+	uint64_t hash = hash_setting( FNV_OFFSET_BASIS
+	                            , config_root_setting(&(sim->config))
+	                            , excluded
+	                            );
+	
+	// The seed may not be in the config when chosen from the time
+	hash = fnv1a(hash, &(sim->seed), sizeof(sim->seed));
+	
+	return fnv1a(hash, salt, salt_length);
+}
+
+
+/**
+ * Get the numeric value of a scalar setting (NaN if it isn't numeric).
+ */
+static double
+setting_get_number(config_setting_t *setting)
+{
+	switch (config_setting_type(setting)) {
+		case CONFIG_TYPE_INT:   return (double)config_setting_get_int(setting);
+		case CONFIG_TYPE_INT64: return (double)config_setting_get_int64(setting);
+		case CONFIG_TYPE_FLOAT: return config_setting_get_float(setting);
+		default:                return NAN;
+	}
+}
+
+
+/**
+ * Test whether two scalar settings have the same type and value.
+ */
+static bool
+setting_equal(config_setting_t *a, config_setting_t *b)
+{
+	if (config_setting_type(a) != config_setting_type(b))
+		return false;
+	
+	switch (config_setting_type(a)) {
+		case CONFIG_TYPE_STRING:
+			return strcmp(config_setting_get_string(a), config_setting_get_string(b)) == 0;
+		case CONFIG_TYPE_BOOL:
+			return config_setting_get_bool(a) == config_setting_get_bool(b);
+		default:
+			return setting_get_number(a) == setting_get_number(b);
+	}
+}
+
+
+bool
+spinn_sim_config_exp_group_dominates( spinn_sim_t *sim
+                                    , int          group_num
+                                    , int          other_group_num
+                                    , const char  *load_key
+                                    )
+{
+	config_setting_t *group_list = config_lookup(&(sim->config), "experiment.groups");
+	config_setting_t *group       = config_setting_get_elem(group_list, group_num);
+	config_setting_t *other_group = config_setting_get_elem(group_list, other_group_num);
+	assert(group != NULL && other_group != NULL);
+	
+	config_setting_t *load_setting = config_lookup(&(sim->config), load_key);
+	
+	bool found_load = false;
+	for (int i = 0; i < sim->num_ivars; i++) {
+		config_setting_t *value       = config_setting_get_elem(group, i);
+		config_setting_t *other_value = config_setting_get_elem(other_group, i);
+		
+		if (sim->ivar_settings[i] == load_setting) {
+			found_load = true;
+			if (!(setting_get_number(value) >= setting_get_number(other_value)))
+				return false;
+		} else if (!setting_equal(value, other_value)) {
+			return false;
+		}
+	}
+	
+	return found_load;
+}
@@ -8,6 +8,9 @@
 #ifndef SPINN_SIM_CONFIG_H
 #define SPINN_SIM_CONFIG_H
 
+#include <stdint.h>
+#include <stdbool.h>
+
 #include <libconfig.h>
 
 #include "spinn_sim.h"
@@ -81,6 +84,13 @@ DEFINE_CONFIG_WRAPPER( spinn_sim_config_lookup_string
 #undef DEFINE_CONFIG_WRAPPER
 
 
+/**
+ * Test whether the given setting may be changed while the model is hot (i.e. by
+ * spinn_sim_model_update).
+ */
+bool spinn_sim_config_is_hot_param(const char *key);
+
+
 /**
  * Get the number of experimental groups.
  */
@@ -91,4 +101,34 @@ int spinn_sim_config_get_num_exp_groups(spinn_sim_t *sim);
  */
 void spinn_sim_config_set_exp_group(spinn_sim_t *sim, int group_num);
 
+/**
+ * Test whether a group is a higher (or equal) load variant of another: the
+ * independent variable load_key is at least as large in group_num as in
+ * other_group_num and all other independent variables are equal. Returns false
+ * if load_key is not an independent variable.
+ */
+bool spinn_sim_config_exp_group_dominates( spinn_sim_t *sim
+                                         , int          group_num
+                                         , int          other_group_num
+                                         , const char  *load_key
+                                         );
+
+/**
+ * Produce a hash of every setting which affects the state of the model at the
+ * end of a cold warmup: the whole model section (with the values of the current
+ * group) along with the seed used (even if chosen from the time) and cold
+ * warmup duration. Note that only the names of any files referenced are hashed,
+ * not their contents.
+ */
+uint64_t spinn_sim_config_hash(spinn_sim_t *sim);
+
+
+/**
+ * Produce a hash of every setting which may affect the results of the current
+ * group: the whole configuration (with the values of the current group) and the
+ * seed, but not the values of other groups or the settings which only select
+ * which groups are run. The given salt (e.g. the sample number) is also hashed.
+ */
+uint64_t spinn_sim_config_hash_results(spinn_sim_t *sim, const void *salt, size_t salt_length);
+
 #endif
@@ -0,0 +1,444 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * spinn_sim_cost.c -- A model of the run time of the simulator used to plan
+ * experiments and to schedule parallel runs.
+ *
+ * The cost model file is a plain text file with one timing per line:
+ *
+ *   <options> <num_nodes> <load> <ticks> <seconds>
+ *
+ * New timings are appended by every run so the model improves as it is used.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+
+#include <unistd.h>
+
+#include "scheduler.h"
+
+#include "spinn_sim.h"
+#include "spinn_sim_config.h"
+#include "spinn_sim_model.h"
+#include "spinn_sim_cost.h"
+
+
+/**
+ * The cost (ns per node-tick) assumed when no timings have been recorded.
+ */
+#define SPINN_SIM_COST_DEFAULT_NS 100.0
+
+/**
+ * The number of timings with matching options required before timings with
+ * other options are ignored.
+ */
+#define SPINN_SIM_COST_MIN_TIMINGS 3
+
+/**
+ * The number of coefficients in the fitted model.
+ */
+#define SPINN_SIM_COST_NUM_COEFFS 3
+
+
+/******************************************************************************
+ * Internal: Utilities
+ ******************************************************************************/
+
+/**
+ * Describe the simulator options of the current configuration which most
+ * affect its speed.
+ */
+static void
+spinn_sim_cost_get_options(spinn_sim_t *sim, char options[SPINN_SIM_COST_MAX_OPTIONS])
+{
+	snprintf( options, SPINN_SIM_COST_MAX_OPTIONS, "%s,emg=%d,log=%d,crn=%d"
+	        , spinn_sim_config_lookup_string(sim, "model.network.topology")
+	        , spinn_sim_config_lookup_bool(sim, "model.router.use_emergency_routing")
+	        , spinn_sim_config_lookup_bool(sim, "measurements.packet_details.delivered_packets")
+	          || spinn_sim_config_lookup_bool(sim, "measurements.packet_details.dropped_packets")
+	        , spinn_sim_config_lookup_bool_default(sim, "experiment.common_random_numbers.enabled", false)
+	        );
+}
+
+
+/**
+ * Get the load of the current configuration: the value of the parameter named
+ * by experiment.cost_model.load_parameter (or 0 if not numeric).
+ */
+static double
+spinn_sim_cost_get_load(spinn_sim_t *sim)
+{
+	const char *parameter = spinn_sim_config_lookup_string_default(sim, "experiment.cost_model.load_parameter", "");
+	config_setting_t *setting = config_lookup(&(sim->config), parameter);
+	if (setting == NULL)
+		return 0.0;
+	
+	switch (config_setting_type(setting)) {
+		case CONFIG_TYPE_INT:   return (double)config_setting_get_int(setting);
+		case CONFIG_TYPE_INT64: return (double)config_setting_get_int64(setting);
+		case CONFIG_TYPE_FLOAT: return config_setting_get_float(setting);
+		default:                return 0.0;
+	}
+}
+
+
+/**
+ * Get the number of nodes in the system of the current configuration.
+ */
+static double
+spinn_sim_cost_get_num_nodes(spinn_sim_t *sim)
+{
+	bool use_wrap_around_links;
+	spinn_coord_t size = spinn_sim_model_get_system_size(sim, &use_wrap_around_links);
+	return (double)size.x * (double)size.y;
+}
+
+
+/**
+ * Solve the n-by-n system a.x = b in place (leaving x in b) by Gaussian
+ * elimination with partial pivoting. Returns false if a is singular.
+ */
+static bool
+solve(double a[SPINN_SIM_COST_NUM_COEFFS][SPINN_SIM_COST_NUM_COEFFS], double b[SPINN_SIM_COST_NUM_COEFFS])
+{
+	const int n = SPINN_SIM_COST_NUM_COEFFS;
+	
+	for (int col = 0; col < n; col++) {
+		int pivot = col;
+		for (int row = col + 1; row < n; row++)
+			if (fabs(a[row][col]) > fabs(a[pivot][col]))
+				pivot = row;
+		if (a[pivot][col] == 0.0)
+			return false;
+		
+		for (int i = 0; i < n; i++) {
+			double tmp = a[col][i]; a[col][i] = a[pivot][i]; a[pivot][i] = tmp;
+		}
+		double tmp = b[col]; b[col] = b[pivot]; b[pivot] = tmp;
+		
+		for (int row = col + 1; row < n; row++) {
+			double f = a[row][col] / a[col][col];
+			for (int i = col; i < n; i++)
+				a[row][i] -= f * a[col][i];
+			b[row] -= f * b[col];
+		}
+	}
+	
+	for (int row = n - 1; row >= 0; row--) {
+		for (int i = row + 1; i < n; i++)
+			b[row] -= a[row][i] * b[i];
+		b[row] /= a[row][row];
+	}
+	
+	return true;
+}
+
+
+/**
+ * Predict the cost (ns per node-tick) of a system with the given options, size
+ * and load by a least-squares fit of the recorded timings weighted by their
+ * number of node-ticks.
+ */
+static double
+spinn_sim_cost_ns_per_node_tick( spinn_sim_cost_t *cost
+                               , const char       *options
+                               , double            num_nodes
+                               , double            load
+                               )
+{
+	// Only use timings with the same options when there are enough of them
+	int num_matching = 0;
+	for (int i = 0; i < cost->num_timings; i++)
+		if (strcmp(cost->timings[i].options, options) == 0)
+			num_matching++;
+	bool matching_only = num_matching >= SPINN_SIM_COST_MIN_TIMINGS;
+	
+	double xtwx[SPINN_SIM_COST_NUM_COEFFS][SPINN_SIM_COST_NUM_COEFFS] = {{0.0}};
+	double xtwy[SPINN_SIM_COST_NUM_COEFFS] = {0.0};
+	double sum_w  = 0.0;
+	double sum_wy = 0.0;
+	for (int i = 0; i < cost->num_timings; i++) {
+		spinn_sim_cost_timing_t *t = &(cost->timings[i]);
+		if (matching_only && strcmp(t->options, options) != 0)
+			continue;
+		if (t->ticks <= 0.0 || t->num_nodes <= 0.0)
+			continue;
+		
+		double x[SPINN_SIM_COST_NUM_COEFFS] = { 1.0, t->load, log2(t->num_nodes) };
+		double y = (t->seconds * 1e9) / (t->ticks * t->num_nodes);
+		double w = t->ticks * t->num_nodes;
+		for (int j = 0; j < SPINN_SIM_COST_NUM_COEFFS; j++) {
+			for (int k = 0; k < SPINN_SIM_COST_NUM_COEFFS; k++)
+				xtwx[j][k] += w * x[j] * x[k];
+			xtwy[j] += w * x[j] * y;
+		}
+		sum_w  += w;
+		sum_wy += w * y;
+	}
+	
+	if (sum_w <= 0.0)
+		return SPINN_SIM_COST_DEFAULT_NS;
+	
+	// Regularise slightly so that features which do not vary between the
+	// timings (e.g. when all were for one system size) still give a solution
+	for (int j = 0; j < SPINN_SIM_COST_NUM_COEFFS; j++)
+		xtwx[j][j] = (xtwx[j][j] > 0.0) ? xtwx[j][j] * (1.0 + 1e-6) : 1.0;
+	
+	double mean = sum_wy / sum_w;
+	if (!solve(xtwx, xtwy))
+		return mean;
+	
+	double x[SPINN_SIM_COST_NUM_COEFFS] = { 1.0, load, log2(num_nodes) };
+	double ns = 0.0;
+	for (int j = 0; j < SPINN_SIM_COST_NUM_COEFFS; j++)
+		ns += xtwy[j] * x[j];
+	
+	// Extrapolation far from the timings may be nonsense
+	return (isfinite(ns) && ns > 0.0) ? ns : mean;
+}
+
+
+/**
+ * Predict the number of ticks simulated by a group (or a single cold sample of
+ * it) with the current configuration.
+ */
+static double
+spinn_sim_cost_predict_ticks(spinn_sim_t *sim, int sample, bool model_hot)
+{
+	double cold = spinn_sim_config_lookup_int(sim, "experiment.warmup_duration.cold");
+	double hot  = spinn_sim_config_lookup_int(sim, "experiment.warmup_duration.hot");
+	double first_warmup = model_hot ? hot : cold;
+	
+	double sample_duration = spinn_sim_config_lookup_int(sim, "experiment.sample_duration");
+	double num_samples     = spinn_sim_config_lookup_int(sim, "experiment.num_samples");
+	bool   cold_sample     = spinn_sim_config_lookup_bool(sim, "experiment.cold_sample");
+	
+	if (spinn_sim_config_lookup_bool(sim, "experiment.saturation_search.enabled")) {
+		double max_probes = spinn_sim_config_lookup_int(sim, "experiment.saturation_search.max_probes");
+		return max_probes * (sample_duration + (cold_sample ? cold : hot)) - hot + first_warmup;
+	}
+	
+	if (spinn_sim_config_lookup_bool(sim, "experiment.staircase.enabled")) {
+		config_setting_t *levels = config_lookup(&(sim->config), "experiment.staircase.levels");
+		double num_levels = (levels != NULL) ? config_setting_length(levels) : 0;
+		double settle = spinn_sim_config_lookup_int(sim, "experiment.staircase.settle_duration");
+		return first_warmup + num_levels * sample_duration + (num_levels - 1.0) * settle;
+	}
+	
+	if (sample >= 0)
+		return cold + sample_duration;
+	else if (cold_sample)
+		return num_samples * (cold + sample_duration);
+	else
+		return first_warmup + num_samples * sample_duration;
+}
+
+
+/**
+ * Format a duration in seconds as h:mm:ss.
+ */
+static void
+format_duration(char *str, size_t length, double seconds)
+{
+	long s = (long)(seconds + 0.5);
+	snprintf(str, length, "%ld:%02ld:%02ld", s / 3600, (s / 60) % 60, s % 60);
+}
+
+
+/**
+ * Compare doubles into descending order.
+ */
+static int
+compare_descending(const void *a, const void *b)
+{
+	double da = *(const double *)a;
+	double db = *(const double *)b;
+	return (da < db) - (da > db);
+}
+
+
+/******************************************************************************
+ * Public functions
+ ******************************************************************************/
+
+void
+spinn_sim_cost_record(spinn_sim_t *sim, ticks_t ticks, double seconds)
+{
+	const char *filename = spinn_sim_config_lookup_string_default(sim, "experiment.cost_model.file", "");
+	if (filename[0] == '\0' || ticks == 0)
+		return;
+	
+	char options[SPINN_SIM_COST_MAX_OPTIONS];
+	spinn_sim_cost_get_options(sim, options);
+	
+	// Each timing is written with a single write so timings appended by
+	// several workers at once do not interleave
+	char line[SPINN_SIM_COST_MAX_OPTIONS + 128];
+	snprintf( line, sizeof(line), "%s %d %g %u %f\n"
+	        , options
+	        , sim->system_size.x * sim->system_size.y
+	        , spinn_sim_cost_get_load(sim)
+	        , ticks
+	        , seconds
+	        );
+	
+	FILE *f = fopen(filename, "a");
+	if (f == NULL || fputs(line, f) == EOF || fclose(f) != 0)
+		fprintf(stderr, "Warning: Couldn't record timing in cost model %s.\n", filename);
+}
+
+
+void
+spinn_sim_cost_init(spinn_sim_cost_t *cost, spinn_sim_t *sim)
+{
+	cost->timings     = NULL;
+	cost->num_timings = 0;
+	
+	const char *filename = spinn_sim_config_lookup_string_default(sim, "experiment.cost_model.file", "");
+	if (filename[0] == '\0')
+		return;
+	
+	FILE *f = fopen(filename, "r");
+	if (f == NULL)
+		return;
+	
+	int size = 0;
+	char line[SPINN_SIM_COST_MAX_OPTIONS + 128];
+	while (fgets(line, sizeof(line), f) != NULL) {
+		if (cost->num_timings == size) {
+			size = (size == 0) ? 64 : size * 2;
+			cost->timings = realloc(cost->timings, size * sizeof(spinn_sim_cost_timing_t));
+			assert(cost->timings != NULL);
+		}
+		
+		// Skip malformed lines (e.g. one being written)
+		spinn_sim_cost_timing_t *t = &(cost->timings[cost->num_timings]);
+		char format[32];
+		snprintf(format, sizeof(format), "%%%ds %%lf %%lf %%lf %%lf", SPINN_SIM_COST_MAX_OPTIONS - 1);
+		if (sscanf(line, format, t->options, &(t->num_nodes), &(t->load), &(t->ticks), &(t->seconds)) == 5)
+			cost->num_timings++;
+	}
+	
+	fclose(f);
+}
+
+
+double
+spinn_sim_cost_predict( spinn_sim_cost_t *cost
+                      , spinn_sim_t      *sim
+                      , int               group
+                      , int               sample
+                      , bool              model_hot
+                      )
+{
+	spinn_sim_config_set_exp_group(sim, group);
+	
+	char options[SPINN_SIM_COST_MAX_OPTIONS];
+	spinn_sim_cost_get_options(sim, options);
+	double num_nodes = spinn_sim_cost_get_num_nodes(sim);
+	double ns = spinn_sim_cost_ns_per_node_tick(cost, options, num_nodes, spinn_sim_cost_get_load(sim));
+	
+	return spinn_sim_cost_predict_ticks(sim, sample, model_hot) * num_nodes * ns * 1e-9;
+}
+
+
+void
+spinn_sim_cost_plan(spinn_sim_t *sim, int num_workers)
+{
+	if (num_workers <= 0)
+		num_workers = sysconf(_SC_NPROCESSORS_ONLN);
+	if (num_workers <= 0)
+		num_workers = 1;
+	
+	spinn_sim_cost_t cost;
+	spinn_sim_cost_init(&cost, sim);
+	
+	int num_groups     = spinn_sim_config_get_num_exp_groups(sim);
+	int parallel_group = spinn_sim_config_lookup_int(sim, "experiment.parallel.group") - 1;
+	bool cold_group    = spinn_sim_config_lookup_bool(sim, "experiment.cold_group");
+	
+	printf("Cost model: %d timing%s recorded.\n"
+	      , cost.num_timings, (cost.num_timings == 1) ? "" : "s"
+	      );
+	printf("group\tpredicted_ticks\tpredicted_seconds\n");
+	
+	// The cost of every job of a parallel run (one per group or cold sample)
+	int     jobs_size = 0;
+	int     num_jobs  = 0;
+	double *jobs      = NULL;
+	
+	double total = 0.0;
+	bool model_hot = false;
+	for (int group = 0; group < num_groups; group++) {
+		if (parallel_group >= 0 && group != parallel_group)
+			continue;
+		
+		double seconds = spinn_sim_cost_predict(&cost, sim, group, -1, model_hot && !cold_group);
+		double ticks   = spinn_sim_cost_predict_ticks(sim, -1, model_hot && !cold_group);
+		model_hot = true;
+		total += seconds;
+		
+		printf("%d\t%.0f\t%.1f\n", group + 1, ticks, seconds);
+		
+		// Split groups into samples as in a parallel run
+		bool cold_sample = spinn_sim_config_lookup_bool(sim, "experiment.cold_sample")
+		                   && !spinn_sim_config_lookup_bool(sim, "experiment.saturation_search.enabled")
+		                   && !spinn_sim_config_lookup_bool(sim, "experiment.staircase.enabled");
+		int num_samples = cold_sample ? spinn_sim_config_lookup_int(sim, "experiment.num_samples") : 1;
+		for (int sample = 0; sample < num_samples; sample++) {
+			if (num_jobs == jobs_size) {
+				jobs_size = (jobs_size == 0) ? 64 : jobs_size * 2;
+				jobs = realloc(jobs, jobs_size * sizeof(double));
+				assert(jobs != NULL);
+			}
+			jobs[num_jobs++] = cold_sample ? spinn_sim_cost_predict(&cost, sim, group, sample, false)
+			                               : seconds;
+		}
+	}
+	
+	char duration[32];
+	format_duration(duration, sizeof(duration), total);
+	printf("Total: %s sequentially", duration);
+	
+	// Predict the makespan of a parallel run which starts the longest jobs first
+	if (cold_group && num_jobs > 0) {
+		qsort(jobs, num_jobs, sizeof(double), compare_descending);
+		
+		double *workers = calloc(num_workers, sizeof(double));
+		assert(workers != NULL);
+		double makespan = 0.0;
+		for (int i = 0; i < num_jobs; i++) {
+			int least = 0;
+			for (int w = 1; w < num_workers; w++)
+				if (workers[w] < workers[least])
+					least = w;
+			workers[least] += jobs[i];
+			if (workers[least] > makespan)
+				makespan = workers[least];
+		}
+		free(workers);
+		
+		format_duration(duration, sizeof(duration), makespan);
+		printf(", %s using %d worker%s", duration, num_workers, (num_workers == 1) ? "" : "s");
+	}
+	printf(".\n");
+	
+	free(jobs);
+	spinn_sim_cost_destroy(&cost);
+}
+
+
+void
+spinn_sim_cost_destroy(spinn_sim_cost_t *cost)
+{
+	free(cost->timings);
+	cost->timings     = NULL;
+	cost->num_timings = 0;
+}
@@ -0,0 +1,104 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * spinn_sim_cost.h -- A model of the run time of the simulator used to plan
+ * experiments and to schedule parallel runs.
+ *
+ * When experiment.cost_model.file is set, the ticks simulated and wall-clock
+ * time taken by every warmup and sample are appended to that file along with
+ * the size of the system, the load (the value of
+ * experiment.cost_model.load_parameter) and a description of the simulator
+ * options which most affect its speed. The cost of simulating one node for one
+ * tick is then predicted by a weighted least-squares fit of the recorded
+ * timings with matching options against the load and the (log) size of the
+ * system.
+ */
+
+#ifndef SPINN_SIM_COST_H
+#define SPINN_SIM_COST_H
+
+#include <stdbool.h>
+
+#include "scheduler.h"
+
+#include "spinn_sim.h"
+
+/**
+ * The maximum length of the description of the simulator options.
+ */
+#define SPINN_SIM_COST_MAX_OPTIONS 64
+
+/**
+ * A timing of a warmup or sample.
+ */
+typedef struct spinn_sim_cost_timing {
+	// The simulator options in use
+	char options[SPINN_SIM_COST_MAX_OPTIONS];
+	
+	// The number of nodes in the system (including disabled ones)
+	double num_nodes;
+	
+	// The load
+	double load;
+	
+	// The number of ticks simulated and the time taken (seconds)
+	double ticks;
+	double seconds;
+} spinn_sim_cost_timing_t;
+
+
+/**
+ * A model of the run time of the simulator.
+ */
+typedef struct spinn_sim_cost {
+	// The recorded timings
+	spinn_sim_cost_timing_t *timings;
+	int                      num_timings;
+} spinn_sim_cost_t;
+
+
+/**
+ * Record the time taken by a warmup or sample of the current group in the cost
+ * model file (if enabled).
+ */
+void spinn_sim_cost_record(spinn_sim_t *sim, ticks_t ticks, double seconds);
+
+
+/**
+ * Load the timings recorded in the cost model file. If no file is given (or it
+ * does not exist), the model holds no timings and predictions are made using a
+ * default cost.
+ */
+void spinn_sim_cost_init(spinn_sim_cost_t *cost, spinn_sim_t *sim);
+
+
+/**
+ * Predict the wall-clock time (in seconds) taken to run the given group or, if
+ * sample is not -1, a single (cold) sample of it. If model_hot, the first
+ * warmup of the group is assumed to be a hot one. Adaptive warmups and samples
+ * are assumed to run for their maximum durations.
+ *
+ * Note: selects the configuration of the given group.
+ */
+double spinn_sim_cost_predict( spinn_sim_cost_t *cost
+                             , spinn_sim_t      *sim
+                             , int               group
+                             , int               sample
+                             , bool              model_hot
+                             );
+
+
+/**
+ * Print the predicted run time of every group of the experiment and of the
+ * whole experiment when run sequentially and with the given number of workers
+ * (scheduled longest job first) on stdout.
+ */
+void spinn_sim_cost_plan(spinn_sim_t *sim, int num_workers);
+
+
+/**
+ * Free the resources used by a cost model.
+ */
+void spinn_sim_cost_destroy(spinn_sim_cost_t *cost);
+
+#endif
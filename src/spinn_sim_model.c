@@ -10,6 +10,7 @@
 #include <string.h>
 #include <assert.h>
 #include <time.h>
+#include <stdint.h>
 
 #include "scheduler.h"
 #include "buffer.h"
@@ -20,6 +21,9 @@
 #include "spinn_topology.h"
 #include "spinn_packet.h"
 #include "spinn_router.h"
+#include "spinn_trace.h"
+#include "spinn_snn.h"
+#include "spinn_mc_table.h"
 
 #include "spinn_sim.h"
 #include "spinn_sim_model.h"
@@ -225,31 +229,128 @@ load_packet_gen_p2p_dist(spinn_sim_t *sim)
 
 
 static void
-configure_node_packet_gen(spinn_node_t *node)
+load_packet_gen_trace(spinn_sim_t *sim)
 {
-	// Set temporal distribution
+	// Release any previously loaded trace (the file may have changed)
+	if (sim->packet_gen_trace_loaded) {
+		spinn_trace_close(&(sim->packet_gen_trace));
+		sim->packet_gen_trace_loaded = false;
+	}
+	
+	// Don't do anything if we're not using this distribution.
 	const char *gen_temporal_dist
-		= spinn_sim_config_lookup_string(node->sim, "model.packet_generator.temporal.dist");
-	if (strcmp(gen_temporal_dist, "bernoulli") == 0) {
-		double prob
-			= spinn_sim_config_lookup_float(node->sim, "model.packet_generator.temporal.bernoulli_prob");
-		spinn_packet_gen_set_temporal_dist_bernoulli(&(node->packet_gen), prob);
-	} else if (strcmp(gen_temporal_dist, "periodic") == 0) {
-		int interval
-			= spinn_sim_config_lookup_int(node->sim, "model.packet_generator.temporal.periodic_interval");
-		spinn_packet_gen_set_temporal_dist_periodic(&(node->packet_gen), interval);
-	} else if (strcmp(gen_temporal_dist, "fixed_delay") == 0) {
-		int delay
-			= spinn_sim_config_lookup_int(node->sim, "model.packet_generator.temporal.fixed_delay_delay");
-		spinn_packet_gen_set_temporal_dist_fixed_delay(&(node->packet_gen), delay);
-	} else {
-		fprintf(stderr, "Error: model.packet_generator.temporal.dist not recognised!\n");
+		= spinn_sim_config_lookup_string(sim, "model.packet_generator.temporal.dist");
+	if (strcmp(gen_temporal_dist, "trace") != 0)
+		return;
+	
+	const char *trace_file
+		= spinn_sim_config_lookup_string(sim, "model.packet_generator.temporal.trace_file");
+	if (!spinn_trace_open(&(sim->packet_gen_trace), trace_file))
+		exit(-1);
+	sim->packet_gen_trace_loaded = true;
+	
+	// The trace must have been recorded from a system of the same size
+	spinn_coord_t trace_size = spinn_trace_get_system_size(&(sim->packet_gen_trace));
+	if (trace_size.x != sim->system_size.x || trace_size.y != sim->system_size.y) {
+		fprintf(stderr, "Trace '%s' is for a %dx%d system but the system is %dx%d.\n"
+		              , trace_file
+		              , trace_size.x, trace_size.y
+		              , sim->system_size.x, sim->system_size.y
+		              );
 		exit(-1);
 	}
+}
+
+
+static void
+load_packet_gen_snn(spinn_sim_t *sim)
+{
+	// Release any previously loaded workload (the files may have changed)
+	if (sim->packet_gen_snn_loaded) {
+		spinn_snn_destroy(&(sim->packet_gen_snn));
+		sim->packet_gen_snn_loaded = false;
+	}
 	
-	// Set spatial distribution
-	const char *gen_spatial_dist
-		= spinn_sim_config_lookup_string(node->sim, "model.packet_generator.spatial.dist");
+	// Don't do anything if we're not using this distribution.
+	const char *gen_temporal_dist
+		= spinn_sim_config_lookup_string(sim, "model.packet_generator.temporal.dist");
+	if (strcmp(gen_temporal_dist, "snn") != 0)
+		return;
+	
+	const char *placement_file
+		= spinn_sim_config_lookup_string(sim, "model.packet_generator.temporal.snn.placement_file");
+	const char *projection_file
+		= spinn_sim_config_lookup_string(sim, "model.packet_generator.temporal.snn.projection_file");
+	double ticks_per_second
+		= spinn_sim_config_lookup_float(sim, "model.packet_generator.temporal.snn.ticks_per_second");
+	if (!spinn_snn_load( &(sim->packet_gen_snn)
+	                   , placement_file
+	                   , projection_file
+	                   , sim->system_size
+	                   , ticks_per_second
+	                   ))
+		exit(-1);
+	sim->packet_gen_snn_loaded = true;
+}
+
+
+static void
+free_mc_tables(spinn_sim_t *sim)
+{
+	if (sim->mc_tables == NULL)
+		return;
+	
+	for (int i = 0; i < sim->system_size.x * sim->system_size.y; i++)
+		spinn_mc_table_destroy(&(sim->mc_tables[i]));
+	free(sim->mc_tables);
+	sim->mc_tables = NULL;
+}
+
+
+/**
+ * Load the multicast routing tables (if a file is given) and give each router
+ * its table. Must be called after the nodes have been initialised.
+ */
+static void
+load_mc_tables(spinn_sim_t *sim)
+{
+	// Release any previously loaded tables (the file may have changed)
+	free_mc_tables(sim);
+	
+	const char *table_file
+		= spinn_sim_config_lookup_string(sim, "model.router.multicast_table_file");
+	if (strcmp(table_file, "") != 0) {
+		sim->mc_tables = calloc( sim->system_size.x*sim->system_size.y
+		                       , sizeof(spinn_mc_table_t)
+		                       );
+		assert(sim->mc_tables != NULL);
+		for (int i = 0; i < sim->system_size.x * sim->system_size.y; i++)
+			spinn_mc_table_init(&(sim->mc_tables[i]));
+		
+		if (!spinn_mc_table_load(sim->mc_tables, sim->system_size, table_file))
+			exit(-1);
+	}
+	
+	for (int i = 0; i < sim->system_size.x * sim->system_size.y; i++)
+		if (sim->nodes[i].enabled)
+			spinn_router_set_mc_table( &(sim->nodes[i].router)
+			                         , (sim->mc_tables != NULL) ? &(sim->mc_tables[i]) : NULL
+			                         , &(sim->pool)
+			                         );
+}
+
+
+/**
+ * Set the node's packet generator's spatial distribution to the named
+ * distribution. The config_path is the setting the name came from and is used
+ * in error messages.
+ */
+static void
+configure_node_packet_gen_spatial_dist( spinn_node_t *node
+                                      , const char   *gen_spatial_dist
+                                      , const char   *config_path
+                                      )
+{
 	if (strcmp(gen_spatial_dist, "uniform") == 0) {
 		spinn_packet_gen_set_spatial_dist_uniform(&(node->packet_gen));
 	} else if (strcmp(gen_spatial_dist, "cyclic") == 0) {
@@ -285,10 +386,138 @@ configure_node_packet_gen(spinn_node_t *node)
 			exit(-1);
 		}
 		spinn_packet_gen_set_spatial_dist_tornado(&(node->packet_gen));
+	} else if (strcmp(gen_spatial_dist, "multicast") == 0) {
+		// Keys identify the source chip
+		uint32_t key = ((uint32_t)node->position.x << 24) | ((uint32_t)node->position.y << 16);
+		spinn_packet_gen_set_spatial_dist_multicast(&(node->packet_gen), key);
+	} else {
+		fprintf(stderr, "Error: %s not recognised!\n", config_path);
+		exit(-1);
+	}
+}
+
+
+/**
+ * Configure the cores of a node's packet generator when using the cores
+ * temporal distribution. Per-core settings are given as lists with either one
+ * entry per core or a single entry which applies to all cores.
+ */
+static void
+configure_node_packet_gen_cores(spinn_node_t *node)
+{
+	int num_cores
+		= spinn_sim_config_lookup_int(node->sim, "model.packet_generator.temporal.cores.num_cores");
+	int queue_length
+		= spinn_sim_config_lookup_int(node->sim, "model.packet_generator.temporal.cores.queue_length");
+	double prob_scale
+		= spinn_sim_config_lookup_float(node->sim, "model.packet_generator.temporal.cores.bernoulli_prob_scale");
+	if (num_cores <= 0 || queue_length <= 0) {
+		fprintf(stderr, "Error: model.packet_generator.temporal.cores.num_cores and queue_length must be positive!\n");
+		exit(-1);
+	}
+	
+	config_setting_t *probs = config_lookup(&(node->sim->config), "model.packet_generator.temporal.cores.bernoulli_probs");
+	if (probs == NULL
+	    || (config_setting_type(probs) != CONFIG_TYPE_LIST && config_setting_type(probs) != CONFIG_TYPE_ARRAY)
+	    || (config_setting_length(probs) != 1 && config_setting_length(probs) != num_cores)
+	   ) {
+		fprintf(stderr, "Expected a list of either 1 or num_cores probabilities in 'model.packet_generator.temporal.cores.bernoulli_probs'.\n");
+		exit(-1);
+	}
+	
+	config_setting_t *dists = config_lookup(&(node->sim->config), "model.packet_generator.temporal.cores.spatial_dists");
+	if (dists == NULL
+	    || (config_setting_type(dists) != CONFIG_TYPE_LIST && config_setting_type(dists) != CONFIG_TYPE_ARRAY)
+	    || (config_setting_length(dists) != 1 && config_setting_length(dists) != num_cores)
+	   ) {
+		fprintf(stderr, "Expected a list of either 1 or num_cores distribution names in 'model.packet_generator.temporal.cores.spatial_dists'.\n");
+		exit(-1);
+	}
+	
+	spinn_packet_gen_set_temporal_dist_cores(&(node->packet_gen), num_cores, queue_length);
+	
+	for (int i = 0; i < num_cores; i++) {
+		config_setting_t *prob = config_setting_get_elem(probs, config_setting_length(probs) == 1 ? 0 : i);
+		if (config_setting_type(prob) != CONFIG_TYPE_FLOAT && config_setting_type(prob) != CONFIG_TYPE_INT) {
+			fprintf(stderr, "Expected item %d of 'model.packet_generator.temporal.cores.bernoulli_probs' to be a number.\n"
+			              , i);
+			exit(-1);
+		}
+		double p = (config_setting_type(prob) == CONFIG_TYPE_FLOAT) ? config_setting_get_float(prob)
+		                                                          : (double)config_setting_get_int(prob);
+		spinn_packet_gen_set_core_bernoulli_prob(&(node->packet_gen), i, p * prob_scale);
+		
+		// Set up the generator with the core's spatial distribution and then copy
+		// it into the core.
+		config_setting_t *dist = config_setting_get_elem(dists, config_setting_length(dists) == 1 ? 0 : i);
+		if (config_setting_type(dist) != CONFIG_TYPE_STRING) {
+			fprintf(stderr, "Expected item %d of 'model.packet_generator.temporal.cores.spatial_dists' to be a string.\n"
+			              , i);
+			exit(-1);
+		}
+		configure_node_packet_gen_spatial_dist( node
+		                                      , config_setting_get_string(dist)
+		                                      , "model.packet_generator.temporal.cores.spatial_dists"
+		                                      );
+		spinn_packet_gen_set_core_spatial_dist(&(node->packet_gen), i);
+	}
+}
+
+
+static void
+configure_node_packet_gen(spinn_node_t *node)
+{
+	// Set temporal distribution
+	const char *gen_temporal_dist
+		= spinn_sim_config_lookup_string(node->sim, "model.packet_generator.temporal.dist");
+	if (strcmp(gen_temporal_dist, "bernoulli") == 0) {
+		double prob
+			= spinn_sim_config_lookup_float(node->sim, "model.packet_generator.temporal.bernoulli_prob");
+		spinn_packet_gen_set_temporal_dist_bernoulli(&(node->packet_gen), prob);
+	} else if (strcmp(gen_temporal_dist, "periodic") == 0) {
+		int interval
+			= spinn_sim_config_lookup_int(node->sim, "model.packet_generator.temporal.periodic_interval");
+		spinn_packet_gen_set_temporal_dist_periodic(&(node->packet_gen), interval);
+	} else if (strcmp(gen_temporal_dist, "fixed_delay") == 0) {
+		int delay
+			= spinn_sim_config_lookup_int(node->sim, "model.packet_generator.temporal.fixed_delay_delay");
+		spinn_packet_gen_set_temporal_dist_fixed_delay(&(node->packet_gen), delay);
+	} else if (strcmp(gen_temporal_dist, "mmpp") == 0) {
+		double on_prob
+			= spinn_sim_config_lookup_float(node->sim, "model.packet_generator.temporal.mmpp_on_prob");
+		double off_prob
+			= spinn_sim_config_lookup_float(node->sim, "model.packet_generator.temporal.mmpp_off_prob");
+		double on_duration
+			= spinn_sim_config_lookup_float(node->sim, "model.packet_generator.temporal.mmpp_on_duration");
+		double off_duration
+			= spinn_sim_config_lookup_float(node->sim, "model.packet_generator.temporal.mmpp_off_duration");
+		spinn_packet_gen_set_temporal_dist_mmpp( &(node->packet_gen)
+		                                       , on_prob, off_prob
+		                                       , on_duration, off_duration
+		                                       );
+	} else if (strcmp(gen_temporal_dist, "trace") == 0) {
+		size_t num_records;
+		const spinn_trace_record_t *records
+			= spinn_trace_get_records(&(node->sim->packet_gen_trace), node->position, &num_records);
+		spinn_packet_gen_set_temporal_dist_trace(&(node->packet_gen), records, num_records);
+	} else if (strcmp(gen_temporal_dist, "snn") == 0) {
+		const spinn_snn_chip_t *chip
+			= spinn_snn_get_chip(&(node->sim->packet_gen_snn), node->position);
+		spinn_packet_gen_set_temporal_dist_snn(&(node->packet_gen), chip);
+	} else if (strcmp(gen_temporal_dist, "cores") == 0) {
+		configure_node_packet_gen_cores(node);
 	} else {
-		fprintf(stderr, "Error: model.packet_generator.spatial.dist not recognised!\n");
+		fprintf(stderr, "Error: model.packet_generator.temporal.dist not recognised!\n");
 		exit(-1);
 	}
+	
+	// Set spatial distribution
+	const char *gen_spatial_dist
+		= spinn_sim_config_lookup_string(node->sim, "model.packet_generator.spatial.dist");
+	configure_node_packet_gen_spatial_dist( node
+	                                      , gen_spatial_dist
+	                                      , "model.packet_generator.spatial.dist"
+	                                      );
 }
 
 
@@ -340,8 +569,10 @@ configure_links(spinn_node_t *node)
 		if (dest_node->board_coord.x == node->board_coord.x
 		    && dest_node->board_coord.y == node->board_coord.y) {
 			delay_set_delay(&(node->delays[i]), node_to_node_delay_ticks);
+			node->link_is_board_to_board[i] = false;
 		} else {
 			delay_set_delay(&(node->delays[i]), board_to_board_delay_ticks);
+			node->link_is_board_to_board[i] = true;
 		}
 	}
 }
@@ -356,7 +587,7 @@ configure_allow_local_packets(spinn_sim_t *sim)
  * Filtering for allowed node destinations
  ******************************************************************************/
 
-bool
+static bool
 dest_filter(const spinn_coord_t *proposed_destination, void *_node)
 {
 	spinn_node_t *node = (spinn_node_t *)_node;
@@ -385,6 +616,28 @@ dest_filter(const spinn_coord_t *proposed_destination, void *_node)
  * Node initialisation
  ******************************************************************************/
 
+/**
+ * Seed the node's random number streams for the current sample. Every node has
+ * three streams (generator timings, generator destinations and the consumer)
+ * and separate streams are used for the warmup and the sample itself.
+ */
+static void
+seed_node_rngs(spinn_node_t *node, bool warmup)
+{
+	spinn_sim_t *sim = node->sim;
+	
+	uint64_t node_index = (node->position.y * sim->system_size.x) + node->position.x;
+	uint64_t stream = ((uint64_t)(warmup ? 0 : 1) << 63)
+	                | ((uint64_t)sim->cur_sample << 32)
+	                | (node_index * 3)
+	                ;
+	
+	rng_init(&(node->gen_temporal_rng), sim->seed, stream + 0);
+	rng_init(&(node->gen_spatial_rng),  sim->seed, stream + 1);
+	rng_init(&(node->con_rng),          sim->seed, stream + 2);
+}
+
+
 /**
  * Initialise a node (but not the links/delays to neighbours).
  *
@@ -524,6 +777,15 @@ spinn_node_init( spinn_sim_t   *sim
 		            , &(node->arb_w_sw_out)
 		            );
 	
+	// Time packets entering and leaving the arbiter tree
+	if (node->enabled && sim->stat_file_latency_breakdown != NULL) {
+		arbiter_set_on_forward(&(node->arb_last),     spinn_sim_stat_on_arbiter_forward, (void *)node);
+		arbiter_set_on_forward(&(node->arb_w_sw_l),   spinn_sim_stat_on_arbiter_forward, (void *)node);
+		arbiter_set_on_forward(&(node->arb_e_s),      spinn_sim_stat_on_arbiter_forward, (void *)node);
+		arbiter_set_on_forward(&(node->arb_ne_n),     spinn_sim_stat_on_arbiter_forward, (void *)node);
+		arbiter_set_on_forward(&(node->arb_w_sw),     spinn_sim_stat_on_arbiter_forward, (void *)node);
+	}
+	
 	
 	// Packet generator
 	int gen_period = spinn_sim_config_lookup_int(sim, "model.packet_generator.period");
@@ -539,8 +801,25 @@ spinn_node_init( spinn_sim_t   *sim
 		                     , dest_filter, (void *)node
 		                     , spinn_sim_stat_on_packet_gen, (void *)node
 		                     );
+	if (node->enabled)
+		spinn_packet_gen_set_on_packet_inject( &(node->packet_gen)
+		                                     , spinn_sim_stat_on_packet_inject, (void *)node
+		                                     );
 
-	configure_node_packet_gen(node);
+	// Each node draws from its own random number streams in common random
+	// numbers mode. These must be attached before the temporal distribution is
+	// configured since some distributions draw their initial state when set.
+	bool crn = spinn_sim_config_lookup_bool(sim, "experiment.common_random_numbers.enabled");
+	if (crn)
+		seed_node_rngs(node, true);
+	if (node->enabled)
+		spinn_packet_gen_set_rngs( &(node->packet_gen)
+		                         , crn ? &(node->gen_temporal_rng) : NULL
+		                         , crn ? &(node->gen_spatial_rng) : NULL
+		                         );
+	
+	if (node->enabled)
+		configure_node_packet_gen(node);
 	
 	// Packet consumer
 	int con_period = spinn_sim_config_lookup_int(sim, "model.packet_consumer.period");
@@ -553,7 +832,11 @@ spinn_node_init( spinn_sim_t   *sim
 		                     , spinn_sim_stat_on_packet_con, (void *)node
 		                     );
 	
-	configure_node_packet_con(node);
+	if (node->enabled)
+		spinn_packet_con_set_rng(&(node->packet_con), crn ? &(node->con_rng) : NULL);
+	
+	if (node->enabled)
+		configure_node_packet_con(node);
 	
 	// Get a pointer to each of the output buffers
 	buffer_t *output_buffers[7];
@@ -623,32 +906,29 @@ spinn_node_destroy(spinn_node_t *node)
  * System-level simulation functions
  ******************************************************************************/
 
-void
-spinn_sim_model_init(spinn_sim_t *sim)
+spinn_coord_t
+spinn_sim_model_get_system_size(spinn_sim_t *sim, bool *use_wrap_around_links)
 {
-	scheduler_init(&(sim->scheduler));
-	spinn_packet_pool_init(&(sim->pool));
-	
-	bool use_wrap_around_links;
+	spinn_coord_t size;
 	
 	// Get the network topology information
 	const char *topology_name = spinn_sim_config_lookup_string(sim, "model.network.topology");
 	if (strcmp(topology_name, "multi_board_torus") == 0) {
 		int board_radius = spinn_sim_config_lookup_int(sim, "model.network.multi_board_torus_radius");
-		sim->system_size.x = 3*board_radius*spinn_sim_config_lookup_int(sim, "model.network.multi_board_torus_width");
-		sim->system_size.y = 3*board_radius*spinn_sim_config_lookup_int(sim, "model.network.multi_board_torus_height");
+		size.x = 3*board_radius*spinn_sim_config_lookup_int(sim, "model.network.multi_board_torus_width");
+		size.y = 3*board_radius*spinn_sim_config_lookup_int(sim, "model.network.multi_board_torus_height");
 		
-		use_wrap_around_links = true;
+		*use_wrap_around_links = true;
 	} else if (strcmp(topology_name, "torus") == 0) {
-		sim->system_size.x = spinn_sim_config_lookup_int(sim, "model.network.torus_width");
-		sim->system_size.y = spinn_sim_config_lookup_int(sim, "model.network.torus_height");
+		size.x = spinn_sim_config_lookup_int(sim, "model.network.torus_width");
+		size.y = spinn_sim_config_lookup_int(sim, "model.network.torus_height");
 		
-		use_wrap_around_links = true;
+		*use_wrap_around_links = true;
 	} else if (strcmp(topology_name, "mesh") == 0) {
-		sim->system_size.x = spinn_sim_config_lookup_int(sim, "model.network.mesh_width");
-		sim->system_size.y = spinn_sim_config_lookup_int(sim, "model.network.mesh_height");
+		size.x = spinn_sim_config_lookup_int(sim, "model.network.mesh_width");
+		size.y = spinn_sim_config_lookup_int(sim, "model.network.mesh_height");
 		
-		use_wrap_around_links = false;
+		*use_wrap_around_links = false;
 		
 		if (spinn_sim_config_lookup_bool(sim, "model.router.use_emergency_routing")) {
 			fprintf(stderr, "Emergency routing is not possible for mesh topologies.\n");
@@ -656,10 +936,10 @@ spinn_sim_model_init(spinn_sim_t *sim)
 		}
 	} else if (strcmp(topology_name, "board_mesh") == 0) {
 		int mesh_radius = spinn_sim_config_lookup_int(sim, "model.network.board_mesh_radius");
-		sim->system_size.x = 2*mesh_radius;
-		sim->system_size.y = 2*mesh_radius;
+		size.x = 2*mesh_radius;
+		size.y = 2*mesh_radius;
 		
-		use_wrap_around_links = false;
+		*use_wrap_around_links = false;
 		
 		if (spinn_sim_config_lookup_bool(sim, "model.router.use_emergency_routing")) {
 			fprintf(stderr, "Emergency routing is not possible for mesh topologies.\n");
@@ -673,6 +953,22 @@ spinn_sim_model_init(spinn_sim_t *sim)
 		exit(-1);
 	}
 	
+	return size;
+}
+
+
+void
+spinn_sim_model_init(spinn_sim_t *sim)
+{
+	scheduler_init(&(sim->scheduler));
+	spinn_packet_pool_init(&(sim->pool));
+	
+	bool use_wrap_around_links;
+	
+	// Get the network topology information
+	sim->system_size = spinn_sim_model_get_system_size(sim, &use_wrap_around_links);
+	const char *topology_name = spinn_sim_config_lookup_string(sim, "model.network.topology");
+	
 	// Should it be possible for a node to send a packet to itself?
 	configure_allow_local_packets(sim);
 	
@@ -711,6 +1007,14 @@ spinn_sim_model_init(spinn_sim_t *sim)
 	assert(sim->node_packet_gen_p2p_target != NULL);
 	load_packet_gen_p2p_dist(sim);
 	
+	// Load the trace to be replayed (if one is used)
+	sim->packet_gen_trace_loaded = false;
+	load_packet_gen_trace(sim);
+	
+	// Load the neural network workload (if one is used)
+	sim->packet_gen_snn_loaded = false;
+	load_packet_gen_snn(sim);
+	
 	// Create the required number of nodes
 	sim->nodes = calloc( sim->system_size.x*sim->system_size.y
 	                   , sizeof(spinn_node_t)
@@ -806,6 +1110,13 @@ spinn_sim_model_init(spinn_sim_t *sim)
 	
 	// Set up the mask of which nodes are able to generate traffic.
 	load_packet_gen_mask(sim);
+	
+	// Give the routers their multicast routing tables
+	sim->mc_tables = NULL;
+	load_mc_tables(sim);
+	
+	// Start any per-model statistics (e.g. trace recording)
+	spinn_sim_stat_start_model(sim);
 }
 
 
@@ -813,6 +1124,8 @@ spinn_sim_model_init(spinn_sim_t *sim)
 void
 spinn_sim_model_destroy(spinn_sim_t *sim)
 {
+	spinn_sim_stat_end_model(sim);
+	
 	scheduler_destroy(&(sim->scheduler));
 	spinn_packet_pool_destroy(&(sim->pool));
 	
@@ -824,6 +1137,14 @@ spinn_sim_model_destroy(spinn_sim_t *sim)
 	free(sim->node_enable_mask);
 	free(sim->node_packet_gen_p2p_target);
 	free(sim->nodes);
+	
+	if (sim->packet_gen_trace_loaded)
+		spinn_trace_close(&(sim->packet_gen_trace));
+	
+	if (sim->packet_gen_snn_loaded)
+		spinn_snn_destroy(&(sim->packet_gen_snn));
+	
+	free_mc_tables(sim);
 }
 
 
@@ -831,20 +1152,37 @@ spinn_sim_model_destroy(spinn_sim_t *sim)
  * System-level hot-update
  ******************************************************************************/
 
+void
+spinn_sim_model_seed_rngs(spinn_sim_t *sim, bool warmup)
+{
+	if (!spinn_sim_config_lookup_bool(sim, "experiment.common_random_numbers.enabled"))
+		return;
+	
+	for (int i = 0; i < sim->system_size.x * sim->system_size.y; i++)
+		seed_node_rngs(&(sim->nodes[i]), warmup);
+}
+
+
 void
 spinn_sim_model_update(spinn_sim_t *sim)
 {
 	configure_allow_local_packets(sim);
 	
 	load_packet_gen_p2p_dist(sim);
+	load_packet_gen_trace(sim);
+	load_packet_gen_snn(sim);
 	load_packet_gen_mask(sim);
+	load_mc_tables(sim);
 	
 	for (int y = 0; y < sim->system_size.y; y++) {
 		for (int x = 0; x < sim->system_size.x; x++) {
 			spinn_node_t *node = &(sim->nodes[(y * sim->system_size.x) + x]);
 			
-			configure_node_packet_gen(node);
-			configure_node_packet_con(node);
+			// Disabled nodes have no generator or consumer to configure
+			if (node->enabled) {
+				configure_node_packet_gen(node);
+				configure_node_packet_con(node);
+			}
 			configure_links(node);
 		}
 	}
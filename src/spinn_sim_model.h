@@ -16,12 +16,28 @@
 void spinn_sim_model_init(spinn_sim_t *sim);
 
 
+/**
+ * Get the size of the system (and whether wrap-around links are used) given by
+ * the current configuration without initialising the model.
+ */
+spinn_coord_t spinn_sim_model_get_system_size(spinn_sim_t *sim, bool *use_wrap_around_links);
+
+
 /**
  * Update all parameters of the model which can be updated without destroying
  * and re-initialising.
  */
 void spinn_sim_model_update(spinn_sim_t *sim);
 
+/**
+ * Reseed the random number streams of every node when
+ * experiment.common_random_numbers is enabled (and do nothing otherwise). The
+ * streams depend only on the experiment seed, the current sample number, the
+ * node and whether it is warming up so that every group sees the same packet
+ * timings, destinations and consumption decisions for a given sample.
+ */
+void spinn_sim_model_seed_rngs(spinn_sim_t *sim, bool warmup);
+
 /**
  * Clean up the system model.
  */
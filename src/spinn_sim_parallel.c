@@ -0,0 +1,544 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * spinn_sim_parallel.c -- Run the groups (or samples) of an experiment in
+ * parallel using a pool of forked worker processes.
+ *
+ * Workers are forked after the configuration has been loaded and the result
+ * files opened so they share the parent's state copy-on-write. The result files
+ * of each worker are replaced with in-memory streams for the duration of each
+ * job. When a job completes, a header giving the job number and the length of
+ * each result file's output is sent to the parent followed by the output itself.
+ *
+ * Jobs whose results are in the result cache (see spinn_sim_cache.h) are loaded
+ * by the parent before the workers are forked and only the remaining jobs are
+ * given to the workers, which add their results to the cache. The remaining jobs
+ * are handed out longest first, as predicted by the cost model (see
+ * spinn_sim_cost.h), so that a long job is not left running alone at the end.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+
+#include <unistd.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "spinn_sim.h"
+#include "spinn_sim_config.h"
+#include "spinn_sim_stat.h"
+#include "spinn_sim_cache.h"
+#include "spinn_sim_cost.h"
+#include "spinn_sim_parallel.h"
+
+
+/**
+ * Number of bytes read from a worker at a time.
+ */
+#define SPINN_SIM_PARALLEL_READ_CHUNK 65536
+
+
+/**
+ * A single job: either a whole group (sample is -1) or one sample of a group.
+ */
+typedef struct spinn_sim_parallel_job {
+	int group;
+	int sample;
+} spinn_sim_parallel_job_t;
+
+
+/**
+ * A job yet to be run along with its predicted run time.
+ */
+typedef struct spinn_sim_parallel_pending {
+	int    job;
+	double cost;
+} spinn_sim_parallel_pending_t;
+
+
+/**
+ * Header sent by a worker ahead of the results of a job.
+ */
+typedef struct spinn_sim_parallel_header {
+	uint32_t job;
+	uint32_t num_files;
+	uint64_t lengths[SPINN_SIM_STAT_MAX_FILES];
+} spinn_sim_parallel_header_t;
+
+
+/**
+ * The results of a job received by the parent.
+ */
+typedef struct spinn_sim_parallel_result {
+	bool received;
+	
+	// Was the result loaded from the result cache?
+	bool cached;
+	
+	// The output for each result file
+	char   *data[SPINN_SIM_STAT_MAX_FILES];
+	size_t  lengths[SPINN_SIM_STAT_MAX_FILES];
+} spinn_sim_parallel_result_t;
+
+
+/**
+ * A worker process as seen by the parent.
+ */
+typedef struct spinn_sim_parallel_worker {
+	pid_t pid;
+	
+	// The read end of the worker's pipe (or -1 once closed)
+	int fd;
+	
+	// Data received but not yet parsed
+	char   *buf;
+	size_t  buf_length;
+	size_t  buf_size;
+} spinn_sim_parallel_worker_t;
+
+
+/******************************************************************************
+ * Internal: Jobs
+ ******************************************************************************/
+
+/**
+ * Build the list of jobs to run, respecting experiment.parallel.group/sample.
+ * Returns the number of jobs.
+ */
+static int
+spinn_sim_parallel_get_jobs(spinn_sim_t *sim, spinn_sim_parallel_job_t **jobs)
+{
+	int num_groups = spinn_sim_config_get_num_exp_groups(sim);
+	
+	int parallel_group  = spinn_sim_config_lookup_int(sim, "experiment.parallel.group")  - 1;
+	int parallel_sample = spinn_sim_config_lookup_int(sim, "experiment.parallel.sample") - 1;
+	
+	if (!spinn_sim_config_lookup_bool(sim, "experiment.cold_group")) {
+		fprintf(stderr, "Error: Running groups in parallel (or using the result cache) requires experiment.cold_group to be enabled.\n");
+		exit(-1);
+	}
+	
+	// Each job is run by its own process which can't know which groups saturated
+	if (spinn_sim_config_lookup_bool(sim, "experiment.early_termination.enabled")
+	    && spinn_sim_config_lookup_bool(sim, "experiment.early_termination.skip_saturated_groups")) {
+		fprintf(stderr, "Error: experiment.early_termination.skip_saturated_groups can't be used when running groups in parallel (or using the result cache).\n");
+		exit(-1);
+	}
+	
+	// Saturation searches and staircases can only be split into groups
+	bool saturation_search = spinn_sim_config_lookup_bool(sim, "experiment.saturation_search.enabled");
+	bool staircase         = spinn_sim_config_lookup_bool(sim, "experiment.staircase.enabled");
+	
+	int jobs_size = num_groups;
+	int num_jobs  = 0;
+	*jobs = calloc(jobs_size, sizeof(spinn_sim_parallel_job_t));
+	assert(*jobs != NULL);
+	
+	for (int group = 0; group < num_groups; group++) {
+		if (parallel_group >= 0 && group != parallel_group)
+			continue;
+		
+		// The number of samples (and whether they're cold) may differ between
+		// groups
+		spinn_sim_config_set_exp_group(sim, group);
+		bool cold_sample = spinn_sim_config_lookup_bool(sim, "experiment.cold_sample")
+		                   && !saturation_search && !staircase;
+		int num_samples  = cold_sample ? spinn_sim_config_lookup_int(sim, "experiment.num_samples") : 1;
+		
+		for (int sample = 0; sample < num_samples; sample++) {
+			if (cold_sample && parallel_sample >= 0 && sample != parallel_sample)
+				continue;
+			
+			if (num_jobs == jobs_size) {
+				jobs_size *= 2;
+				*jobs = realloc(*jobs, jobs_size * sizeof(spinn_sim_parallel_job_t));
+				assert(*jobs != NULL);
+			}
+			
+			(*jobs)[num_jobs].group  = group;
+			(*jobs)[num_jobs].sample = cold_sample ? sample : parallel_sample;
+			num_jobs++;
+		}
+	}
+	
+	return num_jobs;
+}
+
+
+/******************************************************************************
+ * Internal: Worker
+ ******************************************************************************/
+
+/**
+ * Write a whole block of data to a file descriptor. Returns false on failure.
+ */
+static bool
+write_all(int fd, const void *data, size_t length)
+{
+	const char *bytes = (const char *)data;
+	while (length > 0) {
+		ssize_t written = write(fd, bytes, length);
+		if (written < 0 && errno == EINTR)
+			continue;
+		if (written <= 0)
+			return false;
+		bytes  += written;
+		length -= written;
+	}
+	return true;
+}
+
+
+/**
+ * Compare pending jobs into order of decreasing cost (and then job number).
+ */
+static int
+spinn_sim_parallel_compare_pending(const void *a, const void *b)
+{
+	const spinn_sim_parallel_pending_t *pa = a;
+	const spinn_sim_parallel_pending_t *pb = b;
+	if (pa->cost != pb->cost)
+		return (pa->cost < pb->cost) ? 1 : -1;
+	else
+		return pa->job - pb->job;
+}
+
+
+/**
+ * The body of a worker process: run the pending jobs until none remain, sending
+ * the results of each to the parent via fd. Never returns.
+ */
+static void
+spinn_sim_parallel_worker( spinn_sim_t                    *sim
+                         , const spinn_sim_parallel_job_t *jobs
+                         , const int                      *pending
+                         , int                             num_pending
+                         , int                            *next_job
+                         , int                             fd
+                         )
+{
+	// Progress reports from several workers would be unreadable
+	sim->show_progress = false;
+	
+	FILE **files[SPINN_SIM_STAT_MAX_FILES];
+	int num_files = spinn_sim_stat_get_files(sim, files);
+	
+	// Only the files open in the parent are written
+	bool used[SPINN_SIM_STAT_MAX_FILES];
+	for (int i = 0; i < num_files; i++)
+		used[i] = *(files[i]) != NULL;
+	
+	int next;
+	while ((next = __sync_fetch_and_add(next_job, 1)) < num_pending) {
+		int job = pending[next];
+		
+		char   *data[SPINN_SIM_STAT_MAX_FILES];
+		size_t  lengths[SPINN_SIM_STAT_MAX_FILES];
+		for (int i = 0; i < num_files; i++) {
+			data[i]    = NULL;
+			lengths[i] = 0;
+			if (used[i]) {
+				*(files[i]) = open_memstream(&(data[i]), &(lengths[i]));
+				assert(*(files[i]) != NULL);
+			}
+		}
+		
+		// Only the side files of this job are stored in its cache entry
+		spinn_sim_stat_clear_side_files(sim);
+		
+		srand(sim->seed ^ (unsigned int)(((jobs[job].group + 1) * 65599) + jobs[job].sample + 1));
+		spinn_sim_run_groups(sim, jobs[job].group, jobs[job].sample);
+		
+		spinn_sim_parallel_header_t header;
+		memset(&header, 0, sizeof(header));
+		header.job       = job;
+		header.num_files = num_files;
+		for (int i = 0; i < num_files; i++) {
+			if (used[i]) {
+				fclose(*(files[i]));
+				*(files[i]) = NULL;
+				header.lengths[i] = lengths[i];
+			}
+		}
+		
+		spinn_sim_cache_save(sim, jobs[job].group, jobs[job].sample, num_files, data, lengths);
+		
+		bool ok = write_all(fd, &header, sizeof(header));
+		for (int i = 0; i < num_files; i++) {
+			if (used[i]) {
+				ok = ok && write_all(fd, data[i], lengths[i]);
+				free(data[i]);
+			}
+		}
+		if (!ok) {
+			fprintf(stderr, "Error: Worker couldn't send results: %s\n", strerror(errno));
+			_exit(-1);
+		}
+	}
+	
+	close(fd);
+	
+	// Exit without flushing the stdio buffers inherited from the parent
+	_exit(0);
+}
+
+
+/******************************************************************************
+ * Internal: Parent
+ ******************************************************************************/
+
+/**
+ * Parse any complete job results received from a worker.
+ */
+static void
+spinn_sim_parallel_parse( spinn_sim_parallel_worker_t *worker
+                        , spinn_sim_parallel_result_t *results
+                        , int                          num_jobs
+                        , int                          num_files
+                        )
+{
+	while (worker->buf_length >= sizeof(spinn_sim_parallel_header_t)) {
+		spinn_sim_parallel_header_t header;
+		memcpy(&header, worker->buf, sizeof(header));
+		if (header.job >= (uint32_t)num_jobs
+		    || header.num_files != (uint32_t)num_files
+		    || results[header.job].received) {
+			fprintf(stderr, "Error: Received corrupt results from a worker.\n");
+			exit(-1);
+		}
+		
+		size_t length = sizeof(header);
+		for (int i = 0; i < num_files; i++)
+			length += header.lengths[i];
+		if (worker->buf_length < length)
+			return;
+		
+		// Copy out the output of each file
+		spinn_sim_parallel_result_t *result = &(results[header.job]);
+		const char *data = worker->buf + sizeof(header);
+		for (int i = 0; i < num_files; i++) {
+			result->lengths[i] = header.lengths[i];
+			result->data[i]    = malloc(header.lengths[i] + 1);
+			assert(result->data[i] != NULL);
+			memcpy(result->data[i], data, header.lengths[i]);
+			data += header.lengths[i];
+		}
+		result->received = true;
+		
+		memmove(worker->buf, worker->buf + length, worker->buf_length - length);
+		worker->buf_length -= length;
+	}
+}
+
+
+void
+spinn_sim_parallel_run(spinn_sim_t *sim, int num_workers)
+{
+	if (num_workers <= 0)
+		num_workers = sysconf(_SC_NPROCESSORS_ONLN);
+	if (num_workers <= 0)
+		num_workers = 1;
+	
+	spinn_sim_parallel_job_t *jobs;
+	int num_jobs = spinn_sim_parallel_get_jobs(sim, &jobs);
+	
+	FILE **files[SPINN_SIM_STAT_MAX_FILES];
+	int num_files = spinn_sim_stat_get_files(sim, files);
+	
+	spinn_sim_parallel_result_t *results = calloc(num_jobs + 1, sizeof(spinn_sim_parallel_result_t));
+	assert(results != NULL);
+	
+	// Only jobs without cached results need to be run
+	spinn_sim_cost_t cost;
+	spinn_sim_cost_init(&cost, sim);
+	spinn_sim_parallel_pending_t *by_cost = calloc(num_jobs + 1, sizeof(spinn_sim_parallel_pending_t));
+	assert(by_cost != NULL);
+	int num_pending = 0;
+	for (int job = 0; job < num_jobs; job++) {
+		spinn_sim_parallel_result_t *result = &(results[job]);
+		if (spinn_sim_cache_load( sim, jobs[job].group, jobs[job].sample
+		                        , num_files, result->data, result->lengths
+		                        )) {
+			result->received = result->cached = true;
+		} else {
+			by_cost[num_pending].job  = job;
+			by_cost[num_pending].cost = spinn_sim_cost_predict( &cost, sim
+			                                                  , jobs[job].group, jobs[job].sample
+			                                                  , false
+			                                                  );
+			num_pending++;
+		}
+	}
+	spinn_sim_cost_destroy(&cost);
+	
+	// Run the longest jobs first
+	qsort(by_cost, num_pending, sizeof(spinn_sim_parallel_pending_t), spinn_sim_parallel_compare_pending);
+	int *pending = calloc(num_jobs + 1, sizeof(int));
+	assert(pending != NULL);
+	for (int i = 0; i < num_pending; i++)
+		pending[i] = by_cost[i].job;
+	free(by_cost);
+	if (num_workers > num_pending)
+		num_workers = num_pending;
+	
+	// The index of the next job to be taken by a worker, shared by all workers
+	int *next_job = mmap( NULL, sizeof(int)
+	                    , PROT_READ | PROT_WRITE
+	                    , MAP_SHARED | MAP_ANONYMOUS
+	                    , -1, 0
+	                    );
+	if (next_job == MAP_FAILED) {
+		fprintf(stderr, "Error: Couldn't allocate shared memory: %s\n", strerror(errno));
+		exit(-1);
+	}
+	*next_job = 0;
+	
+	fprintf(stderr, "Running %d job%s using %d worker%s (%d cached).\n"
+	              , num_pending, (num_pending == 1) ? "" : "s"
+	              , num_workers, (num_workers == 1) ? "" : "s"
+	              , num_jobs - num_pending
+	              );
+	
+	// Don't let the workers inherit (and later write) buffered output
+	fflush(NULL);
+	
+	spinn_sim_parallel_worker_t *workers = calloc(num_workers + 1, sizeof(spinn_sim_parallel_worker_t));
+	assert(workers != NULL);
+	for (int w = 0; w < num_workers; w++) {
+		int fds[2];
+		if (pipe(fds) != 0) {
+			fprintf(stderr, "Error: Couldn't create pipe: %s\n", strerror(errno));
+			exit(-1);
+		}
+		
+		pid_t pid = fork();
+		if (pid < 0) {
+			fprintf(stderr, "Error: Couldn't fork worker: %s\n", strerror(errno));
+			exit(-1);
+		} else if (pid == 0) {
+			// Close the parent's end of this and earlier workers' pipes
+			close(fds[0]);
+			for (int i = 0; i < w; i++)
+				close(workers[i].fd);
+			spinn_sim_parallel_worker(sim, jobs, pending, num_pending, next_job, fds[1]);
+		}
+		
+		close(fds[1]);
+		workers[w].pid        = pid;
+		workers[w].fd         = fds[0];
+		workers[w].buf_size   = SPINN_SIM_PARALLEL_READ_CHUNK;
+		workers[w].buf_length = 0;
+		workers[w].buf        = malloc(workers[w].buf_size);
+		assert(workers[w].buf != NULL);
+	}
+	
+	// Collect results as they arrive, writing them out in job order
+	struct pollfd *pollfds = calloc(num_workers + 1, sizeof(struct pollfd));
+	assert(pollfds != NULL);
+	int num_open = num_workers;
+	int next_to_write = 0;
+	while (true) {
+		// Write out all results which are next in order
+		while (next_to_write < num_jobs && results[next_to_write].received) {
+			spinn_sim_parallel_result_t *result = &(results[next_to_write]);
+			for (int i = 0; i < num_files; i++) {
+				if (*(files[i]) != NULL)
+					fwrite(result->data[i], 1, result->lengths[i], *(files[i]));
+				free(result->data[i]);
+			}
+			
+			if (sim->show_progress && jobs[next_to_write].sample >= 0)
+				fprintf(stderr, "Group %2d sample %2d %s (%d/%d).\n"
+				              , jobs[next_to_write].group + 1
+				              , jobs[next_to_write].sample + 1
+				              , result->cached ? "cached" : "completed"
+				              , next_to_write + 1, num_jobs
+				              );
+			else if (sim->show_progress)
+				fprintf(stderr, "Group %2d %s (%d/%d).\n"
+				              , jobs[next_to_write].group + 1
+				              , result->cached ? "cached" : "completed"
+				              , next_to_write + 1, num_jobs
+				              );
+			next_to_write++;
+		}
+		
+		if (num_open == 0)
+			break;
+		
+		for (int w = 0; w < num_workers; w++) {
+			pollfds[w].fd     = workers[w].fd;
+			pollfds[w].events = POLLIN;
+		}
+		if (poll(pollfds, num_workers, -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			fprintf(stderr, "Error: Couldn't poll workers: %s\n", strerror(errno));
+			exit(-1);
+		}
+		
+		for (int w = 0; w < num_workers; w++) {
+			spinn_sim_parallel_worker_t *worker = &(workers[w]);
+			if (worker->fd < 0 || !(pollfds[w].revents & (POLLIN | POLLHUP | POLLERR)))
+				continue;
+			
+			if (worker->buf_size - worker->buf_length < SPINN_SIM_PARALLEL_READ_CHUNK) {
+				worker->buf_size *= 2;
+				worker->buf = realloc(worker->buf, worker->buf_size);
+				assert(worker->buf != NULL);
+			}
+			
+			ssize_t num_read = read( worker->fd
+			                       , worker->buf + worker->buf_length
+			                       , worker->buf_size - worker->buf_length
+			                       );
+			if (num_read < 0 && errno == EINTR)
+				continue;
+			if (num_read <= 0) {
+				close(worker->fd);
+				worker->fd = -1;
+				num_open--;
+				continue;
+			}
+			
+			worker->buf_length += num_read;
+			spinn_sim_parallel_parse(worker, results, num_jobs, num_files);
+		}
+	}
+	
+	// Make sure every worker succeeded
+	bool failed = false;
+	for (int w = 0; w < num_workers; w++) {
+		int status;
+		if (waitpid(workers[w].pid, &status, 0) < 0
+		    || !WIFEXITED(status)
+		    || WEXITSTATUS(status) != 0)
+			failed = true;
+		free(workers[w].buf);
+	}
+	if (failed || next_to_write != num_jobs) {
+		fprintf(stderr, "Error: A worker failed, %d of %d jobs completed.\n"
+		              , next_to_write, num_jobs
+		              );
+		exit(-1);
+	}
+	
+	free(pollfds);
+	free(workers);
+	free(results);
+	free(pending);
+	free(jobs);
+	munmap(next_job, sizeof(int));
+	
+	if (sim->show_progress)
+		fprintf(stderr, "Simulation completed.\n");
+}
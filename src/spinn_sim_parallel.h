@@ -0,0 +1,32 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * spinn_sim_parallel.h -- Run the groups (or samples) of an experiment in
+ * parallel using a pool of forked worker processes.
+ *
+ * The experiment is split into jobs: one per sample when experiment.cold_sample
+ * is set and otherwise one per group (which requires experiment.cold_group).
+ * Workers take the next job from a shared counter until none remain, writing
+ * their results into memory and sending them back to the parent through a pipe.
+ * The parent writes the results of each job into the normal result files in
+ * group/sample order, exactly as a sequential run would have.
+ *
+ * The random number generator of each worker is reseeded from the experiment
+ * seed and the group/sample number at the start of every job so the results do
+ * not depend on which worker ran a job or in what order.
+ *
+ * Jobs whose results are held by the result cache are not run again.
+ */
+
+#ifndef SPINN_SIM_PARALLEL_H
+#define SPINN_SIM_PARALLEL_H
+
+#include "spinn_sim.h"
+
+/**
+ * Run the given simulation to completion using the specified number of worker
+ * processes. If num_workers is 0, one worker per online processor is used.
+ */
+void spinn_sim_parallel_run(spinn_sim_t *sim, int num_workers);
+
+#endif
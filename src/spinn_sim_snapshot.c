@@ -0,0 +1,473 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * spinn_sim_snapshot.c -- Snapshots of the complete state of a warmed-up model
+ * which can be restored in place of a cold warmup.
+ *
+ * A snapshot consists of a header followed by the state of every node (in
+ * row-major order) and finally a table of every packet in the network. Packets
+ * are referred to by their index in this table so that a packet held by
+ * several buffers would be restored as a single (shared) packet. (Each copy of
+ * a multicast packet is a separate packet so this does not normally occur.)
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+
+#include <unistd.h>
+
+#include "scheduler.h"
+#include "buffer.h"
+#include "arbiter.h"
+#include "delay.h"
+
+#include "spinn.h"
+#include "spinn_packet.h"
+#include "spinn_router.h"
+
+#include "spinn_sim.h"
+#include "spinn_sim_config.h"
+#include "spinn_sim_snapshot.h"
+
+
+/**
+ * The header at the start of every snapshot file.
+ */
+typedef struct spinn_sim_snapshot_header {
+	// Always SPINN_SIM_SNAPSHOT_MAGIC
+	char magic[8];
+	
+	// Always SPINN_SIM_SNAPSHOT_VERSION
+	uint32_t version;
+	
+	// Always SPINN_SIM_SNAPSHOT_BYTE_ORDER when read in the byte order of the
+	// writer
+	uint32_t byte_order;
+	
+	// The size of a packet record (differs between builds for different
+	// platforms)
+	uint32_t packet_size;
+	
+	// The size of the system
+	uint32_t width;
+	uint32_t height;
+	
+	// The hash of the configuration which produced the snapshot
+	uint64_t config_hash;
+	
+	// The simulation time at which the snapshot was taken
+	uint64_t ticks;
+} spinn_sim_snapshot_header_t;
+
+#define SPINN_SIM_SNAPSHOT_MAGIC      "TICKYSNP"
+#define SPINN_SIM_SNAPSHOT_VERSION    1
+#define SPINN_SIM_SNAPSHOT_BYTE_ORDER 0x01020304u
+
+
+/**
+ * The packets written to/read from a snapshot so far in the order they were
+ * first encountered. When saving, a hash table maps packets to their index.
+ */
+typedef struct spinn_sim_snapshot_packets {
+	spinn_packet_t **packets;
+	size_t           num_packets;
+	size_t           packets_size;
+	
+	// Open-addressed hash table of indices into packets (SIZE_MAX if empty).
+	// Only used when saving.
+	size_t *index;
+	size_t  index_size;
+	
+	// The pool to allocate packets from when restoring
+	spinn_packet_pool_t *pool;
+} spinn_sim_snapshot_packets_t;
+
+
+/******************************************************************************
+ * Internal: Packet table
+ ******************************************************************************/
+
+static void
+spinn_sim_snapshot_packets_init( spinn_sim_snapshot_packets_t *packets
+                               , spinn_packet_pool_t          *pool
+                               , bool                          use_index
+                               )
+{
+	packets->packets_size = 64;
+	packets->num_packets  = 0;
+	packets->packets = calloc(packets->packets_size, sizeof(spinn_packet_t *));
+	assert(packets->packets != NULL);
+	
+	// Every live packet came from the pool so a table twice the size of the pool
+	// can never become more than half full
+	packets->index      = NULL;
+	packets->index_size = 0;
+	if (use_index) {
+		packets->index_size = 1;
+		while (packets->index_size < 2 * (size_t)spinn_packet_pool_get_num_packets(pool))
+			packets->index_size *= 2;
+		packets->index = malloc(packets->index_size * sizeof(size_t));
+		assert(packets->index != NULL);
+		for (size_t i = 0; i < packets->index_size; i++)
+			packets->index[i] = SIZE_MAX;
+	}
+	
+	packets->pool = pool;
+}
+
+
+static void
+spinn_sim_snapshot_packets_destroy(spinn_sim_snapshot_packets_t *packets)
+{
+	free(packets->packets);
+	free(packets->index);
+}
+
+
+/**
+ * Append a packet to the table, returning its index.
+ */
+static size_t
+spinn_sim_snapshot_packets_append( spinn_sim_snapshot_packets_t *packets
+                                 , spinn_packet_t               *packet
+                                 )
+{
+	if (packets->num_packets == packets->packets_size) {
+		packets->packets_size *= 2;
+		packets->packets = realloc(packets->packets, packets->packets_size * sizeof(spinn_packet_t *));
+		assert(packets->packets != NULL);
+	}
+	
+	packets->packets[packets->num_packets] = packet;
+	return packets->num_packets++;
+}
+
+
+/**
+ * Buffer value callback: write the index of a packet, adding it to the table if
+ * it has not been seen before.
+ */
+static bool
+spinn_sim_snapshot_save_packet(FILE *f, void *value, void *data)
+{
+	spinn_sim_snapshot_packets_t *packets = (spinn_sim_snapshot_packets_t *)data;
+	
+	// Find the packet (or the empty slot where it belongs) in the index
+	size_t slot = (((uintptr_t)value) / sizeof(spinn_packet_t)) & (packets->index_size - 1);
+	while (packets->index[slot] != SIZE_MAX
+	       && packets->packets[packets->index[slot]] != (spinn_packet_t *)value)
+		slot = (slot + 1) & (packets->index_size - 1);
+	
+	if (packets->index[slot] == SIZE_MAX)
+		packets->index[slot] = spinn_sim_snapshot_packets_append(packets, (spinn_packet_t *)value);
+	
+	uint64_t index = packets->index[slot];
+	return fwrite(&index, sizeof(index), 1, f) == 1;
+}
+
+
+/**
+ * Buffer value callback: read the index of a packet. Packets seen for the first
+ * time are allocated (their contents are filled in at the end of the snapshot)
+ * and further references to a packet retain it.
+ */
+static bool
+spinn_sim_snapshot_restore_packet(FILE *f, void **value, void *data)
+{
+	spinn_sim_snapshot_packets_t *packets = (spinn_sim_snapshot_packets_t *)data;
+	
+	uint64_t index;
+	if (fread(&index, sizeof(index), 1, f) != 1)
+		return false;
+	
+	if (index < packets->num_packets) {
+		spinn_packet_pool_pretain(packets->pool, packets->packets[index]);
+	} else if (index == packets->num_packets) {
+		spinn_sim_snapshot_packets_append(packets, spinn_packet_pool_palloc(packets->pool));
+	} else {
+		return false;
+	}
+	
+	*value = (void *)packets->packets[index];
+	return true;
+}
+
+
+/******************************************************************************
+ * Internal: Node state
+ ******************************************************************************/
+
+/**
+ * Get all buffers in a node in the order they are written to a snapshot.
+ */
+static void
+spinn_sim_snapshot_node_buffers(spinn_node_t *node, buffer_t *buffers[20])
+{
+	for (int i = 0; i < 6; i++) {
+		buffers[i]     = &(node->input_buffers[i]);
+		buffers[6 + i] = &(node->output_buffers[i]);
+	}
+	buffers[12] = &(node->gen_buffer);
+	buffers[13] = &(node->con_buffer);
+	buffers[14] = &(node->arb_e_s_out);
+	buffers[15] = &(node->arb_ne_n_out);
+	buffers[16] = &(node->arb_w_sw_out);
+	buffers[17] = &(node->arb_e_s_ne_n_out);
+	buffers[18] = &(node->arb_w_sw_l_out);
+	buffers[19] = &(node->arb_last_out);
+}
+
+
+/**
+ * Get all arbiters in a node in the order they are written to a snapshot.
+ */
+static void
+spinn_sim_snapshot_node_arbiters(spinn_node_t *node, arbiter_t *arbiters[6])
+{
+	arbiters[0] = &(node->arb_e_s);
+	arbiters[1] = &(node->arb_ne_n);
+	arbiters[2] = &(node->arb_w_sw);
+	arbiters[3] = &(node->arb_e_s_ne_n);
+	arbiters[4] = &(node->arb_w_sw_l);
+	arbiters[5] = &(node->arb_last);
+}
+
+
+static bool
+spinn_sim_snapshot_save_node( spinn_node_t                 *node
+                            , FILE                         *f
+                            , spinn_sim_snapshot_packets_t *packets
+                            )
+{
+	buffer_t *buffers[20];
+	spinn_sim_snapshot_node_buffers(node, buffers);
+	for (int i = 0; i < 20; i++)
+		if (!buffer_save(buffers[i], f, spinn_sim_snapshot_save_packet, (void *)packets))
+			return false;
+	
+	// Delays exist for all nodes, other components only in enabled nodes
+	for (int i = 0; i < 6; i++)
+		if (!delay_save(&(node->delays[i]), f))
+			return false;
+	
+	if (!node->enabled)
+		return true;
+	
+	arbiter_t *arbiters[6];
+	spinn_sim_snapshot_node_arbiters(node, arbiters);
+	for (int i = 0; i < 6; i++)
+		if (!arbiter_save(arbiters[i], f))
+			return false;
+	
+	return spinn_router_save(&(node->router), f, spinn_sim_snapshot_save_packet, (void *)packets)
+	       && spinn_packet_gen_save(&(node->packet_gen), f, spinn_sim_snapshot_save_packet, (void *)packets)
+	       && spinn_packet_con_save(&(node->packet_con), f);
+}
+
+
+static bool
+spinn_sim_snapshot_restore_node( spinn_node_t                 *node
+                               , FILE                         *f
+                               , spinn_sim_snapshot_packets_t *packets
+                               )
+{
+	buffer_t *buffers[20];
+	spinn_sim_snapshot_node_buffers(node, buffers);
+	for (int i = 0; i < 20; i++)
+		if (!buffer_restore(buffers[i], f, spinn_sim_snapshot_restore_packet, (void *)packets))
+			return false;
+	
+	for (int i = 0; i < 6; i++)
+		if (!delay_restore(&(node->delays[i]), f))
+			return false;
+	
+	if (!node->enabled)
+		return true;
+	
+	arbiter_t *arbiters[6];
+	spinn_sim_snapshot_node_arbiters(node, arbiters);
+	for (int i = 0; i < 6; i++)
+		if (!arbiter_restore(arbiters[i], f))
+			return false;
+	
+	return spinn_router_restore(&(node->router), f, spinn_sim_snapshot_restore_packet, (void *)packets)
+	       && spinn_packet_gen_restore(&(node->packet_gen), f, spinn_sim_snapshot_restore_packet, (void *)packets)
+	       && spinn_packet_con_restore(&(node->packet_con), f);
+}
+
+
+/******************************************************************************
+ * Internal: Utilities
+ ******************************************************************************/
+
+/**
+ * Get the filename of the snapshot for the current configuration or NULL if
+ * snapshots are disabled. The string must be freed by the caller.
+ */
+static char *
+spinn_sim_snapshot_filename(spinn_sim_t *sim)
+{
+	const char *directory = spinn_sim_config_lookup_string_default(sim, "experiment.snapshot.directory", "");
+	if (directory[0] == '\0')
+		return NULL;
+	
+	size_t length = strlen(directory) + 64;
+	char *filename = malloc(length);
+	assert(filename != NULL);
+	snprintf( filename, length, "%s/snapshot_%016llx.bin"
+	        , directory
+	        , (unsigned long long)spinn_sim_config_hash(sim)
+	        );
+	return filename;
+}
+
+
+/**
+ * Reseed the random number generator after a cold warmup such that every
+ * sample continues from the warmed-up model with its own (reproducible) random
+ * numbers.
+ */
+static void
+spinn_sim_snapshot_reseed(spinn_sim_t *sim)
+{
+	uint64_t hash = spinn_sim_config_hash(sim);
+	srand((unsigned int)(hash ^ (hash >> 32)) + (unsigned int)sim->cur_sample);
+}
+
+
+/******************************************************************************
+ * Public functions
+ ******************************************************************************/
+
+bool
+spinn_sim_snapshot_restore(spinn_sim_t *sim)
+{
+	char *filename = spinn_sim_snapshot_filename(sim);
+	if (filename == NULL)
+		return false;
+	
+	FILE *f = fopen(filename, "rb");
+	if (f == NULL) {
+		free(filename);
+		return false;
+	}
+	
+	// Don't use snapshots which don't belong to this configuration and build
+	// (leaving the model untouched)
+	spinn_sim_snapshot_header_t header;
+	if (fread(&header, sizeof(header), 1, f) != 1
+	    || memcmp(header.magic, SPINN_SIM_SNAPSHOT_MAGIC, sizeof(header.magic)) != 0
+	    || header.version != SPINN_SIM_SNAPSHOT_VERSION
+	    || header.byte_order != SPINN_SIM_SNAPSHOT_BYTE_ORDER
+	    || header.packet_size != sizeof(spinn_packet_t)
+	    || header.width != (uint32_t)sim->system_size.x
+	    || header.height != (uint32_t)sim->system_size.y
+	    || header.config_hash != spinn_sim_config_hash(sim)) {
+		fprintf(stderr, "Warning: Ignoring incompatible snapshot %s.\n", filename);
+		fclose(f);
+		free(filename);
+		return false;
+	}
+	
+	// From here on, the model is modified and so failure is fatal
+	spinn_sim_snapshot_packets_t packets;
+	spinn_sim_snapshot_packets_init(&packets, &(sim->pool), false);
+	
+	bool ok = true;
+	for (int i = 0; ok && i < sim->system_size.x * sim->system_size.y; i++)
+		ok = spinn_sim_snapshot_restore_node(&(sim->nodes[i]), f, &packets);
+	
+	// Fill in the contents of the packets (keeping the reference counts found
+	// while restoring)
+	uint64_t num_packets;
+	ok = ok
+	     && fread(&num_packets, sizeof(num_packets), 1, f) == 1
+	     && num_packets == packets.num_packets;
+	for (size_t i = 0; ok && i < packets.num_packets; i++) {
+		spinn_packet_t *p = packets.packets[i];
+		unsigned int ref_count = p->ref_count;
+		ok = fread(p, sizeof(spinn_packet_t), 1, f) == 1;
+		p->ref_count = ref_count;
+		p->payload   = NULL;
+	}
+	
+	spinn_sim_snapshot_packets_destroy(&packets);
+	fclose(f);
+	
+	if (!ok) {
+		fprintf(stderr, "Error: Snapshot %s is corrupt, delete it and try again.\n", filename);
+		exit(-1);
+	}
+	free(filename);
+	
+	scheduler_set_ticks(&(sim->scheduler), header.ticks);
+	spinn_sim_snapshot_reseed(sim);
+	
+	return true;
+}
+
+
+void
+spinn_sim_snapshot_save(spinn_sim_t *sim)
+{
+	char *filename = spinn_sim_snapshot_filename(sim);
+	if (filename == NULL)
+		return;
+	
+	// Write to a temporary file and move it into place once complete so that an
+	// interrupted run never leaves a partial snapshot behind. The process ID is
+	// included since parallel workers may write the same snapshot at once.
+	size_t tmp_length = strlen(filename) + 32;
+	char *tmp_filename = malloc(tmp_length);
+	assert(tmp_filename != NULL);
+	snprintf(tmp_filename, tmp_length, "%s.%ld.tmp", filename, (long)getpid());
+	
+	FILE *f = fopen(tmp_filename, "wb");
+	bool ok = f != NULL;
+	
+	spinn_sim_snapshot_header_t header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, SPINN_SIM_SNAPSHOT_MAGIC, sizeof(header.magic));
+	header.version     = SPINN_SIM_SNAPSHOT_VERSION;
+	header.byte_order  = SPINN_SIM_SNAPSHOT_BYTE_ORDER;
+	header.packet_size = sizeof(spinn_packet_t);
+	header.width       = sim->system_size.x;
+	header.height      = sim->system_size.y;
+	header.config_hash = spinn_sim_config_hash(sim);
+	header.ticks       = scheduler_get_ticks(&(sim->scheduler));
+	ok = ok && fwrite(&header, sizeof(header), 1, f) == 1;
+	
+	spinn_sim_snapshot_packets_t packets;
+	spinn_sim_snapshot_packets_init(&packets, &(sim->pool), true);
+	
+	for (int i = 0; ok && i < sim->system_size.x * sim->system_size.y; i++)
+		ok = spinn_sim_snapshot_save_node(&(sim->nodes[i]), f, &packets);
+	
+	uint64_t num_packets = packets.num_packets;
+	ok = ok && fwrite(&num_packets, sizeof(num_packets), 1, f) == 1;
+	for (size_t i = 0; ok && i < packets.num_packets; i++)
+		ok = fwrite(packets.packets[i], sizeof(spinn_packet_t), 1, f) == 1;
+	
+	spinn_sim_snapshot_packets_destroy(&packets);
+	
+	if (f != NULL && fclose(f) != 0)
+		ok = false;
+	if (ok && rename(tmp_filename, filename) != 0)
+		ok = false;
+	
+	if (!ok) {
+		fprintf(stderr, "Warning: Couldn't write snapshot %s.\n", filename);
+		remove(tmp_filename);
+	}
+	
+	free(tmp_filename);
+	free(filename);
+	
+	spinn_sim_snapshot_reseed(sim);
+}
@@ -0,0 +1,43 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * spinn_sim_snapshot.h -- Snapshots of the complete state of a warmed-up model
+ * which can be restored in place of a cold warmup.
+ *
+ * When experiment.snapshot.directory is set, the state of the model at the end
+ * of every cold warmup is written to a file in that directory named after a
+ * hash of the configuration (see spinn_sim_config_hash). Later cold warmups
+ * with the same configuration (e.g. further samples, groups which only differ
+ * in their measurements, or a re-run after a crash) restore the snapshot rather
+ * than simulating the warmup again.
+ *
+ * Since the C library's random number generator state cannot be saved, the
+ * generator is reseeded from the configuration hash and the sample number after
+ * every cold warmup whether or not it was restored. This ensures a run using a
+ * restored snapshot is identical to the run which wrote it.
+ */
+
+#ifndef SPINN_SIM_SNAPSHOT_H
+#define SPINN_SIM_SNAPSHOT_H
+
+#include <stdbool.h>
+
+#include "spinn_sim.h"
+
+/**
+ * Replace a freshly initialised model with a snapshot of the warmed-up model
+ * for the current configuration. Returns false (leaving the model untouched) if
+ * snapshots are disabled or no snapshot exists. Exits with an error if a
+ * snapshot exists but is corrupt.
+ */
+bool spinn_sim_snapshot_restore(spinn_sim_t *sim);
+
+
+/**
+ * Write a snapshot of the model for the current configuration, if snapshots are
+ * enabled. To be called at the end of a cold warmup. Failure to write a
+ * snapshot is not fatal and produces a warning on stderr.
+ */
+void spinn_sim_snapshot_save(spinn_sim_t *sim);
+
+#endif
@@ -8,16 +8,86 @@
 #include "config.h"
 
 #include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
 #include <assert.h>
 #include <stdbool.h>
 #include <string.h>
 #include <sys/time.h>
+#include <math.h>
+
+#include "columnar.h"
+#include "time_series.h"
+#include "async_writer.h"
+#include "spinn_trace.h"
+#include "spinn_flow_matrix.h"
 
 #include "spinn_sim.h"
 #include "spinn_sim_stat.h"
 #include "spinn_sim_config.h"
+#include "spinn_sim_model.h"
+
+
+
+
+/******************************************************************************
+ * Internal Utility functions
+ ******************************************************************************/
+
+/**
+ * Open a result file for writing. If measurements.async_writer is enabled, the
+ * stream returned is written to the file by a background thread. Returns NULL
+ * if the file could not be opened.
+ */
+static FILE *
+spinn_sim_stat_fopen(spinn_sim_t *sim, const char *filename)
+{
+	FILE *file = fopen(filename, "w");
+	if (file == NULL || sim->stat_writers == NULL)
+		return file;
+	
+	size_t buffer_size = spinn_sim_config_lookup_int(sim,
+		"measurements.async_writer.buffer_size");
+	const char *policy_name = spinn_sim_config_lookup_string(sim,
+		"measurements.async_writer.policy");
+	async_writer_policy_t policy;
+	if (strcmp(policy_name, "grow") == 0) {
+		policy = ASYNC_WRITER_GROW;
+	} else if (strcmp(policy_name, "block") == 0) {
+		policy = ASYNC_WRITER_BLOCK;
+	} else {
+		fprintf(stderr, "Error: Unknown measurements.async_writer.policy '%s'.\n", policy_name);
+		exit(-1);
+	}
+	
+	assert(sim->stat_num_writers < SPINN_SIM_STAT_MAX_FILES);
+	async_writer_t *w = &(sim->stat_writers[sim->stat_num_writers]);
+	FILE *stream = async_writer_open(w, file, buffer_size, policy);
+	if (stream == NULL) {
+		fprintf(stderr, "Warning: Couldn't start a writer thread for %s.\n", filename);
+		return file;
+	}
+	
+	sim->stat_num_writers++;
+	return stream;
+}
 
 
+/**
+ * Record that a file other than a result file was written (given relative to
+ * the results directory) so that the result cache can store it.
+ */
+static void
+spinn_sim_stat_add_side_file(spinn_sim_t *sim, const char *name)
+{
+	sim->stat_side_files = realloc(sim->stat_side_files,
+		(sim->stat_num_side_files + 1) * sizeof(char *));
+	assert(sim->stat_side_files != NULL);
+	
+	sim->stat_side_files[sim->stat_num_side_files] = strdup(name);
+	assert(sim->stat_side_files[sim->stat_num_side_files] != NULL);
+	sim->stat_num_side_files++;
+}
 
 
 /******************************************************************************
@@ -76,6 +146,399 @@ fprint_standard_fields(spinn_sim_t *sim, FILE *file)
 }
 
 
+/**
+ * Get the names of the common fields (there are 2 + sim->num_ivars). The array
+ * returned should be freed.
+ */
+static const char **
+get_standard_fields_names(spinn_sim_t *sim)
+{
+	const char **names = calloc(2 + sim->num_ivars, sizeof(const char *));
+	assert(names != NULL);
+	
+	names[0] = "group";
+	names[1] = "sample";
+	for (int i = 0; i < sim->num_ivars; i++)
+		names[2 + i] = sim->ivar_names[i];
+	
+	return names;
+}
+
+
+/**
+ * Get the values of the common fields formatted exactly as they would be
+ * printed by fprint_standard_fields. The array returned and *fields (which holds
+ * the strings) should be freed.
+ */
+static const char **
+get_standard_fields_values(spinn_sim_t *sim, char **fields)
+{
+	size_t fields_length;
+	FILE *stream = open_memstream(fields, &fields_length);
+	assert(stream != NULL);
+	fprint_standard_fields(sim, stream);
+	fclose(stream);
+	
+	// Split the fields at the tabs
+	int num_fields = 2 + sim->num_ivars;
+	const char **values = calloc(num_fields, sizeof(const char *));
+	assert(values != NULL);
+	char *field = *fields;
+	for (int i = 0; i < num_fields; i++) {
+		values[i] = field;
+		char *tab = strchr(field, '\t');
+		if (tab != NULL) {
+			*tab  = '\0';
+			field = tab + 1;
+		}
+	}
+	
+	return values;
+}
+
+
+/**
+ * Initialise a columnar table writer whose labels are the common fields.
+ */
+static void
+init_standard_fields_columnar( spinn_sim_t *sim
+                             , columnar_t  *c
+                             , int          num_columns
+                             , const char **column_names
+                             )
+{
+	const char **label_names = get_standard_fields_names(sim);
+	columnar_init(c, 2 + sim->num_ivars, label_names, num_columns, column_names);
+	free(label_names);
+}
+
+
+/**
+ * Set the labels of a columnar table to the values of the common fields.
+ */
+static void
+set_standard_fields_labels(spinn_sim_t *sim, columnar_t *c, FILE *file)
+{
+	char *fields;
+	const char **values = get_standard_fields_values(sim, &fields);
+	columnar_set_labels(c, file, values);
+	free(values);
+	free(fields);
+}
+
+
+/**
+ * Make sure the latency histograms have at least the given number of keys,
+ * allocating empty histograms for any new keys.
+ */
+static void
+spinn_sim_stat_grow_histograms(spinn_sim_t *sim, int num_keys)
+{
+	if (num_keys <= sim->stat_histograms_num_keys)
+		return;
+	
+	sim->stat_histograms = realloc( sim->stat_histograms
+	                              , num_keys * SPINN_SIM_NUM_HISTOGRAM_METRICS
+	                                * sizeof(histogram_t)
+	                              );
+	assert(sim->stat_histograms != NULL);
+	
+	for ( int i = sim->stat_histograms_num_keys * SPINN_SIM_NUM_HISTOGRAM_METRICS
+	    ; i < num_keys * SPINN_SIM_NUM_HISTOGRAM_METRICS
+	    ; i++
+	    )
+		histogram_init(&(sim->stat_histograms[i]), sim->stat_histograms_precision);
+	
+	sim->stat_histograms_num_keys = num_keys;
+}
+
+
+/**
+ * Print the fields identifying the packets in the histograms for a given key
+ * (nothing if there is only one key).
+ */
+static void
+fprint_histogram_key(spinn_sim_t *sim, FILE *file, int key)
+{
+	switch (sim->stat_histograms_per) {
+		default:
+		case SPINN_SIM_HISTOGRAMS_PER_NONE:
+			break;
+		
+		case SPINN_SIM_HISTOGRAMS_PER_SOURCE:
+			fprintf(file, "\t%d\t%d", key % sim->system_size.x, key / sim->system_size.x);
+			break;
+		
+		case SPINN_SIM_HISTOGRAMS_PER_HOPS:
+			fprintf(file, "\t%d", key);
+			break;
+	}
+}
+
+
+/**
+ * The names of the buffer roles in buffer_occupancy.dat.
+ */
+static const char *buffer_role_names[SPINN_SIM_NUM_BUFFER_ROLES] = {
+	"input", "output", "arbiter_lvl2", "arbiter_lvl1", "arbiter_root",
+	"generator", "consumer",
+};
+
+
+/**
+ * Get the buffers of a node with the given role (an index into
+ * buffer_role_names). Returns the number of buffers.
+ */
+static int
+get_role_buffers(spinn_node_t *node, int role, buffer_t *buffers[6])
+{
+	int num_buffers = 0;
+	switch (role) {
+		case 0: // input
+			for (int i = 0; i < 6; i++)
+				buffers[num_buffers++] = &(node->input_buffers[i]);
+			break;
+		
+		case 1: // output
+			for (int i = 0; i < 6; i++)
+				buffers[num_buffers++] = &(node->output_buffers[i]);
+			break;
+		
+		case 2: // arbiter_lvl2
+			buffers[num_buffers++] = &(node->arb_e_s_out);
+			buffers[num_buffers++] = &(node->arb_ne_n_out);
+			buffers[num_buffers++] = &(node->arb_w_sw_out);
+			break;
+		
+		case 3: // arbiter_lvl1
+			buffers[num_buffers++] = &(node->arb_e_s_ne_n_out);
+			buffers[num_buffers++] = &(node->arb_w_sw_l_out);
+			break;
+		
+		case 4: // arbiter_root
+			buffers[num_buffers++] = &(node->arb_last_out);
+			break;
+		
+		case 5: // generator
+			buffers[num_buffers++] = &(node->gen_buffer);
+			break;
+		
+		case 6: // consumer
+			buffers[num_buffers++] = &(node->con_buffer);
+			break;
+	}
+	
+	return num_buffers;
+}
+
+
+/**
+ * Print the length, time-weighted mean occupancy and fraction of time spent at
+ * each occupancy of the given buffers (given as an array of all nodes' buffers
+ * of one role).
+ */
+static void
+fprint_buffer_occupancy(FILE *file, buffer_t **buffers, int num_buffers)
+{
+	size_t size = 0;
+	for (int i = 0; i < num_buffers; i++)
+		if (buffer_get_size(buffers[i]) > size)
+			size = buffer_get_size(buffers[i]);
+	
+	// Total time at each occupancy over all buffers
+	uint64_t *ticks = calloc(size + 1, sizeof(uint64_t));
+	assert(ticks != NULL);
+	uint64_t total_ticks = 0;
+	double   sum         = 0.0;
+	for (int i = 0; i < num_buffers; i++) {
+		for (size_t occupancy = 0; occupancy <= buffer_get_size(buffers[i]); occupancy++) {
+			uint64_t t = buffer_get_stats_ticks(buffers[i], occupancy);
+			ticks[occupancy] += t;
+			total_ticks      += t;
+			sum              += (double)occupancy * (double)t;
+		}
+	}
+	
+	fprintf(file, "\t%zu\t%f\t", size, (total_ticks > 0) ? sum / (double)total_ticks : 0.0);
+	for (size_t occupancy = 0; occupancy <= size; occupancy++)
+		fprintf( file, "%s%f", (occupancy > 0) ? "," : ""
+		       , (total_ticks > 0) ? (double)ticks[occupancy] / (double)total_ticks : 0.0
+		       );
+	fprintf(file, "\n");
+	
+	free(ticks);
+}
+
+
+/**
+ * The names of the latency components (see spinn_packet_latency_t) and total
+ * latency in latency_breakdown.dat.
+ */
+static const char *latency_component_names[SPINN_PACKET_NUM_LATENCIES + 1] = {
+	"queue", "arbiter", "router", "link", "total",
+};
+
+
+/**
+ * The arbiters in the tree at the input of each router (from the inputs to the
+ * root), the tree level each is in and the names of their two inputs.
+ */
+#define NUM_ARBITERS 6
+
+static const char *arbiter_names[NUM_ARBITERS] = {
+	"e_s", "ne_n", "w_sw", "e_s_ne_n", "w_sw_l", "last",
+};
+
+static const char *arbiter_levels[NUM_ARBITERS] = {
+	"lvl2", "lvl2", "lvl2", "lvl1", "lvl1", "root",
+};
+
+static const char *arbiter_input_names[NUM_ARBITERS][2] = {
+	{"east", "south"}, {"north_east", "north"}, {"west", "south_west"},
+	{"e_s", "ne_n"}, {"w_sw", "local"},
+	{"e_s_ne_n", "w_sw_l"},
+};
+
+
+/**
+ * Get one of a node's arbiters (an index into arbiter_names).
+ */
+static arbiter_t *
+get_arbiter(spinn_node_t *node, int arbiter)
+{
+	switch (arbiter) {
+		case 0:  return &(node->arb_e_s);
+		case 1:  return &(node->arb_ne_n);
+		case 2:  return &(node->arb_w_sw);
+		case 3:  return &(node->arb_e_s_ne_n);
+		case 4:  return &(node->arb_w_sw_l);
+		default: return &(node->arb_last);
+	}
+}
+
+
+/**
+ * Print the level, name and per-input counters of an arbiter summed over the
+ * given nodes.
+ */
+static void
+fprint_arbiter_contention(FILE *file, spinn_node_t **nodes, int num_nodes, int arbiter)
+{
+	unsigned long num_granted[2] = {0, 0};
+	unsigned long num_waiting[2] = {0, 0};
+	unsigned long num_blocked    = 0;
+	
+	for (int i = 0; i < num_nodes; i++) {
+		arbiter_t *a = get_arbiter(nodes[i], arbiter);
+		for (int input = 0; input < 2; input++) {
+			num_granted[input] += arbiter_get_num_granted(a, input);
+			num_waiting[input] += arbiter_get_num_waiting(a, input);
+		}
+		num_blocked += arbiter_get_num_blocked(a);
+	}
+	
+	fprintf( file, "\t%s\t%s\t%s\t%lu\t%lu\t%s\t%lu\t%lu\t%lu\n"
+	       , arbiter_levels[arbiter], arbiter_names[arbiter]
+	       , arbiter_input_names[arbiter][0], num_granted[0], num_waiting[0]
+	       , arbiter_input_names[arbiter][1], num_granted[1], num_waiting[1]
+	       , num_blocked
+	       );
+}
+
+
+/**
+ * Print the router cycle and packet counters, mean pipeline occupancy and
+ * summary of waiting times of the given routers combined.
+ */
+static void
+fprint_router_stats(FILE *file, spinn_router_t **routers, int num_routers, int precision)
+{
+	unsigned long num_cycles         = 0;
+	unsigned long num_stall_cycles   = 0;
+	unsigned long num_bubble_cycles  = 0;
+	unsigned long num_first_timeouts = 0;
+	unsigned long num_emg_routed     = 0;
+	unsigned long num_final_timeouts = 0;
+	unsigned long num_dropped        = 0;
+	double        occupancy_sum      = 0.0;
+	
+	histogram_t wait;
+	histogram_init(&wait, precision);
+	
+	for (int i = 0; i < num_routers; i++) {
+		num_cycles         += spinn_router_get_num_cycles(routers[i]);
+		num_stall_cycles   += spinn_router_get_num_stall_cycles(routers[i]);
+		num_bubble_cycles  += spinn_router_get_num_bubble_cycles(routers[i]);
+		num_first_timeouts += spinn_router_get_num_first_timeouts(routers[i]);
+		num_emg_routed     += spinn_router_get_num_emg_routed(routers[i]);
+		num_final_timeouts += spinn_router_get_num_final_timeouts(routers[i]);
+		num_dropped        += spinn_router_get_num_dropped(routers[i]);
+		occupancy_sum      += spinn_router_get_mean_pipeline_occupancy(routers[i])
+		                      * (double)spinn_router_get_num_cycles(routers[i]);
+		histogram_merge(&wait, spinn_router_get_wait_histogram(routers[i]));
+	}
+	
+	fprintf( file
+	       , "\t%lu\t%lu\t%lu\t%f\t%lu\t%lu\t%lu\t%lu"
+	         "\t%"PRIu64"\t%f\t%"PRIu64"\t%"PRIu64"\t%"PRIu64"\t%"PRIu64"\n"
+	       , num_cycles, num_stall_cycles, num_bubble_cycles
+	       , (num_cycles > 0) ? occupancy_sum / (double)num_cycles : 0.0
+	       , num_first_timeouts, num_emg_routed, num_final_timeouts, num_dropped
+	       , histogram_get_count(&wait)
+	       , histogram_get_mean(&wait)
+	       , histogram_get_quantile(&wait, 0.5)
+	       , histogram_get_quantile(&wait, 0.9)
+	       , histogram_get_quantile(&wait, 0.99)
+	       , histogram_get_max(&wait)
+	       );
+	
+	histogram_destroy(&wait);
+}
+
+
+/**
+ * The number of global and per-node counters in the time series.
+ */
+#define TIME_SERIES_NUM_GLOBAL   6
+#define TIME_SERIES_NUM_PER_NODE 5
+
+
+/**
+ * Write a row of the time series giving the counters now.
+ */
+static void
+append_time_series(spinn_sim_t *sim)
+{
+	int64_t *row = sim->stat_time_series_row;
+	memset(row, 0, TIME_SERIES_NUM_GLOBAL * sizeof(int64_t));
+	
+	for (size_t i = 0; i < sim->system_size.x*sim->system_size.y; i++) {
+		spinn_node_t *node = &(sim->nodes[i]);
+		row[0] += node->stat_packets_offered;
+		row[1] += node->stat_packets_accepted;
+		row[2] += node->stat_packets_arrived;
+		row[3] += node->stat_packets_dropped;
+		row[4] += node->stat_packets_forwarded;
+	}
+	row[5] = spinn_packet_pool_get_num_in_use(&(sim->pool));
+	
+	for (int i = 0; i < sim->stat_time_series_num_nodes; i++) {
+		spinn_node_t *node = &(sim->nodes[i]);
+		int64_t *node_row = row + TIME_SERIES_NUM_GLOBAL + (i * TIME_SERIES_NUM_PER_NODE);
+		node_row[0] = node->stat_packets_offered;
+		node_row[1] = node->stat_packets_accepted;
+		node_row[2] = node->stat_packets_arrived;
+		node_row[3] = node->stat_packets_dropped;
+		node_row[4] = node->stat_packets_forwarded;
+	}
+	
+	sim->stat_time_series_last = scheduler_get_ticks(&(sim->scheduler)) - sim->stat_start_ticks;
+	time_series_append( &(sim->stat_time_series), sim->stat_file_time_series
+	                  , sim->stat_time_series_last, row
+	                  );
+}
+
+
 /******************************************************************************
  * Callback functions
  ******************************************************************************/
@@ -93,6 +556,22 @@ spinn_sim_stat_log_packet( bool delivered
 	if (!node->sim->stat_started)
 		return;
 	
+	if (node->sim->stat_columnar) {
+		int32_t row[9] = { delivered
+		                 , packet->source.x,      packet->source.y
+		                 , packet->destination.x, packet->destination.y
+		                 , packet->sent_time - node->sim->stat_start_ticks
+		                 , scheduler_get_ticks(&(node->sim->scheduler)) - packet->sent_time
+		                 , packet->num_hops
+		                 , packet->num_emg_hops
+		                 };
+		columnar_append( &(node->sim->stat_columnar_packet_details)
+		               , node->sim->stat_file_packet_details
+		               , row
+		               );
+		return;
+	}
+	
 	fprint_standard_fields(node->sim, node->sim->stat_file_packet_details);
 	fprintf( node->sim->stat_file_packet_details
 	       , "\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\n"
@@ -107,6 +586,43 @@ spinn_sim_stat_log_packet( bool delivered
 }
 
 
+/**
+ * Internal function which adds a delivered packet to the latency histograms of
+ * the current sample.
+ */
+void
+spinn_sim_stat_histogram_packet(spinn_packet_t *packet, spinn_node_t *node)
+{
+	spinn_sim_t *sim = node->sim;
+	
+	// Do nothing when not sampling
+	if (!sim->stat_started)
+		return;
+	
+	int key;
+	switch (sim->stat_histograms_per) {
+		default:
+		case SPINN_SIM_HISTOGRAMS_PER_NONE:
+			key = 0;
+			break;
+		
+		case SPINN_SIM_HISTOGRAMS_PER_SOURCE:
+			key = packet->source.x + (packet->source.y * sim->system_size.x);
+			break;
+		
+		case SPINN_SIM_HISTOGRAMS_PER_HOPS:
+			key = packet->num_hops;
+			spinn_sim_stat_grow_histograms(sim, key + 1);
+			break;
+	}
+	
+	histogram_t *h = &(sim->stat_histograms[key * SPINN_SIM_NUM_HISTOGRAM_METRICS]);
+	histogram_add(&(h[0]), scheduler_get_ticks(&(sim->scheduler)) - packet->sent_time);
+	histogram_add(&(h[1]), packet->num_hops);
+	histogram_add(&(h[2]), packet->num_emg_hops);
+}
+
+
 void *
 spinn_sim_stat_on_packet_gen(spinn_packet_t *packet, void *node_)
 {
@@ -123,15 +639,52 @@ spinn_sim_stat_on_packet_gen(spinn_packet_t *packet, void *node_)
 }
 
 
+void
+spinn_sim_stat_on_packet_inject(spinn_packet_t *packet, void *node_)
+{
+	spinn_node_t *node = (spinn_node_t *)node_;
+	
+	// Record the time packets enter the network in the trace (which may be later
+	// than they were generated, e.g. when queued in a core).
+	if (node->sim->stat_record_trace)
+		spinn_trace_writer_append( &(node->sim->stat_trace_writer)
+		                         , scheduler_get_ticks(&(node->sim->scheduler))
+		                         , packet->source
+		                         , packet->destination
+		                         );
+}
+
+
 void
 spinn_sim_stat_on_packet_con(spinn_packet_t *packet, void *node_)
 {
 	spinn_node_t *node = (spinn_node_t *)node_;
 	
 	node->stat_packets_arrived++;
+	node->sim->stat_latency_sum += scheduler_get_ticks(&(node->sim->scheduler)) - packet->sent_time;
 	
 	if (node->sim->stat_log_delivered_packets)
 		spinn_sim_stat_log_packet(true, packet, node);
+	
+	if (node->sim->stat_file_latency_summary != NULL)
+		spinn_sim_stat_histogram_packet(packet, node);
+	
+	if (node->sim->stat_flow_matrix_valid)
+		spinn_flow_matrix_add_delivered( &(node->sim->stat_flow_matrix)
+		                               , packet->source, node->position
+		                               , scheduler_get_ticks(&(node->sim->scheduler)) - packet->sent_time
+		                               );
+	
+	// The packet leaves the link to the consumer
+	if (node->sim->stat_file_latency_breakdown != NULL) {
+		ticks_t now = scheduler_get_ticks(&(node->sim->scheduler));
+		spinn_packet_stamp(packet, now, SPINN_PACKET_LATENCY_LINK);
+		
+		histogram_t *h = node->sim->stat_breakdown_histograms;
+		for (int i = 0; i < SPINN_PACKET_NUM_LATENCIES; i++)
+			histogram_add(&(h[i]), packet->latency[i]);
+		histogram_add(&(h[SPINN_PACKET_NUM_LATENCIES]), now - packet->sent_time);
+	}
 }
 
 
@@ -145,6 +698,11 @@ spinn_sim_stat_on_drop(spinn_router_t *router, spinn_packet_t *packet, void *nod
 	if (node->sim->stat_log_dropped_packets)
 		spinn_sim_stat_log_packet(false, packet, node);
 	
+	if (node->sim->stat_flow_matrix_valid)
+		spinn_flow_matrix_add_dropped( &(node->sim->stat_flow_matrix)
+		                             , packet->source, packet->destination
+		                             );
+	
 	// Free the packet now we're done with it
 	spinn_packet_pool_pfree(&(node->sim->pool), packet);
 }
@@ -156,6 +714,34 @@ spinn_sim_stat_on_forward(spinn_router_t *router, spinn_packet_t *packet, void *
 	spinn_node_t *node = (spinn_node_t *)node_;
 	
 	node->stat_packets_forwarded++;
+	
+	// The packet leaves the router (each copy of a multicast packet separately)
+	if (node->sim->stat_file_latency_breakdown != NULL)
+		spinn_packet_stamp( packet, scheduler_get_ticks(&(node->sim->scheduler))
+		                  , SPINN_PACKET_LATENCY_ROUTER
+		                  );
+}
+
+
+void
+spinn_sim_stat_on_arbiter_forward(arbiter_t *arbiter, size_t input, void *packet_, void *node_)
+{
+	spinn_node_t   *node   = (spinn_node_t *)node_;
+	spinn_packet_t *packet = (spinn_packet_t *)packet_;
+	
+	ticks_t now = scheduler_get_ticks(&(node->sim->scheduler));
+	
+	if (arbiter == &(node->arb_last)) {
+		// Leaving the arbiter tree for the router
+		spinn_packet_stamp(packet, now, SPINN_PACKET_LATENCY_ARBITER);
+	} else if (arbiter == &(node->arb_w_sw_l)) {
+		// Leaving the generator's buffer (input 1) into the arbiter tree
+		if (input == 1)
+			spinn_packet_stamp(packet, now, SPINN_PACKET_LATENCY_QUEUE);
+	} else if (arbiter != &(node->arb_e_s_ne_n)) {
+		// Leaving a link's input buffer into the arbiter tree
+		spinn_packet_stamp(packet, now, SPINN_PACKET_LATENCY_LINK);
+	}
 }
 
 
@@ -193,7 +779,7 @@ spinn_sim_stat_open_global_counters(spinn_sim_t *sim)
 	if (glbl_packets_offered || glbl_packets_accepted ||
 	    glbl_packets_arrived || glbl_packets_dropped ||
 	    glbl_packets_forwarded) {
-		sim->stat_file_global_counters = fopen(filename, "w");
+		sim->stat_file_global_counters = spinn_sim_stat_fopen(sim, filename);
 		if (sim->stat_file_global_counters == NULL) {
 			fprintf(stderr, "Couldn't open %s for writing!\n", filename);
 			exit(-1);
@@ -217,7 +803,7 @@ spinn_sim_stat_open_global_counters(spinn_sim_t *sim)
 void
 spinn_sim_stat_open_per_node_counters(spinn_sim_t *sim)
 {
-	const char *basename   = "per_node_counters.dat";
+	const char *basename   = sim->stat_columnar ? "per_node_counters.col" : "per_node_counters.dat";
 	const char *result_dir = spinn_sim_config_lookup_string(sim, "measurements.results_directory");
 	
 	// A string long enough for the filename
@@ -244,21 +830,37 @@ spinn_sim_stat_open_per_node_counters(spinn_sim_t *sim)
 	if (per_node_packets_offered || per_node_packets_accepted ||
 	    per_node_packets_arrived || per_node_packets_dropped ||
 	    per_node_packets_forwarded) {
-		sim->stat_file_per_node_counters = fopen(filename, "w");
+		sim->stat_file_per_node_counters = spinn_sim_stat_fopen(sim, filename);
 		if (sim->stat_file_per_node_counters == NULL) {
 			fprintf(stderr, "Couldn't open %s for writing!\n", filename);
 			exit(-1);
 		}
 		
 		// Add the header
-		fprint_standard_fields_headers(sim, sim->stat_file_per_node_counters);
-		fprintf(sim->stat_file_per_node_counters, "\tnode_x\tnode_y");
-		if (per_node_packets_offered)  fprintf(sim->stat_file_per_node_counters, "\tpackets_offered");
-		if (per_node_packets_accepted) fprintf(sim->stat_file_per_node_counters, "\tpackets_accepted");
-		if (per_node_packets_arrived)  fprintf(sim->stat_file_per_node_counters, "\tpackets_arrived");
-		if (per_node_packets_dropped)  fprintf(sim->stat_file_per_node_counters, "\tpackets_dropped");
-		if (per_node_packets_forwarded)fprintf(sim->stat_file_per_node_counters, "\tpackets_forwarded");
-		fprintf(sim->stat_file_per_node_counters, "\n");
+		if (sim->stat_columnar) {
+			const char *column_names[7];
+			int num_columns = 0;
+			column_names[num_columns++] = "node_x";
+			column_names[num_columns++] = "node_y";
+			if (per_node_packets_offered)  column_names[num_columns++] = "packets_offered";
+			if (per_node_packets_accepted) column_names[num_columns++] = "packets_accepted";
+			if (per_node_packets_arrived)  column_names[num_columns++] = "packets_arrived";
+			if (per_node_packets_dropped)  column_names[num_columns++] = "packets_dropped";
+			if (per_node_packets_forwarded)column_names[num_columns++] = "packets_forwarded";
+			init_standard_fields_columnar( sim, &(sim->stat_columnar_per_node_counters)
+			                             , num_columns, column_names
+			                             );
+			columnar_write_header(&(sim->stat_columnar_per_node_counters), sim->stat_file_per_node_counters);
+		} else {
+			fprint_standard_fields_headers(sim, sim->stat_file_per_node_counters);
+			fprintf(sim->stat_file_per_node_counters, "\tnode_x\tnode_y");
+			if (per_node_packets_offered)  fprintf(sim->stat_file_per_node_counters, "\tpackets_offered");
+			if (per_node_packets_accepted) fprintf(sim->stat_file_per_node_counters, "\tpackets_accepted");
+			if (per_node_packets_arrived)  fprintf(sim->stat_file_per_node_counters, "\tpackets_arrived");
+			if (per_node_packets_dropped)  fprintf(sim->stat_file_per_node_counters, "\tpackets_dropped");
+			if (per_node_packets_forwarded)fprintf(sim->stat_file_per_node_counters, "\tpackets_forwarded");
+			fprintf(sim->stat_file_per_node_counters, "\n");
+		}
 	}
 	
 	// Clean up
@@ -267,93 +869,360 @@ spinn_sim_stat_open_per_node_counters(spinn_sim_t *sim)
 
 
 void
-spinn_sim_stat_open_packet_details(spinn_sim_t *sim)
+spinn_sim_stat_open_per_link_counters(spinn_sim_t *sim)
 {
-	const char *basename   = "packet_details.dat";
+	const char *basename   = "per_link_counters.dat";
 	const char *result_dir = spinn_sim_config_lookup_string(sim, "measurements.results_directory");
 	
+	sim->stat_file_per_link_counters = NULL;
+	
+	if (!spinn_sim_config_lookup_bool_default(sim, "measurements.per_link_counters.enabled", false))
+		return;
+	
 	// A string long enough for the filename
 	char *filename = calloc(strlen(result_dir) + strlen(basename) + 1, sizeof(char));
 	assert(filename != NULL);
 	strcpy(filename, result_dir);
 	strcat(filename, basename);
 	
-	// What global stats are being counted?
-	sim->stat_log_delivered_packets = spinn_sim_config_lookup_bool(sim,
-		"measurements.packet_details.delivered_packets");
-	sim->stat_log_dropped_packets = spinn_sim_config_lookup_bool(sim,
-		"measurements.packet_details.dropped_packets");
-	
-	sim->stat_file_packet_details = NULL;
-	
-	// Open the per-node counters file if some are being kept
-	if (sim->stat_log_delivered_packets || sim->stat_log_dropped_packets) {
-		sim->stat_file_packet_details = fopen(filename, "w");
-		if (sim->stat_file_packet_details == NULL) {
-			fprintf(stderr, "Couldn't open %s for writing!\n", filename);
-			exit(-1);
-		}
-		
-		// Add the header
-		fprint_standard_fields_headers(sim, sim->stat_file_packet_details);
-		fprintf(sim->stat_file_packet_details,
-		        "\tdelivered\t"
-		        "source_x\tsource_y\tdest_x\tdest_y\t"
-		        "sent_time\tlatency\tnum_hops\temg_hops\n"
-		        );
+	sim->stat_file_per_link_counters = spinn_sim_stat_fopen(sim, filename);
+	if (sim->stat_file_per_link_counters == NULL) {
+		fprintf(stderr, "Couldn't open %s for writing!\n", filename);
+		exit(-1);
 	}
 	
+	// Add the header
+	fprint_standard_fields_headers(sim, sim->stat_file_per_link_counters);
+	fprintf( sim->stat_file_per_link_counters
+	       , "\tnode_x\tnode_y\tdirection\tboard_to_board"
+	         "\trouter_packets\trouter_blocked\tlink_packets\tlink_blocked\n"
+	       );
+	
 	// Clean up
 	free(filename);
 }
 
 
 void
-spinn_sim_stat_open_simulator(spinn_sim_t *sim)
+spinn_sim_stat_open_buffer_occupancy(spinn_sim_t *sim)
 {
-	const char *basename   = "simulator.dat";
+	const char *basename   = "buffer_occupancy.dat";
 	const char *result_dir = spinn_sim_config_lookup_string(sim, "measurements.results_directory");
 	
+	sim->stat_file_buffer_occupancy = NULL;
+	
+	if (!spinn_sim_config_lookup_bool_default(sim, "measurements.buffer_occupancy.enabled", false))
+		return;
+	
+	sim->stat_buffer_occupancy_per_node = spinn_sim_config_lookup_bool_default(sim,
+		"measurements.buffer_occupancy.per_node", false);
+	
 	// A string long enough for the filename
 	char *filename = calloc(strlen(result_dir) + strlen(basename) + 1, sizeof(char));
 	assert(filename != NULL);
 	strcpy(filename, result_dir);
 	strcat(filename, basename);
 	
-	// What global stats are being counted?
-	bool warmup_ticks = spinn_sim_config_lookup_bool(sim,
-		"measurements.simulator.warmup_ticks");
-	bool warmup_duration = spinn_sim_config_lookup_bool(sim,
-		"measurements.simulator.warmup_duration");
-	bool warmup_packet_pool_size = spinn_sim_config_lookup_bool(sim,
-		"measurements.simulator.warmup_packet_pool_size");
-	bool sample_ticks = spinn_sim_config_lookup_bool(sim,
-		"measurements.simulator.sample_ticks");
-	bool sample_duration = spinn_sim_config_lookup_bool(sim,
-		"measurements.simulator.sample_duration");
-	bool sample_packet_pool_size = spinn_sim_config_lookup_bool(sim,
-		"measurements.simulator.sample_packet_pool_size");
+	sim->stat_file_buffer_occupancy = spinn_sim_stat_fopen(sim, filename);
+	if (sim->stat_file_buffer_occupancy == NULL) {
+		fprintf(stderr, "Couldn't open %s for writing!\n", filename);
+		exit(-1);
+	}
 	
-	sim->stat_file_simulator = NULL;
+	// Add the header
+	fprint_standard_fields_headers(sim, sim->stat_file_buffer_occupancy);
+	if (sim->stat_buffer_occupancy_per_node)
+		fprintf(sim->stat_file_buffer_occupancy, "\tnode_x\tnode_y");
+	fprintf( sim->stat_file_buffer_occupancy
+	       , "\trole\tbuffer_length\tmean_occupancy\toccupancy_fractions\n"
+	       );
 	
-	// Open the per-node counters file if some are being kept
-	if (warmup_duration || sample_duration ||
-			warmup_packet_pool_size || sample_packet_pool_size ||
-			warmup_ticks || sample_ticks) {
-		sim->stat_file_simulator = fopen(filename, "w");
-		if (sim->stat_file_simulator == NULL) {
-			fprintf(stderr, "Couldn't open %s for writing!\n", filename);
-			exit(-1);
-		}
-		
-		// Add the header
-		fprint_standard_fields_headers(sim, sim->stat_file_simulator);
-		if (warmup_ticks)            fprintf(sim->stat_file_simulator, "\twarmup_ticks");
-		if (warmup_duration)         fprintf(sim->stat_file_simulator, "\twarmup_duration");
-		if (warmup_packet_pool_size) fprintf(sim->stat_file_simulator, "\twarmup_packet_pool_size");
+	// Clean up
+	free(filename);
+}
+
+
+void
+spinn_sim_stat_open_router_stats(spinn_sim_t *sim)
+{
+	const char *basename   = "router_stats.dat";
+	const char *result_dir = spinn_sim_config_lookup_string(sim, "measurements.results_directory");
+	
+	sim->stat_file_router_stats = NULL;
+	
+	if (!spinn_sim_config_lookup_bool_default(sim, "measurements.router_stats.enabled", false))
+		return;
+	
+	sim->stat_router_stats_per_node = spinn_sim_config_lookup_bool_default(sim,
+		"measurements.router_stats.per_node", false);
+	sim->stat_router_stats_precision = spinn_sim_config_lookup_int_default(sim,
+		"measurements.router_stats.precision", 5);
+	if (sim->stat_router_stats_precision < 0 || sim->stat_router_stats_precision > 16) {
+		fprintf(stderr, "Error: measurements.router_stats.precision must be 0-16.\n");
+		exit(-1);
+	}
+	
+	// A string long enough for the filename
+	char *filename = calloc(strlen(result_dir) + strlen(basename) + 1, sizeof(char));
+	assert(filename != NULL);
+	strcpy(filename, result_dir);
+	strcat(filename, basename);
+	
+	sim->stat_file_router_stats = spinn_sim_stat_fopen(sim, filename);
+	if (sim->stat_file_router_stats == NULL) {
+		fprintf(stderr, "Couldn't open %s for writing!\n", filename);
+		exit(-1);
+	}
+	
+	// Add the header
+	fprint_standard_fields_headers(sim, sim->stat_file_router_stats);
+	if (sim->stat_router_stats_per_node)
+		fprintf(sim->stat_file_router_stats, "\tnode_x\tnode_y");
+	fprintf( sim->stat_file_router_stats
+	       , "\tcycles\tstall_cycles\tbubble_cycles\tmean_pipeline_occupancy"
+	         "\tfirst_timeouts\temg_routed\tfinal_timeouts\tdropped"
+	         "\twait_count\twait_mean\twait_p50\twait_p90\twait_p99\twait_max\n"
+	       );
+	
+	// Clean up
+	free(filename);
+}
+
+
+void
+spinn_sim_stat_open_arbiter_contention(spinn_sim_t *sim)
+{
+	const char *basename   = "arbiter_contention.dat";
+	const char *result_dir = spinn_sim_config_lookup_string(sim, "measurements.results_directory");
+	
+	sim->stat_file_arbiter_contention = NULL;
+	
+	if (!spinn_sim_config_lookup_bool_default(sim, "measurements.arbiter_contention.enabled", false))
+		return;
+	
+	sim->stat_arbiter_contention_per_node = spinn_sim_config_lookup_bool_default(sim,
+		"measurements.arbiter_contention.per_node", false);
+	
+	// A string long enough for the filename
+	char *filename = calloc(strlen(result_dir) + strlen(basename) + 1, sizeof(char));
+	assert(filename != NULL);
+	strcpy(filename, result_dir);
+	strcat(filename, basename);
+	
+	sim->stat_file_arbiter_contention = spinn_sim_stat_fopen(sim, filename);
+	if (sim->stat_file_arbiter_contention == NULL) {
+		fprintf(stderr, "Couldn't open %s for writing!\n", filename);
+		exit(-1);
+	}
+	
+	// Add the header
+	fprint_standard_fields_headers(sim, sim->stat_file_arbiter_contention);
+	if (sim->stat_arbiter_contention_per_node)
+		fprintf(sim->stat_file_arbiter_contention, "\tnode_x\tnode_y");
+	fprintf( sim->stat_file_arbiter_contention
+	       , "\tlevel\tarbiter"
+	         "\tinput_0\tinput_0_granted\tinput_0_waiting"
+	         "\tinput_1\tinput_1_granted\tinput_1_waiting"
+	         "\tblocked\n"
+	       );
+	
+	// Clean up
+	free(filename);
+}
+
+
+void
+spinn_sim_stat_open_time_series(spinn_sim_t *sim)
+{
+	const char *basename   = "time_series.bin";
+	const char *result_dir = spinn_sim_config_lookup_string(sim, "measurements.results_directory");
+	
+	const char *global_names[TIME_SERIES_NUM_GLOBAL] = {
+		"packets_offered", "packets_accepted", "packets_arrived",
+		"packets_dropped", "packets_forwarded", "packets_in_flight",
+	};
+	
+	sim->stat_file_time_series = NULL;
+	
+	if (!spinn_sim_config_lookup_bool_default(sim, "measurements.time_series.enabled", false))
+		return;
+	
+	sim->stat_time_series_window = spinn_sim_config_lookup_int_default(sim,
+		"measurements.time_series.window", 1000);
+	if (sim->stat_time_series_window <= 0) {
+		fprintf(stderr, "Error: measurements.time_series.window must be positive.\n");
+		exit(-1);
+	}
+	
+	// The per-node counters are given for every node of the system (whose size
+	// must not change between groups).
+	spinn_coord_t size = {0, 0};
+	if (spinn_sim_config_lookup_bool_default(sim, "measurements.time_series.per_node", false)) {
+		bool use_wrap_around_links;
+		size = spinn_sim_model_get_system_size(sim, &use_wrap_around_links);
+	}
+	sim->stat_time_series_num_nodes = size.x * size.y;
+	
+	// Name the columns (per-node counters are suffixed with the node's position)
+	int num_columns = TIME_SERIES_NUM_GLOBAL
+	                + (sim->stat_time_series_num_nodes * TIME_SERIES_NUM_PER_NODE);
+	char **column_names = calloc(num_columns, sizeof(char *));
+	assert(column_names != NULL);
+	for (int i = 0; i < num_columns; i++) {
+		const char *name = global_names[(i < TIME_SERIES_NUM_GLOBAL)
+		                                ? i
+		                                : (i - TIME_SERIES_NUM_GLOBAL) % TIME_SERIES_NUM_PER_NODE];
+		column_names[i] = calloc(strlen(name) + 32, sizeof(char));
+		assert(column_names[i] != NULL);
+		
+		if (i < TIME_SERIES_NUM_GLOBAL) {
+			strcpy(column_names[i], name);
+		} else {
+			int node = (i - TIME_SERIES_NUM_GLOBAL) / TIME_SERIES_NUM_PER_NODE;
+			sprintf(column_names[i], "%s_%d_%d", name, node % size.x, node / size.x);
+		}
+	}
+	
+	// A string long enough for the filename
+	char *filename = calloc(strlen(result_dir) + strlen(basename) + 1, sizeof(char));
+	assert(filename != NULL);
+	strcpy(filename, result_dir);
+	strcat(filename, basename);
+	
+	sim->stat_file_time_series = spinn_sim_stat_fopen(sim, filename);
+	if (sim->stat_file_time_series == NULL) {
+		fprintf(stderr, "Couldn't open %s for writing!\n", filename);
+		exit(-1);
+	}
+	
+	// Add the header
+	const char **label_names = get_standard_fields_names(sim);
+	time_series_init( &(sim->stat_time_series)
+	                , 2 + sim->num_ivars, label_names
+	                , num_columns, (const char **)column_names
+	                );
+	time_series_write_header(&(sim->stat_time_series), sim->stat_file_time_series);
+	
+	sim->stat_time_series_row = calloc(num_columns, sizeof(int64_t));
+	assert(sim->stat_time_series_row != NULL);
+	
+	// Clean up
+	free(label_names);
+	for (int i = 0; i < num_columns; i++)
+		free(column_names[i]);
+	free(column_names);
+	free(filename);
+}
+
+
+void
+spinn_sim_stat_open_packet_details(spinn_sim_t *sim)
+{
+	const char *basename   = sim->stat_columnar ? "packet_details.col" : "packet_details.dat";
+	const char *result_dir = spinn_sim_config_lookup_string(sim, "measurements.results_directory");
+	
+	// A string long enough for the filename
+	char *filename = calloc(strlen(result_dir) + strlen(basename) + 1, sizeof(char));
+	assert(filename != NULL);
+	strcpy(filename, result_dir);
+	strcat(filename, basename);
+	
+	// What global stats are being counted?
+	sim->stat_log_delivered_packets = spinn_sim_config_lookup_bool(sim,
+		"measurements.packet_details.delivered_packets");
+	sim->stat_log_dropped_packets = spinn_sim_config_lookup_bool(sim,
+		"measurements.packet_details.dropped_packets");
+	
+	sim->stat_file_packet_details = NULL;
+	
+	// Open the per-node counters file if some are being kept
+	if (sim->stat_log_delivered_packets || sim->stat_log_dropped_packets) {
+		sim->stat_file_packet_details = spinn_sim_stat_fopen(sim, filename);
+		if (sim->stat_file_packet_details == NULL) {
+			fprintf(stderr, "Couldn't open %s for writing!\n", filename);
+			exit(-1);
+		}
+		
+		// Add the header
+		if (sim->stat_columnar) {
+			const char *column_names[9] = { "delivered"
+			                              , "source_x", "source_y", "dest_x", "dest_y"
+			                              , "sent_time", "latency", "num_hops", "emg_hops"
+			                              };
+			init_standard_fields_columnar( sim, &(sim->stat_columnar_packet_details)
+			                             , 9, column_names
+			                             );
+			columnar_write_header(&(sim->stat_columnar_packet_details), sim->stat_file_packet_details);
+		} else {
+			fprint_standard_fields_headers(sim, sim->stat_file_packet_details);
+			fprintf(sim->stat_file_packet_details,
+			        "\tdelivered\t"
+			        "source_x\tsource_y\tdest_x\tdest_y\t"
+			        "sent_time\tlatency\tnum_hops\temg_hops\n"
+			        );
+		}
+	}
+	
+	// Clean up
+	free(filename);
+}
+
+
+void
+spinn_sim_stat_open_simulator(spinn_sim_t *sim)
+{
+	const char *basename   = "simulator.dat";
+	const char *result_dir = spinn_sim_config_lookup_string(sim, "measurements.results_directory");
+	
+	// A string long enough for the filename
+	char *filename = calloc(strlen(result_dir) + strlen(basename) + 1, sizeof(char));
+	assert(filename != NULL);
+	strcpy(filename, result_dir);
+	strcat(filename, basename);
+	
+	// What global stats are being counted?
+	bool warmup_ticks = spinn_sim_config_lookup_bool(sim,
+		"measurements.simulator.warmup_ticks");
+	bool warmup_duration = spinn_sim_config_lookup_bool(sim,
+		"measurements.simulator.warmup_duration");
+	bool warmup_packet_pool_size = spinn_sim_config_lookup_bool(sim,
+		"measurements.simulator.warmup_packet_pool_size");
+	bool sample_ticks = spinn_sim_config_lookup_bool(sim,
+		"measurements.simulator.sample_ticks");
+	bool sample_duration = spinn_sim_config_lookup_bool(sim,
+		"measurements.simulator.sample_duration");
+	bool sample_packet_pool_size = spinn_sim_config_lookup_bool(sim,
+		"measurements.simulator.sample_packet_pool_size");
+	bool sample_confidence_intervals = spinn_sim_config_lookup_bool(sim,
+		"measurements.simulator.sample_confidence_intervals");
+	bool terminated = spinn_sim_config_lookup_bool(sim,
+		"measurements.simulator.terminated");
+	
+	sim->stat_file_simulator = NULL;
+	
+	// Open the per-node counters file if some are being kept
+	if (warmup_duration || sample_duration ||
+			warmup_packet_pool_size || sample_packet_pool_size ||
+			warmup_ticks || sample_ticks || sample_confidence_intervals ||
+			terminated) {
+		sim->stat_file_simulator = spinn_sim_stat_fopen(sim, filename);
+		if (sim->stat_file_simulator == NULL) {
+			fprintf(stderr, "Couldn't open %s for writing!\n", filename);
+			exit(-1);
+		}
+		
+		// Add the header
+		fprint_standard_fields_headers(sim, sim->stat_file_simulator);
+		if (warmup_ticks)            fprintf(sim->stat_file_simulator, "\twarmup_ticks");
+		if (warmup_duration)         fprintf(sim->stat_file_simulator, "\twarmup_duration");
+		if (warmup_packet_pool_size) fprintf(sim->stat_file_simulator, "\twarmup_packet_pool_size");
 		if (sample_ticks)            fprintf(sim->stat_file_simulator, "\tsample_ticks");
 		if (sample_duration)         fprintf(sim->stat_file_simulator, "\tsample_duration");
 		if (sample_packet_pool_size) fprintf(sim->stat_file_simulator, "\tsample_packet_pool_size");
+		if (sample_confidence_intervals)
+			fprintf(sim->stat_file_simulator, "\tsample_throughput\tsample_throughput_half_width"
+			                                  "\tsample_latency\tsample_latency_half_width");
+		if (terminated)              fprintf(sim->stat_file_simulator, "\tterminated");
 		fprintf(sim->stat_file_simulator, "\n");
 	}
 	
@@ -363,6 +1232,259 @@ spinn_sim_stat_open_simulator(spinn_sim_t *sim)
 
 
 
+void
+spinn_sim_stat_open_saturation(spinn_sim_t *sim)
+{
+	const char *basename   = "saturation.dat";
+	const char *result_dir = spinn_sim_config_lookup_string(sim, "measurements.results_directory");
+	
+	sim->stat_file_saturation = NULL;
+	
+	// Only produced when searching for the saturation point
+	if (!spinn_sim_config_lookup_bool(sim, "experiment.saturation_search.enabled"))
+		return;
+	
+	// A string long enough for the filename
+	char *filename = calloc(strlen(result_dir) + strlen(basename) + 1, sizeof(char));
+	assert(filename != NULL);
+	strcpy(filename, result_dir);
+	strcat(filename, basename);
+	
+	sim->stat_file_saturation = spinn_sim_stat_fopen(sim, filename);
+	if (sim->stat_file_saturation == NULL) {
+		fprintf(stderr, "Couldn't open %s for writing!\n", filename);
+		exit(-1);
+	}
+	
+	// Add the header
+	fprint_standard_fields_headers(sim, sim->stat_file_saturation);
+	fprintf(sim->stat_file_saturation, "\tsaturation_point\tlower_bound\tupper_bound\tnum_probes\n");
+	
+	// Clean up
+	free(filename);
+}
+
+
+
+
+void
+spinn_sim_stat_open_paired_differences(spinn_sim_t *sim)
+{
+	const char *basename   = "paired_differences.dat";
+	const char *result_dir = spinn_sim_config_lookup_string(sim, "measurements.results_directory");
+	
+	const char *metrics[SPINN_SIM_NUM_PAIRED_METRICS] = {
+		"packets_offered", "packets_accepted", "packets_arrived",
+		"packets_dropped", "packets_forwarded", "latency",
+	};
+	
+	sim->stat_file_paired_differences = NULL;
+	sim->stat_baseline                = NULL;
+	sim->stat_baseline_num_samples    = 0;
+	
+	// Only produced when using common random numbers
+	if (!spinn_sim_config_lookup_bool(sim, "experiment.common_random_numbers.enabled"))
+		return;
+	
+	// The probes of a saturation search are made at differing loads so can't be
+	// paired with those of another group (and no group's samples are summarised)
+	if (spinn_sim_config_lookup_bool(sim, "experiment.saturation_search.enabled")) {
+		fprintf(stderr, "Error: experiment.common_random_numbers can't be used with experiment.saturation_search.\n");
+		exit(-1);
+	}
+	
+	// A string long enough for the filename
+	char *filename = calloc(strlen(result_dir) + strlen(basename) + 1, sizeof(char));
+	assert(filename != NULL);
+	strcpy(filename, result_dir);
+	strcat(filename, basename);
+	
+	sim->stat_file_paired_differences = spinn_sim_stat_fopen(sim, filename);
+	if (sim->stat_file_paired_differences == NULL) {
+		fprintf(stderr, "Couldn't open %s for writing!\n", filename);
+		exit(-1);
+	}
+	
+	// Add the header
+	fprint_standard_fields_headers(sim, sim->stat_file_paired_differences);
+	fprintf(sim->stat_file_paired_differences, "\tnum_pairs");
+	for (int i = 0; i < SPINN_SIM_NUM_PAIRED_METRICS; i++)
+		fprintf( sim->stat_file_paired_differences, "\t%s\t%s_half_width\t%s_diff\t%s_diff_half_width"
+		       , metrics[i], metrics[i], metrics[i], metrics[i]
+		       );
+	fprintf(sim->stat_file_paired_differences, "\n");
+	
+	// Clean up
+	free(filename);
+}
+
+
+void
+spinn_sim_stat_open_latency_histograms(spinn_sim_t *sim)
+{
+	const char *summary_basename    = "latency_summary.dat";
+	const char *histograms_basename = "latency_histograms.dat";
+	const char *result_dir = spinn_sim_config_lookup_string(sim, "measurements.results_directory");
+	
+	sim->stat_file_latency_summary    = NULL;
+	sim->stat_file_latency_histograms = NULL;
+	sim->stat_histograms              = NULL;
+	sim->stat_histograms_num_keys     = 0;
+	
+	if (!spinn_sim_config_lookup_bool_default(sim, "measurements.latency_histograms.enabled", false))
+		return;
+	
+	sim->stat_histograms_precision = spinn_sim_config_lookup_int_default(sim,
+		"measurements.latency_histograms.precision", 5);
+	if (sim->stat_histograms_precision < 0 || sim->stat_histograms_precision > 16) {
+		fprintf(stderr, "Error: measurements.latency_histograms.precision must be 0-16.\n");
+		exit(-1);
+	}
+	
+	const char *per = spinn_sim_config_lookup_string_default(sim,
+		"measurements.latency_histograms.per", "none");
+	const char *key_headers;
+	if (strcmp(per, "none") == 0) {
+		sim->stat_histograms_per = SPINN_SIM_HISTOGRAMS_PER_NONE;
+		key_headers = "";
+	} else if (strcmp(per, "source") == 0) {
+		sim->stat_histograms_per = SPINN_SIM_HISTOGRAMS_PER_SOURCE;
+		key_headers = "\tsource_x\tsource_y";
+	} else if (strcmp(per, "hops") == 0) {
+		sim->stat_histograms_per = SPINN_SIM_HISTOGRAMS_PER_HOPS;
+		key_headers = "\tnum_hops";
+	} else {
+		fprintf(stderr, "Error: Unknown measurements.latency_histograms.per '%s'.\n", per);
+		exit(-1);
+	}
+	
+	// A string long enough for either filename
+	char *filename = calloc( strlen(result_dir)
+	                         + strlen(histograms_basename) + strlen(summary_basename) + 1
+	                       , sizeof(char)
+	                       );
+	assert(filename != NULL);
+	
+	strcpy(filename, result_dir);
+	strcat(filename, summary_basename);
+	sim->stat_file_latency_summary = spinn_sim_stat_fopen(sim, filename);
+	if (sim->stat_file_latency_summary == NULL) {
+		fprintf(stderr, "Couldn't open %s for writing!\n", filename);
+		exit(-1);
+	}
+	
+	fprint_standard_fields_headers(sim, sim->stat_file_latency_summary);
+	fprintf( sim->stat_file_latency_summary
+	       , "%s\tmetric\tcount\tmean\tp50\tp90\tp99\tp99_9\tmax\n"
+	       , key_headers
+	       );
+	
+	if (spinn_sim_config_lookup_bool_default(sim, "measurements.latency_histograms.buckets", false)) {
+		strcpy(filename, result_dir);
+		strcat(filename, histograms_basename);
+		sim->stat_file_latency_histograms = spinn_sim_stat_fopen(sim, filename);
+		if (sim->stat_file_latency_histograms == NULL) {
+			fprintf(stderr, "Couldn't open %s for writing!\n", filename);
+			exit(-1);
+		}
+		
+		fprint_standard_fields_headers(sim, sim->stat_file_latency_histograms);
+		fprintf( sim->stat_file_latency_histograms
+		       , "%s\tmetric\tbucket_lower\tbucket_upper\tcount\n"
+		       , key_headers
+		       );
+	}
+	
+	// Clean up
+	free(filename);
+}
+
+
+void
+spinn_sim_stat_open_latency_breakdown(spinn_sim_t *sim)
+{
+	const char *summary_basename    = "latency_breakdown.dat";
+	const char *histograms_basename = "latency_breakdown_histograms.dat";
+	const char *result_dir = spinn_sim_config_lookup_string(sim, "measurements.results_directory");
+	
+	sim->stat_file_latency_breakdown            = NULL;
+	sim->stat_file_latency_breakdown_histograms = NULL;
+	
+	if (!spinn_sim_config_lookup_bool_default(sim, "measurements.latency_breakdown.enabled", false))
+		return;
+	
+	int precision = spinn_sim_config_lookup_int_default(sim,
+		"measurements.latency_breakdown.precision", 5);
+	if (precision < 0 || precision > 16) {
+		fprintf(stderr, "Error: measurements.latency_breakdown.precision must be 0-16.\n");
+		exit(-1);
+	}
+	for (int i = 0; i < SPINN_PACKET_NUM_LATENCIES + 1; i++)
+		histogram_init(&(sim->stat_breakdown_histograms[i]), precision);
+	
+	// A string long enough for either filename
+	char *filename = calloc( strlen(result_dir)
+	                         + strlen(histograms_basename) + strlen(summary_basename) + 1
+	                       , sizeof(char)
+	                       );
+	assert(filename != NULL);
+	
+	strcpy(filename, result_dir);
+	strcat(filename, summary_basename);
+	sim->stat_file_latency_breakdown = spinn_sim_stat_fopen(sim, filename);
+	if (sim->stat_file_latency_breakdown == NULL) {
+		fprintf(stderr, "Couldn't open %s for writing!\n", filename);
+		exit(-1);
+	}
+	
+	fprint_standard_fields_headers(sim, sim->stat_file_latency_breakdown);
+	fprintf( sim->stat_file_latency_breakdown
+	       , "\tcomponent\tcount\tmean\tfraction\tp50\tp90\tp99\tp99_9\tmax\n"
+	       );
+	
+	if (spinn_sim_config_lookup_bool_default(sim, "measurements.latency_breakdown.buckets", false)) {
+		strcpy(filename, result_dir);
+		strcat(filename, histograms_basename);
+		sim->stat_file_latency_breakdown_histograms = spinn_sim_stat_fopen(sim, filename);
+		if (sim->stat_file_latency_breakdown_histograms == NULL) {
+			fprintf(stderr, "Couldn't open %s for writing!\n", filename);
+			exit(-1);
+		}
+		
+		fprint_standard_fields_headers(sim, sim->stat_file_latency_breakdown_histograms);
+		fprintf( sim->stat_file_latency_breakdown_histograms
+		       , "\tcomponent\tbucket_lower\tbucket_upper\tcount\n"
+		       );
+	}
+	
+	// Clean up
+	free(filename);
+}
+
+
+void
+spinn_sim_stat_open_flow_matrix(spinn_sim_t *sim)
+{
+	sim->stat_flow_matrix_valid = false;
+	
+	sim->stat_flow_matrix_enabled = spinn_sim_config_lookup_bool_default(sim,
+		"measurements.flow_matrix.enabled", false);
+	if (!sim->stat_flow_matrix_enabled)
+		return;
+	
+	const char *per = spinn_sim_config_lookup_string_default(sim,
+		"measurements.flow_matrix.per", "board");
+	if (strcmp(per, "board") == 0) {
+		sim->stat_flow_matrix_per_node = false;
+	} else if (strcmp(per, "node") == 0) {
+		sim->stat_flow_matrix_per_node = true;
+	} else {
+		fprintf(stderr, "Error: Unknown measurements.flow_matrix.per '%s'.\n", per);
+		exit(-1);
+	}
+}
+
+
 /******************************************************************************
  * Destroy Functions
  ******************************************************************************/
@@ -379,18 +1501,72 @@ spinn_sim_stat_close_global_counters(spinn_sim_t *sim)
 void
 spinn_sim_stat_close_per_node_counters(spinn_sim_t *sim)
 {
-	if (sim->stat_file_per_node_counters != NULL)
+	if (sim->stat_file_per_node_counters != NULL) {
+		if (sim->stat_columnar)
+			columnar_destroy(&(sim->stat_columnar_per_node_counters));
 		if (fclose(sim->stat_file_per_node_counters) != 0)
 			fprintf(stderr, "Error closing per-node counters data file.\n");
+	}
+}
+
+
+void
+spinn_sim_stat_close_per_link_counters(spinn_sim_t *sim)
+{
+	if (sim->stat_file_per_link_counters != NULL)
+		if (fclose(sim->stat_file_per_link_counters) != 0)
+			fprintf(stderr, "Error closing per-link counters data file.\n");
+}
+
+
+void
+spinn_sim_stat_close_buffer_occupancy(spinn_sim_t *sim)
+{
+	if (sim->stat_file_buffer_occupancy != NULL)
+		if (fclose(sim->stat_file_buffer_occupancy) != 0)
+			fprintf(stderr, "Error closing buffer occupancy data file.\n");
+}
+
+
+void
+spinn_sim_stat_close_router_stats(spinn_sim_t *sim)
+{
+	if (sim->stat_file_router_stats != NULL)
+		if (fclose(sim->stat_file_router_stats) != 0)
+			fprintf(stderr, "Error closing router stats data file.\n");
+}
+
+
+void
+spinn_sim_stat_close_arbiter_contention(spinn_sim_t *sim)
+{
+	if (sim->stat_file_arbiter_contention != NULL)
+		if (fclose(sim->stat_file_arbiter_contention) != 0)
+			fprintf(stderr, "Error closing arbiter contention data file.\n");
+}
+
+
+void
+spinn_sim_stat_close_time_series(spinn_sim_t *sim)
+{
+	if (sim->stat_file_time_series != NULL) {
+		time_series_destroy(&(sim->stat_time_series));
+		free(sim->stat_time_series_row);
+		if (fclose(sim->stat_file_time_series) != 0)
+			fprintf(stderr, "Error closing time series data file.\n");
+	}
 }
 
 
 void
 spinn_sim_stat_close_packet_details(spinn_sim_t *sim)
 {
-	if (sim->stat_file_packet_details != NULL)
+	if (sim->stat_file_packet_details != NULL) {
+		if (sim->stat_columnar)
+			columnar_destroy(&(sim->stat_columnar_packet_details));
 		if (fclose(sim->stat_file_packet_details) != 0)
 			fprintf(stderr, "Error closing packet details data file.\n");
+	}
 }
 
 
@@ -403,6 +1579,73 @@ spinn_sim_stat_close_simulator(spinn_sim_t *sim)
 }
 
 
+void
+spinn_sim_stat_close_saturation(spinn_sim_t *sim)
+{
+	if (sim->stat_file_saturation != NULL)
+		if (fclose(sim->stat_file_saturation) != 0)
+			fprintf(stderr, "Error closing saturation data file.\n");
+}
+
+
+void
+spinn_sim_stat_close_paired_differences(spinn_sim_t *sim)
+{
+	if (sim->stat_file_paired_differences != NULL)
+		if (fclose(sim->stat_file_paired_differences) != 0)
+			fprintf(stderr, "Error closing paired differences data file.\n");
+	
+	free(sim->stat_baseline);
+	sim->stat_baseline = NULL;
+}
+
+
+void
+spinn_sim_stat_close_latency_histograms(spinn_sim_t *sim)
+{
+	if (sim->stat_file_latency_summary != NULL)
+		if (fclose(sim->stat_file_latency_summary) != 0)
+			fprintf(stderr, "Error closing latency summary data file.\n");
+	
+	if (sim->stat_file_latency_histograms != NULL)
+		if (fclose(sim->stat_file_latency_histograms) != 0)
+			fprintf(stderr, "Error closing latency histograms data file.\n");
+	
+	for (int i = 0; i < sim->stat_histograms_num_keys * SPINN_SIM_NUM_HISTOGRAM_METRICS; i++)
+		histogram_destroy(&(sim->stat_histograms[i]));
+	free(sim->stat_histograms);
+	sim->stat_histograms          = NULL;
+	sim->stat_histograms_num_keys = 0;
+}
+
+
+void
+spinn_sim_stat_close_latency_breakdown(spinn_sim_t *sim)
+{
+	if (sim->stat_file_latency_breakdown == NULL)
+		return;
+	
+	if (fclose(sim->stat_file_latency_breakdown) != 0)
+		fprintf(stderr, "Error closing latency breakdown data file.\n");
+	
+	if (sim->stat_file_latency_breakdown_histograms != NULL)
+		if (fclose(sim->stat_file_latency_breakdown_histograms) != 0)
+			fprintf(stderr, "Error closing latency breakdown histograms data file.\n");
+	
+	for (int i = 0; i < SPINN_PACKET_NUM_LATENCIES + 1; i++)
+		histogram_destroy(&(sim->stat_breakdown_histograms[i]));
+}
+
+
+void
+spinn_sim_stat_close_flow_matrix(spinn_sim_t *sim)
+{
+	if (sim->stat_flow_matrix_valid)
+		spinn_flow_matrix_destroy(&(sim->stat_flow_matrix));
+	sim->stat_flow_matrix_valid = false;
+}
+
+
 /******************************************************************************
  * Warmup Start Functions
  ******************************************************************************/
@@ -483,16 +1726,174 @@ spinn_sim_stat_start_sample_per_node_counters(spinn_sim_t *sim)
 
 
 void
-spinn_sim_stat_start_sample_packet_details(spinn_sim_t *sim)
+spinn_sim_stat_start_sample_per_link_counters(spinn_sim_t *sim)
+{
+	if (sim->stat_file_per_link_counters == NULL)
+		return;
+	
+	for (size_t i = 0; i < sim->system_size.x*sim->system_size.y; i++) {
+		spinn_router_reset_counters(&(sim->nodes[i].router));
+		for (int j = 0; j < 6; j++)
+			delay_reset_counters(&(sim->nodes[i].delays[j]));
+	}
+}
+
+
+void
+spinn_sim_stat_start_sample_buffer_occupancy(spinn_sim_t *sim)
+{
+	if (sim->stat_file_buffer_occupancy == NULL)
+		return;
+	
+	// (Re)start recording the occupancy of every buffer
+	for (size_t i = 0; i < sim->system_size.x*sim->system_size.y; i++) {
+		for (int role = 0; role < SPINN_SIM_NUM_BUFFER_ROLES; role++) {
+			buffer_t *buffers[6];
+			int num_buffers = get_role_buffers(&(sim->nodes[i]), role, buffers);
+			for (int j = 0; j < num_buffers; j++)
+				buffer_enable_stats(buffers[j], &(sim->scheduler));
+		}
+	}
+}
+
+
+void
+spinn_sim_stat_start_sample_router_stats(spinn_sim_t *sim)
+{
+	if (sim->stat_file_router_stats == NULL)
+		return;
+	
+	for (size_t i = 0; i < sim->system_size.x*sim->system_size.y; i++) {
+		spinn_router_enable_wait_histogram( &(sim->nodes[i].router)
+		                                  , sim->stat_router_stats_precision
+		                                  );
+		spinn_router_reset_counters(&(sim->nodes[i].router));
+	}
+}
+
+
+void
+spinn_sim_stat_start_sample_arbiter_contention(spinn_sim_t *sim)
+{
+	if (sim->stat_file_arbiter_contention == NULL)
+		return;
+	
+	// Only enabled nodes have arbiters
+	for (size_t i = 0; i < sim->system_size.x*sim->system_size.y; i++)
+		if (sim->nodes[i].enabled)
+			for (int arbiter = 0; arbiter < NUM_ARBITERS; arbiter++)
+				arbiter_reset_counters(get_arbiter(&(sim->nodes[i]), arbiter));
+}
+
+
+void
+spinn_sim_stat_start_sample_time_series(spinn_sim_t *sim)
+{
+	if (sim->stat_file_time_series == NULL)
+		return;
+	
+	if (sim->stat_time_series_num_nodes > 0 &&
+	    sim->stat_time_series_num_nodes != sim->system_size.x * sim->system_size.y) {
+		fprintf(stderr, "Error: measurements.time_series.per_node requires the system size to be the same in every group.\n");
+		exit(-1);
+	}
+	
+	char *fields;
+	const char **values = get_standard_fields_values(sim, &fields);
+	time_series_set_labels(&(sim->stat_time_series), sim->stat_file_time_series, values);
+	free(values);
+	free(fields);
+	
+	sim->stat_time_series_last = 0;
+}
+
+
+void
+spinn_sim_stat_start_sample_packet_details(spinn_sim_t *sim)
+{
+	// Columnar tables give the common fields once for all following packets
+	if (sim->stat_columnar && sim->stat_file_packet_details != NULL)
+		set_standard_fields_labels( sim, &(sim->stat_columnar_packet_details)
+		                          , sim->stat_file_packet_details
+		                          );
+}
+
+
+void
+spinn_sim_stat_start_sample_simulator(spinn_sim_t *sim)
+{
+	// Reset the confidence interval estimates (batches are added by the sample
+	// loop in spinn_sim_run_groups)
+	double confidence = spinn_sim_config_lookup_float(sim,
+		"experiment.adaptive_sample.confidence");
+	batch_means_init(&(sim->stat_sample_throughput), confidence);
+	batch_means_init(&(sim->stat_sample_latency), confidence);
+	sim->stat_latency_sum = 0;
+}
+
+
+void
+spinn_sim_stat_start_sample_latency_histograms(spinn_sim_t *sim)
+{
+	if (sim->stat_file_latency_summary == NULL)
+		return;
+	
+	// Every node has its own key when keeping histograms per source (the system
+	// size is only known once the model has been created)
+	if (sim->stat_histograms_per == SPINN_SIM_HISTOGRAMS_PER_SOURCE)
+		spinn_sim_stat_grow_histograms(sim, sim->system_size.x * sim->system_size.y);
+	else
+		spinn_sim_stat_grow_histograms(sim, 1);
+	
+	for (int i = 0; i < sim->stat_histograms_num_keys * SPINN_SIM_NUM_HISTOGRAM_METRICS; i++)
+		histogram_reset(&(sim->stat_histograms[i]));
+}
+
+
+void
+spinn_sim_stat_start_sample_latency_breakdown(spinn_sim_t *sim)
 {
-	// Nothing to do
+	if (sim->stat_file_latency_breakdown == NULL)
+		return;
+	
+	for (int i = 0; i < SPINN_PACKET_NUM_LATENCIES + 1; i++)
+		histogram_reset(&(sim->stat_breakdown_histograms[i]));
 }
 
 
 void
-spinn_sim_stat_start_sample_simulator(spinn_sim_t *sim)
+spinn_sim_stat_start_sample_flow_matrix(spinn_sim_t *sim)
 {
-	// Nothing to do
+	if (!sim->stat_flow_matrix_enabled)
+		return;
+	
+	// The matrices are sized for the current model
+	spinn_sim_stat_close_flow_matrix(sim);
+	
+	// Number the sources: either every node or every board in the order of the
+	// first of its nodes.
+	int num_nodes = sim->system_size.x * sim->system_size.y;
+	uint32_t *source_of = calloc(num_nodes, sizeof(uint32_t));
+	assert(source_of != NULL);
+	size_t num_sources = 0;
+	for (int i = 0; i < num_nodes; i++) {
+		if (sim->stat_flow_matrix_per_node) {
+			source_of[i] = num_sources++;
+			continue;
+		}
+		
+		int j;
+		for (j = 0; j < i; j++)
+			if (sim->nodes[j].board_coord.x == sim->nodes[i].board_coord.x
+			    && sim->nodes[j].board_coord.y == sim->nodes[i].board_coord.y)
+				break;
+		source_of[i] = (j < i) ? source_of[j] : num_sources++;
+	}
+	
+	spinn_flow_matrix_init(&(sim->stat_flow_matrix), sim->system_size, num_sources, source_of);
+	sim->stat_flow_matrix_valid = true;
+	
+	free(source_of);
 }
 
 
@@ -573,6 +1974,10 @@ spinn_sim_stat_end_sample_per_node_counters(spinn_sim_t *sim)
 	    per_node_packets_arrived || per_node_packets_dropped ||
 	    per_node_packets_forwarded) {
 		
+		columnar_t *c = &(sim->stat_columnar_per_node_counters);
+		if (sim->stat_columnar)
+			set_standard_fields_labels(sim, c, sim->stat_file_per_node_counters);
+		
 		// Iterate over all nodes
 		for (int y = 0; y < sim->system_size.y; y++) {
 			for (int x = 0; x < sim->system_size.x; x++) {
@@ -582,6 +1987,20 @@ spinn_sim_stat_end_sample_per_node_counters(spinn_sim_t *sim)
 				if (!node->enabled)
 					continue;
 				
+				if (sim->stat_columnar) {
+					int32_t row[7];
+					int num_columns = 0;
+					row[num_columns++] = x;
+					row[num_columns++] = y;
+					if (per_node_packets_offered)  row[num_columns++] = node->stat_packets_offered;
+					if (per_node_packets_accepted) row[num_columns++] = node->stat_packets_accepted;
+					if (per_node_packets_arrived)  row[num_columns++] = node->stat_packets_arrived;
+					if (per_node_packets_dropped)  row[num_columns++] = node->stat_packets_dropped;
+					if (per_node_packets_forwarded)row[num_columns++] = node->stat_packets_forwarded;
+					columnar_append(c, sim->stat_file_per_node_counters, row);
+					continue;
+				}
+				
 				fprint_standard_fields(sim, sim->stat_file_per_node_counters);
 				fprintf(sim->stat_file_per_node_counters, "\t%d\t%d"
 				       , x, y
@@ -602,15 +2021,203 @@ spinn_sim_stat_end_sample_per_node_counters(spinn_sim_t *sim)
 			}
 		}
 		
+		if (sim->stat_columnar)
+			columnar_flush(c, sim->stat_file_per_node_counters);
 		fflush(sim->stat_file_per_node_counters);
 	}
 }
 
 
+void
+spinn_sim_stat_end_sample_per_link_counters(spinn_sim_t *sim)
+{
+	if (sim->stat_file_per_link_counters == NULL)
+		return;
+	
+	for (int y = 0; y < sim->system_size.y; y++) {
+		for (int x = 0; x < sim->system_size.x; x++) {
+			spinn_node_t *node = sim->nodes + (x + (sim->system_size.x * y));
+			
+			// Skip disabled nodes
+			if (!node->enabled)
+				continue;
+			
+			for (int i = 0; i < 6; i++) {
+				fprint_standard_fields(sim, sim->stat_file_per_link_counters);
+				fprintf( sim->stat_file_per_link_counters
+				       , "\t%d\t%d\t%d\t%d\t%lu\t%lu\t%lu\t%lu\n"
+				       , x, y, i, node->link_is_board_to_board[i]
+				       , spinn_router_get_num_forwarded(&(node->router), (spinn_direction_t)i)
+				       , spinn_router_get_num_blocked(&(node->router), (spinn_direction_t)i)
+				       , delay_get_num_forwarded(&(node->delays[i]))
+				       , delay_get_num_blocked(&(node->delays[i]))
+				       );
+			}
+		}
+	}
+	
+	fflush(sim->stat_file_per_link_counters);
+}
+
+
+void
+spinn_sim_stat_end_sample_buffer_occupancy(spinn_sim_t *sim)
+{
+	if (sim->stat_file_buffer_occupancy == NULL)
+		return;
+	
+	int num_nodes = sim->system_size.x * sim->system_size.y;
+	buffer_t **buffers = calloc(num_nodes * 6, sizeof(buffer_t *));
+	assert(buffers != NULL);
+	
+	if (sim->stat_buffer_occupancy_per_node) {
+		for (int y = 0; y < sim->system_size.y; y++) {
+			for (int x = 0; x < sim->system_size.x; x++) {
+				spinn_node_t *node = sim->nodes + (x + (sim->system_size.x * y));
+				
+				// Skip disabled nodes
+				if (!node->enabled)
+					continue;
+				
+				for (int role = 0; role < SPINN_SIM_NUM_BUFFER_ROLES; role++) {
+					int num_buffers = get_role_buffers(node, role, buffers);
+					fprint_standard_fields(sim, sim->stat_file_buffer_occupancy);
+					fprintf( sim->stat_file_buffer_occupancy, "\t%d\t%d\t%s"
+					       , x, y, buffer_role_names[role]
+					       );
+					fprint_buffer_occupancy(sim->stat_file_buffer_occupancy, buffers, num_buffers);
+				}
+			}
+		}
+	} else {
+		for (int role = 0; role < SPINN_SIM_NUM_BUFFER_ROLES; role++) {
+			// Gather the buffers of every enabled node
+			int num_buffers = 0;
+			for (int i = 0; i < num_nodes; i++)
+				if (sim->nodes[i].enabled)
+					num_buffers += get_role_buffers(&(sim->nodes[i]), role, buffers + num_buffers);
+			
+			fprint_standard_fields(sim, sim->stat_file_buffer_occupancy);
+			fprintf(sim->stat_file_buffer_occupancy, "\t%s", buffer_role_names[role]);
+			fprint_buffer_occupancy(sim->stat_file_buffer_occupancy, buffers, num_buffers);
+		}
+	}
+	
+	free(buffers);
+	fflush(sim->stat_file_buffer_occupancy);
+}
+
+
+void
+spinn_sim_stat_end_sample_router_stats(spinn_sim_t *sim)
+{
+	if (sim->stat_file_router_stats == NULL)
+		return;
+	
+	if (sim->stat_router_stats_per_node) {
+		for (int y = 0; y < sim->system_size.y; y++) {
+			for (int x = 0; x < sim->system_size.x; x++) {
+				spinn_node_t *node = sim->nodes + (x + (sim->system_size.x * y));
+				
+				// Skip disabled nodes
+				if (!node->enabled)
+					continue;
+				
+				spinn_router_t *router = &(node->router);
+				fprint_standard_fields(sim, sim->stat_file_router_stats);
+				fprintf(sim->stat_file_router_stats, "\t%d\t%d", x, y);
+				fprint_router_stats( sim->stat_file_router_stats, &router, 1
+				                   , sim->stat_router_stats_precision
+				                   );
+			}
+		}
+	} else {
+		// Gather the routers of every enabled node
+		int num_nodes = sim->system_size.x * sim->system_size.y;
+		spinn_router_t **routers = calloc(num_nodes, sizeof(spinn_router_t *));
+		assert(routers != NULL);
+		int num_routers = 0;
+		for (int i = 0; i < num_nodes; i++)
+			if (sim->nodes[i].enabled)
+				routers[num_routers++] = &(sim->nodes[i].router);
+		
+		fprint_standard_fields(sim, sim->stat_file_router_stats);
+		fprint_router_stats( sim->stat_file_router_stats, routers, num_routers
+		                   , sim->stat_router_stats_precision
+		                   );
+		
+		free(routers);
+	}
+	
+	fflush(sim->stat_file_router_stats);
+}
+
+
+void
+spinn_sim_stat_end_sample_arbiter_contention(spinn_sim_t *sim)
+{
+	if (sim->stat_file_arbiter_contention == NULL)
+		return;
+	
+	if (sim->stat_arbiter_contention_per_node) {
+		for (int y = 0; y < sim->system_size.y; y++) {
+			for (int x = 0; x < sim->system_size.x; x++) {
+				spinn_node_t *node = sim->nodes + (x + (sim->system_size.x * y));
+				
+				// Skip disabled nodes
+				if (!node->enabled)
+					continue;
+				
+				for (int arbiter = 0; arbiter < NUM_ARBITERS; arbiter++) {
+					fprint_standard_fields(sim, sim->stat_file_arbiter_contention);
+					fprintf(sim->stat_file_arbiter_contention, "\t%d\t%d", x, y);
+					fprint_arbiter_contention(sim->stat_file_arbiter_contention, &node, 1, arbiter);
+				}
+			}
+		}
+	} else {
+		// Gather every enabled node
+		int num_nodes = sim->system_size.x * sim->system_size.y;
+		spinn_node_t **nodes = calloc(num_nodes, sizeof(spinn_node_t *));
+		assert(nodes != NULL);
+		int num_enabled = 0;
+		for (int i = 0; i < num_nodes; i++)
+			if (sim->nodes[i].enabled)
+				nodes[num_enabled++] = &(sim->nodes[i]);
+		
+		for (int arbiter = 0; arbiter < NUM_ARBITERS; arbiter++) {
+			fprint_standard_fields(sim, sim->stat_file_arbiter_contention);
+			fprint_arbiter_contention(sim->stat_file_arbiter_contention, nodes, num_enabled, arbiter);
+		}
+		
+		free(nodes);
+	}
+	
+	fflush(sim->stat_file_arbiter_contention);
+}
+
+
+void
+spinn_sim_stat_end_sample_time_series(spinn_sim_t *sim)
+{
+	if (sim->stat_file_time_series == NULL)
+		return;
+	
+	// Record the final (partial) window, if any
+	if (scheduler_get_ticks(&(sim->scheduler)) - sim->stat_start_ticks > sim->stat_time_series_last)
+		append_time_series(sim);
+	
+	fflush(sim->stat_file_time_series);
+}
+
+
 void
 spinn_sim_stat_end_sample_packet_details(spinn_sim_t *sim)
 {
-	// Nothing to do
+	// Write out the final (partial) block of the sample
+	if (sim->stat_columnar && sim->stat_file_packet_details != NULL)
+		columnar_flush(&(sim->stat_columnar_packet_details), sim->stat_file_packet_details);
+	
 	fflush(sim->stat_file_packet_details);
 }
 
@@ -625,10 +2232,15 @@ spinn_sim_stat_end_sample_simulator(spinn_sim_t *sim)
 		"measurements.simulator.sample_duration");
 	bool sample_packet_pool_size = spinn_sim_config_lookup_bool(sim,
 		"measurements.simulator.sample_packet_pool_size");
+	bool sample_confidence_intervals = spinn_sim_config_lookup_bool(sim,
+		"measurements.simulator.sample_confidence_intervals");
+	bool terminated = spinn_sim_config_lookup_bool(sim,
+		"measurements.simulator.terminated");
 	
 	
 	// Produce sample stats
-	if (sample_ticks || sample_duration || sample_packet_pool_size) {
+	if (sample_ticks || sample_duration || sample_packet_pool_size ||
+	    sample_confidence_intervals || terminated) {
 		if (sample_ticks)
 			fprintf(sim->stat_file_simulator, "\t%d",
 			        scheduler_get_ticks(&(sim->scheduler)) - sim->stat_start_ticks);
@@ -646,6 +2258,19 @@ spinn_sim_stat_end_sample_simulator(spinn_sim_t *sim)
 			fprintf(sim->stat_file_simulator, "\t%d",
 			        spinn_packet_pool_get_num_packets(&(sim->pool)));
 		}
+		
+		if (sample_confidence_intervals) {
+			fprintf(sim->stat_file_simulator, "\t%f\t%f\t%f\t%f",
+			        batch_means_get_mean(&(sim->stat_sample_throughput)),
+			        batch_means_get_half_width(&(sim->stat_sample_throughput)),
+			        batch_means_get_mean(&(sim->stat_sample_latency)),
+			        batch_means_get_half_width(&(sim->stat_sample_latency)));
+		}
+		
+		if (terminated) {
+			const char *reasons[] = { "none", "in_flight", "drops", "stalled" };
+			fprintf(sim->stat_file_simulator, "\t%s", reasons[sim->terminated]);
+		}
 	}
 	
 	
@@ -658,6 +2283,248 @@ spinn_sim_stat_end_sample_simulator(spinn_sim_t *sim)
 
 
 
+void
+spinn_sim_stat_end_sample_paired_differences(spinn_sim_t *sim)
+{
+	if (sim->stat_file_paired_differences == NULL)
+		return;
+	
+	// Measure the rate (per tick) of each global counter and the mean latency
+	double metrics[SPINN_SIM_NUM_PAIRED_METRICS] = {0.0};
+	for (size_t i = 0; i < sim->system_size.x*sim->system_size.y; i++) {
+		metrics[0] += sim->nodes[i].stat_packets_offered;
+		metrics[1] += sim->nodes[i].stat_packets_accepted;
+		metrics[2] += sim->nodes[i].stat_packets_arrived;
+		metrics[3] += sim->nodes[i].stat_packets_dropped;
+		metrics[4] += sim->nodes[i].stat_packets_forwarded;
+	}
+	metrics[5] = (metrics[2] > 0.0) ? (double)sim->stat_latency_sum / metrics[2] : NAN;
+	
+	ticks_t ticks = scheduler_get_ticks(&(sim->scheduler)) - sim->stat_start_ticks;
+	for (int i = 0; i < 5; i++)
+		metrics[i] = (ticks > 0) ? metrics[i] / (double)ticks : NAN;
+	
+	// Record the samples of the baseline group
+	int baseline_group = spinn_sim_config_lookup_int(sim,
+		"experiment.common_random_numbers.baseline_group") - 1;
+	if (sim->cur_group == baseline_group) {
+		if (sim->cur_sample >= sim->stat_baseline_num_samples) {
+			sim->stat_baseline = realloc( sim->stat_baseline
+			                            , (sim->cur_sample + 1) * sizeof(*(sim->stat_baseline))
+			                            );
+			assert(sim->stat_baseline != NULL);
+			
+			// Samples skipped by a parallel run have no baseline
+			for (int s = sim->stat_baseline_num_samples; s < sim->cur_sample; s++)
+				for (int i = 0; i < SPINN_SIM_NUM_PAIRED_METRICS; i++)
+					sim->stat_baseline[s][i] = NAN;
+			sim->stat_baseline_num_samples = sim->cur_sample + 1;
+		}
+		memcpy(sim->stat_baseline[sim->cur_sample], metrics, sizeof(metrics));
+	}
+	
+	// Compare with the same sample of the baseline (which saw the same random
+	// numbers)
+	bool paired = sim->cur_sample < sim->stat_baseline_num_samples;
+	for (int i = 0; i < SPINN_SIM_NUM_PAIRED_METRICS; i++) {
+		if (isnan(metrics[i]))
+			continue;
+		batch_means_add(&(sim->stat_paired_absolute[i]), metrics[i]);
+		if (paired && !isnan(sim->stat_baseline[sim->cur_sample][i]))
+			batch_means_add( &(sim->stat_paired_difference[i])
+			               , metrics[i] - sim->stat_baseline[sim->cur_sample][i]
+			               );
+	}
+}
+
+
+void
+spinn_sim_stat_end_sample_latency_histograms(spinn_sim_t *sim)
+{
+	if (sim->stat_file_latency_summary == NULL)
+		return;
+	
+	const char *metrics[SPINN_SIM_NUM_HISTOGRAM_METRICS] = {
+		"latency", "num_hops", "num_emg_hops",
+	};
+	
+	for (int key = 0; key < sim->stat_histograms_num_keys; key++) {
+		for (int metric = 0; metric < SPINN_SIM_NUM_HISTOGRAM_METRICS; metric++) {
+			histogram_t *h = &(sim->stat_histograms[key*SPINN_SIM_NUM_HISTOGRAM_METRICS + metric]);
+			
+			// Only the single system-wide histogram is reported when empty
+			if (histogram_get_count(h) == 0 &&
+			    sim->stat_histograms_per != SPINN_SIM_HISTOGRAMS_PER_NONE)
+				continue;
+			
+			fprint_standard_fields(sim, sim->stat_file_latency_summary);
+			fprint_histogram_key(sim, sim->stat_file_latency_summary, key);
+			fprintf( sim->stat_file_latency_summary
+			       , "\t%s\t%"PRIu64"\t%f\t%"PRIu64"\t%"PRIu64"\t%"PRIu64"\t%"PRIu64"\t%"PRIu64"\n"
+			       , metrics[metric]
+			       , histogram_get_count(h)
+			       , histogram_get_mean(h)
+			       , histogram_get_quantile(h, 0.5)
+			       , histogram_get_quantile(h, 0.9)
+			       , histogram_get_quantile(h, 0.99)
+			       , histogram_get_quantile(h, 0.999)
+			       , histogram_get_max(h)
+			       );
+			
+			if (sim->stat_file_latency_histograms == NULL)
+				continue;
+			
+			// Only non-empty buckets are listed
+			for (size_t bucket = 0; bucket < histogram_get_num_buckets(h); bucket++) {
+				uint64_t lower, upper;
+				uint64_t count = histogram_get_bucket(h, bucket, &lower, &upper);
+				if (count == 0)
+					continue;
+				
+				fprint_standard_fields(sim, sim->stat_file_latency_histograms);
+				fprint_histogram_key(sim, sim->stat_file_latency_histograms, key);
+				fprintf( sim->stat_file_latency_histograms
+				       , "\t%s\t%"PRIu64"\t%"PRIu64"\t%"PRIu64"\n"
+				       , metrics[metric], lower, upper, count
+				       );
+			}
+		}
+	}
+	
+	fflush(sim->stat_file_latency_summary);
+	if (sim->stat_file_latency_histograms != NULL)
+		fflush(sim->stat_file_latency_histograms);
+}
+
+
+void
+spinn_sim_stat_end_sample_latency_breakdown(spinn_sim_t *sim)
+{
+	if (sim->stat_file_latency_breakdown == NULL)
+		return;
+	
+	histogram_t *total = &(sim->stat_breakdown_histograms[SPINN_PACKET_NUM_LATENCIES]);
+	
+	for (int i = 0; i < SPINN_PACKET_NUM_LATENCIES + 1; i++) {
+		histogram_t *h = &(sim->stat_breakdown_histograms[i]);
+		
+		// The share of the mean latency due to this component
+		double fraction = (histogram_get_mean(total) > 0.0)
+		                  ? histogram_get_mean(h) / histogram_get_mean(total)
+		                  : 0.0;
+		
+		fprint_standard_fields(sim, sim->stat_file_latency_breakdown);
+		fprintf( sim->stat_file_latency_breakdown
+		       , "\t%s\t%"PRIu64"\t%f\t%f\t%"PRIu64"\t%"PRIu64"\t%"PRIu64"\t%"PRIu64"\t%"PRIu64"\n"
+		       , latency_component_names[i]
+		       , histogram_get_count(h)
+		       , histogram_get_mean(h)
+		       , fraction
+		       , histogram_get_quantile(h, 0.5)
+		       , histogram_get_quantile(h, 0.9)
+		       , histogram_get_quantile(h, 0.99)
+		       , histogram_get_quantile(h, 0.999)
+		       , histogram_get_max(h)
+		       );
+		
+		if (sim->stat_file_latency_breakdown_histograms == NULL)
+			continue;
+		
+		// Only non-empty buckets are listed
+		for (size_t bucket = 0; bucket < histogram_get_num_buckets(h); bucket++) {
+			uint64_t lower, upper;
+			uint64_t count = histogram_get_bucket(h, bucket, &lower, &upper);
+			if (count == 0)
+				continue;
+			
+			fprint_standard_fields(sim, sim->stat_file_latency_breakdown_histograms);
+			fprintf( sim->stat_file_latency_breakdown_histograms
+			       , "\t%s\t%"PRIu64"\t%"PRIu64"\t%"PRIu64"\n"
+			       , latency_component_names[i], lower, upper, count
+			       );
+		}
+	}
+	
+	fflush(sim->stat_file_latency_breakdown);
+	if (sim->stat_file_latency_breakdown_histograms != NULL)
+		fflush(sim->stat_file_latency_breakdown_histograms);
+}
+
+
+void
+spinn_sim_stat_end_sample_flow_matrix(spinn_sim_t *sim)
+{
+	if (!sim->stat_flow_matrix_valid)
+		return;
+	
+	// Each sample's matrices are written to their own file
+	const char *result_dir = spinn_sim_config_lookup_string(sim, "measurements.results_directory");
+	char *filename = calloc(strlen(result_dir) + 64, sizeof(char));
+	assert(filename != NULL);
+	sprintf(filename, "%sflow_matrix_g%d_s%d.bin"
+	       , result_dir
+	       , sim->cur_group+1, sim->cur_sample+1
+	       );
+	
+	// Failures are reported by the writer but the simulation continues
+	if (spinn_flow_matrix_write(&(sim->stat_flow_matrix), filename))
+		spinn_sim_stat_add_side_file(sim, filename + strlen(result_dir));
+	
+	// Clean up (no flows are recorded between samples)
+	free(filename);
+	spinn_sim_stat_close_flow_matrix(sim);
+}
+
+
+/******************************************************************************
+ * Model Start/End Functions
+ ******************************************************************************/
+
+void
+spinn_sim_stat_start_model_trace(spinn_sim_t *sim)
+{
+	sim->stat_record_trace = spinn_sim_config_lookup_bool_default(sim,
+		"measurements.packet_trace.record", false);
+	
+	if (!sim->stat_record_trace)
+		return;
+	
+	// Traces are named after the first group/sample simulated by the model
+	const char *result_dir = spinn_sim_config_lookup_string(sim, "measurements.results_directory");
+	char *filename = calloc(strlen(result_dir) + 64, sizeof(char));
+	assert(filename != NULL);
+	sprintf(filename, "%spacket_trace_g%d_s%d.bin"
+	       , result_dir
+	       , sim->cur_group+1, sim->cur_sample+1
+	       );
+	
+	if (!spinn_trace_writer_open(&(sim->stat_trace_writer), filename, sim->system_size))
+		exit(-1);
+	
+	// Keep the name to record the file once it has been written
+	sim->stat_trace_filename = strdup(filename + strlen(result_dir));
+	assert(sim->stat_trace_filename != NULL);
+	
+	// Clean up
+	free(filename);
+}
+
+
+void
+spinn_sim_stat_end_model_trace(spinn_sim_t *sim)
+{
+	if (sim->stat_record_trace) {
+		if (spinn_trace_writer_close(&(sim->stat_trace_writer)))
+			spinn_sim_stat_add_side_file(sim, sim->stat_trace_filename);
+		else
+			fprintf(stderr, "Error writing packet trace.\n");
+		free(sim->stat_trace_filename);
+	}
+	
+	sim->stat_record_trace = false;
+}
+
+
 /******************************************************************************
  * Public-facing functions
  ******************************************************************************/
@@ -666,11 +2533,43 @@ void
 spinn_sim_stat_open(spinn_sim_t *sim)
 {
 	sim->stat_started = false;
+	sim->stat_record_trace = false;
+	
+	sim->stat_side_files     = NULL;
+	sim->stat_num_side_files = 0;
+	
+	sim->stat_writers     = NULL;
+	sim->stat_num_writers = 0;
+	if (spinn_sim_config_lookup_bool_default(sim, "measurements.async_writer.enabled", false)) {
+		sim->stat_writers = calloc(SPINN_SIM_STAT_MAX_FILES, sizeof(async_writer_t));
+		assert(sim->stat_writers != NULL);
+	}
+	
+	const char *output_format = spinn_sim_config_lookup_string_default(sim,
+		"measurements.output_format", "tsv");
+	if (strcmp(output_format, "columnar") == 0) {
+		sim->stat_columnar = true;
+	} else if (strcmp(output_format, "tsv") == 0) {
+		sim->stat_columnar = false;
+	} else {
+		fprintf(stderr, "Error: Unknown measurements.output_format '%s'.\n", output_format);
+		exit(-1);
+	}
 	
 	spinn_sim_stat_open_global_counters(sim);
 	spinn_sim_stat_open_per_node_counters(sim);
+	spinn_sim_stat_open_per_link_counters(sim);
+	spinn_sim_stat_open_buffer_occupancy(sim);
+	spinn_sim_stat_open_router_stats(sim);
+	spinn_sim_stat_open_arbiter_contention(sim);
+	spinn_sim_stat_open_time_series(sim);
 	spinn_sim_stat_open_packet_details(sim);
 	spinn_sim_stat_open_simulator(sim);
+	spinn_sim_stat_open_saturation(sim);
+	spinn_sim_stat_open_paired_differences(sim);
+	spinn_sim_stat_open_latency_histograms(sim);
+	spinn_sim_stat_open_latency_breakdown(sim);
+	spinn_sim_stat_open_flow_matrix(sim);
 }
 
 
@@ -679,8 +2578,86 @@ spinn_sim_stat_close(spinn_sim_t *sim)
 {
 	spinn_sim_stat_close_global_counters(sim);
 	spinn_sim_stat_close_per_node_counters(sim);
+	spinn_sim_stat_close_per_link_counters(sim);
+	spinn_sim_stat_close_buffer_occupancy(sim);
+	spinn_sim_stat_close_router_stats(sim);
+	spinn_sim_stat_close_arbiter_contention(sim);
+	spinn_sim_stat_close_time_series(sim);
 	spinn_sim_stat_close_packet_details(sim);
 	spinn_sim_stat_close_simulator(sim);
+	spinn_sim_stat_close_saturation(sim);
+	spinn_sim_stat_close_paired_differences(sim);
+	spinn_sim_stat_close_latency_histograms(sim);
+	spinn_sim_stat_close_latency_breakdown(sim);
+	spinn_sim_stat_close_flow_matrix(sim);
+	spinn_sim_stat_clear_side_files(sim);
+	
+	// Report any time the writer threads fell behind the simulation
+	unsigned long num_overflows = 0;
+	unsigned long num_stalls    = 0;
+	size_t        peak_length   = 0;
+	for (int i = 0; i < sim->stat_num_writers; i++) {
+		num_overflows += async_writer_get_num_overflows(&(sim->stat_writers[i]));
+		num_stalls    += async_writer_get_num_stalls(&(sim->stat_writers[i]));
+		if (async_writer_get_peak_length(&(sim->stat_writers[i])) > peak_length)
+			peak_length = async_writer_get_peak_length(&(sim->stat_writers[i]));
+	}
+	if (num_overflows > 0)
+		fprintf( stderr, "Warning: Writing results fell behind the simulation %lu time%s"
+		                 " (%lu stall%s, largest buffer %zu bytes).\n"
+		       , num_overflows, (num_overflows == 1) ? "" : "s"
+		       , num_stalls,    (num_stalls == 1) ? "" : "s"
+		       , peak_length
+		       );
+	
+	free(sim->stat_writers);
+	sim->stat_writers     = NULL;
+	sim->stat_num_writers = 0;
+}
+
+
+int
+spinn_sim_stat_get_files(spinn_sim_t *sim, FILE **files[SPINN_SIM_STAT_MAX_FILES])
+{
+	int num_files = 0;
+	files[num_files++] = &(sim->stat_file_global_counters);
+	files[num_files++] = &(sim->stat_file_per_node_counters);
+	files[num_files++] = &(sim->stat_file_per_link_counters);
+	files[num_files++] = &(sim->stat_file_buffer_occupancy);
+	files[num_files++] = &(sim->stat_file_router_stats);
+	files[num_files++] = &(sim->stat_file_arbiter_contention);
+	files[num_files++] = &(sim->stat_file_time_series);
+	files[num_files++] = &(sim->stat_file_packet_details);
+	files[num_files++] = &(sim->stat_file_simulator);
+	files[num_files++] = &(sim->stat_file_saturation);
+	files[num_files++] = &(sim->stat_file_paired_differences);
+	files[num_files++] = &(sim->stat_file_latency_summary);
+	files[num_files++] = &(sim->stat_file_latency_histograms);
+	files[num_files++] = &(sim->stat_file_latency_breakdown);
+	files[num_files++] = &(sim->stat_file_latency_breakdown_histograms);
+	
+	assert(num_files <= SPINN_SIM_STAT_MAX_FILES);
+	return num_files;
+}
+
+
+int
+spinn_sim_stat_get_side_files(spinn_sim_t *sim, char **names[])
+{
+	*names = sim->stat_side_files;
+	return sim->stat_num_side_files;
+}
+
+
+void
+spinn_sim_stat_clear_side_files(spinn_sim_t *sim)
+{
+	for (int i = 0; i < sim->stat_num_side_files; i++)
+		free(sim->stat_side_files[i]);
+	free(sim->stat_side_files);
+	
+	sim->stat_side_files     = NULL;
+	sim->stat_num_side_files = 0;
 }
 
 
@@ -693,8 +2670,16 @@ spinn_sim_stat_start_sample(spinn_sim_t *sim)
 	
 	spinn_sim_stat_start_sample_global_counters(sim);
 	spinn_sim_stat_start_sample_per_node_counters(sim);
+	spinn_sim_stat_start_sample_per_link_counters(sim);
+	spinn_sim_stat_start_sample_buffer_occupancy(sim);
+	spinn_sim_stat_start_sample_router_stats(sim);
+	spinn_sim_stat_start_sample_arbiter_contention(sim);
+	spinn_sim_stat_start_sample_time_series(sim);
 	spinn_sim_stat_start_sample_packet_details(sim);
 	spinn_sim_stat_start_sample_simulator(sim);
+	spinn_sim_stat_start_sample_latency_histograms(sim);
+	spinn_sim_stat_start_sample_latency_breakdown(sim);
+	spinn_sim_stat_start_sample_flow_matrix(sim);
 }
 
 
@@ -705,8 +2690,40 @@ spinn_sim_stat_end_sample(spinn_sim_t *sim)
 	
 	spinn_sim_stat_end_sample_global_counters(sim);
 	spinn_sim_stat_end_sample_per_node_counters(sim);
+	spinn_sim_stat_end_sample_per_link_counters(sim);
+	spinn_sim_stat_end_sample_buffer_occupancy(sim);
+	spinn_sim_stat_end_sample_router_stats(sim);
+	spinn_sim_stat_end_sample_arbiter_contention(sim);
+	spinn_sim_stat_end_sample_time_series(sim);
 	spinn_sim_stat_end_sample_packet_details(sim);
 	spinn_sim_stat_end_sample_simulator(sim);
+	spinn_sim_stat_end_sample_paired_differences(sim);
+	spinn_sim_stat_end_sample_latency_histograms(sim);
+	spinn_sim_stat_end_sample_latency_breakdown(sim);
+	spinn_sim_stat_end_sample_flow_matrix(sim);
+}
+
+
+int
+spinn_sim_stat_ticks_until_window(spinn_sim_t *sim)
+{
+	if (sim->stat_file_time_series == NULL || !sim->stat_started)
+		return 0;
+	
+	ticks_t elapsed = scheduler_get_ticks(&(sim->scheduler)) - sim->stat_start_ticks;
+	return sim->stat_time_series_window - (elapsed % sim->stat_time_series_window);
+}
+
+
+void
+spinn_sim_stat_end_window(spinn_sim_t *sim)
+{
+	if (sim->stat_file_time_series == NULL || !sim->stat_started)
+		return;
+	
+	ticks_t elapsed = scheduler_get_ticks(&(sim->scheduler)) - sim->stat_start_ticks;
+	if (elapsed % sim->stat_time_series_window == 0 && elapsed > sim->stat_time_series_last)
+		append_time_series(sim);
 }
 
 
@@ -726,3 +2743,74 @@ spinn_sim_stat_end_warmup(spinn_sim_t *sim)
 	spinn_sim_stat_end_warmup_simulator(sim);
 }
 
+
+void
+spinn_sim_stat_start_model(spinn_sim_t *sim)
+{
+	spinn_sim_stat_start_model_trace(sim);
+}
+
+
+void
+spinn_sim_stat_end_model(spinn_sim_t *sim)
+{
+	spinn_sim_stat_end_model_trace(sim);
+}
+
+
+void
+spinn_sim_stat_start_group(spinn_sim_t *sim)
+{
+	double confidence = spinn_sim_config_lookup_float(sim,
+		"experiment.adaptive_sample.confidence");
+	for (int i = 0; i < SPINN_SIM_NUM_PAIRED_METRICS; i++) {
+		batch_means_init(&(sim->stat_paired_absolute[i]), confidence);
+		batch_means_init(&(sim->stat_paired_difference[i]), confidence);
+	}
+}
+
+
+void
+spinn_sim_stat_end_group(spinn_sim_t *sim)
+{
+	if (sim->stat_file_paired_differences == NULL)
+		return;
+	
+	// Each sample is an independent replication so the batch means estimators
+	// give the usual paired-t confidence intervals. The sample column gives the
+	// number of samples in the group (the sample loop has just ended).
+	sim->cur_sample--;
+	fprint_standard_fields(sim, sim->stat_file_paired_differences);
+	sim->cur_sample++;
+	fprintf( sim->stat_file_paired_differences, "\t%d"
+	       , batch_means_get_num_batches(&(sim->stat_paired_difference[0]))
+	       );
+	for (int i = 0; i < SPINN_SIM_NUM_PAIRED_METRICS; i++)
+		fprintf( sim->stat_file_paired_differences, "\t%f\t%f\t%f\t%f"
+		       , batch_means_get_mean(&(sim->stat_paired_absolute[i]))
+		       , batch_means_get_half_width(&(sim->stat_paired_absolute[i]))
+		       , batch_means_get_mean(&(sim->stat_paired_difference[i]))
+		       , batch_means_get_half_width(&(sim->stat_paired_difference[i]))
+		       );
+	fprintf(sim->stat_file_paired_differences, "\n");
+	fflush(sim->stat_file_paired_differences);
+}
+
+
+void
+spinn_sim_stat_saturation( spinn_sim_t *sim
+                         , double       lower
+                         , double       upper
+                         , int          num_probes
+                         )
+{
+	if (sim->stat_file_saturation == NULL)
+		return;
+	
+	fprint_standard_fields(sim, sim->stat_file_saturation);
+	fprintf( sim->stat_file_saturation, "\t%f\t%f\t%f\t%d\n"
+	       , (lower + upper) / 2.0, lower, upper
+	       , num_probes
+	       );
+	fflush(sim->stat_file_saturation);
+}
@@ -19,6 +19,12 @@
  */
 void *spinn_sim_stat_on_packet_gen(spinn_packet_t *packet, void *node);
 
+/**
+ * Callback for packets entering the network from the packet generators.
+ * Expects a reference to the simulation node as the data argument.
+ */
+void spinn_sim_stat_on_packet_inject(spinn_packet_t *packet, void *node);
+
 /**
  * Callback for the packet consumers. Expects a reference to the simulation node
  * as the data argument.
@@ -37,6 +43,13 @@ void spinn_sim_stat_on_drop(spinn_router_t *router, spinn_packet_t *packet, void
  */
 void spinn_sim_stat_on_forward(spinn_router_t *router, spinn_packet_t *packet, void *node);
 
+/**
+ * Callback for the arbiters' on-forward event used to time packets passing
+ * through the arbiter tree when recording latency breakdowns. Expects a
+ * reference to the simulation node as the data argument.
+ */
+void spinn_sim_stat_on_arbiter_forward(arbiter_t *arbiter, size_t input, void *packet, void *node);
+
 
 /******************************************************************************
  * Stat management functions
@@ -57,6 +70,34 @@ void spinn_sim_stat_open(spinn_sim_t *sim);
 void spinn_sim_stat_close(spinn_sim_t *sim);
 
 
+/**
+ * The maximum number of result files returned by spinn_sim_stat_get_files.
+ */
+#define SPINN_SIM_STAT_MAX_FILES 16
+
+/**
+ * Get a pointer to the handle of each result file (i.e. the files opened by
+ * spinn_sim_stat_open) in a fixed order, allowing their output to be redirected.
+ * Handles of files which are not being written are NULL. Returns the number of
+ * files.
+ */
+int spinn_sim_stat_get_files(spinn_sim_t *sim, FILE **files[SPINN_SIM_STAT_MAX_FILES]);
+
+
+/**
+ * Get the names (relative to measurements.results_directory) of the files
+ * written besides the result files, i.e. packet traces and flow matrices, since
+ * spinn_sim_stat_clear_side_files was last called. Returns the number of files.
+ */
+int spinn_sim_stat_get_side_files(spinn_sim_t *sim, char **names[]);
+
+
+/**
+ * Forget the files returned by spinn_sim_stat_get_side_files.
+ */
+void spinn_sim_stat_clear_side_files(spinn_sim_t *sim);
+
+
 /**
  * Start monitoring the simulation.
  */
@@ -69,6 +110,20 @@ void spinn_sim_stat_start_sample(spinn_sim_t *sim);
 void spinn_sim_stat_end_sample(spinn_sim_t *sim);
 
 
+/**
+ * Get the number of ticks until the end of the current window of the time
+ * series being recorded (or 0 if no time series is being recorded).
+ */
+int spinn_sim_stat_ticks_until_window(spinn_sim_t *sim);
+
+
+/**
+ * Record the counters in the time series if a window has just ended (otherwise
+ * do nothing).
+ */
+void spinn_sim_stat_end_window(spinn_sim_t *sim);
+
+
 /**
  * Start monitoring the simulation's warmup.
  */
@@ -81,4 +136,43 @@ void spinn_sim_stat_start_warmup(spinn_sim_t *sim);
 void spinn_sim_stat_end_warmup(spinn_sim_t *sim);
 
 
+/**
+ * Start monitoring a newly initialised model (e.g. start recording a trace of
+ * its packet injections).
+ */
+void spinn_sim_stat_start_model(spinn_sim_t *sim);
+
+
+/**
+ * End the monitoring of a model which is about to be destroyed.
+ */
+void spinn_sim_stat_end_model(spinn_sim_t *sim);
+
+
+/**
+ * Start monitoring a group of samples.
+ */
+void spinn_sim_stat_start_group(spinn_sim_t *sim);
+
+
+/**
+ * End the monitoring of a group of samples, writing the group's paired
+ * differences from the common random numbers baseline group (if enabled).
+ * Differences are only available for samples whose baseline sample was run by
+ * the same process (so not when the baseline group is run by a different worker
+ * of a parallel run) and are otherwise NaN.
+ */
+void spinn_sim_stat_end_group(spinn_sim_t *sim);
+
+
+/**
+ * Record the result of a saturation search for the current group: the bounds
+ * between which the saturation point was found and the number of probes used.
+ */
+void spinn_sim_stat_saturation( spinn_sim_t *sim
+                              , double       lower
+                              , double       upper
+                              , int          num_probes
+                              );
+
 #endif
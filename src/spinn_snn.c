@@ -0,0 +1,480 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * spinn_snn.c -- Spiking neural network workloads described by a placement of
+ * populations onto chips and the projections between them.
+ */
+
+
+#include "config.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+
+#include "spinn.h"
+#include "spinn_snn.h"
+
+
+/**
+ * Maximum length of a line in a placement or projection file.
+ */
+#define SPINN_SNN_MAX_LINE_LENGTH 1024
+
+
+/**
+ * A population read from the placement file.
+ */
+typedef struct {
+	char *name;
+	size_t chip;
+} spinn_snn_population_t;
+
+
+/**
+ * A projection read from the projection file, reduced to the chips involved.
+ */
+typedef struct {
+	size_t pre_chip;
+	size_t post_chip;
+	double rate;
+} spinn_snn_projection_t;
+
+
+static int
+spinn_snn_population_cmp(const void *a_, const void *b_)
+{
+	const spinn_snn_population_t *a = (const spinn_snn_population_t *)a_;
+	const spinn_snn_population_t *b = (const spinn_snn_population_t *)b_;
+	return strcmp(a->name, b->name);
+}
+
+
+static int
+spinn_snn_projection_cmp(const void *a_, const void *b_)
+{
+	const spinn_snn_projection_t *a = (const spinn_snn_projection_t *)a_;
+	const spinn_snn_projection_t *b = (const spinn_snn_projection_t *)b_;
+	if (a->pre_chip != b->pre_chip)
+		return (a->pre_chip < b->pre_chip) ? -1 : 1;
+	if (a->post_chip != b->post_chip)
+		return (a->post_chip < b->post_chip) ? -1 : 1;
+	return 0;
+}
+
+
+/**
+ * Read the next non-blank, non-comment line from a file into line. Returns false
+ * at the end of the file. The line number is incremented for every line read.
+ */
+static bool
+spinn_snn_read_line(FILE *f, char *line, int *line_num)
+{
+	while (fgets(line, SPINN_SNN_MAX_LINE_LENGTH, f) != NULL) {
+		(*line_num)++;
+		
+		const char *c = line;
+		while (isspace((unsigned char)*c))
+			c++;
+		if (*c != '\0' && *c != '#')
+			return true;
+	}
+	
+	return false;
+}
+
+
+/**
+ * Find the named population in a sorted array of populations. Returns NULL if
+ * not present.
+ */
+static spinn_snn_population_t *
+spinn_snn_find_population( spinn_snn_population_t *populations
+                         , size_t                  num_populations
+                         , char                   *name
+                         )
+{
+	spinn_snn_population_t key;
+	key.name = name;
+	return bsearch( &key
+	              , populations, num_populations
+	              , sizeof(spinn_snn_population_t)
+	              , spinn_snn_population_cmp
+	              );
+}
+
+
+static void
+spinn_snn_free_populations(spinn_snn_population_t *populations, size_t num_populations)
+{
+	for (size_t i = 0; i < num_populations; i++)
+		free(populations[i].name);
+	free(populations);
+}
+
+
+/**
+ * Read the placement file into a newly allocated array of populations sorted by
+ * name. Returns NULL on failure.
+ */
+static spinn_snn_population_t *
+spinn_snn_load_placement( const char    *filename
+                        , spinn_coord_t  system_size
+                        , size_t        *num_populations
+                        )
+{
+	FILE *f = fopen(filename, "r");
+	if (f == NULL) {
+		fprintf(stderr, "Couldn't open placement file %s!\n", filename);
+		return NULL;
+	}
+	
+	size_t size = 16;
+	*num_populations = 0;
+	spinn_snn_population_t *populations = calloc(size, sizeof(spinn_snn_population_t));
+	assert(populations != NULL);
+	
+	char line[SPINN_SNN_MAX_LINE_LENGTH];
+	char name[SPINN_SNN_MAX_LINE_LENGTH];
+	int line_num = 0;
+	while (spinn_snn_read_line(f, line, &line_num)) {
+		spinn_coord_t position;
+		if (sscanf(line, "%s %d %d", name, &(position.x), &(position.y)) != 3) {
+			fprintf(stderr, "%s:%d: Expected '<population> <x> <y>'.\n", filename, line_num);
+			spinn_snn_free_populations(populations, *num_populations);
+			fclose(f);
+			return NULL;
+		}
+		
+		if (position.x < 0 || position.x >= system_size.x
+		    || position.y < 0 || position.y >= system_size.y) {
+			fprintf(stderr, "%s:%d: Chip (%d,%d) is outside the %dx%d system.\n"
+			              , filename, line_num
+			              , position.x, position.y
+			              , system_size.x, system_size.y
+			              );
+			spinn_snn_free_populations(populations, *num_populations);
+			fclose(f);
+			return NULL;
+		}
+		
+		// Grow the array as required
+		if (*num_populations == size) {
+			size *= 2;
+			populations = realloc(populations, size * sizeof(spinn_snn_population_t));
+			assert(populations != NULL);
+		}
+		
+		populations[*num_populations].name = calloc(strlen(name) + 1, sizeof(char));
+		assert(populations[*num_populations].name != NULL);
+		strcpy(populations[*num_populations].name, name);
+		populations[*num_populations].chip = (position.y * system_size.x) + position.x;
+		(*num_populations)++;
+	}
+	fclose(f);
+	
+	// Sort by name to allow populations to be looked up quickly
+	qsort(populations, *num_populations, sizeof(spinn_snn_population_t), spinn_snn_population_cmp);
+	for (size_t i = 1; i < *num_populations; i++) {
+		if (strcmp(populations[i-1].name, populations[i].name) == 0) {
+			fprintf(stderr, "%s: Population '%s' is placed more than once.\n"
+			              , filename, populations[i].name
+			              );
+			spinn_snn_free_populations(populations, *num_populations);
+			return NULL;
+		}
+	}
+	
+	return populations;
+}
+
+
+/**
+ * Read the projection file into a newly allocated array of projections between
+ * chips sorted by pre and then post chip. Returns NULL on failure.
+ */
+static spinn_snn_projection_t *
+spinn_snn_load_projections( const char             *filename
+                          , spinn_snn_population_t *populations
+                          , size_t                  num_populations
+                          , size_t                 *num_projections
+                          )
+{
+	FILE *f = fopen(filename, "r");
+	if (f == NULL) {
+		fprintf(stderr, "Couldn't open projection file %s!\n", filename);
+		return NULL;
+	}
+	
+	size_t size = 16;
+	*num_projections = 0;
+	spinn_snn_projection_t *projections = calloc(size, sizeof(spinn_snn_projection_t));
+	assert(projections != NULL);
+	
+	char line[SPINN_SNN_MAX_LINE_LENGTH];
+	char pre_name[SPINN_SNN_MAX_LINE_LENGTH];
+	char post_name[SPINN_SNN_MAX_LINE_LENGTH];
+	int line_num = 0;
+	while (spinn_snn_read_line(f, line, &line_num)) {
+		double rate;
+		if (sscanf(line, "%s %s %lf", pre_name, post_name, &rate) != 3) {
+			fprintf(stderr, "%s:%d: Expected '<pre population> <post population> <rate>'.\n"
+			              , filename, line_num
+			              );
+			free(projections);
+			fclose(f);
+			return NULL;
+		}
+		
+		spinn_snn_population_t *pre  = spinn_snn_find_population(populations, num_populations, pre_name);
+		spinn_snn_population_t *post = spinn_snn_find_population(populations, num_populations, post_name);
+		if (pre == NULL || post == NULL) {
+			fprintf(stderr, "%s:%d: Population '%s' has not been placed.\n"
+			              , filename, line_num
+			              , (pre == NULL) ? pre_name : post_name
+			              );
+			free(projections);
+			fclose(f);
+			return NULL;
+		}
+		
+		if (!(rate >= 0.0) || isinf(rate)) {
+			fprintf(stderr, "%s:%d: Rate must be a non-negative number.\n", filename, line_num);
+			free(projections);
+			fclose(f);
+			return NULL;
+		}
+		
+		// Projections which never spike need not be simulated
+		if (rate == 0.0)
+			continue;
+		
+		// Grow the array as required
+		if (*num_projections == size) {
+			size *= 2;
+			projections = realloc(projections, size * sizeof(spinn_snn_projection_t));
+			assert(projections != NULL);
+		}
+		
+		projections[*num_projections].pre_chip  = pre->chip;
+		projections[*num_projections].post_chip = post->chip;
+		projections[*num_projections].rate      = rate;
+		(*num_projections)++;
+	}
+	fclose(f);
+	
+	qsort(projections, *num_projections, sizeof(spinn_snn_projection_t), spinn_snn_projection_cmp);
+	
+	return projections;
+}
+
+
+/**
+ * Set up the targets of a chip from a run of projections which all share the
+ * chip as their pre chip. Projections to the same chip are merged and an alias
+ * table is built for picking targets in proportion to their rate.
+ */
+static void
+spinn_snn_chip_init( spinn_snn_chip_t             *chip
+                   , const spinn_snn_projection_t *projections
+                   , size_t                        num_projections
+                   , spinn_coord_t                 system_size
+                   , double                        ticks_per_second
+                   )
+{
+	chip->rate = 0.0;
+	chip->num_targets = 0;
+	chip->targets    = NULL;
+	chip->alias_prob = NULL;
+	chip->alias      = NULL;
+	
+	if (num_projections == 0)
+		return;
+	
+	// Count the distinct targets (the projections are sorted by post chip)
+	for (size_t i = 0; i < num_projections; i++)
+		if (i == 0 || projections[i].post_chip != projections[i-1].post_chip)
+			chip->num_targets++;
+	
+	chip->targets    = calloc(chip->num_targets, sizeof(spinn_coord_t));
+	chip->alias_prob = calloc(chip->num_targets, sizeof(double));
+	chip->alias      = calloc(chip->num_targets, sizeof(size_t));
+	assert(chip->targets != NULL);
+	assert(chip->alias_prob != NULL);
+	assert(chip->alias != NULL);
+	
+	// Merge the projections to each target, accumulating their rates in
+	// alias_prob for now.
+	size_t n = 0;
+	for (size_t i = 0; i < num_projections; i++) {
+		if (i != 0 && projections[i].post_chip != projections[i-1].post_chip)
+			n++;
+		chip->targets[n].x = projections[i].post_chip % system_size.x;
+		chip->targets[n].y = projections[i].post_chip / system_size.x;
+		chip->alias_prob[n] += projections[i].rate;
+		chip->rate += projections[i].rate;
+	}
+	
+	// Build the alias table using Vose's method. Each target's rate is scaled
+	// such that the mean is 1 and targets are split into those below and those
+	// above the mean. Each slot is then filled by a small target topped up by a
+	// large one.
+	size_t *small = calloc(chip->num_targets, sizeof(size_t));
+	size_t *large = calloc(chip->num_targets, sizeof(size_t));
+	assert(small != NULL);
+	assert(large != NULL);
+	size_t num_small = 0;
+	size_t num_large = 0;
+	
+	for (size_t i = 0; i < chip->num_targets; i++) {
+		chip->alias_prob[i] *= ((double)chip->num_targets) / chip->rate;
+		chip->alias[i] = i;
+		if (chip->alias_prob[i] < 1.0)
+			small[num_small++] = i;
+		else
+			large[num_large++] = i;
+	}
+	
+	while (num_small > 0 && num_large > 0) {
+		size_t s = small[--num_small];
+		size_t l = large[--num_large];
+		
+		chip->alias[s] = l;
+		chip->alias_prob[l] -= 1.0 - chip->alias_prob[s];
+		if (chip->alias_prob[l] < 1.0)
+			small[num_small++] = l;
+		else
+			large[num_large++] = l;
+	}
+	
+	// Any remaining slots are (up to rounding error) exactly full
+	while (num_large > 0)
+		chip->alias_prob[large[--num_large]] = 1.0;
+	while (num_small > 0)
+		chip->alias_prob[small[--num_small]] = 1.0;
+	
+	free(small);
+	free(large);
+	
+	// Convert from Hz to spikes per tick
+	chip->rate /= ticks_per_second;
+}
+
+
+bool
+spinn_snn_load( spinn_snn_t   *snn
+              , const char    *placement_filename
+              , const char    *projection_filename
+              , spinn_coord_t  system_size
+              , double         ticks_per_second
+              )
+{
+	if (!(ticks_per_second > 0.0)) {
+		fprintf(stderr, "The number of ticks per second must be positive.\n");
+		return false;
+	}
+	
+	size_t num_populations;
+	spinn_snn_population_t *populations
+		= spinn_snn_load_placement(placement_filename, system_size, &num_populations);
+	if (populations == NULL)
+		return false;
+	
+	size_t num_projections;
+	spinn_snn_projection_t *projections
+		= spinn_snn_load_projections( projection_filename
+		                            , populations, num_populations
+		                            , &num_projections
+		                            );
+	spinn_snn_free_populations(populations, num_populations);
+	if (projections == NULL)
+		return false;
+	
+	snn->system_size = system_size;
+	
+	size_t num_chips = system_size.x * system_size.y;
+	snn->chips = calloc(num_chips, sizeof(spinn_snn_chip_t));
+	assert(snn->chips != NULL);
+	
+	// Give each chip its run of the (sorted) projections
+	size_t first = 0;
+	for (size_t i = 0; i < num_chips; i++) {
+		size_t last = first;
+		while (last < num_projections && projections[last].pre_chip == i)
+			last++;
+		
+		spinn_snn_chip_init( &(snn->chips[i])
+		                   , projections + first, last - first
+		                   , system_size
+		                   , ticks_per_second
+		                   );
+		first = last;
+	}
+	
+	free(projections);
+	
+	return true;
+}
+
+
+const spinn_snn_chip_t *
+spinn_snn_get_chip(spinn_snn_t *snn, spinn_coord_t position)
+{
+	assert(position.x >= 0 && position.x < snn->system_size.x);
+	assert(position.y >= 0 && position.y < snn->system_size.y);
+	
+	return &(snn->chips[(position.y * snn->system_size.x) + position.x]);
+}
+
+
+double
+spinn_snn_chip_get_rate(const spinn_snn_chip_t *chip)
+{
+	return chip->rate;
+}
+
+
+double
+spinn_snn_chip_next_interval(const spinn_snn_chip_t *chip, rng_t *rng)
+{
+	if (chip->rate <= 0.0)
+		return INFINITY;
+	
+	// Uniform on (0,1]
+	double u = rng_uniform_pos(rng);
+	return -log(u) / chip->rate;
+}
+
+
+spinn_coord_t
+spinn_snn_chip_pick_destination(const spinn_snn_chip_t *chip, rng_t *rng)
+{
+	assert(chip->num_targets > 0);
+	
+	// Pick a slot and then choose between its target and its alias
+	double u = rng_uniform(rng) * chip->num_targets;
+	size_t slot = (size_t)u;
+	if (slot >= chip->num_targets)
+		slot = chip->num_targets - 1;
+	
+	if ((u - slot) < chip->alias_prob[slot])
+		return chip->targets[slot];
+	else
+		return chip->targets[chip->alias[slot]];
+}
+
+
+void
+spinn_snn_destroy(spinn_snn_t *snn)
+{
+	for (size_t i = 0; i < (size_t)(snn->system_size.x * snn->system_size.y); i++) {
+		free(snn->chips[i].targets);
+		free(snn->chips[i].alias_prob);
+		free(snn->chips[i].alias);
+	}
+	free(snn->chips);
+}
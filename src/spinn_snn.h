@@ -0,0 +1,104 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * spinn_snn.h -- Spiking neural network workloads. A workload is described by
+ * a placement of neural populations onto chips and a list of projections
+ * between populations, each carrying spikes at a given rate.
+ *
+ * The placement file contains one population per line in the form:
+ *
+ *   <population> <x> <y>
+ *
+ * The projection file contains one projection per line in the form:
+ *
+ *   <pre population> <post population> <rate in Hz>
+ *
+ * Where the rate is the total number of spikes per second sent along the
+ * projection (i.e. the number of neurons in the pre population multiplied by
+ * their mean firing rate). Each spike results in a single packet from the chip
+ * holding the pre population to the chip holding the post population. In both
+ * files, blank lines and lines starting with a '#' are ignored.
+ *
+ * All projections leaving a chip are merged into a single Poisson process
+ * whose rate is the sum of their rates. The time to each spike is drawn from an
+ * exponential distribution and its destination is chosen using an alias table
+ * weighted by rate so the cost of simulating a chip is proportional to the
+ * number of spikes it sends rather than the number of neurons or projections.
+ */
+
+#ifndef SPINN_SNN_H
+#define SPINN_SNN_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "config.h"
+
+#include "spinn.h"
+#include "rng.h"
+
+/**
+ * A loaded spiking neural network workload.
+ */
+typedef struct spinn_snn spinn_snn_t;
+
+
+/**
+ * The merged stream of spikes sent by a single chip in a workload.
+ */
+typedef struct spinn_snn_chip spinn_snn_chip_t;
+
+
+// Concrete definitions of the above types
+#include "spinn_snn_internal.h"
+
+
+/**
+ * Load a workload for a system of the given size from the named placement and
+ * projection files. Rates are converted from Hz into spikes per tick using
+ * ticks_per_second. Returns false and prints a description of the problem on
+ * stderr if the files could not be read or are not valid.
+ */
+bool spinn_snn_load( spinn_snn_t   *snn
+                   , const char    *placement_filename
+                   , const char    *projection_filename
+                   , spinn_coord_t  system_size
+                   , double         ticks_per_second
+                   );
+
+
+/**
+ * Get the stream of spikes sent by the chip at the given position. The pointer
+ * returned remains valid until the workload is destroyed.
+ */
+const spinn_snn_chip_t *spinn_snn_get_chip(spinn_snn_t *snn, spinn_coord_t position);
+
+
+/**
+ * Get the total rate at which the chip sends spikes (in spikes per tick).
+ */
+double spinn_snn_chip_get_rate(const spinn_snn_chip_t *chip);
+
+
+/**
+ * Draw the number of ticks until the chip's next spike using the given random
+ * number generator (or rand() if NULL). Returns INFINITY if the chip never
+ * sends spikes.
+ */
+double spinn_snn_chip_next_interval(const spinn_snn_chip_t *chip, rng_t *rng);
+
+
+/**
+ * Draw the destination of a spike sent by the chip using the given random number
+ * generator (or rand() if NULL). Must not be called for a chip with no
+ * projections.
+ */
+spinn_coord_t spinn_snn_chip_pick_destination(const spinn_snn_chip_t *chip, rng_t *rng);
+
+
+/**
+ * Free all resources used by the workload.
+ */
+void spinn_snn_destroy(spinn_snn_t *snn);
+
+#endif
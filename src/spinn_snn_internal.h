@@ -0,0 +1,32 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * spinn_snn_internal.h -- Concrete definitions of internal datastrucutres.
+ * This is provided to allow the creation of these types. Users should not
+ * access the fields directly. This file should only be included by
+ * spinn_snn.h
+ */
+
+
+struct spinn_snn_chip {
+	// The total rate of spikes sent by the chip (spikes per tick)
+	double rate;
+	
+	// The chips to which spikes are sent
+	size_t         num_targets;
+	spinn_coord_t *targets;
+	
+	// Alias table for picking a target weighted by the rate of spikes sent to
+	// it. Target i is picked with probability alias_prob[i] when slot i is drawn,
+	// otherwise target alias[i] is picked.
+	double *alias_prob;
+	size_t *alias;
+};
+
+
+struct spinn_snn {
+	spinn_coord_t system_size;
+	
+	// The stream of spikes sent by each chip (in row-major order)
+	spinn_snn_chip_t *chips;
+};
@@ -0,0 +1,337 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * spinn_trace.c -- Binary packet injection traces which can be recorded from a
+ * simulation and later replayed by the packet generators.
+ */
+
+
+#include "config.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "scheduler.h"
+
+#include "spinn.h"
+#include "spinn_trace.h"
+
+
+/**
+ * Number of records copied from the spool file at a time when a trace is
+ * being written.
+ */
+#define SPINN_TRACE_COPY_CHUNK 4096
+
+
+/**
+ * Size of the header and index of a trace for a system with the given number
+ * of nodes. Records start immediately after this.
+ */
+static size_t
+spinn_trace_records_offset(size_t num_nodes)
+{
+	return sizeof(spinn_trace_header_t) + ((num_nodes + 1) * sizeof(uint64_t));
+}
+
+
+/******************************************************************************
+ * Trace reading
+ ******************************************************************************/
+
+bool
+spinn_trace_open(spinn_trace_t *trace, const char *filename)
+{
+	int fd = open(filename, O_RDONLY);
+	if (fd < 0) {
+		fprintf(stderr, "Couldn't open trace %s: %s\n", filename, strerror(errno));
+		return false;
+	}
+	
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		fprintf(stderr, "Couldn't stat trace %s: %s\n", filename, strerror(errno));
+		close(fd);
+		return false;
+	}
+	
+	if ((size_t)st.st_size < sizeof(spinn_trace_header_t)) {
+		fprintf(stderr, "Trace %s is too short to be a trace.\n", filename);
+		close(fd);
+		return false;
+	}
+	
+	trace->mapping_size = st.st_size;
+	trace->mapping = mmap(NULL, trace->mapping_size, PROT_READ, MAP_SHARED, fd, 0);
+	
+	// The mapping remains valid after the file is closed
+	close(fd);
+	
+	if (trace->mapping == MAP_FAILED) {
+		fprintf(stderr, "Couldn't map trace %s: %s\n", filename, strerror(errno));
+		return false;
+	}
+	
+	// Check the header
+	trace->header = (const spinn_trace_header_t *)trace->mapping;
+	if (memcmp(trace->header->magic, SPINN_TRACE_MAGIC, sizeof(trace->header->magic)) != 0) {
+		fprintf(stderr, "%s is not a trace file.\n", filename);
+		munmap(trace->mapping, trace->mapping_size);
+		return false;
+	}
+	if (trace->header->byte_order != SPINN_TRACE_BYTE_ORDER) {
+		fprintf(stderr, "Trace %s was written on a machine with a different byte order.\n", filename);
+		munmap(trace->mapping, trace->mapping_size);
+		return false;
+	}
+	if (trace->header->version != SPINN_TRACE_VERSION) {
+		fprintf(stderr, "Trace %s has unsupported version %u.\n", filename, trace->header->version);
+		munmap(trace->mapping, trace->mapping_size);
+		return false;
+	}
+	
+	// Check the file is large enough for the index and records it claims to
+	// contain
+	size_t num_nodes = (size_t)trace->header->width * (size_t)trace->header->height;
+	size_t records_offset = spinn_trace_records_offset(num_nodes);
+	if (records_offset > trace->mapping_size
+	    || trace->header->num_records > (trace->mapping_size - records_offset) / sizeof(spinn_trace_record_t)
+	   ) {
+		fprintf(stderr, "Trace %s is truncated.\n", filename);
+		munmap(trace->mapping, trace->mapping_size);
+		return false;
+	}
+	
+	trace->slices  = (const uint64_t *)((const char *)trace->mapping + sizeof(spinn_trace_header_t));
+	trace->records = (const spinn_trace_record_t *)((const char *)trace->mapping + records_offset);
+	
+	// Check the index is consistent
+	for (size_t i = 0; i < num_nodes; i++) {
+		if (trace->slices[i] > trace->slices[i+1]) {
+			fprintf(stderr, "Trace %s has a corrupt index.\n", filename);
+			munmap(trace->mapping, trace->mapping_size);
+			return false;
+		}
+	}
+	if (trace->slices[0] != 0 || trace->slices[num_nodes] != trace->header->num_records) {
+		fprintf(stderr, "Trace %s has a corrupt index.\n", filename);
+		munmap(trace->mapping, trace->mapping_size);
+		return false;
+	}
+	
+	return true;
+}
+
+
+spinn_coord_t
+spinn_trace_get_system_size(spinn_trace_t *trace)
+{
+	return (spinn_coord_t){trace->header->width, trace->header->height};
+}
+
+
+size_t
+spinn_trace_get_num_records(spinn_trace_t *trace)
+{
+	return trace->header->num_records;
+}
+
+
+const spinn_trace_record_t *
+spinn_trace_get_records( spinn_trace_t *trace
+                       , spinn_coord_t  source
+                       , size_t        *num_records
+                       )
+{
+	assert(source.x >= 0 && source.x < trace->header->width);
+	assert(source.y >= 0 && source.y < trace->header->height);
+	
+	size_t i = (source.y * trace->header->width) + source.x;
+	*num_records = trace->slices[i+1] - trace->slices[i];
+	return trace->records + trace->slices[i];
+}
+
+
+void
+spinn_trace_close(spinn_trace_t *trace)
+{
+	munmap(trace->mapping, trace->mapping_size);
+}
+
+
+/******************************************************************************
+ * Trace recording
+ ******************************************************************************/
+
+bool
+spinn_trace_writer_open( spinn_trace_writer_t *w
+                       , const char           *filename
+                       , spinn_coord_t         system_size
+                       )
+{
+	const char *spool_suffix = ".spool";
+	
+	w->system_size = system_size;
+	
+	w->filename = calloc(strlen(filename) + 1, sizeof(char));
+	assert(w->filename != NULL);
+	strcpy(w->filename, filename);
+	
+	w->spool_filename = calloc(strlen(filename) + strlen(spool_suffix) + 1, sizeof(char));
+	assert(w->spool_filename != NULL);
+	strcpy(w->spool_filename, filename);
+	strcat(w->spool_filename, spool_suffix);
+	
+	w->node_num_records = calloc(system_size.x * system_size.y, sizeof(uint64_t));
+	assert(w->node_num_records != NULL);
+	
+	w->spool = fopen(w->spool_filename, "w+b");
+	if (w->spool == NULL) {
+		fprintf(stderr, "Couldn't open %s for writing!\n", w->spool_filename);
+		free(w->filename);
+		free(w->spool_filename);
+		free(w->node_num_records);
+		return false;
+	}
+	
+	return true;
+}
+
+
+void
+spinn_trace_writer_append( spinn_trace_writer_t *w
+                         , ticks_t               tick
+                         , spinn_coord_t         source
+                         , spinn_coord_t         destination
+                         )
+{
+	spinn_trace_record_t r;
+	r.tick          = tick;
+	r.source_x      = source.x;
+	r.source_y      = source.y;
+	r.destination_x = destination.x;
+	r.destination_y = destination.y;
+	
+	fwrite(&r, sizeof(spinn_trace_record_t), 1, w->spool);
+	
+	w->node_num_records[(source.y * w->system_size.x) + source.x]++;
+}
+
+
+/**
+ * Write the finished trace file. The spool file must be open and will be read
+ * from the start.
+ */
+static bool
+spinn_trace_writer_write_trace(spinn_trace_writer_t *w)
+{
+	size_t num_nodes = w->system_size.x * w->system_size.y;
+	
+	// Build the index of where each node's slice starts
+	uint64_t *slices = calloc(num_nodes + 1, sizeof(uint64_t));
+	assert(slices != NULL);
+	for (size_t i = 0; i < num_nodes; i++)
+		slices[i+1] = slices[i] + w->node_num_records[i];
+	uint64_t num_records = slices[num_nodes];
+	
+	size_t records_offset = spinn_trace_records_offset(num_nodes);
+	size_t size = records_offset + (num_records * sizeof(spinn_trace_record_t));
+	
+	// Create the output at its full size and map it so that records can be
+	// scattered into their slices.
+	int fd = open(w->filename, O_RDWR | O_CREAT | O_TRUNC, 0666);
+	if (fd < 0) {
+		fprintf(stderr, "Couldn't open %s for writing!\n", w->filename);
+		free(slices);
+		return false;
+	}
+	if (ftruncate(fd, size) != 0) {
+		fprintf(stderr, "Couldn't resize %s: %s\n", w->filename, strerror(errno));
+		close(fd);
+		free(slices);
+		return false;
+	}
+	void *mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED) {
+		fprintf(stderr, "Couldn't map %s: %s\n", w->filename, strerror(errno));
+		free(slices);
+		return false;
+	}
+	
+	// Write the header and index
+	spinn_trace_header_t *header = (spinn_trace_header_t *)mapping;
+	memcpy(header->magic, SPINN_TRACE_MAGIC, sizeof(header->magic));
+	header->version     = SPINN_TRACE_VERSION;
+	header->byte_order  = SPINN_TRACE_BYTE_ORDER;
+	header->width       = w->system_size.x;
+	header->height      = w->system_size.y;
+	header->num_records = num_records;
+	memcpy((char *)mapping + sizeof(spinn_trace_header_t), slices, (num_nodes + 1) * sizeof(uint64_t));
+	
+	// Scatter the spooled records into each node's slice. As records were spooled
+	// in time order, each slice ends up sorted by time. The slice index is reused
+	// as the cursor into each slice.
+	spinn_trace_record_t *records = (spinn_trace_record_t *)((char *)mapping + records_offset);
+	spinn_trace_record_t *chunk = calloc(SPINN_TRACE_COPY_CHUNK, sizeof(spinn_trace_record_t));
+	assert(chunk != NULL);
+	
+	bool success = true;
+	rewind(w->spool);
+	uint64_t num_copied = 0;
+	while (num_copied < num_records) {
+		size_t num_read = fread(chunk, sizeof(spinn_trace_record_t), SPINN_TRACE_COPY_CHUNK, w->spool);
+		if (num_read == 0) {
+			fprintf(stderr, "Couldn't read back %s.\n", w->spool_filename);
+			success = false;
+			break;
+		}
+		
+		for (size_t i = 0; i < num_read; i++) {
+			size_t node = (chunk[i].source_y * w->system_size.x) + chunk[i].source_x;
+			records[slices[node]++] = chunk[i];
+		}
+		num_copied += num_read;
+	}
+	
+	free(chunk);
+	free(slices);
+	
+	if (munmap(mapping, size) != 0) {
+		fprintf(stderr, "Couldn't write %s: %s\n", w->filename, strerror(errno));
+		success = false;
+	}
+	
+	return success;
+}
+
+
+bool
+spinn_trace_writer_close(spinn_trace_writer_t *w)
+{
+	// Any record which failed to be spooled leaves the error flag set
+	bool success = fflush(w->spool) == 0 && !ferror(w->spool);
+	if (!success)
+		fprintf(stderr, "Couldn't write %s.\n", w->spool_filename);
+	else
+		success = spinn_trace_writer_write_trace(w);
+	
+	fclose(w->spool);
+	remove(w->spool_filename);
+	
+	free(w->filename);
+	free(w->spool_filename);
+	free(w->node_num_records);
+	
+	return success;
+}
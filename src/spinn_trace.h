@@ -0,0 +1,141 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * spinn_trace.h -- Binary packet injection traces which can be recorded from a
+ * simulation and later replayed by the packet generators.
+ *
+ * A trace file consists of a fixed-size header, an index giving the offset of
+ * each node's slice of records and then the records themselves. Records are
+ * grouped by source node (in the same row-major order as the nodes of a
+ * simulation) and are sorted by injection time within each slice. All fields
+ * are stored in the host's byte order; files written on a machine of the
+ * opposite endianness are rejected when opened.
+ *
+ * Traces are memory-mapped when opened for reading and so records are accessed
+ * in-place without any parsing or copying.
+ */
+
+#ifndef SPINN_TRACE_H
+#define SPINN_TRACE_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "config.h"
+
+#include "scheduler.h"
+
+#include "spinn.h"
+
+/**
+ * A single packet injection in a trace. Records are packed to 12 bytes.
+ */
+typedef struct spinn_trace_record {
+	// The tick during which the packet was injected into the network
+	uint32_t tick;
+	
+	// Where the packet was injected
+	uint16_t source_x;
+	uint16_t source_y;
+	
+	// Where the packet was sent
+	uint16_t destination_x;
+	uint16_t destination_y;
+} spinn_trace_record_t;
+
+
+/**
+ * A trace file opened for reading.
+ */
+typedef struct spinn_trace spinn_trace_t;
+
+
+/**
+ * A trace file being recorded.
+ */
+typedef struct spinn_trace_writer spinn_trace_writer_t;
+
+
+// Concrete definitions of the above types
+#include "spinn_trace_internal.h"
+
+
+/******************************************************************************
+ * Trace reading
+ ******************************************************************************/
+
+/**
+ * Memory-map the named trace file. Returns false and prints a description of
+ * the problem on stderr if the file could not be opened or is not a valid
+ * trace.
+ */
+bool spinn_trace_open(spinn_trace_t *trace, const char *filename);
+
+
+/**
+ * Get the size of the system the trace was recorded from.
+ */
+spinn_coord_t spinn_trace_get_system_size(spinn_trace_t *trace);
+
+
+/**
+ * Get the total number of records in the trace.
+ */
+size_t spinn_trace_get_num_records(spinn_trace_t *trace);
+
+
+/**
+ * Get the (time-sorted) slice of records injected by the given node. The
+ * number of records in the slice is written to num_records. The pointer
+ * returned remains valid until the trace is closed.
+ */
+const spinn_trace_record_t *spinn_trace_get_records( spinn_trace_t *trace
+                                                   , spinn_coord_t  source
+                                                   , size_t        *num_records
+                                                   );
+
+
+/**
+ * Unmap the trace file.
+ */
+void spinn_trace_close(spinn_trace_t *trace);
+
+
+/******************************************************************************
+ * Trace recording
+ ******************************************************************************/
+
+/**
+ * Start recording a trace of a system of the given size into the named file.
+ * Records are initially spooled into a temporary file alongside the output
+ * which is removed when the writer is closed. Returns false and prints a
+ * description of the problem on stderr if the files could not be created.
+ */
+bool spinn_trace_writer_open( spinn_trace_writer_t *writer
+                            , const char           *filename
+                            , spinn_coord_t         system_size
+                            );
+
+
+/**
+ * Record a packet injection. Injections must be recorded in non-decreasing
+ * order of tick. Failures to record an injection are reported by
+ * spinn_trace_writer_close.
+ */
+void spinn_trace_writer_append( spinn_trace_writer_t *writer
+                              , ticks_t               tick
+                              , spinn_coord_t         source
+                              , spinn_coord_t         destination
+                              );
+
+
+/**
+ * Sort the recorded injections into per-node slices, write the finished trace
+ * file and free all resources used by the writer. Returns false and prints a
+ * description of the problem on stderr if the trace could not be written.
+ */
+bool spinn_trace_writer_close(spinn_trace_writer_t *writer);
+
+#endif
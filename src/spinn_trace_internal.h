@@ -0,0 +1,66 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * spinn_trace_internal.h -- Concrete definitions of internal datastrucutres.
+ * This is provided to allow the creation of these types. Users should not
+ * access the fields directly. This file should only be included by
+ * spinn_trace.h
+ */
+
+
+/**
+ * The header at the start of every trace file.
+ */
+typedef struct spinn_trace_header {
+	// Always SPINN_TRACE_MAGIC
+	char magic[8];
+	
+	// Always SPINN_TRACE_VERSION
+	uint32_t version;
+	
+	// Always SPINN_TRACE_BYTE_ORDER when read in the byte order of the writer
+	uint32_t byte_order;
+	
+	// The size of the system recorded
+	uint32_t width;
+	uint32_t height;
+	
+	// The total number of records in the file
+	uint64_t num_records;
+} spinn_trace_header_t;
+
+#define SPINN_TRACE_MAGIC      "TICKYTRC"
+#define SPINN_TRACE_VERSION    1
+#define SPINN_TRACE_BYTE_ORDER 0x01020304u
+
+
+struct spinn_trace {
+	// The mapping of the whole file
+	void   *mapping;
+	size_t  mapping_size;
+	
+	// Pointers into the mapping
+	const spinn_trace_header_t *header;
+	
+	// The index of the first record of each node's slice. Has one more entry
+	// than the number of nodes, the last being num_records.
+	const uint64_t *slices;
+	
+	const spinn_trace_record_t *records;
+};
+
+
+struct spinn_trace_writer {
+	// The filename of the finished trace
+	char *filename;
+	
+	// The temporary file into which records are spooled in the order they are
+	// recorded, along with its filename.
+	char *spool_filename;
+	FILE *spool;
+	
+	spinn_coord_t system_size;
+	
+	// The number of records spooled for each node
+	uint64_t *node_num_records;
+};
@@ -0,0 +1,150 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * steady_state.c -- Detection of the end of the initial transient of a set of
+ * time series using the MSER-m heuristic.
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+
+#include "config.h"
+
+#include "steady_state.h"
+
+
+void
+steady_state_init( steady_state_t *ss
+                 , int             num_series
+                 , int             batch_size
+                 )
+{
+	assert(num_series > 0);
+	assert(batch_size > 0);
+	
+	ss->num_series = num_series;
+	ss->batch_size = batch_size;
+	
+	ss->num_observations  = 0;
+	ss->observations_size = 64;
+	ss->observations = calloc(ss->observations_size * num_series, sizeof(double));
+	assert(ss->observations != NULL);
+	
+	ss->batch_means = NULL;
+}
+
+
+void
+steady_state_add(steady_state_t *ss, const double *values)
+{
+	// Grow the array as required
+	if (ss->num_observations == ss->observations_size) {
+		ss->observations_size *= 2;
+		ss->observations = realloc(ss->observations, ss->observations_size * ss->num_series * sizeof(double));
+		assert(ss->observations != NULL);
+	}
+	
+	for (int i = 0; i < ss->num_series; i++)
+		ss->observations[(ss->num_observations * ss->num_series) + i] = values[i];
+	ss->num_observations++;
+}
+
+
+size_t
+steady_state_get_num_observations(steady_state_t *ss)
+{
+	return ss->num_observations;
+}
+
+
+/**
+ * Find the MSER truncation point (in batches) of the given batch means.
+ */
+static size_t
+steady_state_mser(const double *batch_means, size_t num_batches)
+{
+	// Work backwards from the end of the series accumulating the sum and sum of
+	// squares of the batch means after each truncation point. The last batch is
+	// never considered as a truncation point since the variance of a single
+	// value is meaningless.
+	double sum    = batch_means[num_batches - 1];
+	double sum_sq = batch_means[num_batches - 1] * batch_means[num_batches - 1];
+	
+	size_t best_d    = num_batches - 1;
+	double best_mser = 0.0;
+	bool   found     = false;
+	for (size_t d = num_batches - 1; d-- > 0;) {
+		sum    += batch_means[d];
+		sum_sq += batch_means[d] * batch_means[d];
+		
+		double n = (double)(num_batches - d);
+		double sum_sq_dev = sum_sq - ((sum * sum) / n);
+		if (sum_sq_dev < 0.0)
+			sum_sq_dev = 0.0;
+		double mser = sum_sq_dev / (n * n);
+		
+		// Prefer the earliest truncation point in the event of a tie
+		if (!found || mser <= best_mser) {
+			best_d    = d;
+			best_mser = mser;
+			found     = true;
+		}
+	}
+	
+	return best_d;
+}
+
+
+bool
+steady_state_reached(steady_state_t *ss, size_t *truncation)
+{
+	size_t num_batches = ss->num_observations / ss->batch_size;
+	
+	// At least two batches must remain after truncating half the series
+	if (num_batches < 4) {
+		if (truncation != NULL)
+			*truncation = ss->num_observations;
+		return false;
+	}
+	
+	ss->batch_means = realloc(ss->batch_means, num_batches * sizeof(double));
+	assert(ss->batch_means != NULL);
+	
+	bool   reached  = true;
+	size_t latest_d = 0;
+	for (int s = 0; s < ss->num_series; s++) {
+		for (size_t b = 0; b < num_batches; b++) {
+			double sum = 0.0;
+			for (int i = 0; i < ss->batch_size; i++)
+				sum += ss->observations[(((b * ss->batch_size) + i) * ss->num_series) + s];
+			ss->batch_means[b] = sum / (double)ss->batch_size;
+		}
+		
+		size_t d = steady_state_mser(ss->batch_means, num_batches);
+		if (d > num_batches / 2)
+			reached = false;
+		if (d > latest_d)
+			latest_d = d;
+	}
+	
+	if (truncation != NULL)
+		*truncation = latest_d * ss->batch_size;
+	
+	return reached;
+}
+
+
+void
+steady_state_reset(steady_state_t *ss)
+{
+	ss->num_observations = 0;
+}
+
+
+void
+steady_state_destroy(steady_state_t *ss)
+{
+	free(ss->observations);
+	free(ss->batch_means);
+}
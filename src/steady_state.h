@@ -0,0 +1,78 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * steady_state.h -- Detection of the end of the initial transient of a set of
+ * time series using the MSER-m (Marginal Standard Error Rule) heuristic.
+ *
+ * Observations of each series are grouped into batches of m observations (m = 5
+ * gives the commonly used MSER-5). For each candidate truncation point d the
+ * MSER statistic is the variance of the batch means after d divided by the
+ * number of batches remaining. The truncation point minimising this statistic
+ * is the estimated end of the transient. If it lies in the first half of the
+ * series, the series is deemed to have reached steady state; otherwise the
+ * series is still changing (or too short to tell).
+ */
+
+#ifndef STEADY_STATE_H
+#define STEADY_STATE_H
+
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "config.h"
+
+/**
+ * A data structure recording a set of time series.
+ */
+typedef struct steady_state steady_state_t;
+
+
+// Concrete definitions of the above types
+#include "steady_state_internal.h"
+
+
+/**
+ * Initialise a new, empty set of time series.
+ *
+ * @param num_series The number of series observed.
+ * @param batch_size The number of observations averaged into each batch (i.e.
+ *                   the m in MSER-m).
+ */
+void steady_state_init( steady_state_t *ss
+                      , int             num_series
+                      , int             batch_size
+                      );
+
+
+/**
+ * Add an observation of every series. values must contain num_series values.
+ */
+void steady_state_add(steady_state_t *ss, const double *values);
+
+
+/**
+ * Get the number of observations made of each series.
+ */
+size_t steady_state_get_num_observations(steady_state_t *ss);
+
+
+/**
+ * Test whether every series has reached steady state. If truncation is not
+ * NULL, it is set to the latest estimated end of the transient of any series
+ * (in observations).
+ */
+bool steady_state_reached(steady_state_t *ss, size_t *truncation);
+
+
+/**
+ * Discard all observations.
+ */
+void steady_state_reset(steady_state_t *ss);
+
+
+/**
+ * Free the resources used by a set of time series.
+ */
+void steady_state_destroy(steady_state_t *ss);
+
+#endif
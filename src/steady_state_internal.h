@@ -0,0 +1,22 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * steady_state_internal.h -- Concrete definitions of internal datastrucutres.
+ * This is provided to allow the creation of these types. Users should not
+ * access the fields directly. This file should only be included by
+ * steady_state.h
+ */
+
+struct steady_state {
+	int num_series;
+	int batch_size;
+	
+	// The observations made so far stored as an array of num_observations rows
+	// of num_series values.
+	double *observations;
+	size_t  num_observations;
+	size_t  observations_size;
+	
+	// Scratch space for the batch means of a single series
+	double *batch_means;
+};
@@ -0,0 +1,170 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * time_series.c -- Compact binary time series of integer counters.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdio.h>
+#include <assert.h>
+
+#include "config.h"
+
+#include "time_series.h"
+
+
+/******************************************************************************
+ * Internal: Utilities
+ ******************************************************************************/
+
+/**
+ * The largest number of bytes in the varint encoding of a 64-bit value.
+ */
+#define MAX_VARINT_LENGTH 10
+
+
+/**
+ * Encode a varint into the given buffer, returning the number of bytes used.
+ */
+static size_t
+encode_varint(uint8_t *buf, uint64_t value)
+{
+	size_t length = 0;
+	while (value >= 0x80) {
+		buf[length++] = (uint8_t)(value | 0x80);
+		value >>= 7;
+	}
+	buf[length++] = (uint8_t)value;
+	return length;
+}
+
+
+/**
+ * Zig-zag encode a signed value.
+ */
+static uint64_t
+zigzag(int64_t value)
+{
+	return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+
+/**
+ * Write a varint to the given file.
+ */
+static void
+write_varint(FILE *f, uint64_t value)
+{
+	uint8_t buf[MAX_VARINT_LENGTH];
+	fwrite(buf, 1, encode_varint(buf, value), f);
+}
+
+
+/**
+ * Write a NUL-terminated string for each of the given strings.
+ */
+static void
+write_strings(FILE *f, int num_strings, const char **strings)
+{
+	for (int i = 0; i < num_strings; i++)
+		fwrite(strings[i], 1, strlen(strings[i]) + 1, f);
+}
+
+
+/******************************************************************************
+ * Public functions
+ ******************************************************************************/
+
+void
+time_series_init( time_series_t  *ts
+                , int             num_labels
+                , const char    **label_names
+                , int             num_columns
+                , const char    **column_names
+                )
+{
+	ts->num_labels  = num_labels;
+	ts->label_names = calloc(num_labels + 1, sizeof(char *));
+	assert(ts->label_names != NULL);
+	for (int i = 0; i < num_labels; i++) {
+		ts->label_names[i] = strdup(label_names[i]);
+		assert(ts->label_names[i] != NULL);
+	}
+	
+	ts->num_columns  = num_columns;
+	ts->column_names = calloc(num_columns + 1, sizeof(char *));
+	assert(ts->column_names != NULL);
+	for (int i = 0; i < num_columns; i++) {
+		ts->column_names[i] = strdup(column_names[i]);
+		assert(ts->column_names[i] != NULL);
+	}
+	
+	ts->last_time = 0;
+	ts->last_row  = calloc(num_columns + 1, sizeof(int64_t));
+	assert(ts->last_row != NULL);
+	
+	ts->encoded = malloc(1 + (num_columns + 1) * MAX_VARINT_LENGTH);
+	assert(ts->encoded != NULL);
+}
+
+
+void
+time_series_write_header(time_series_t *ts, FILE *f)
+{
+	fwrite(TIME_SERIES_MAGIC, 1, strlen(TIME_SERIES_MAGIC), f);
+	write_varint(f, TIME_SERIES_VERSION);
+	write_varint(f, ts->num_labels);
+	write_varint(f, ts->num_columns);
+	write_strings(f, ts->num_labels,  (const char **)ts->label_names);
+	write_strings(f, ts->num_columns, (const char **)ts->column_names);
+}
+
+
+void
+time_series_set_labels(time_series_t *ts, FILE *f, const char **label_values)
+{
+	fputc(TIME_SERIES_TAG_LABELS, f);
+	write_strings(f, ts->num_labels, label_values);
+	
+	// The next row is encoded relative to zero
+	ts->last_time = 0;
+	memset(ts->last_row, 0, ts->num_columns * sizeof(int64_t));
+}
+
+
+void
+time_series_append(time_series_t *ts, FILE *f, uint64_t time, const int64_t *row)
+{
+	assert(time >= ts->last_time);
+	
+	// Encode the whole row and write it at once
+	size_t length = 0;
+	ts->encoded[length++] = TIME_SERIES_TAG_ROW;
+	length += encode_varint(ts->encoded + length, time - ts->last_time);
+	for (int i = 0; i < ts->num_columns; i++)
+		length += encode_varint( ts->encoded + length
+		                       , zigzag((int64_t)((uint64_t)row[i] - (uint64_t)ts->last_row[i]))
+		                       );
+	fwrite(ts->encoded, 1, length, f);
+	
+	ts->last_time = time;
+	memcpy(ts->last_row, row, ts->num_columns * sizeof(int64_t));
+}
+
+
+void
+time_series_destroy(time_series_t *ts)
+{
+	for (int i = 0; i < ts->num_labels; i++)
+		free(ts->label_names[i]);
+	free(ts->label_names);
+	
+	for (int i = 0; i < ts->num_columns; i++)
+		free(ts->column_names[i]);
+	free(ts->column_names);
+	
+	free(ts->last_row);
+	free(ts->encoded);
+}
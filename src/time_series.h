@@ -0,0 +1,92 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * time_series.h -- Compact binary time series of integer counters.
+ *
+ * A time series has a fixed set of integer columns (e.g. counters sampled at
+ * the end of every window of a simulation) and a fixed set of string labels
+ * (e.g. the group, sample and independent variables of an experiment). Each
+ * row gives the time it was taken and the value of every column. Since
+ * consecutive rows of counters differ little, every row is stored as the
+ * difference from the previous row using variable-length integers, so a row of
+ * counters which changed by less than 64 takes one byte per column.
+ *
+ * A file starts with the magic TIME_SERIES_MAGIC followed by varints giving the
+ * version, the number of labels and the number of columns and then the
+ * NUL-terminated names of the labels and columns. A sequence of records then
+ * follows, each starting with a tag byte:
+ *
+ * - TIME_SERIES_TAG_LABELS is followed by the NUL-terminated value of every
+ *   label which applies to all following rows. The previous row (time and every
+ *   value) is reset to zero.
+ * - TIME_SERIES_TAG_ROW is followed by a varint giving the time since the
+ *   previous row and a zig-zag encoded varint giving the change in each column
+ *   since the previous row.
+ *
+ * Varints are little-endian base-128 (seven bits per byte, the top bit set on
+ * all but the last byte). Zig-zag encoding maps signed values to unsigned
+ * values with small magnitudes remaining small (0, -1, 1, -2, ... become 0, 1,
+ * 2, 3, ...).
+ *
+ * As with columnar tables, the writer does not hold the file being written but
+ * is given it by every call which may write to it. Use util/time_series_to_tsv.py
+ * to decode a file.
+ */
+
+#ifndef TIME_SERIES_H
+#define TIME_SERIES_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "config.h"
+
+/**
+ * A writer of a time series.
+ */
+typedef struct time_series time_series_t;
+
+
+// Concrete definitions of the above types
+#include "time_series_internal.h"
+
+
+/**
+ * Initialise a writer for a time series with the given labels and columns. The
+ * names are copied.
+ */
+void time_series_init( time_series_t  *ts
+                     , int             num_labels
+                     , const char    **label_names
+                     , int             num_columns
+                     , const char    **column_names
+                     );
+
+
+/**
+ * Write the header of the time series to the given file.
+ */
+void time_series_write_header(time_series_t *ts, FILE *f);
+
+
+/**
+ * Set the value of every label for the rows which follow (writing them to the
+ * given file). The values need not remain valid.
+ */
+void time_series_set_labels(time_series_t *ts, FILE *f, const char **label_values);
+
+
+/**
+ * Write a row of num_columns values taken at the given time to the given file.
+ * Times should not decrease between rows with the same labels.
+ */
+void time_series_append(time_series_t *ts, FILE *f, uint64_t time, const int64_t *row);
+
+
+/**
+ * Free the resources used by the writer.
+ */
+void time_series_destroy(time_series_t *ts);
+
+#endif
@@ -0,0 +1,30 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * time_series_internal.h -- Concrete definitions of internal datastrucutres.
+ * This is provided to allow the creation of these types. Users should not
+ * access the fields directly. This file should only be included by
+ * time_series.h
+ */
+
+#define TIME_SERIES_MAGIC      "TICKYTSS"
+#define TIME_SERIES_VERSION    1
+#define TIME_SERIES_TAG_LABELS 'L'
+#define TIME_SERIES_TAG_ROW    'R'
+
+
+struct time_series {
+	int    num_labels;
+	char **label_names;
+	
+	int    num_columns;
+	char **column_names;
+	
+	// The previous row written (which the next row is encoded relative to)
+	uint64_t  last_time;
+	int64_t  *last_row;
+	
+	// Space to encode a row before it is written (long enough for the tag and
+	// the largest varint for the time and every column)
+	uint8_t *encoded;
+};
@@ -33,6 +33,10 @@ buffer_t *inputs_p[NUM_INPUTS];
 // Output buffer
 buffer_t output;
 
+// The inputs of the values passed to on_forward in order (and the number)
+size_t forwarded_inputs[NUM_INPUTS];
+int    num_forwarded;
+
 
 
 /**
@@ -70,6 +74,22 @@ check_arbiter_teardown(void)
 }
 
 
+/**
+ * Forwarding callback recording the input each value came from (and checking
+ * it was placed in the output).
+ */
+void
+on_arbiter_forward(arbiter_t *arbiter, size_t input, void *value, void *data)
+{
+	ck_assert(arbiter == &a);
+	ck_assert(data == (void *)&num_forwarded);
+	ck_assert((size_t)value == input);
+	ck_assert(!buffer_is_empty(&output));
+	
+	forwarded_inputs[num_forwarded++] = input;
+}
+
+
 /**
  * Ensure that a full buffer of values propagates through one-per-period
  */
@@ -107,6 +127,9 @@ START_TEST (test_round_robbin)
 	// each input
 	ck_assert(NUM_INPUTS <= buf_len);
 	
+	num_forwarded = 0;
+	arbiter_set_on_forward(&a, on_arbiter_forward, (void *)&num_forwarded);
+	
 	// Place a couple of values in each input buffer (so that after pulling one
 	// item out of each buffer the buffer is still not empty. As a bodge, identify
 	// each input by casting the input number as the void pointer to send...
@@ -128,6 +151,18 @@ START_TEST (test_round_robbin)
 	
 	// We should have grabbed everything there was to grab!
 	ck_assert(buffer_is_empty(&output));
+	
+	// The callback was raised for each value forwarded
+	ck_assert_int_eq(num_forwarded, NUM_INPUTS);
+	for (int i = 0; i < NUM_INPUTS; i++)
+		ck_assert_int_eq(forwarded_inputs[i], i);
+	
+	// Each input was granted once and waited while the others were granted
+	for (int i = 0; i < NUM_INPUTS; i++) {
+		ck_assert_int_eq(arbiter_get_num_granted(&a, i), 1);
+		ck_assert_int_eq(arbiter_get_num_waiting(&a, i), NUM_INPUTS-1);
+	}
+	ck_assert_int_eq(arbiter_get_num_blocked(&a), 0);
 }
 END_TEST
 
@@ -157,6 +192,11 @@ START_TEST (test_output_blocked)
 	ck_assert(!buffer_is_empty(&(inputs[0])));
 	ck_assert(buffer_is_full(&output));
 	
+	// The input waited during both arbiter cycles
+	ck_assert_int_eq(arbiter_get_num_blocked(&a), 2);
+	ck_assert_int_eq(arbiter_get_num_waiting(&a, 0), 2);
+	ck_assert_int_eq(arbiter_get_num_granted(&a, 0), 0);
+	
 	// Unblock it and make sure it goes again
 	buffer_pop(&output);
 	ck_assert(!buffer_is_full(&output));
@@ -170,6 +210,15 @@ START_TEST (test_output_blocked)
 	// Check that the input buffer did empty this time
 	ck_assert(buffer_is_empty(&(inputs[0])));
 	ck_assert(buffer_is_full(&output));
+	
+	// Once the input is empty a full output no longer counts as blocking
+	ck_assert_int_eq(arbiter_get_num_blocked(&a), 2);
+	ck_assert_int_eq(arbiter_get_num_granted(&a, 0), 1);
+	
+	arbiter_reset_counters(&a);
+	ck_assert_int_eq(arbiter_get_num_blocked(&a), 0);
+	ck_assert_int_eq(arbiter_get_num_waiting(&a, 0), 0);
+	ck_assert_int_eq(arbiter_get_num_granted(&a, 0), 0);
 }
 END_TEST
 
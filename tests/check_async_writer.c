@@ -0,0 +1,149 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * check_async_writer.c -- Unit tests for double-buffered background writing.
+ */
+
+#include <check.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "config.h"
+
+#include "check_check.h"
+
+#include "../src/async_writer.h"
+
+/******************************************************************************
+ * Testbench
+ ******************************************************************************/
+
+// Number of lines written in the round-trip tests
+#define NUM_LINES 20000
+
+char async_writer_filename[] = "/tmp/check_async_writer_XXXXXX";
+
+async_writer_t w;
+
+void
+check_async_writer_setup(void)
+{
+	// Reserve a unique filename for the output
+	strcpy(async_writer_filename, "/tmp/check_async_writer_XXXXXX");
+	int fd = mkstemp(async_writer_filename);
+	ck_assert(fd >= 0);
+	close(fd);
+}
+
+
+void
+check_async_writer_teardown(void)
+{
+	remove(async_writer_filename);
+}
+
+
+/**
+ * Open a writer for the test file.
+ */
+static FILE *
+open_writer(size_t buffer_size, async_writer_policy_t policy)
+{
+	FILE *file = fopen(async_writer_filename, "w");
+	ck_assert(file != NULL);
+	FILE *stream = async_writer_open(&w, file, buffer_size, policy);
+	ck_assert(stream != NULL);
+	return stream;
+}
+
+
+/**
+ * Check that the file contains exactly the lines written by test_round_trip.
+ */
+static void
+check_lines(int num_lines)
+{
+	FILE *f = fopen(async_writer_filename, "r");
+	ck_assert(f != NULL);
+	
+	char line[64];
+	int i;
+	for (i = 0; fgets(line, sizeof(line), f) != NULL; i++) {
+		char expected[64];
+		snprintf(expected, sizeof(expected), "line %d of the output\n", i);
+		ck_assert(strcmp(line, expected) == 0);
+	}
+	ck_assert_int_eq(i, num_lines);
+	
+	fclose(f);
+}
+
+
+/******************************************************************************
+ * Testcases
+ ******************************************************************************/
+
+START_TEST (test_empty)
+{
+	FILE *stream = open_writer(1024, ASYNC_WRITER_GROW);
+	ck_assert_int_eq(fclose(stream), 0);
+	
+	check_lines(0);
+	ck_assert_int_eq(async_writer_get_num_overflows(&w), 0);
+	ck_assert_int_eq(async_writer_get_num_stalls(&w), 0);
+	ck_assert_int_eq(async_writer_get_peak_length(&w), 0);
+}
+END_TEST
+
+
+/**
+ * Write many lines with each policy and a range of buffer sizes (given by the
+ * loop iteration) and check they all arrive in order.
+ */
+START_TEST (test_round_trip)
+{
+	async_writer_policy_t policy = (_i % 2) ? ASYNC_WRITER_BLOCK : ASYNC_WRITER_GROW;
+	size_t buffer_size = (size_t[]){1, 64, 4096, 1 << 20}[_i / 2];
+	
+	FILE *stream = open_writer(buffer_size, policy);
+	
+	// Unbuffered so that every line reaches the writer separately
+	if (_i / 2 == 0)
+		setvbuf(stream, NULL, _IONBF, 0);
+	
+	for (int i = 0; i < NUM_LINES; i++)
+		fprintf(stream, "line %d of the output\n", i);
+	ck_assert_int_eq(fclose(stream), 0);
+	
+	check_lines(NUM_LINES);
+	
+	// Only the blocking policy stalls, and then whenever the writer falls behind
+	if (policy == ASYNC_WRITER_BLOCK)
+		ck_assert_int_eq(async_writer_get_num_stalls(&w), async_writer_get_num_overflows(&w));
+	else
+		ck_assert_int_eq(async_writer_get_num_stalls(&w), 0);
+	
+	ck_assert(async_writer_get_peak_length(&w) > 0);
+}
+END_TEST
+
+
+Suite *
+make_async_writer_suite(void)
+{
+	Suite *s = suite_create("async_writer");
+	
+	// Add tests to the test case
+	TCase *tc_core = tcase_create("Core");
+	tcase_add_checked_fixture(tc_core, check_async_writer_setup, check_async_writer_teardown);
+	tcase_add_test(tc_core, test_empty);
+	tcase_add_loop_test(tc_core, test_round_trip, 0, 8);
+	
+	// Add each test case to the suite
+	suite_add_tcase(s, tc_core);
+	
+	return s;
+}
@@ -0,0 +1,122 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * check_batch_means.c -- Unit tests for the batch means estimator.
+ */
+
+#include <check.h>
+#include <math.h>
+
+#include "config.h"
+
+#include "check_check.h"
+
+#include "../src/batch_means.h"
+
+// Tolerance used when comparing with tabulated values
+#define TOLERANCE 0.005
+
+batch_means_t bm;
+
+
+void
+check_batch_means_setup(void)
+{
+	batch_means_init(&bm, 0.95);
+}
+
+
+void
+check_batch_means_teardown(void)
+{
+	// Nothing to do
+}
+
+
+/**
+ * Test the t critical values against tabulated values.
+ */
+START_TEST (test_t_critical)
+{
+	ck_assert(fabs(batch_means_t_critical(0.95, 1)   - 12.706) < TOLERANCE);
+	ck_assert(fabs(batch_means_t_critical(0.95, 2)   - 4.303)  < TOLERANCE);
+	ck_assert(fabs(batch_means_t_critical(0.95, 4)   - 2.776)  < TOLERANCE);
+	ck_assert(fabs(batch_means_t_critical(0.95, 9)   - 2.262)  < TOLERANCE);
+	ck_assert(fabs(batch_means_t_critical(0.95, 30)  - 2.042)  < TOLERANCE);
+	ck_assert(fabs(batch_means_t_critical(0.99, 10)  - 3.169)  < TOLERANCE);
+	ck_assert(fabs(batch_means_t_critical(0.90, 20)  - 1.725)  < TOLERANCE);
+	ck_assert(fabs(batch_means_t_critical(0.95, 1000) - 1.962) < TOLERANCE);
+}
+END_TEST
+
+
+/**
+ * Test that no interval is given without enough batches.
+ */
+START_TEST (test_empty)
+{
+	ck_assert_int_eq(batch_means_get_num_batches(&bm), 0);
+	ck_assert(isnan(batch_means_get_mean(&bm)));
+	ck_assert(isinf(batch_means_get_half_width(&bm)));
+	ck_assert(!batch_means_precise(&bm, 1.0));
+	
+	batch_means_add(&bm, 5.0);
+	ck_assert_int_eq(batch_means_get_num_batches(&bm), 1);
+	ck_assert(batch_means_get_mean(&bm) == 5.0);
+	ck_assert(isinf(batch_means_get_half_width(&bm)));
+	ck_assert(!batch_means_precise(&bm, 1.0));
+}
+END_TEST
+
+
+/**
+ * Test the interval of a known set of batch means.
+ */
+START_TEST (test_interval)
+{
+	for (int i = 1; i <= 5; i++)
+		batch_means_add(&bm, (double)i);
+	
+	// Mean 3, sample standard deviation sqrt(2.5), t(0.975, 4) = 2.776
+	ck_assert(fabs(batch_means_get_mean(&bm) - 3.0) < 1e-9);
+	double half_width = 2.776 * sqrt(2.5) / sqrt(5.0);
+	ck_assert(fabs(batch_means_get_half_width(&bm) - half_width) < TOLERANCE);
+	
+	ck_assert(batch_means_precise(&bm, 0.7));
+	ck_assert(!batch_means_precise(&bm, 0.6));
+}
+END_TEST
+
+
+/**
+ * Test that identical batches give a zero-width interval.
+ */
+START_TEST (test_constant)
+{
+	for (int i = 0; i < 3; i++)
+		batch_means_add(&bm, 0.0);
+	
+	ck_assert(batch_means_get_half_width(&bm) == 0.0);
+	ck_assert(batch_means_precise(&bm, 0.0));
+}
+END_TEST
+
+
+Suite *
+make_batch_means_suite(void)
+{
+	Suite *s = suite_create("batch_means");
+	
+	// Add tests to the test case
+	TCase *tc_core = tcase_create("Core");
+	tcase_add_checked_fixture(tc_core, check_batch_means_setup, check_batch_means_teardown);
+	tcase_add_test(tc_core, test_t_critical);
+	tcase_add_test(tc_core, test_empty);
+	tcase_add_test(tc_core, test_interval);
+	tcase_add_test(tc_core, test_constant);
+	
+	// Add each test case to the suite
+	suite_add_tcase(s, tc_core);
+	
+	return s;
+}
@@ -6,9 +6,12 @@
 
 #include <check.h>
 
+#include <stdio.h>
+
 #include "config.h"
 
 #include "check_check.h"
+#include "../src/scheduler.h"
 #include "../src/buffer.h"
 
 START_TEST (test_buffer_push_pop)
@@ -70,6 +73,119 @@ START_TEST (test_buffer_push_pop)
 END_TEST
 
 
+/**
+ * Snapshot value callbacks which save the offset of a char pointer from the
+ * start of the string given as data.
+ */
+static bool
+save_char(FILE *f, void *value, void *data)
+{
+	int offset = (char *)value - (char *)data;
+	return fwrite(&offset, sizeof(offset), 1, f) == 1;
+}
+
+static bool
+restore_char(FILE *f, void **value, void *data)
+{
+	int offset;
+	if (fread(&offset, sizeof(offset), 1, f) != 1)
+		return false;
+	*value = (void *)((char *)data + offset);
+	return true;
+}
+
+
+/**
+ * Make sure a buffer's contents survive being saved and restored (even when the
+ * values wrap around the end of the buffer) and that a snapshot which doesn't
+ * fit is rejected.
+ */
+START_TEST (test_buffer_save_restore)
+{
+	char *pointables = "ABCD";
+	
+	buffer_t b;
+	buffer_init(&b, 4);
+	
+	// Move the pointers part-way along so that the contents wrap around
+	for (int i = 0; i < 3; i++)
+		buffer_push(&b, (void *)pointables);
+	for (int i = 0; i < 3; i++)
+		buffer_pop(&b);
+	for (int i = 0; i < 3; i++)
+		buffer_push(&b, (void *)(pointables + i));
+	
+	FILE *f = tmpfile();
+	ck_assert(f != NULL);
+	ck_assert(buffer_save(&b, f, save_char, (void *)pointables));
+	
+	// Restore into a fresh buffer
+	buffer_t restored;
+	buffer_init(&restored, 4);
+	rewind(f);
+	ck_assert(buffer_restore(&restored, f, restore_char, (void *)pointables));
+	for (int i = 0; i < 3; i++)
+		ck_assert(buffer_pop(&restored) == (void *)(pointables + i));
+	ck_assert(buffer_is_empty(&restored));
+	
+	// A smaller buffer can't hold the values
+	buffer_t small;
+	buffer_init(&small, 2);
+	rewind(f);
+	ck_assert(!buffer_restore(&small, f, restore_char, (void *)pointables));
+	
+	fclose(f);
+	buffer_destroy(&b);
+	buffer_destroy(&restored);
+	buffer_destroy(&small);
+}
+END_TEST
+
+
+/**
+ * Test the time spent at each occupancy is recorded once enabled.
+ */
+START_TEST (test_buffer_stats)
+{
+	scheduler_t s;
+	scheduler_init(&s);
+	
+	buffer_t b;
+	buffer_init(&b, 2);
+	
+	// Nothing is recorded until enabled
+	buffer_push(&b, NULL);
+	scheduler_tick_tock(&s);
+	ck_assert_int_eq(buffer_get_stats_ticks(&b, 1), 0);
+	
+	// One value for 3 ticks, two for 2 ticks then none for 1 tick
+	buffer_enable_stats(&b, &s);
+	for (int i = 0; i < 3; i++)
+		scheduler_tick_tock(&s);
+	buffer_push(&b, NULL);
+	for (int i = 0; i < 2; i++)
+		scheduler_tick_tock(&s);
+	buffer_pop(&b);
+	buffer_pop(&b);
+	scheduler_tick_tock(&s);
+	
+	ck_assert_int_eq(buffer_get_stats_ticks(&b, 0), 1);
+	ck_assert_int_eq(buffer_get_stats_ticks(&b, 1), 3);
+	ck_assert_int_eq(buffer_get_stats_ticks(&b, 2), 2);
+	
+	// Re-enabling discards the statistics so far
+	buffer_enable_stats(&b, &s);
+	scheduler_tick_tock(&s);
+	ck_assert_int_eq(buffer_get_stats_ticks(&b, 0), 1);
+	ck_assert_int_eq(buffer_get_stats_ticks(&b, 1), 0);
+	ck_assert_int_eq(buffer_get_stats_ticks(&b, 2), 0);
+	
+	buffer_destroy(&b);
+	scheduler_destroy(&s);
+}
+END_TEST
+
+
 Suite *
 make_buffer_suite(void)
 {
@@ -78,6 +194,8 @@ make_buffer_suite(void)
 	// Add tests to the test case
 	TCase *tc_core = tcase_create("Core");
 	tcase_add_test(tc_core, test_buffer_push_pop);
+	tcase_add_test(tc_core, test_buffer_save_restore);
+	tcase_add_test(tc_core, test_buffer_stats);
 	
 	// Add each test case to the suite
 	suite_add_tcase(s, tc_core);
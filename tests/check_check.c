@@ -25,12 +25,28 @@ main(int argc, char *argv[])
 	srunner_add_suite(sr, make_buffer_suite());
 	srunner_add_suite(sr, make_scheduler_suite());
 	srunner_add_suite(sr, make_delay_suite());
+	srunner_add_suite(sr, make_steady_state_suite());
+	srunner_add_suite(sr, make_batch_means_suite());
+	srunner_add_suite(sr, make_rng_suite());
+	srunner_add_suite(sr, make_columnar_suite());
+	srunner_add_suite(sr, make_async_writer_suite());
+	srunner_add_suite(sr, make_histogram_suite());
+	srunner_add_suite(sr, make_time_series_suite());
 	srunner_add_suite(sr, make_spinn_topology_suite());
 	srunner_add_suite(sr, make_spinn_router_suite());
+	srunner_add_suite(sr, make_spinn_mc_table_suite());
 	srunner_add_suite(sr, make_spinn_packet_init_dor());
 	srunner_add_suite(sr, make_spinn_packet_pool_suite());
 	srunner_add_suite(sr, make_spinn_packet_gen_suite());
 	srunner_add_suite(sr, make_spinn_packet_con_suite());
+	srunner_add_suite(sr, make_spinn_trace_suite());
+	srunner_add_suite(sr, make_spinn_flow_matrix_suite());
+	srunner_add_suite(sr, make_spinn_snn_suite());
+	srunner_add_suite(sr, make_spinn_sim_model_suite());
+	srunner_add_suite(sr, make_spinn_sim_suite());
+	srunner_add_suite(sr, make_spinn_sim_cache_suite());
+	srunner_add_suite(sr, make_spinn_sim_parallel_suite());
+	srunner_add_suite(sr, make_spinn_sim_cost_suite());
 	
 	// Run the tests
 	srunner_run_all(sr, CK_NORMAL);
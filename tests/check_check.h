@@ -16,11 +16,27 @@ Suite *make_arbiter_suite(void);
 Suite *make_buffer_suite(void);
 Suite *make_scheduler_suite(void);
 Suite *make_delay_suite(void);
+Suite *make_steady_state_suite(void);
+Suite *make_batch_means_suite(void);
+Suite *make_rng_suite(void);
+Suite *make_columnar_suite(void);
+Suite *make_async_writer_suite(void);
+Suite *make_histogram_suite(void);
+Suite *make_time_series_suite(void);
 Suite *make_spinn_topology_suite(void);
 Suite *make_spinn_router_suite(void);
+Suite *make_spinn_mc_table_suite(void);
 Suite *make_spinn_packet_init_dor(void);
 Suite *make_spinn_packet_pool_suite(void);
 Suite *make_spinn_packet_gen_suite(void);
 Suite *make_spinn_packet_con_suite(void);
+Suite *make_spinn_trace_suite(void);
+Suite *make_spinn_flow_matrix_suite(void);
+Suite *make_spinn_snn_suite(void);
+Suite *make_spinn_sim_model_suite(void);
+Suite *make_spinn_sim_suite(void);
+Suite *make_spinn_sim_cache_suite(void);
+Suite *make_spinn_sim_parallel_suite(void);
+Suite *make_spinn_sim_cost_suite(void);
 
 #endif
@@ -0,0 +1,234 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * check_columnar.c -- Unit tests for binary columnar tables.
+ */
+
+#include <check.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "config.h"
+
+#include "check_check.h"
+
+#include "../src/columnar.h"
+
+/******************************************************************************
+ * Testbench
+ ******************************************************************************/
+
+#define NUM_LABELS  2
+#define NUM_COLUMNS 3
+
+const char *label_names[NUM_LABELS]   = { "group", "sample" };
+const char *column_names[NUM_COLUMNS] = { "x", "y", "value" };
+
+columnar_t c;
+FILE *f;
+
+// The contents of the file after the test has written it
+uint8_t *data;
+size_t   data_length;
+
+void
+check_columnar_setup(void)
+{
+	columnar_init(&c, NUM_LABELS, label_names, NUM_COLUMNS, column_names);
+	f = tmpfile();
+	ck_assert(f != NULL);
+	data = NULL;
+}
+
+
+void
+check_columnar_teardown(void)
+{
+	columnar_destroy(&c);
+	fclose(f);
+	free(data);
+}
+
+
+/**
+ * Read back everything written to the file.
+ */
+static void
+read_back(void)
+{
+	fflush(f);
+	data_length = ftell(f);
+	data = malloc(data_length + 1);
+	ck_assert(data != NULL);
+	rewind(f);
+	ck_assert_int_eq(fread(data, 1, data_length, f), data_length);
+}
+
+
+/**
+ * Decode a little-endian 32-bit value.
+ */
+static uint32_t
+le32(const uint8_t *bytes)
+{
+	return (uint32_t)bytes[0]
+	     | (uint32_t)bytes[1] << 8
+	     | (uint32_t)bytes[2] << 16
+	     | (uint32_t)bytes[3] << 24
+	     ;
+}
+
+
+/**
+ * The row number-th row appended by the tests.
+ */
+static void
+make_row(int32_t row[NUM_COLUMNS], int number)
+{
+	row[0] = number;
+	row[1] = -number;
+	row[2] = number * 1000;
+}
+
+
+/******************************************************************************
+ * Testcases
+ ******************************************************************************/
+
+START_TEST (test_header)
+{
+	columnar_write_header(&c, f);
+	read_back();
+	
+	ck_assert(memcmp(data, "TICKYCOL", 8) == 0);
+	ck_assert_int_eq(le32(data + 8),  1);
+	ck_assert_int_eq(le32(data + 12), NUM_LABELS);
+	ck_assert_int_eq(le32(data + 16), NUM_COLUMNS);
+	ck_assert_int_eq(le32(data + 20), COLUMNAR_BLOCK_ROWS);
+	
+	// The names are padded to a multiple of 8 bytes
+	const char names[] = "group\0sample\0x\0y\0value";
+	size_t names_length = le32(data + 24);
+	ck_assert_int_eq(names_length % 8, 0);
+	ck_assert(names_length >= sizeof(names));
+	ck_assert_int_eq(data_length, sizeof(columnar_header_t) + names_length);
+	ck_assert(memcmp(data + sizeof(columnar_header_t), names, sizeof(names)) == 0);
+}
+END_TEST
+
+
+START_TEST (test_flush_empty)
+{
+	// Nothing should be written when there are no rows
+	columnar_flush(&c, f);
+	read_back();
+	ck_assert_int_eq(data_length, 0);
+}
+END_TEST
+
+
+START_TEST (test_labels)
+{
+	int32_t row[NUM_COLUMNS];
+	
+	// Rows appended before the labels change must be written first
+	make_row(row, 1);
+	columnar_append(&c, f, row);
+	const char *values[NUM_LABELS] = { "1", "2" };
+	columnar_set_labels(&c, f, values);
+	columnar_flush(&c, f);
+	read_back();
+	
+	uint8_t *record = data;
+	ck_assert(memcmp(record, "BLCK", 4) == 0);
+	ck_assert_int_eq(le32(record + 4), 16);
+	ck_assert_int_eq(le32(record + 8), 1);
+	ck_assert_int_eq((int32_t)le32(record + 16), 1);
+	ck_assert_int_eq((int32_t)le32(record + 20), -1);
+	ck_assert_int_eq((int32_t)le32(record + 24), 1000);
+	
+	record += sizeof(columnar_record_t) + 16;
+	ck_assert(memcmp(record, "LBLS", 4) == 0);
+	ck_assert_int_eq(le32(record + 4), 8);
+	ck_assert_int_eq(le32(record + 8), 0);
+	ck_assert(memcmp(record + sizeof(columnar_record_t), "1\0" "2\0\0\0\0\0", 8) == 0);
+	
+	ck_assert_int_eq(data_length, record + sizeof(columnar_record_t) + 8 - data);
+}
+END_TEST
+
+
+/**
+ * Append a number of rows (given by the loop iteration) and check that they
+ * are written in full and partial blocks as appropriate.
+ */
+START_TEST (test_blocks)
+{
+	int num_rows = (int[]){ 1
+	                      , COLUMNAR_BLOCK_ROWS - 1
+	                      , COLUMNAR_BLOCK_ROWS
+	                      , (2 * COLUMNAR_BLOCK_ROWS) + 5
+	                      }[_i];
+	
+	int32_t row[NUM_COLUMNS];
+	for (int i = 0; i < num_rows; i++) {
+		make_row(row, i);
+		columnar_append(&c, f, row);
+	}
+	columnar_flush(&c, f);
+	read_back();
+	
+	int num_read = 0;
+	uint8_t *record = data;
+	while (record < data + data_length) {
+		ck_assert(memcmp(record, "BLCK", 4) == 0);
+		size_t length = le32(record + 4);
+		int block_rows = le32(record + 8);
+		ck_assert_int_eq(length % 8, 0);
+		ck_assert(block_rows > 0 && block_rows <= COLUMNAR_BLOCK_ROWS);
+		ck_assert(length >= block_rows * NUM_COLUMNS * sizeof(int32_t));
+		
+		// Only the last block may be partial
+		if (num_read + block_rows < num_rows)
+			ck_assert_int_eq(block_rows, COLUMNAR_BLOCK_ROWS);
+		
+		uint8_t *columns = record + sizeof(columnar_record_t);
+		for (int i = 0; i < block_rows; i++) {
+			make_row(row, num_read + i);
+			for (int j = 0; j < NUM_COLUMNS; j++)
+				ck_assert_int_eq( (int32_t)le32(columns + (((j * block_rows) + i) * sizeof(int32_t)))
+				                , row[j]
+				                );
+		}
+		
+		num_read += block_rows;
+		record   += sizeof(columnar_record_t) + length;
+	}
+	
+	ck_assert(record == data + data_length);
+	ck_assert_int_eq(num_read, num_rows);
+}
+END_TEST
+
+
+Suite *
+make_columnar_suite(void)
+{
+	Suite *s = suite_create("columnar");
+	
+	// Add tests to the test case
+	TCase *tc_core = tcase_create("Core");
+	tcase_add_checked_fixture(tc_core, check_columnar_setup, check_columnar_teardown);
+	tcase_add_test(tc_core, test_header);
+	tcase_add_test(tc_core, test_flush_empty);
+	tcase_add_test(tc_core, test_labels);
+	tcase_add_loop_test(tc_core, test_blocks, 0, 4);
+	
+	// Add each test case to the suite
+	suite_add_tcase(s, tc_core);
+	
+	return s;
+}
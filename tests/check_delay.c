@@ -64,6 +64,10 @@ START_TEST (test_unblocked_forwarding)
 		ck_assert((int)buffer_pop(&output) == i);
 		ck_assert(buffer_is_empty(&output));
 	}
+	
+	// Everything was forwarded without blocking
+	ck_assert_int_eq(delay_get_num_forwarded(&d), BUFF_SIZE);
+	ck_assert_int_eq(delay_get_num_blocked(&d), 0);
 }
 END_TEST
 
@@ -85,6 +89,11 @@ START_TEST (test_blocked_forwarding)
 		scheduler_tick_tock(&s);
 	ck_assert(!buffer_is_empty(&input));
 	
+	// Every period was spent blocked
+	ck_assert_int_eq(delay_get_num_forwarded(&d), 0);
+	ck_assert_int_eq(delay_get_num_blocked(&d), DELAY);
+	delay_reset_counters(&d);
+	
 	// Take something out of the output buffer and see if things arrive after a
 	// wire delay.
 	buffer_pop(&output);
@@ -96,6 +105,9 @@ START_TEST (test_blocked_forwarding)
 	}
 	ck_assert(buffer_is_empty(&input));
 	ck_assert(buffer_is_full(&output));
+	
+	ck_assert_int_eq(delay_get_num_forwarded(&d), 1);
+	ck_assert_int_eq(delay_get_num_blocked(&d), 0);
 }
 END_TEST
 
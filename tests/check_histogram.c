@@ -0,0 +1,199 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * check_histogram.c -- Unit tests for log-linear histograms.
+ */
+
+#include <check.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "config.h"
+
+#include "check_check.h"
+
+#include "../src/histogram.h"
+
+/******************************************************************************
+ * Testbench
+ ******************************************************************************/
+
+histogram_t h;
+
+
+/******************************************************************************
+ * Testcases
+ ******************************************************************************/
+
+START_TEST (test_empty)
+{
+	histogram_init(&h, 5);
+	
+	ck_assert_int_eq(histogram_get_count(&h), 0);
+	ck_assert_int_eq(histogram_get_max(&h), 0);
+	ck_assert(histogram_get_mean(&h) == 0.0);
+	ck_assert_int_eq(histogram_get_quantile(&h, 0.5), 0);
+	
+	histogram_destroy(&h);
+}
+END_TEST
+
+
+START_TEST (test_exact)
+{
+	// Values below 2^(precision+1) are stored exactly
+	histogram_init(&h, 7);
+	for (int i = 99; i >= 0; i--)
+		histogram_add(&h, i);
+	
+	ck_assert_int_eq(histogram_get_count(&h), 100);
+	ck_assert_int_eq(histogram_get_max(&h), 99);
+	ck_assert(histogram_get_mean(&h) == 49.5);
+	
+	ck_assert_int_eq(histogram_get_quantile(&h, 0.0),  0);
+	ck_assert_int_eq(histogram_get_quantile(&h, 0.01), 0);
+	ck_assert_int_eq(histogram_get_quantile(&h, 0.5),  49);
+	ck_assert_int_eq(histogram_get_quantile(&h, 0.9),  89);
+	ck_assert_int_eq(histogram_get_quantile(&h, 0.99), 98);
+	ck_assert_int_eq(histogram_get_quantile(&h, 1.0),  99);
+	
+	histogram_destroy(&h);
+}
+END_TEST
+
+
+/**
+ * Check the buckets tile the values without gaps and are within the precision
+ * (given by the loop iteration).
+ */
+START_TEST (test_buckets)
+{
+	int precision = _i;
+	histogram_init(&h, precision);
+	
+	// Allocate plenty of buckets
+	histogram_add(&h, UINT64_C(1) << 40);
+	
+	uint64_t next = 0;
+	for (size_t bucket = 0; bucket < histogram_get_num_buckets(&h); bucket++) {
+		uint64_t lower, upper;
+		uint64_t count = histogram_get_bucket(&h, bucket, &lower, &upper);
+		ck_assert(lower == next);
+		ck_assert(upper >= lower);
+		
+		// The width is within the relative precision
+		uint64_t width = upper - lower + 1;
+		ck_assert(width == 1 || width <= (lower >> precision));
+		
+		// Only the bucket of the value added is non-empty
+		bool contains = lower <= (UINT64_C(1) << 40) && (UINT64_C(1) << 40) <= upper;
+		ck_assert_int_eq(count, contains ? 1 : 0);
+		
+		next = upper + 1;
+	}
+	
+	histogram_destroy(&h);
+}
+END_TEST
+
+
+START_TEST (test_quantile_error)
+{
+	histogram_init(&h, 5);
+	for (int i = 1; i <= 100000; i++)
+		histogram_add(&h, i);
+	
+	ck_assert_int_eq(histogram_get_max(&h), 100000);
+	
+	// Quantiles are never underestimated and are within the relative error
+	double qs[] = {0.5, 0.9, 0.99, 0.999};
+	for (int i = 0; i < 4; i++) {
+		uint64_t exact    = (uint64_t)(qs[i] * 100000.0);
+		uint64_t estimate = histogram_get_quantile(&h, qs[i]);
+		ck_assert(estimate >= exact);
+		ck_assert(estimate <= exact + (exact / 32));
+	}
+	
+	ck_assert_int_eq(histogram_get_quantile(&h, 1.0), 100000);
+	
+	histogram_destroy(&h);
+}
+END_TEST
+
+
+START_TEST (test_merge)
+{
+	histogram_t h2;
+	histogram_init(&h,  5);
+	histogram_init(&h2, 5);
+	
+	// The second histogram has larger values (and so more buckets)
+	for (int i = 0; i < 100; i++)
+		histogram_add(&h, i);
+	for (int i = 100; i < 10000; i++)
+		histogram_add(&h2, i);
+	
+	histogram_merge(&h, &h2);
+	
+	ck_assert_int_eq(histogram_get_count(&h), 10000);
+	ck_assert_int_eq(histogram_get_max(&h), 9999);
+	ck_assert(histogram_get_mean(&h) == 4999.5);
+	ck_assert_int_eq(histogram_get_num_buckets(&h), histogram_get_num_buckets(&h2));
+	ck_assert_int_eq(histogram_get_quantile(&h, 0.005), 49);
+	
+	// Merging into an empty histogram gives a copy
+	histogram_reset(&h2);
+	histogram_merge(&h2, &h);
+	ck_assert_int_eq(histogram_get_count(&h2), 10000);
+	ck_assert_int_eq(histogram_get_quantile(&h2, 0.9), histogram_get_quantile(&h, 0.9));
+	
+	histogram_destroy(&h);
+	histogram_destroy(&h2);
+}
+END_TEST
+
+
+START_TEST (test_reset)
+{
+	histogram_init(&h, 3);
+	for (int i = 0; i < 1000; i++)
+		histogram_add(&h, i);
+	histogram_reset(&h);
+	
+	ck_assert_int_eq(histogram_get_count(&h), 0);
+	ck_assert_int_eq(histogram_get_max(&h), 0);
+	for (size_t bucket = 0; bucket < histogram_get_num_buckets(&h); bucket++) {
+		uint64_t lower, upper;
+		ck_assert_int_eq(histogram_get_bucket(&h, bucket, &lower, &upper), 0);
+	}
+	
+	histogram_add(&h, 5);
+	ck_assert_int_eq(histogram_get_quantile(&h, 0.5), 5);
+	
+	histogram_destroy(&h);
+}
+END_TEST
+
+
+Suite *
+make_histogram_suite(void)
+{
+	Suite *s = suite_create("histogram");
+	
+	// Add tests to the test case
+	TCase *tc_core = tcase_create("Core");
+	tcase_add_test(tc_core, test_empty);
+	tcase_add_test(tc_core, test_exact);
+	tcase_add_loop_test(tc_core, test_buckets, 0, 8);
+	tcase_add_test(tc_core, test_quantile_error);
+	tcase_add_test(tc_core, test_merge);
+	tcase_add_test(tc_core, test_reset);
+	
+	// Add each test case to the suite
+	suite_add_tcase(s, tc_core);
+	
+	return s;
+}
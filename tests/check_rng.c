@@ -0,0 +1,161 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * check_rng.c -- Unit tests for the random number generator.
+ */
+
+#include <check.h>
+#include <stdio.h>
+
+#include "config.h"
+
+#include "check_check.h"
+
+#include "../src/rng.h"
+
+// Number of values drawn in each test
+#define NUM_DRAWS 10000
+
+// Number of bins used when checking uniformity
+#define NUM_BINS 10
+
+rng_t r;
+
+
+void
+check_rng_setup(void)
+{
+	rng_init(&r, 1234, 0);
+}
+
+
+void
+check_rng_teardown(void)
+{
+	// Nothing to do
+}
+
+
+/**
+ * Test that the same seed and stream always give the same sequence.
+ */
+START_TEST (test_reproducible)
+{
+	rng_t r2;
+	rng_init(&r2, 1234, 0);
+	
+	for (int i = 0; i < NUM_DRAWS; i++)
+		ck_assert(rng_next(&r) == rng_next(&r2));
+}
+END_TEST
+
+
+/**
+ * Test that different streams and seeds give different sequences.
+ */
+START_TEST (test_streams_differ)
+{
+	rng_t other_stream;
+	rng_t other_seed;
+	rng_init(&other_stream, 1234, 1);
+	rng_init(&other_seed, 1235, 0);
+	
+	int num_same_stream = 0;
+	int num_same_seed   = 0;
+	for (int i = 0; i < NUM_DRAWS; i++) {
+		uint64_t value = rng_next(&r);
+		num_same_stream += value == rng_next(&other_stream);
+		num_same_seed   += value == rng_next(&other_seed);
+	}
+	ck_assert_int_eq(num_same_stream, 0);
+	ck_assert_int_eq(num_same_seed, 0);
+}
+END_TEST
+
+
+/**
+ * Test that uniform values lie in the right range and are roughly uniform.
+ */
+START_TEST (test_uniform)
+{
+	int bins[NUM_BINS] = {0};
+	
+	for (int i = 0; i < NUM_DRAWS; i++) {
+		double u = rng_uniform(&r);
+		ck_assert(u >= 0.0 && u < 1.0);
+		bins[(int)(u * NUM_BINS)]++;
+		
+		double v = rng_uniform_pos(&r);
+		ck_assert(v > 0.0 && v <= 1.0);
+	}
+	
+	// Each bin should get 10% (+/- a generous margin)
+	for (int i = 0; i < NUM_BINS; i++) {
+		ck_assert(bins[i] > (NUM_DRAWS / NUM_BINS) * 0.85);
+		ck_assert(bins[i] < (NUM_DRAWS / NUM_BINS) * 1.15);
+	}
+}
+END_TEST
+
+
+/**
+ * Test that the C library generator is used when no generator is given.
+ */
+START_TEST (test_null)
+{
+	srand(42);
+	double expected = ((double)rand())/((double)RAND_MAX+1.0);
+	srand(42);
+	ck_assert(rng_uniform(NULL) == expected);
+	
+	srand(42);
+	expected = (((double)rand())+1.0)/((double)RAND_MAX+1.0);
+	srand(42);
+	ck_assert(rng_uniform_pos(NULL) == expected);
+}
+END_TEST
+
+
+/**
+ * Test that a saved generator continues the same sequence when restored.
+ */
+START_TEST (test_save_restore)
+{
+	for (int i = 0; i < 10; i++)
+		rng_next(&r);
+	
+	FILE *f = tmpfile();
+	ck_assert(f != NULL);
+	ck_assert(rng_save(&r, f));
+	rewind(f);
+	
+	rng_t restored;
+	rng_init(&restored, 0, 0);
+	ck_assert(rng_restore(&restored, f));
+	fclose(f);
+	
+	for (int i = 0; i < NUM_DRAWS; i++)
+		ck_assert(rng_next(&r) == rng_next(&restored));
+}
+END_TEST
+
+
+Suite *
+make_rng_suite(void)
+{
+	Suite *s = suite_create("rng");
+	
+	// Add tests to the test case
+	TCase *tc_core = tcase_create("Core");
+	tcase_add_checked_fixture(tc_core, check_rng_setup, check_rng_teardown);
+	tcase_add_test(tc_core, test_reproducible);
+	tcase_add_test(tc_core, test_streams_differ);
+	tcase_add_test(tc_core, test_uniform);
+	tcase_add_test(tc_core, test_null);
+	tcase_add_test(tc_core, test_save_restore);
+	
+	// Add each test case to the suite
+	suite_add_tcase(s, tc_core);
+	
+	return s;
+}
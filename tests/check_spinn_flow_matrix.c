@@ -0,0 +1,178 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * check_spinn_flow_matrix.c -- Unit tests for source-destination flow matrices.
+ */
+
+#include <check.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "config.h"
+
+#include "check_check.h"
+
+#include "../src/spinn.h"
+#include "../src/spinn_flow_matrix.h"
+
+/******************************************************************************
+ * Testbench
+ ******************************************************************************/
+
+#define SYSTEM_SIZE_X 3
+#define SYSTEM_SIZE_Y 2
+#define SYSTEM_SIZE ((spinn_coord_t){SYSTEM_SIZE_X,SYSTEM_SIZE_Y})
+#define NUM_NODES (SYSTEM_SIZE_X*SYSTEM_SIZE_Y)
+
+// Nodes are grouped into sources by row
+#define NUM_SOURCES SYSTEM_SIZE_Y
+static const uint32_t flow_matrix_source_of[NUM_NODES] = {0, 0, 0, 1, 1, 1};
+
+static char flow_matrix_filename[] = "/tmp/check_spinn_flow_matrix_XXXXXX";
+
+static spinn_flow_matrix_t m;
+
+static void
+check_spinn_flow_matrix_setup(void)
+{
+	// Reserve a unique filename for the output
+	strcpy(flow_matrix_filename, "/tmp/check_spinn_flow_matrix_XXXXXX");
+	int fd = mkstemp(flow_matrix_filename);
+	ck_assert(fd >= 0);
+	close(fd);
+	
+	spinn_flow_matrix_init(&m, SYSTEM_SIZE, NUM_SOURCES, flow_matrix_source_of);
+}
+
+
+static void
+check_spinn_flow_matrix_teardown(void)
+{
+	spinn_flow_matrix_destroy(&m);
+	remove(flow_matrix_filename);
+}
+
+
+/**
+ * Record a few flows: (0,0) and (2,0) share a source row and so accumulate
+ * together.
+ */
+static void
+add_flows(void)
+{
+	spinn_flow_matrix_add_delivered(&m, (spinn_coord_t){0,0}, (spinn_coord_t){1,1}, 10);
+	spinn_flow_matrix_add_delivered(&m, (spinn_coord_t){2,0}, (spinn_coord_t){1,1}, 30);
+	spinn_flow_matrix_add_delivered(&m, (spinn_coord_t){1,1}, (spinn_coord_t){0,0}, 7);
+	spinn_flow_matrix_add_dropped(&m, (spinn_coord_t){0,1}, (spinn_coord_t){0,0});
+	spinn_flow_matrix_add_dropped(&m, (spinn_coord_t){0,1}, (spinn_coord_t){0,0});
+}
+
+
+/******************************************************************************
+ * Testcases
+ ******************************************************************************/
+
+START_TEST (test_accumulate)
+{
+	add_flows();
+	
+	spinn_coord_t a = {0,0};
+	spinn_coord_t b = {1,1};
+	ck_assert_int_eq(spinn_flow_matrix_get_num_delivered(&m, a, b), 2);
+	ck_assert_int_eq(spinn_flow_matrix_get_latency_sum(&m, a, b), 40);
+	ck_assert_int_eq(spinn_flow_matrix_get_latency_max(&m, a, b), 30);
+	ck_assert_int_eq(spinn_flow_matrix_get_num_dropped(&m, a, b), 0);
+	
+	// Any node of a source's row gives the same values
+	ck_assert_int_eq(spinn_flow_matrix_get_num_delivered(&m, (spinn_coord_t){1,0}, b), 2);
+	
+	ck_assert_int_eq(spinn_flow_matrix_get_num_delivered(&m, b, a), 1);
+	ck_assert_int_eq(spinn_flow_matrix_get_num_dropped(&m, b, a), 2);
+	ck_assert_int_eq(spinn_flow_matrix_get_latency_max(&m, b, a), 7);
+	
+	// Other flows are untouched
+	ck_assert_int_eq(spinn_flow_matrix_get_num_delivered(&m, a, a), 0);
+	ck_assert_int_eq(spinn_flow_matrix_get_num_delivered(&m, b, b), 0);
+	
+	spinn_flow_matrix_reset(&m);
+	ck_assert_int_eq(spinn_flow_matrix_get_num_delivered(&m, a, b), 0);
+	ck_assert_int_eq(spinn_flow_matrix_get_latency_sum(&m, a, b), 0);
+	ck_assert_int_eq(spinn_flow_matrix_get_latency_max(&m, a, b), 0);
+	ck_assert_int_eq(spinn_flow_matrix_get_num_dropped(&m, b, a), 0);
+}
+END_TEST
+
+
+/**
+ * Check the file written has the documented layout.
+ */
+START_TEST (test_write)
+{
+	add_flows();
+	ck_assert(spinn_flow_matrix_write(&m, flow_matrix_filename));
+	
+	FILE *f = fopen(flow_matrix_filename, "rb");
+	ck_assert(f != NULL);
+	
+	spinn_flow_matrix_header_t header;
+	ck_assert(fread(&header, sizeof(header), 1, f) == 1);
+	ck_assert(memcmp(header.magic, "TICKYFLM", 8) == 0);
+	ck_assert_int_eq(header.version, 1);
+	ck_assert(header.byte_order == 0x01020304u);
+	ck_assert_int_eq(header.width,  SYSTEM_SIZE_X);
+	ck_assert_int_eq(header.height, SYSTEM_SIZE_Y);
+	ck_assert_int_eq(header.num_sources, NUM_SOURCES);
+	
+	uint32_t source_of[NUM_NODES];
+	uint32_t num_delivered[NUM_SOURCES][NUM_NODES];
+	uint32_t num_dropped[NUM_SOURCES][NUM_NODES];
+	uint64_t latency_sum[NUM_SOURCES][NUM_NODES];
+	uint32_t latency_max[NUM_SOURCES][NUM_NODES];
+	ck_assert(fread(source_of, sizeof(source_of), 1, f) == 1);
+	ck_assert(fread(num_delivered, sizeof(num_delivered), 1, f) == 1);
+	ck_assert(fread(num_dropped, sizeof(num_dropped), 1, f) == 1);
+	ck_assert(fread(latency_sum, sizeof(latency_sum), 1, f) == 1);
+	ck_assert(fread(latency_max, sizeof(latency_max), 1, f) == 1);
+	
+	// Nothing follows the matrices
+	ck_assert(fgetc(f) == EOF);
+	fclose(f);
+	
+	for (int i = 0; i < NUM_NODES; i++)
+		ck_assert_int_eq(source_of[i], flow_matrix_source_of[i]);
+	
+	// Destination (1,1) is node 4 and (0,0) is node 0
+	for (int source = 0; source < NUM_SOURCES; source++) {
+		for (int node = 0; node < NUM_NODES; node++) {
+			bool row_0_to_4 = source == 0 && node == 4;
+			bool row_1_to_0 = source == 1 && node == 0;
+			ck_assert_int_eq(num_delivered[source][node], row_0_to_4 ? 2 : row_1_to_0 ? 1 : 0);
+			ck_assert_int_eq(num_dropped[source][node], row_1_to_0 ? 2 : 0);
+			ck_assert_int_eq(latency_sum[source][node], row_0_to_4 ? 40 : row_1_to_0 ? 7 : 0);
+			ck_assert_int_eq(latency_max[source][node], row_0_to_4 ? 30 : row_1_to_0 ? 7 : 0);
+		}
+	}
+}
+END_TEST
+
+
+Suite *
+make_spinn_flow_matrix_suite(void)
+{
+	Suite *s = suite_create("spinn_flow_matrix");
+	
+	// Add tests to the test case
+	TCase *tc_core = tcase_create("Core");
+	tcase_add_checked_fixture(tc_core, check_spinn_flow_matrix_setup, check_spinn_flow_matrix_teardown);
+	tcase_add_test(tc_core, test_accumulate);
+	tcase_add_test(tc_core, test_write);
+	
+	// Add each test case to the suite
+	suite_add_tcase(s, tc_core);
+	
+	return s;
+}
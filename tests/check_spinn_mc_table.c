@@ -0,0 +1,289 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * check_spinn_mc_table.c -- Unit tests for multicast routing tables.
+ */
+
+#include <check.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "config.h"
+
+#include "check_check.h"
+
+#include "../src/spinn.h"
+#include "../src/spinn_mc_table.h"
+
+/******************************************************************************
+ * Testbench
+ ******************************************************************************/
+
+#define SYSTEM_SIZE_X 3
+#define SYSTEM_SIZE_Y 2
+#define SYSTEM_SIZE ((spinn_coord_t){SYSTEM_SIZE_X,SYSTEM_SIZE_Y})
+
+// Number of entries and lookups in the randomised test
+#define NUM_RANDOM_ENTRIES 200
+#define NUM_RANDOM_LOOKUPS 10000
+
+char table_filename[] = "/tmp/check_spinn_mc_table_XXXXXX";
+
+spinn_mc_table_t t;
+spinn_mc_table_t tables[SYSTEM_SIZE_X * SYSTEM_SIZE_Y];
+
+void
+check_spinn_mc_table_setup(void)
+{
+	spinn_mc_table_init(&t);
+	for (int i = 0; i < SYSTEM_SIZE_X * SYSTEM_SIZE_Y; i++)
+		spinn_mc_table_init(&(tables[i]));
+	
+	// Reserve a unique filename for table files
+	strcpy(table_filename, "/tmp/check_spinn_mc_table_XXXXXX");
+	int fd = mkstemp(table_filename);
+	ck_assert(fd >= 0);
+	close(fd);
+}
+
+
+void
+check_spinn_mc_table_teardown(void)
+{
+	spinn_mc_table_destroy(&t);
+	for (int i = 0; i < SYSTEM_SIZE_X * SYSTEM_SIZE_Y; i++)
+		spinn_mc_table_destroy(&(tables[i]));
+	
+	remove(table_filename);
+}
+
+
+/**
+ * Write a string to the table file.
+ */
+static void
+write_table_file(const char *contents)
+{
+	FILE *f = fopen(table_filename, "w");
+	ck_assert(f != NULL);
+	fputs(contents, f);
+	fclose(f);
+}
+
+
+/**
+ * Look up a key by checking every entry of the table in turn (i.e. how a
+ * SpiNNaker router's TCAM behaves).
+ */
+static bool
+linear_lookup(spinn_mc_table_t *table, uint32_t key, uint32_t *route)
+{
+	for (size_t i = 0; i < table->num_entries; i++) {
+		if ((key & table->entries[i].mask) == table->entries[i].key) {
+			*route = table->entries[i].route;
+			return true;
+		}
+	}
+	return false;
+}
+
+/******************************************************************************
+ * Tests
+ ******************************************************************************/
+
+/**
+ * Make sure an empty table matches nothing.
+ */
+START_TEST (test_empty)
+{
+	spinn_mc_table_compile(&t);
+	
+	uint32_t route;
+	ck_assert(!spinn_mc_table_lookup(&t, 0x00000000u, &route));
+	ck_assert(!spinn_mc_table_lookup(&t, 0x12345678u, &route));
+	ck_assert(!spinn_mc_table_lookup(&t, 0xFFFFFFFFu, &route));
+}
+END_TEST
+
+
+/**
+ * Make sure entries are matched in priority order regardless of their masks
+ * and that shadowed entries are never used.
+ */
+START_TEST (test_priority)
+{
+	spinn_mc_table_add_entry(&t, 0x01020000u, 0xFFFF0000u, 0x01);
+	spinn_mc_table_add_entry(&t, 0x01000000u, 0xFF000000u, 0x02);
+	spinn_mc_table_add_entry(&t, 0x01020300u, 0xFFFFFF00u, 0x04); // Shadowed by the first
+	spinn_mc_table_add_entry(&t, 0x01020000u, 0xFFFF0000u, 0x08); // Shadowed by the first
+	spinn_mc_table_add_entry(&t, 0x00000000u, 0x00000000u, 0x40); // Default
+	spinn_mc_table_add_entry(&t, 0x00000001u, 0x00000000u, 0x20); // Never matches
+	ck_assert_int_eq(spinn_mc_table_get_num_entries(&t), 6);
+	spinn_mc_table_compile(&t);
+	
+	uint32_t route;
+	ck_assert(spinn_mc_table_lookup(&t, 0x01020304u, &route));
+	ck_assert_int_eq(route, 0x01);
+	ck_assert(spinn_mc_table_lookup(&t, 0x01020000u, &route));
+	ck_assert_int_eq(route, 0x01);
+	ck_assert(spinn_mc_table_lookup(&t, 0x01030000u, &route));
+	ck_assert_int_eq(route, 0x02);
+	ck_assert(spinn_mc_table_lookup(&t, 0x02000000u, &route));
+	ck_assert_int_eq(route, 0x40);
+	ck_assert(spinn_mc_table_lookup(&t, 0x00000001u, &route));
+	ck_assert_int_eq(route, 0x40);
+}
+END_TEST
+
+
+/**
+ * Make sure a table can be recompiled after more entries are added.
+ */
+START_TEST (test_recompile)
+{
+	uint32_t route;
+	
+	spinn_mc_table_add_entry(&t, 0x00010000u, 0xFFFF0000u, 0x01);
+	spinn_mc_table_compile(&t);
+	ck_assert(!spinn_mc_table_lookup(&t, 0x00020000u, &route));
+	
+	spinn_mc_table_add_entry(&t, 0x00020000u, 0xFFFF0000u, 0x02);
+	spinn_mc_table_compile(&t);
+	ck_assert(spinn_mc_table_lookup(&t, 0x00010000u, &route));
+	ck_assert_int_eq(route, 0x01);
+	ck_assert(spinn_mc_table_lookup(&t, 0x00020000u, &route));
+	ck_assert_int_eq(route, 0x02);
+}
+END_TEST
+
+
+/**
+ * Compare lookups in a large randomly generated table against a linear search.
+ * Keys and masks are drawn from a small set of values to ensure plenty of
+ * overlapping and shadowed entries.
+ */
+START_TEST (test_random)
+{
+	srand(_i);
+	
+	const uint32_t masks[] = { 0x00000000u, 0xFF000000u, 0xFFFF0000u
+	                         , 0xFFFFFF00u, 0xFFFFFFFFu, 0x00FF00FFu
+	                         };
+	const int num_masks = sizeof(masks) / sizeof(masks[0]);
+	
+	for (int i = 0; i < NUM_RANDOM_ENTRIES; i++) {
+		uint32_t mask = masks[rand() % num_masks];
+		uint32_t key  = ((uint32_t)(rand() % 4) * 0x01010101u) & mask;
+		spinn_mc_table_add_entry(&t, key, mask, (uint32_t)(rand() % 128));
+	}
+	spinn_mc_table_compile(&t);
+	
+	for (int i = 0; i < NUM_RANDOM_LOOKUPS; i++) {
+		uint32_t key = ((uint32_t)(rand() % 4) << 24)
+		             | ((uint32_t)(rand() % 4) << 16)
+		             | ((uint32_t)(rand() % 4) << 8)
+		             | ((uint32_t)(rand() % 4));
+		
+		uint32_t expected_route = 0;
+		uint32_t route = 0;
+		bool expected_found = linear_lookup(&t, key, &expected_route);
+		bool found = spinn_mc_table_lookup(&t, key, &route);
+		ck_assert(found == expected_found);
+		if (found)
+			ck_assert_int_eq(route, expected_route);
+	}
+}
+END_TEST
+
+
+/**
+ * Make sure a table file is loaded into the right tables.
+ */
+START_TEST (test_load)
+{
+	write_table_file( "# A comment\n"
+	                  "0 0 0x00010000 0xFFFF0000 0x01\n"
+	                  "\n"
+	                  "2 1 0x00010000 0xFFFF0000 0x42\n"
+	                  "  2 1 0 0 64\n"
+	                );
+	ck_assert(spinn_mc_table_load(tables, SYSTEM_SIZE, table_filename));
+	
+	uint32_t route;
+	for (int y = 0; y < SYSTEM_SIZE_Y; y++) {
+		for (int x = 0; x < SYSTEM_SIZE_X; x++) {
+			spinn_mc_table_t *table = &(tables[(y * SYSTEM_SIZE_X) + x]);
+			if (x == 0 && y == 0) {
+				ck_assert_int_eq(spinn_mc_table_get_num_entries(table), 1);
+				ck_assert(spinn_mc_table_lookup(table, 0x00010203u, &route));
+				ck_assert_int_eq(route, 0x01);
+				ck_assert(!spinn_mc_table_lookup(table, 0x00020203u, &route));
+			} else if (x == 2 && y == 1) {
+				ck_assert_int_eq(spinn_mc_table_get_num_entries(table), 2);
+				ck_assert(spinn_mc_table_lookup(table, 0x00010203u, &route));
+				ck_assert_int_eq(route, 0x42);
+				ck_assert(spinn_mc_table_lookup(table, 0x00020203u, &route));
+				ck_assert_int_eq(route, 0x40);
+			} else {
+				ck_assert_int_eq(spinn_mc_table_get_num_entries(table), 0);
+				ck_assert(!spinn_mc_table_lookup(table, 0x00010203u, &route));
+			}
+		}
+	}
+}
+END_TEST
+
+
+/**
+ * Make sure invalid table files are rejected.
+ */
+static const char *bad_table_files[] = {
+	// Malformed lines
+	"0 0 1 1\n",
+	"0 0 1 1 1 1\n",
+	"0 0 0x1G 1 1\n",
+	"0 0 -1 1 1\n",
+	"0 0 0x100000000 0xFFFFFFFF 1\n",
+	// Outside the system
+	"3 0 0 0 1\n",
+	"0 -1 0 0 1\n",
+	// Key bits outside mask
+	"0 0 0x00010001 0xFFFF0000 1\n",
+	// Non-existent outputs
+	"0 0 0 0 0x80\n",
+};
+
+START_TEST (test_bad_files)
+{
+	write_table_file(bad_table_files[_i]);
+	ck_assert(!spinn_mc_table_load(tables, SYSTEM_SIZE, table_filename));
+}
+END_TEST
+
+
+Suite *
+make_spinn_mc_table_suite(void)
+{
+	Suite *s = suite_create("spinn_mc_table");
+	
+	// Add tests to the test case
+	TCase *tc_core = tcase_create("Core");
+	tcase_add_checked_fixture(tc_core, check_spinn_mc_table_setup, check_spinn_mc_table_teardown);
+	tcase_add_test(tc_core, test_empty);
+	tcase_add_test(tc_core, test_priority);
+	tcase_add_test(tc_core, test_recompile);
+	tcase_add_loop_test(tc_core, test_random, 0, 10);
+	tcase_add_test(tc_core, test_load);
+	tcase_add_loop_test( tc_core, test_bad_files
+	                   , 0, sizeof(bad_table_files)/sizeof(bad_table_files[0])
+	                   );
+	
+	// Add each test case to the suite
+	suite_add_tcase(s, tc_core);
+	
+	return s;
+}
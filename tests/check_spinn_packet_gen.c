@@ -41,6 +41,10 @@ spinn_packet_gen_t g;
 int packets_blocked;
 int packets_sent;
 
+// Packets seen by the on_packet_inject callback
+static int             packets_injected;
+static spinn_packet_t *last_injected;
+
 void
 check_spinn_packet_gen_setup(void)
 {
@@ -49,6 +53,8 @@ check_spinn_packet_gen_setup(void)
 	spinn_packet_pool_init(&pool);
 	packets_blocked = 0;
 	packets_sent = 0;
+	packets_injected = 0;
+	last_injected = NULL;
 }
 
 
@@ -75,6 +81,16 @@ on_packet_gen(spinn_packet_t *p, void *data)
 	return (void *)4321;
 }
 
+void
+on_packet_inject(spinn_packet_t *p, void *data)
+{
+	ck_assert_int_eq((int)data, 5678);
+	ck_assert(p != NULL);
+	
+	packets_injected++;
+	last_injected = p;
+}
+
 bool
 dest_filter(const spinn_coord_t *dest, void *_allow_local)
 {
@@ -101,6 +117,11 @@ dest_filter(const spinn_coord_t *dest, void *_allow_local)
 
 #define SET_GEN_BERNOULLI(prob) spinn_packet_gen_set_temporal_dist_bernoulli(&g, (prob))
 #define SET_GEN_PERIODIC(interval) spinn_packet_gen_set_temporal_dist_periodic(&g, (interval))
+#define SET_GEN_TRACE(records, num_records) spinn_packet_gen_set_temporal_dist_trace(&g, (records), (num_records))
+#define SET_GEN_CORES(num_cores, queue_length) spinn_packet_gen_set_temporal_dist_cores(&g, (num_cores), (queue_length))
+#define SET_GEN_SNN(chip) spinn_packet_gen_set_temporal_dist_snn(&g, (chip))
+#define SET_GEN_MMPP(on_prob, off_prob, on_duration, off_duration) \
+	spinn_packet_gen_set_temporal_dist_mmpp(&g, (on_prob), (off_prob), (on_duration), (off_duration))
 
 #define SET_GEN_CYCLIC() spinn_packet_gen_set_spatial_dist_cyclic(&g)
 #define SET_GEN_UNIFORM() spinn_packet_gen_set_spatial_dist_uniform(&g)
@@ -141,6 +162,7 @@ START_TEST (test_certain)
 		case 0: INIT_GEN(true); SET_GEN_BERNOULLI(1.0); SET_GEN_CYCLIC(); break;
 		case 1: INIT_GEN(true); SET_GEN_BERNOULLI(1.0); SET_GEN_UNIFORM(); break;
 	}
+	spinn_packet_gen_set_on_packet_inject(&g, on_packet_inject, (void *)5678);
 	
 	// Run for long enough that the buffer ends up full
 	for (int i = 0; i < BUFFER_SIZE + 1; i++) {
@@ -158,6 +180,9 @@ START_TEST (test_certain)
 	
 	ck_assert_int_eq(packets_sent, BUFFER_SIZE);
 	ck_assert_int_eq(packets_blocked, 1);
+	
+	// Packets enter the network as soon as they're generated
+	ck_assert_int_eq(packets_injected, BUFFER_SIZE);
 }
 END_TEST
 
@@ -464,6 +489,427 @@ START_TEST (test_periodic_blocked)
 END_TEST
 
 
+// A trace for the generator at POSITION including records which share a tick,
+// fall between generator periods and which are sent locally.
+static const spinn_trace_record_t trace_records[] = {
+	{ 0, 2,3, 0,0},
+	{ 4, 2,3, 1,2},
+	{ 4, 2,3, 3,6},
+	{13, 2,3, 2,3},
+};
+#define NUM_TRACE_RECORDS (sizeof(trace_records)/sizeof(spinn_trace_record_t))
+
+/**
+ * Ensure that packets in a trace are sent at the first generator period at or
+ * after the time in the record (or later if multiple records share a time) to
+ * the destination in the record regardless of the destination filter.
+ */
+START_TEST (test_trace_dist)
+{
+	INIT_GEN(false); SET_GEN_TRACE(trace_records, NUM_TRACE_RECORDS); SET_GEN_CYCLIC();
+	
+	ticks_t expected_times[] = {0, 6, 9, 15};
+	
+	int num_received = 0;
+	for (int i = 0; i < PERIOD * 10; i++) {
+		scheduler_tick_tock(&s);
+		
+		if (!buffer_is_empty(&b)) {
+			spinn_packet_t *p = (spinn_packet_t *)buffer_pop(&b);
+			ck_assert(num_received < NUM_TRACE_RECORDS);
+			ck_assert_int_eq(p->sent_time, expected_times[num_received]);
+			ck_assert_int_eq(p->sent_time, scheduler_get_ticks(&s) - 1);
+			ck_assert_int_eq(p->source.x, POSITION.x);
+			ck_assert_int_eq(p->source.y, POSITION.y);
+			ck_assert_int_eq(p->destination.x, trace_records[num_received].destination_x);
+			ck_assert_int_eq(p->destination.y, trace_records[num_received].destination_y);
+			ck_assert_int_eq((int)p->payload, 4321);
+			spinn_packet_pool_pfree(&pool, p);
+			num_received++;
+		}
+	}
+	
+	ck_assert_int_eq(num_received, NUM_TRACE_RECORDS);
+	ck_assert_int_eq(packets_sent, NUM_TRACE_RECORDS);
+	ck_assert_int_eq(packets_blocked, 0);
+}
+END_TEST
+
+
+/**
+ * Ensure that when a trace is replayed into a blocked output, all records are
+ * eventually sent, in order.
+ */
+START_TEST (test_trace_blocked)
+{
+	INIT_GEN(true); SET_GEN_TRACE(trace_records, NUM_TRACE_RECORDS); SET_GEN_CYCLIC();
+	
+	// Fill the buffer
+	for (int i = 0; i < BUFFER_SIZE; i++)
+		buffer_push(&b, NULL);
+	
+	// Run until after the end of the trace, nothing should get through
+	for (int i = 0; i < PERIOD * 10; i++)
+		scheduler_tick_tock(&s);
+	ck_assert_int_eq(packets_sent, 0);
+	ck_assert(packets_blocked > 0);
+	
+	// Empty the buffer and then every record should be sent, one per period
+	for (int i = 0; i < BUFFER_SIZE; i++)
+		buffer_pop(&b);
+	for (int i = 0; i < PERIOD * NUM_TRACE_RECORDS; i++)
+		scheduler_tick_tock(&s);
+	ck_assert_int_eq(packets_sent, NUM_TRACE_RECORDS);
+	
+	for (int i = 0; i < NUM_TRACE_RECORDS; i++) {
+		spinn_packet_t *p = (spinn_packet_t *)buffer_pop(&b);
+		ck_assert_int_eq(p->destination.x, trace_records[i].destination_x);
+		ck_assert_int_eq(p->destination.y, trace_records[i].destination_y);
+		spinn_packet_pool_pfree(&pool, p);
+	}
+	ck_assert(buffer_is_empty(&b));
+}
+END_TEST
+
+
+/**
+ * Ensure that records in the past are skipped when a trace is started part-way
+ * through a simulation.
+ */
+START_TEST (test_trace_late_start)
+{
+	INIT_GEN(true); SET_GEN_BERNOULLI(0.0); SET_GEN_CYCLIC();
+	
+	// Start the trace at tick 5 at which point all but the last record are in the
+	// past.
+	for (int i = 0; i < 5; i++)
+		scheduler_tick_tock(&s);
+	SET_GEN_TRACE(trace_records, NUM_TRACE_RECORDS);
+	
+	for (int i = 0; i < PERIOD * 10; i++)
+		scheduler_tick_tock(&s);
+	
+	ck_assert_int_eq(packets_sent, 1);
+	spinn_packet_t *p = (spinn_packet_t *)buffer_pop(&b);
+	ck_assert_int_eq(p->sent_time, 15);
+	ck_assert_int_eq(p->destination.x, trace_records[NUM_TRACE_RECORDS-1].destination_x);
+	ck_assert_int_eq(p->destination.y, trace_records[NUM_TRACE_RECORDS-1].destination_y);
+	spinn_packet_pool_pfree(&pool, p);
+	ck_assert(buffer_is_empty(&b));
+}
+END_TEST
+
+
+/**
+ * Give each core of a generator using the cores distribution the given
+ * probability and send to a unique p2p target ((core%SYSTEM_SIZE_X,
+ * core/SYSTEM_SIZE_X)).
+ */
+static void
+set_cores_p2p(int num_cores, double *probs)
+{
+	for (int i = 0; i < num_cores; i++) {
+		spinn_packet_gen_set_core_bernoulli_prob(&g, i, probs[i]);
+		SET_GEN_P2P(((spinn_coord_t){i%SYSTEM_SIZE_X, i/SYSTEM_SIZE_X}));
+		spinn_packet_gen_set_core_spatial_dist(&g, i);
+	}
+}
+
+/**
+ * Ensure the aggregate rate of a set of identical cores matches the rate of
+ * running every core independently.
+ */
+START_TEST (test_cores_rate)
+{
+	const int num_cores = 18;
+	const int num_periods = 10000;
+	const double prob = 0.04;
+	
+	INIT_GEN(true); SET_GEN_CORES(num_cores, 100); SET_GEN_UNIFORM();
+	for (int i = 0; i < num_cores; i++)
+		spinn_packet_gen_set_core_bernoulli_prob(&g, i, prob);
+	
+	int num_forwarded = 0;
+	for (int i = 0; i < num_periods; i++) {
+		for (int j = 0; j < PERIOD; j++)
+			scheduler_tick_tock(&s);
+		
+		// At most one packet is forwarded each period
+		if (!buffer_is_empty(&b)) {
+			spinn_packet_pool_pfree(&pool, buffer_pop(&b));
+			num_forwarded++;
+		}
+		ck_assert(buffer_is_empty(&b));
+	}
+	
+	// Should be within 5% of the expected number of packets
+	double expected = num_cores * prob * num_periods;
+	ck_assert(packets_sent > expected * 0.95);
+	ck_assert(packets_sent < expected * 1.05);
+	ck_assert(num_forwarded <= packets_sent);
+	ck_assert(num_forwarded > packets_sent - 100);
+	ck_assert_int_eq(packets_blocked, 0);
+}
+END_TEST
+
+
+/**
+ * Ensure cores with differing rates each send at their own rate using their own
+ * spatial distributions.
+ */
+START_TEST (test_cores_per_core_rates)
+{
+	const int num_cores = 9;
+	const int num_periods = 20000;
+	
+	// Cores 0, 3 and 6 never send, others send at one of two rates
+	double probs[] = {0.0, 0.02, 0.04, 0.0, 0.02, 0.04, 0.0, 0.02, 0.04};
+	
+	INIT_GEN(true); SET_GEN_CORES(num_cores, 100);
+	set_cores_p2p(num_cores, probs);
+	
+	int num_arrived[num_cores];
+	for (int i = 0; i < num_cores; i++)
+		num_arrived[i] = 0;
+	
+	for (int i = 0; i < num_periods; i++) {
+		for (int j = 0; j < PERIOD; j++)
+			scheduler_tick_tock(&s);
+		
+		if (!buffer_is_empty(&b)) {
+			spinn_packet_t *p = (spinn_packet_t *)buffer_pop(&b);
+			num_arrived[(p->destination.y * SYSTEM_SIZE_X) + p->destination.x]++;
+			spinn_packet_pool_pfree(&pool, p);
+		}
+	}
+	
+	int low_rate = 0;
+	int high_rate = 0;
+	for (int i = 0; i < num_cores; i++) {
+		switch (i % 3) {
+			case 0: ck_assert_int_eq(num_arrived[i], 0); break;
+			case 1: low_rate  += num_arrived[i]; break;
+			case 2: high_rate += num_arrived[i]; break;
+		}
+	}
+	
+	// Each group of three cores should send at roughly the expected rate
+	ck_assert(low_rate  > 3 * 0.02 * num_periods * 0.9);
+	ck_assert(low_rate  < 3 * 0.02 * num_periods * 1.1);
+	ck_assert(high_rate > 3 * 0.04 * num_periods * 0.9);
+	ck_assert(high_rate < 3 * 0.04 * num_periods * 1.1);
+}
+END_TEST
+
+
+/**
+ * Ensure that core queues fill up when the output is blocked and then drain in
+ * round-robin order once it becomes free.
+ */
+START_TEST (test_cores_blocked)
+{
+	const int num_cores = 3;
+	const int queue_length = 2;
+	
+	double always[] = {1.0, 1.0, 1.0};
+	double never[]  = {0.0, 0.0, 0.0};
+	
+	INIT_GEN(true); SET_GEN_CORES(num_cores, queue_length);
+	set_cores_p2p(num_cores, always);
+	spinn_packet_gen_set_on_packet_inject(&g, on_packet_inject, (void *)5678);
+	
+	// Fill the buffer
+	for (int i = 0; i < BUFFER_SIZE; i++)
+		buffer_push(&b, NULL);
+	
+	// Run for five periods: the core queues fill after two and then packets are
+	// blocked.
+	for (int i = 0; i < PERIOD * 5; i++)
+		scheduler_tick_tock(&s);
+	ck_assert_int_eq(packets_sent, num_cores * queue_length);
+	ck_assert_int_eq(packets_blocked, num_cores * 3);
+	ck_assert_int_eq(packets_injected, 0);
+	
+	// Stop generating new packets and free the output
+	set_cores_p2p(num_cores, never);
+	for (int i = 0; i < BUFFER_SIZE; i++)
+		buffer_pop(&b);
+	
+	// Queued packets should be forwarded one per period, taking turns between
+	// cores.
+	for (int i = 0; i < num_cores * queue_length; i++) {
+		for (int j = 0; j < PERIOD; j++)
+			scheduler_tick_tock(&s);
+		
+		spinn_packet_t *p = (spinn_packet_t *)buffer_pop(&b);
+		ck_assert_int_eq(p->destination.x, i % num_cores);
+		ck_assert_int_eq(p->destination.y, 0);
+		ck_assert(buffer_is_empty(&b));
+		
+		// Packets enter the network only when leaving their core's queue, long
+		// after they were generated.
+		ck_assert_int_eq(packets_injected, i + 1);
+		ck_assert(last_injected == p);
+		ck_assert(p->sent_time < scheduler_get_ticks(&s) - PERIOD);
+		spinn_packet_pool_pfree(&pool, p);
+	}
+	
+	// Nothing more should be sent
+	for (int i = 0; i < PERIOD * 5; i++)
+		scheduler_tick_tock(&s);
+	ck_assert(buffer_is_empty(&b));
+	ck_assert_int_eq(packets_sent, num_cores * queue_length);
+}
+END_TEST
+
+
+/**
+ * Ensure the long-run rate of the MMPP distribution is the duration-weighted
+ * mean of the rates of its two states.
+ */
+START_TEST (test_mmpp_rate)
+{
+	const int num_periods = 100000;
+	const double on_prob = 0.5;
+	const double off_prob = 0.05;
+	const double on_duration = 20.0;
+	const double off_duration = 60.0;
+	
+	INIT_GEN(true); SET_GEN_MMPP(on_prob, off_prob, on_duration, off_duration); SET_GEN_UNIFORM();
+	
+	for (int i = 0; i < num_periods; i++) {
+		for (int j = 0; j < PERIOD; j++)
+			scheduler_tick_tock(&s);
+		
+		if (!buffer_is_empty(&b))
+			spinn_packet_pool_pfree(&pool, buffer_pop(&b));
+	}
+	
+	// Should be within 10% of the expected number of packets
+	double expected = num_periods * ( (on_prob * on_duration) + (off_prob * off_duration))
+	                                / (on_duration + off_duration);
+	ck_assert(packets_sent > expected * 0.9);
+	ck_assert(packets_sent < expected * 1.1);
+	ck_assert_int_eq(packets_blocked, 0);
+}
+END_TEST
+
+
+/**
+ * Ensure an MMPP which always sends when on and never when off produces bursts
+ * of packets in consecutive periods whose lengths match the mean on duration.
+ */
+START_TEST (test_mmpp_bursts)
+{
+	const int num_periods = 100000;
+	const double on_duration = 10.0;
+	const double off_duration = 30.0;
+	
+	INIT_GEN(true); SET_GEN_MMPP(1.0, 0.0, on_duration, off_duration); SET_GEN_UNIFORM();
+	
+	int num_bursts = 0;
+	bool last_sent = false;
+	for (int i = 0; i < num_periods; i++) {
+		for (int j = 0; j < PERIOD; j++)
+			scheduler_tick_tock(&s);
+		
+		bool sent = !buffer_is_empty(&b);
+		if (sent) {
+			spinn_packet_pool_pfree(&pool, buffer_pop(&b));
+			ck_assert(buffer_is_empty(&b));
+		}
+		
+		if (sent && !last_sent)
+			num_bursts++;
+		last_sent = sent;
+	}
+	
+	// The mean burst length should be close to the on duration
+	double mean_burst = ((double)packets_sent) / ((double)num_bursts);
+	ck_assert(mean_burst > on_duration * 0.9);
+	ck_assert(mean_burst < on_duration * 1.1);
+	
+	// The fraction of periods spent on should be close to the expected value
+	double expected = num_periods * on_duration / (on_duration + off_duration);
+	ck_assert(packets_sent > expected * 0.9);
+	ck_assert(packets_sent < expected * 1.1);
+}
+END_TEST
+
+
+/**
+ * Ensure the SNN distribution sends spikes at the chip's rate to the chip's
+ * targets and queues spikes while the output is blocked.
+ */
+START_TEST (test_snn_dist)
+{
+	const int num_periods = 20000;
+	
+	// A chip sending spikes to (1,1) and (3,4) with equal probability
+	spinn_coord_t targets[] = {{1,1}, {3,4}};
+	double alias_prob[] = {1.0, 1.0};
+	size_t alias[] = {0, 1};
+	spinn_snn_chip_t chip;
+	chip.rate = 0.1 / PERIOD;
+	chip.num_targets = 2;
+	chip.targets = targets;
+	chip.alias_prob = alias_prob;
+	chip.alias = alias;
+	
+	INIT_GEN(false); SET_GEN_SNN(&chip);
+	
+	int num_arrived[] = {0, 0};
+	for (int i = 0; i < num_periods; i++) {
+		for (int j = 0; j < PERIOD; j++)
+			scheduler_tick_tock(&s);
+		
+		if (!buffer_is_empty(&b)) {
+			spinn_packet_t *p = (spinn_packet_t *)buffer_pop(&b);
+			ck_assert(buffer_is_empty(&b));
+			if (p->destination.x == 1 && p->destination.y == 1) {
+				num_arrived[0]++;
+			} else {
+				ck_assert_int_eq(p->destination.x, 3);
+				ck_assert_int_eq(p->destination.y, 4);
+				num_arrived[1]++;
+			}
+			spinn_packet_pool_pfree(&pool, p);
+		}
+	}
+	
+	// Should be within 10% of the expected number of packets, split evenly
+	double expected = 0.1 * num_periods;
+	ck_assert(packets_sent > expected * 0.9);
+	ck_assert(packets_sent < expected * 1.1);
+	ck_assert(num_arrived[0] > (expected / 2) * 0.85);
+	ck_assert(num_arrived[1] > (expected / 2) * 0.85);
+	ck_assert_int_eq(packets_blocked, 0);
+	
+	// Block the output: spikes should queue up rather than being lost
+	for (int i = 0; i < BUFFER_SIZE; i++)
+		buffer_push(&b, NULL);
+	for (int i = 0; i < num_periods / 10; i++)
+		for (int j = 0; j < PERIOD; j++)
+			scheduler_tick_tock(&s);
+	ck_assert(packets_blocked > 0);
+	
+	int sent_before = packets_sent;
+	for (int i = 0; i < BUFFER_SIZE; i++)
+		buffer_pop(&b);
+	
+	// Once unblocked, queued spikes are sent every period until the backlog of
+	// roughly 0.1 * (num_periods / 10) spikes is cleared.
+	for (int i = 0; i < 50; i++) {
+		for (int j = 0; j < PERIOD; j++)
+			scheduler_tick_tock(&s);
+		ck_assert(!buffer_is_empty(&b));
+		spinn_packet_pool_pfree(&pool, buffer_pop(&b));
+	}
+	ck_assert_int_eq(packets_sent, sent_before + 50);
+}
+END_TEST
+
+
 Suite *
 make_spinn_packet_gen_suite(void)
 {
@@ -483,6 +929,15 @@ make_spinn_packet_gen_suite(void)
 	tcase_add_loop_test(tc_core, test_complement_dist, 0, SYSTEM_SIZE_X*SYSTEM_SIZE_Y);
 	tcase_add_loop_test(tc_core, test_transpose_dist, 0, SYSTEM_SIZE_X*SYSTEM_SIZE_Y);
 	tcase_add_loop_test(tc_core, test_tornado_dist, 0, SYSTEM_SIZE_X*SYSTEM_SIZE_Y);
+	tcase_add_test(tc_core, test_trace_dist);
+	tcase_add_test(tc_core, test_trace_blocked);
+	tcase_add_test(tc_core, test_trace_late_start);
+	tcase_add_test(tc_core, test_cores_rate);
+	tcase_add_test(tc_core, test_cores_per_core_rates);
+	tcase_add_test(tc_core, test_cores_blocked);
+	tcase_add_test(tc_core, test_mmpp_rate);
+	tcase_add_test(tc_core, test_mmpp_bursts);
+	tcase_add_test(tc_core, test_snn_dist);
 	
 	// Add each test case to the suite
 	suite_add_tcase(s, tc_core);
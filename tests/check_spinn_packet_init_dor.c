@@ -50,6 +50,39 @@ START_TEST (test_manual)
 }
 END_TEST
 
+/**
+ * Check that latency components are cleared by initialisation and accumulate
+ * the time between stamps.
+ */
+START_TEST (test_stamp)
+{
+	spinn_packet_t p;
+	
+	spinn_packet_init_dor( &p
+	                     , (spinn_coord_t){0,0}
+	                     , (spinn_coord_t){2,1}
+	                     , (spinn_coord_t){5,5}
+	                     , true
+	                     , NULL
+	                     );
+	for (int i = 0; i < SPINN_PACKET_NUM_LATENCIES; i++)
+		ck_assert_int_eq(p.latency[i], 0);
+	
+	p.sent_time  = 10;
+	p.stamp_time = 10;
+	spinn_packet_stamp(&p, 15, SPINN_PACKET_LATENCY_QUEUE);
+	spinn_packet_stamp(&p, 20, SPINN_PACKET_LATENCY_ROUTER);
+	spinn_packet_stamp(&p, 27, SPINN_PACKET_LATENCY_LINK);
+	spinn_packet_stamp(&p, 30, SPINN_PACKET_LATENCY_ROUTER);
+	
+	ck_assert_int_eq(p.latency[SPINN_PACKET_LATENCY_QUEUE],   5);
+	ck_assert_int_eq(p.latency[SPINN_PACKET_LATENCY_ARBITER], 0);
+	ck_assert_int_eq(p.latency[SPINN_PACKET_LATENCY_ROUTER],  8);
+	ck_assert_int_eq(p.latency[SPINN_PACKET_LATENCY_LINK],    7);
+	ck_assert_int_eq(p.stamp_time, 30);
+}
+END_TEST
+
 /**
  * Test creation of packets between every pair of points in the system for
  * various system sizes/shapes. Assumes that if there is no inflection point,
@@ -202,6 +235,7 @@ make_spinn_packet_init_dor(void)
 	// Add tests to the test case
 	TCase *tc_core = tcase_create("Core");
 	tcase_add_test(tc_core, test_manual);
+	tcase_add_test(tc_core, test_stamp);
 	tcase_add_test(tc_core, test_exhaustive);
 	
 	// Add each test case to the suite
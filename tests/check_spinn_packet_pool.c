@@ -104,6 +104,53 @@ START_TEST (test_many_packets)
 END_TEST
 
 
+/**
+ * Test that a retained packet is only returned to the pool once every reference
+ * has been freed.
+ */
+START_TEST (test_pretain)
+{
+	spinn_packet_t *p = spinn_packet_pool_palloc(&pool);
+	spinn_packet_pool_pretain(&pool, p);
+	spinn_packet_pool_pretain(&pool, p);
+	
+	// The packet is still referenced and so must not be handed out again
+	spinn_packet_pool_pfree(&pool, p);
+	spinn_packet_pool_pfree(&pool, p);
+	spinn_packet_t *q = spinn_packet_pool_palloc(&pool);
+	ck_assert(q != p);
+	spinn_packet_pool_pfree(&pool, q);
+	
+	// Once the last reference is freed the packet is reused
+	spinn_packet_pool_pfree(&pool, p);
+	ck_assert(spinn_packet_pool_palloc(&pool) == p);
+}
+END_TEST
+
+
+/**
+ * Test that the number of packets in use is tracked as the pool grows.
+ */
+START_TEST (test_num_in_use)
+{
+	spinn_packet_t *ps[NUM_PACKETS];
+	
+	ck_assert_int_eq(spinn_packet_pool_get_num_in_use(&pool), 0);
+	
+	for (int i = 0; i < NUM_PACKETS; i++) {
+		ps[i] = spinn_packet_pool_palloc(&pool);
+		ck_assert_int_eq(spinn_packet_pool_get_num_in_use(&pool), i + 1);
+		ck_assert(spinn_packet_pool_get_num_packets(&pool) >= i + 1);
+	}
+	
+	for (int i = 0; i < NUM_PACKETS; i++) {
+		spinn_packet_pool_pfree(&pool, ps[i]);
+		ck_assert_int_eq(spinn_packet_pool_get_num_in_use(&pool), NUM_PACKETS - i - 1);
+	}
+}
+END_TEST
+
+
 Suite *
 make_spinn_packet_pool_suite(void)
 {
@@ -116,6 +163,8 @@ make_spinn_packet_pool_suite(void)
 	tcase_add_test(tc_core, test_no_pfree);
 	tcase_add_test(tc_core, test_single_packet);
 	tcase_add_test(tc_core, test_many_packets);
+	tcase_add_test(tc_core, test_pretain);
+	tcase_add_test(tc_core, test_num_in_use);
 	
 	// Add each test case to the suite
 	suite_add_tcase(s, tc_core);
@@ -17,6 +17,7 @@
 #include "../src/spinn_topology.h"
 #include "../src/spinn_packet.h"
 #include "../src/spinn_router.h"
+#include "../src/spinn_mc_table.h"
 
 /******************************************************************************
  * Testbench
@@ -43,6 +44,10 @@ spinn_packet_t packets[NUM_PACKETS];
 
 spinn_router_t r;
 
+// Pool and routing table for multicast packets
+spinn_packet_pool_t pool;
+spinn_mc_table_t mc_table;
+
 
 // A record of a call to on_forward
 typedef struct on_forward_debug_data {
@@ -97,6 +102,9 @@ check_spinn_router_setup(void)
 	
 	last_on_forward.packet = NULL;
 	last_on_drop.packet = NULL;
+	
+	spinn_packet_pool_init(&pool);
+	spinn_mc_table_init(&mc_table);
 }
 
 
@@ -108,6 +116,8 @@ check_spinn_router_teardown(void)
 	for (int i = 0; i < 7; i++)
 		buffer_destroy(&(outputs[i]));
 	spinn_router_destroy(&r);
+	spinn_packet_pool_destroy(&pool);
+	spinn_mc_table_destroy(&mc_table);
 }
 
 /**
@@ -213,6 +223,7 @@ START_TEST (test_single_normal_packet)
 	
 	// Create a packet going in the given direction
 	spinn_packet_t p;
+	p.type                 = SPINN_PACKET_P2P;
 	p.inflection_point     = (spinn_coord_t){-1,-1};
 	p.inflection_direction = SPINN_NORTH;
 	p.source               = (spinn_coord_t){-1,-1};
@@ -265,10 +276,27 @@ START_TEST (test_single_normal_packet)
 	ck_assert_int_eq(last_on_forward.time, ROUTER_PERIOD*ROUTER_PIPELINE);
 	ck_assert_int_eq(last_on_forward.packet, &p);
 	
+	// Only the output used should have been counted
+	for (int i = 0; i < 7; i++) {
+		ck_assert_int_eq(spinn_router_get_num_forwarded(&r, i), (i == direction) ? 1 : 0);
+		ck_assert_int_eq(spinn_router_get_num_blocked(&r, i), 0);
+	}
+	
 	// Make sure nothing else happens
 	for (int i = 0; i < ROUTER_PERIOD*(FIRST_TIMEOUT + FINAL_TIMEOUT)*2; i++)
 		scheduler_tick_tock(&s);
 	
+	// The packet was at the end of the pipeline for only the cycle it was sent
+	// in and occupied one stage during each cycle it was in the pipeline
+	ck_assert(spinn_router_get_num_cycles(&r) > ROUTER_PIPELINE);
+	ck_assert_int_eq(spinn_router_get_num_stall_cycles(&r), 0);
+	ck_assert_int_eq(spinn_router_get_num_bubble_cycles(&r), spinn_router_get_num_cycles(&r) - 1);
+	ck_assert(spinn_router_get_mean_pipeline_occupancy(&r) * spinn_router_get_num_cycles(&r) > ROUTER_PIPELINE - 0.001);
+	ck_assert(spinn_router_get_mean_pipeline_occupancy(&r) * spinn_router_get_num_cycles(&r) < ROUTER_PIPELINE + 0.001);
+	ck_assert_int_eq(spinn_router_get_num_first_timeouts(&r), 0);
+	ck_assert_int_eq(spinn_router_get_num_emg_routed(&r), 0);
+	ck_assert_int_eq(spinn_router_get_num_dropped(&r), 0);
+	
 	// Make sure no buffers became occupied
 	ck_assert(buffer_is_empty(&input));
 	for (int i = 0; i < 7; i++)
@@ -293,6 +321,7 @@ START_TEST (test_multiple_normal_packet)
 	spinn_packet_t *p = packets;
 	for (int i = 0; i < OUT_BUFFER_SIZE; i++) {
 		for (int direction = 0; direction < 6; direction++) {
+			p->type                 = SPINN_PACKET_P2P;
 			p->inflection_point     = (spinn_coord_t){-1,-1};
 			p->inflection_direction = SPINN_NORTH;
 			p->source               = (spinn_coord_t){-1,-1};
@@ -364,6 +393,7 @@ START_TEST (test_normal_packet_arrival)
 	spinn_packet_t *p = packets;
 	for (int i = 0; i < emg_types_len; i++) {
 		for (int direction = 0; direction < 7; direction++) {
+			p->type                 = SPINN_PACKET_P2P;
 			p->inflection_point     = (spinn_coord_t){-1,-1};
 			p->inflection_direction = SPINN_NORTH;
 			p->source               = (spinn_coord_t){-1,-1};
@@ -442,6 +472,7 @@ START_TEST (test_normal_packet_drop)
 	spinn_packet_t *p = packets;
 	for (int i = 0; i < emg_types_len; i++) {
 		for (int direction = 0; direction < 7; direction++) {
+			p->type                 = SPINN_PACKET_P2P;
 			p->inflection_point     = (spinn_coord_t){-1,-1};
 			p->inflection_direction = SPINN_NORTH;
 			p->source               = (spinn_coord_t){-1,-1};
@@ -493,6 +524,13 @@ START_TEST (test_normal_packet_drop)
 			p++;
 		}
 	}
+	
+	// Every packet timed out (twice if emergency routing was attempted)
+	ck_assert_int_eq(spinn_router_get_num_dropped(&r), emg_types_len*7);
+	ck_assert_int_eq(spinn_router_get_num_first_timeouts(&r), emg_types_len*7);
+	ck_assert_int_eq(spinn_router_get_num_final_timeouts(&r), use_emg_routing ? emg_types_len*7 : 0);
+	ck_assert_int_eq(spinn_router_get_num_emg_routed(&r), 0);
+	ck_assert_int_eq(spinn_router_get_num_stall_cycles(&r), emg_types_len*7*drop_cycles);
 }
 END_TEST
 
@@ -503,6 +541,7 @@ END_TEST
 START_TEST (test_emg_first_leg)
 {
 	INIT_ROUTER(true, on_forward, on_drop);
+	spinn_router_enable_wait_histogram(&r, 3);
 	
 	// Packet states
 	const spinn_emg_state_t emg_types[] = { SPINN_EMG_NORMAL, SPINN_EMG_SECOND_LEG };
@@ -513,6 +552,7 @@ START_TEST (test_emg_first_leg)
 	
 	// Place the packet in the input buffer
 	spinn_packet_t *p = packets;
+	p->type                 = SPINN_PACKET_P2P;
 	p->inflection_point     = (spinn_coord_t){-1,-1};
 	p->inflection_direction = SPINN_NORTH;
 	p->source               = (spinn_coord_t){-1,-1};
@@ -554,6 +594,22 @@ START_TEST (test_emg_first_leg)
 	// And that it got forwarded on exactly this router cycle (when it was
 	// expected)
 	ck_assert_int_eq(last_on_forward.time, scheduler_get_ticks(&s) - ROUTER_PERIOD);
+	
+	// Check the packet was counted as having timed out and waited for exactly
+	// the first timeout
+	ck_assert_int_eq(spinn_router_get_num_first_timeouts(&r), 1);
+	ck_assert_int_eq(spinn_router_get_num_emg_routed(&r), 1);
+	ck_assert_int_eq(spinn_router_get_num_final_timeouts(&r), 0);
+	ck_assert_int_eq(spinn_router_get_num_stall_cycles(&r), FIRST_TIMEOUT);
+	histogram_t *h = spinn_router_get_wait_histogram(&r);
+	ck_assert(h != NULL);
+	ck_assert_int_eq(histogram_get_count(h), 1);
+	ck_assert_int_eq(histogram_get_max(h), FIRST_TIMEOUT);
+	
+	// Resetting the counters clears the histogram
+	spinn_router_reset_counters(&r);
+	ck_assert_int_eq(histogram_get_count(h), 0);
+	ck_assert_int_eq(spinn_router_get_num_emg_routed(&r), 0);
 }
 END_TEST
 
@@ -570,6 +626,7 @@ START_TEST (test_emg_second_leg)
 	
 	// Place the packet in the input buffer
 	spinn_packet_t *p = packets;
+	p->type                 = SPINN_PACKET_P2P;
 	p->inflection_point     = (spinn_coord_t){-1,-1};
 	p->inflection_direction = SPINN_NORTH;
 	p->source               = (spinn_coord_t){-1,-1};
@@ -620,6 +677,7 @@ START_TEST (test_bubbles)
 	// (which will later be put into the input buffer)
 	spinn_packet_t *p = packets;
 	for (int i = 0; i < _i; i++) {
+		p->type                 = SPINN_PACKET_P2P;
 		p->inflection_point     = (spinn_coord_t){-1,-1};
 		p->inflection_direction = SPINN_NORTH;
 		p->source               = (spinn_coord_t){-1,-1};
@@ -696,6 +754,219 @@ START_TEST (test_bubbles)
 END_TEST
 
 
+// The outputs a multicast packet is routed to in the tests below
+#define MC_KEY   0x00010000u
+#define MC_MASK  0xFFFF0000u
+#define MC_ROUTE ((1u<<SPINN_EAST) | (1u<<SPINN_NORTH) | (1u<<SPINN_LOCAL))
+
+/**
+ * Initialise a router with a multicast routing table containing a single entry
+ * for MC_KEY.
+ */
+static void
+init_mc_router(void)
+{
+	INIT_ROUTER(true, on_forward, on_drop);
+	spinn_mc_table_add_entry(&mc_table, MC_KEY, MC_MASK, MC_ROUTE);
+	spinn_mc_table_compile(&mc_table);
+	spinn_router_set_mc_table(&r, &mc_table, &pool);
+}
+
+
+/**
+ * Test that a multicast packet is sent to every output in its route at once:
+ * the packet itself to the first output and a separate copy to each other.
+ */
+START_TEST (test_mc_forward)
+{
+	init_mc_router();
+	
+	spinn_packet_t *p = spinn_packet_pool_palloc(&pool);
+	spinn_packet_init_mc(p, (spinn_coord_t){0,0}, MC_KEY | 0x1234u, NULL);
+	p->sent_time = 42;
+	buffer_push(&input, (void *)p);
+	
+	// Run until the packet reaches the end of the pipeline
+	for (int i = 0; i < ROUTER_PERIOD*(ROUTER_PIPELINE+1); i++)
+		scheduler_tick_tock(&s);
+	
+	// Each selected output should have its own copy of the packet, the first
+	// (east) being the original.
+	spinn_packet_t *copies[7];
+	for (int i = 0; i < 7; i++) {
+		if (MC_ROUTE & (1u << i)) {
+			copies[i] = (spinn_packet_t *)buffer_pop(&(outputs[i]));
+			ck_assert(buffer_is_empty(&(outputs[i])));
+			ck_assert(i == SPINN_EAST ? copies[i] == p : copies[i] != p);
+			ck_assert_int_eq(copies[i]->type, SPINN_PACKET_MC);
+			ck_assert_int_eq(copies[i]->key, MC_KEY | 0x1234u);
+			ck_assert_int_eq(copies[i]->sent_time, 42);
+			ck_assert_int_eq(copies[i]->num_hops, 1);
+			ck_assert_int_eq(copies[i]->direction, i);
+		} else {
+			ck_assert(buffer_is_empty(&(outputs[i])));
+		}
+	}
+	ck_assert_int_eq(last_on_forward.num_calls, 3);
+	ck_assert_int_eq(last_on_forward.time, ROUTER_PERIOD*ROUTER_PIPELINE);
+	ck_assert_int_eq(last_on_drop.num_calls, 0);
+	
+	// Each copy is returned to the pool independently
+	ck_assert_int_eq(spinn_packet_pool_get_num_in_use(&pool), 3);
+	spinn_packet_pool_pfree(&pool, copies[SPINN_NORTH]);
+	ck_assert_int_eq(spinn_packet_pool_get_num_in_use(&pool), 2);
+	ck_assert(spinn_packet_pool_palloc(&pool) == copies[SPINN_NORTH]);
+	spinn_packet_pool_pfree(&pool, copies[SPINN_NORTH]);
+	spinn_packet_pool_pfree(&pool, copies[SPINN_EAST]);
+	spinn_packet_pool_pfree(&pool, copies[SPINN_LOCAL]);
+	ck_assert_int_eq(spinn_packet_pool_get_num_in_use(&pool), 0);
+}
+END_TEST
+
+
+/**
+ * Test that each copy of a multicast packet counts the hops along its own branch
+ * of the tree: a packet is split in two and one copy is then passed through the
+ * router again (as if it were the next router along) and split again.
+ */
+START_TEST (test_mc_hops)
+{
+	// The on_forward handler expects packets to take a single hop
+	INIT_ROUTER(true, NULL, on_drop);
+	spinn_mc_table_add_entry(&mc_table, MC_KEY, MC_MASK, (1u<<SPINN_EAST) | (1u<<SPINN_LOCAL));
+	spinn_mc_table_compile(&mc_table);
+	spinn_router_set_mc_table(&r, &mc_table, &pool);
+	
+	spinn_packet_t *p = spinn_packet_pool_palloc(&pool);
+	spinn_packet_init_mc(p, (spinn_coord_t){0,0}, MC_KEY, NULL);
+	buffer_push(&input, (void *)p);
+	for (int i = 0; i < ROUTER_PERIOD*(ROUTER_PIPELINE+1); i++)
+		scheduler_tick_tock(&s);
+	
+	// First router: both branches have taken one hop
+	spinn_packet_t *east  = (spinn_packet_t *)buffer_pop(&(outputs[SPINN_EAST]));
+	spinn_packet_t *local = (spinn_packet_t *)buffer_pop(&(outputs[SPINN_LOCAL]));
+	ck_assert(east != local);
+	ck_assert_int_eq(east->num_hops, 1);
+	ck_assert_int_eq(local->num_hops, 1);
+	ck_assert_int_eq(east->direction, SPINN_EAST);
+	ck_assert_int_eq(local->direction, SPINN_LOCAL);
+	
+	// Second router: the east branch is split again
+	buffer_push(&input, (void *)east);
+	for (int i = 0; i < ROUTER_PERIOD*(ROUTER_PIPELINE+1); i++)
+		scheduler_tick_tock(&s);
+	spinn_packet_t *east_east  = (spinn_packet_t *)buffer_pop(&(outputs[SPINN_EAST]));
+	spinn_packet_t *east_local = (spinn_packet_t *)buffer_pop(&(outputs[SPINN_LOCAL]));
+	ck_assert_int_eq(east_east->num_hops, 2);
+	ck_assert_int_eq(east_local->num_hops, 2);
+	ck_assert_int_eq(east_east->direction, SPINN_EAST);
+	ck_assert_int_eq(east_local->direction, SPINN_LOCAL);
+	
+	// The copy which left at the first router is unaffected
+	ck_assert_int_eq(local->num_hops, 1);
+	ck_assert_int_eq(local->direction, SPINN_LOCAL);
+	
+	spinn_packet_pool_pfree(&pool, local);
+	spinn_packet_pool_pfree(&pool, east_east);
+	spinn_packet_pool_pfree(&pool, east_local);
+	ck_assert_int_eq(spinn_packet_pool_get_num_in_use(&pool), 0);
+}
+END_TEST
+
+
+/**
+ * Test that a multicast packet waits while any output in its route is blocked
+ * and, if _i is 1, is dropped if the blockage does not clear in time.
+ */
+START_TEST (test_mc_blocked)
+{
+	bool drop = _i == 1;
+	
+	init_mc_router();
+	
+	// Block the north output
+	for (int i = 0; i < OUT_BUFFER_SIZE; i++)
+		buffer_push(&(outputs[SPINN_NORTH]), (void *)&(packets[i]));
+	
+	spinn_packet_t *p = spinn_packet_pool_palloc(&pool);
+	spinn_packet_init_mc(p, (spinn_coord_t){0,0}, MC_KEY, NULL);
+	buffer_push(&input, (void *)p);
+	
+	// Wait until just before the packet would time out: nothing should be sent,
+	// not even to the outputs with space.
+	for (int i = 0; i < ROUTER_PERIOD*(ROUTER_PIPELINE+FIRST_TIMEOUT); i++)
+		scheduler_tick_tock(&s);
+	ck_assert(buffer_is_empty(&(outputs[SPINN_EAST])));
+	ck_assert(buffer_is_empty(&(outputs[SPINN_LOCAL])));
+	ck_assert_int_eq(last_on_forward.num_calls, 0);
+	ck_assert_int_eq(last_on_drop.num_calls, 0);
+	
+	// Only the blocked output counts the cycles spent waiting
+	ck_assert(spinn_router_get_num_blocked(&r, SPINN_NORTH) > 0);
+	ck_assert_int_eq(spinn_router_get_num_blocked(&r, SPINN_EAST), 0);
+	ck_assert_int_eq(spinn_router_get_num_blocked(&r, SPINN_LOCAL), 0);
+	
+	// Either unblock the output or let the packet time out
+	if (!drop)
+		buffer_pop(&(outputs[SPINN_NORTH]));
+	for (int i = 0; i < ROUTER_PERIOD; i++)
+		scheduler_tick_tock(&s);
+	
+	if (drop) {
+		ck_assert_int_eq(last_on_forward.num_calls, 0);
+		ck_assert_int_eq(last_on_drop.num_calls, 1);
+		ck_assert(last_on_drop.packet == p);
+		ck_assert(buffer_is_empty(&(outputs[SPINN_EAST])));
+		ck_assert(buffer_is_empty(&(outputs[SPINN_LOCAL])));
+	} else {
+		ck_assert_int_eq(last_on_forward.num_calls, 3);
+		ck_assert_int_eq(last_on_drop.num_calls, 0);
+		ck_assert(buffer_pop(&(outputs[SPINN_EAST])) == (void *)p);
+		spinn_packet_t *local = (spinn_packet_t *)buffer_pop(&(outputs[SPINN_LOCAL]));
+		ck_assert_int_eq(local->key, MC_KEY);
+		for (int i = 0; i < OUT_BUFFER_SIZE - 1; i++)
+			buffer_pop(&(outputs[SPINN_NORTH]));
+		spinn_packet_t *north = (spinn_packet_t *)buffer_pop(&(outputs[SPINN_NORTH]));
+		ck_assert_int_eq(north->key, MC_KEY);
+		ck_assert(local != p && north != p && local != north);
+		
+		ck_assert_int_eq(spinn_router_get_num_forwarded(&r, SPINN_EAST), 1);
+		ck_assert_int_eq(spinn_router_get_num_forwarded(&r, SPINN_NORTH), 1);
+		ck_assert_int_eq(spinn_router_get_num_forwarded(&r, SPINN_LOCAL), 1);
+	}
+}
+END_TEST
+
+
+/**
+ * Test that multicast packets are dropped immediately when there is no routing
+ * table (_i == 0) or no entry matches their key (_i == 1).
+ */
+START_TEST (test_mc_no_route)
+{
+	if (_i == 0)
+		INIT_ROUTER(true, on_forward, on_drop);
+	else
+		init_mc_router();
+	
+	spinn_packet_t *p = spinn_packet_pool_palloc(&pool);
+	spinn_packet_init_mc(p, (spinn_coord_t){0,0}, ~MC_KEY, NULL);
+	buffer_push(&input, (void *)p);
+	
+	for (int i = 0; i < ROUTER_PERIOD*(ROUTER_PIPELINE+1); i++)
+		scheduler_tick_tock(&s);
+	
+	for (int i = 0; i < 7; i++)
+		ck_assert(buffer_is_empty(&(outputs[i])));
+	ck_assert_int_eq(last_on_forward.num_calls, 0);
+	ck_assert_int_eq(last_on_drop.num_calls, 1);
+	ck_assert_int_eq(last_on_drop.time, ROUTER_PERIOD*ROUTER_PIPELINE);
+	ck_assert(last_on_drop.packet == p);
+}
+END_TEST
+
+
 Suite *
 make_spinn_router_suite(void)
 {
@@ -712,6 +983,10 @@ make_spinn_router_suite(void)
 	tcase_add_loop_test(tc_core, test_emg_first_leg, 0, 6*2);
 	tcase_add_loop_test(tc_core, test_emg_second_leg, 0, 6);
 	tcase_add_loop_test(tc_core, test_bubbles, 1, ROUTER_PIPELINE+1);
+	tcase_add_test(tc_core, test_mc_forward);
+	tcase_add_test(tc_core, test_mc_hops);
+	tcase_add_loop_test(tc_core, test_mc_blocked, 0, 2);
+	tcase_add_loop_test(tc_core, test_mc_no_route, 0, 2);
 	
 	// Add each test case to the suite
 	suite_add_tcase(s, tc_core);
@@ -0,0 +1,272 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * check_spinn_sim.c -- Tests of running experiments (warmups, samples and the
+ * alternative group modes) on small models built from the example config file.
+ */
+
+#include <check.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <dirent.h>
+#include <unistd.h>
+
+#include "config.h"
+
+#include "check_check.h"
+
+#include "../src/spinn.h"
+#include "../src/spinn_sim.h"
+#include "../src/spinn_sim_config.h"
+
+/******************************************************************************
+ * Testbench
+ ******************************************************************************/
+
+// The config file the models are built from (defined by the build)
+#ifndef TICKYSIM_CONFIG_FILE
+#define TICKYSIM_CONFIG_FILE "../configs/mohsen.config"
+#endif
+
+// The maximum number of overrides given to a simulation
+#define MAX_OVERRIDES 32
+
+static char sim_dir[] = "/tmp/check_spinn_sim_XXXXXX";
+
+static spinn_sim_t sim;
+
+// The overrides given to the simulation (and storage for their strings)
+static char *sim_overrides[MAX_OVERRIDES];
+static int   sim_num_overrides;
+
+void
+check_spinn_sim_setup(void)
+{
+	// A unique directory for the results
+	strcpy(sim_dir, "/tmp/check_spinn_sim_XXXXXX");
+	ck_assert(mkdtemp(sim_dir) != NULL);
+	
+	sim_num_overrides = 0;
+}
+
+
+void
+check_spinn_sim_teardown(void)
+{
+	for (int i = 0; i < sim_num_overrides; i++)
+		free(sim_overrides[i]);
+	
+	// Remove everything produced
+	DIR *dir = opendir(sim_dir);
+	ck_assert(dir != NULL);
+	struct dirent *entry;
+	while ((entry = readdir(dir)) != NULL) {
+		if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+			continue;
+		char path[sizeof(sim_dir) + 256];
+		snprintf(path, sizeof(path), "%s/%s", sim_dir, entry->d_name);
+		remove(path);
+	}
+	closedir(dir);
+	rmdir(sim_dir);
+}
+
+
+/**
+ * Add a config override of the form "key=value" where value may contain a %s
+ * which is replaced with the test's directory.
+ */
+static void
+sim_override(const char *key, const char *value)
+{
+	ck_assert(sim_num_overrides < MAX_OVERRIDES);
+	
+	char formatted_value[sizeof(sim_dir) + 256];
+	snprintf(formatted_value, sizeof(formatted_value), value, sim_dir);
+	
+	char *override = malloc(strlen(key) + strlen(formatted_value) + 2);
+	ck_assert(override != NULL);
+	sprintf(override, "%s=%s", key, formatted_value);
+	sim_overrides[sim_num_overrides++] = override;
+}
+
+
+/**
+ * Load the config with the overrides given so far on a small torus without a
+ * warmup, writing its results into the test's directory.
+ */
+static void
+init_sim(void)
+{
+	sim_override("model.network.torus_width", "4");
+	sim_override("model.network.torus_height", "4");
+	sim_override("measurements.results_directory", "%s/");
+	sim_override("experiment.warmup_duration.cold", "0");
+	sim_override("experiment.warmup_duration.hot", "0");
+	
+	spinn_sim_init(&sim, TICKYSIM_CONFIG_FILE, sim_num_overrides, sim_overrides);
+	sim.show_progress = false;
+}
+
+
+/******************************************************************************
+ * Testcases
+ ******************************************************************************/
+
+/**
+ * A deadlocked network must be terminated by the early termination monitors
+ * even when the sample is run in batches shorter than the monitors' interval.
+ */
+START_TEST (test_terminate_adaptive_sample)
+{
+	// Routers which never forward anything
+	sim_override("model.router.period", "100000000");
+	
+	sim_override("experiment.sample_duration", "100000");
+	sim_override("experiment.adaptive_sample.enabled", "True");
+	sim_override("experiment.adaptive_sample.batch_duration", "100");
+	sim_override("experiment.adaptive_sample.min_batches", "100000");
+	
+	sim_override("experiment.early_termination.enabled", "True");
+	sim_override("experiment.early_termination.interval", "1000");
+	sim_override("experiment.early_termination.max_drop_ratio", "0.0");
+	sim_override("experiment.early_termination.max_stalled_ticks", "3000");
+	init_sim();
+	
+	spinn_sim_run_groups(&sim, 0, -1);
+	ck_assert_int_eq(sim.terminated, SPINN_SIM_TERMINATED_STALLED);
+	
+	spinn_sim_destroy(&sim);
+}
+END_TEST
+
+
+/**
+ * The saturation search must bisect the range given until it is narrower than
+ * the tolerance, finding a saturation point strictly within the range.
+ */
+START_TEST (test_saturation_search)
+{
+	sim_override("experiment.sample_duration", "3000");
+	
+	// Saturated once packets are refused by the network or dropped
+	sim_override("experiment.saturation_search.enabled", "True");
+	sim_override("experiment.saturation_search.lower", "0.0");
+	sim_override("experiment.saturation_search.upper", "1.0");
+	sim_override("experiment.saturation_search.tolerance", "0.05");
+	sim_override("experiment.saturation_search.max_probes", "10");
+	sim_override("experiment.saturation_search.min_acceptance", "0.99");
+	sim_override("experiment.saturation_search.max_drop_ratio", "0.001");
+	init_sim();
+	
+	spinn_sim_run_groups(&sim, 0, -1);
+	spinn_sim_destroy(&sim);
+	
+	// Read back the bounds found
+	char filename[sizeof(sim_dir) + 32];
+	sprintf(filename, "%s/saturation.dat", sim_dir);
+	FILE *f = fopen(filename, "r");
+	ck_assert(f != NULL);
+	ck_assert(fscanf(f, "%*[^\n]\n") == 0);
+	int group, sample, num_probes;
+	double point, lower, upper;
+	ck_assert_int_eq(fscanf( f, "%d\t%d\t%*s\t%*s\t%*f\t%lf\t%lf\t%lf\t%d"
+	                       , &group, &sample, &point, &lower, &upper, &num_probes
+	                       ), 6);
+	fclose(f);
+	
+	ck_assert_int_eq(group, 1);
+	
+	// Halving the range from 1.0 to below 0.05 takes five probes
+	ck_assert_int_eq(num_probes, 5);
+	ck_assert(upper - lower <= 0.05);
+	ck_assert(upper - lower > 0.025);
+	ck_assert(point > lower && point < upper);
+	
+	// Neither an idle nor a fully loaded network is at the saturation point
+	ck_assert(lower > 0.0);
+	ck_assert(upper < 1.0);
+}
+END_TEST
+
+
+/**
+ * The staircase must measure each level in turn as a sample of the group and
+ * restore the group's own value afterwards.
+ */
+START_TEST (test_staircase)
+{
+	sim_override("experiment.sample_duration", "2000");
+	sim_override("experiment.staircase.enabled", "True");
+	sim_override("experiment.staircase.settle_duration", "100");
+	init_sim();
+	
+	config_setting_t *levels = config_lookup(&(sim.config), "experiment.staircase.levels");
+	ck_assert(levels != NULL);
+	int num_levels = config_setting_length(levels);
+	ck_assert(num_levels > 1);
+	double *values = malloc(num_levels * sizeof(double));
+	ck_assert(values != NULL);
+	for (int i = 0; i < num_levels; i++)
+		values[i] = config_setting_get_float_elem(levels, i);
+	
+	spinn_sim_run_groups(&sim, 0, -1);
+	
+	// The group's own load (the last independent variable) is restored
+	spinn_sim_config_set_exp_group(&sim, 0);
+	config_setting_t *groups = config_lookup(&(sim.config), "experiment.groups");
+	config_setting_t *group  = config_setting_get_elem(groups, 0);
+	ck_assert(config_setting_get_float(config_setting_get_elem(group, config_setting_length(group) - 1))
+	          == spinn_sim_config_lookup_float(&sim, "model.packet_generator.temporal.bernoulli_prob"));
+	
+	spinn_sim_destroy(&sim);
+	
+	// One sample per level (written with six decimal places) with increasing
+	// numbers of packets accepted
+	char filename[sizeof(sim_dir) + 32];
+	sprintf(filename, "%s/global_counters.dat", sim_dir);
+	FILE *f = fopen(filename, "r");
+	ck_assert(f != NULL);
+	ck_assert(fscanf(f, "%*[^\n]\n") == 0);
+	long last_accepted = -1;
+	for (int i = 0; i < num_levels; i++) {
+		int group, sample;
+		double load;
+		long accepted;
+		ck_assert_int_eq(fscanf( f, "%d\t%d\t%*s\t%*s\t%lf\t%ld%*[^\n]\n"
+		                       , &group, &sample, &load, &accepted
+		                       ), 4);
+		ck_assert_int_eq(group, 1);
+		ck_assert_int_eq(sample, i + 1);
+		ck_assert(fabs(load - values[i]) < 1e-6);
+		ck_assert(accepted > last_accepted);
+		last_accepted = accepted;
+	}
+	ck_assert(fgetc(f) == EOF);
+	fclose(f);
+	
+	free(values);
+}
+END_TEST
+
+
+Suite *
+make_spinn_sim_suite(void)
+{
+	Suite *s = suite_create("spinn_sim");
+	
+	// Add tests to the test case
+	TCase *tc_core = tcase_create("Core");
+	tcase_add_checked_fixture(tc_core, check_spinn_sim_setup, check_spinn_sim_teardown);
+	tcase_add_test(tc_core, test_terminate_adaptive_sample);
+	tcase_add_test(tc_core, test_saturation_search);
+	tcase_add_test(tc_core, test_staircase);
+	
+	// Add each test case to the suite
+	suite_add_tcase(s, tc_core);
+	
+	return s;
+}
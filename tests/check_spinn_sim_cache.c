@@ -0,0 +1,386 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * check_spinn_sim_cache.c -- Tests of the result cache.
+ */
+
+#include <check.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "config.h"
+
+#include "check_check.h"
+
+#include "../src/spinn.h"
+#include "../src/spinn_sim.h"
+#include "../src/spinn_sim_config.h"
+#include "../src/spinn_sim_stat.h"
+#include "../src/spinn_sim_cache.h"
+
+/******************************************************************************
+ * Testbench
+ ******************************************************************************/
+
+// The config file the models are built from (defined by the build)
+#ifndef TICKYSIM_CONFIG_FILE
+#define TICKYSIM_CONFIG_FILE "../configs/mohsen.config"
+#endif
+
+// The maximum number of overrides given to a simulation
+#define MAX_OVERRIDES 16
+
+// The number of result files stored in the entries
+#define NUM_FILES 2
+
+static char cache_dir[] = "/tmp/check_spinn_sim_cache_XXXXXX";
+
+static spinn_sim_t cache_sim;
+
+// The overrides given to the simulation (and storage for their strings)
+static char *cache_overrides[MAX_OVERRIDES];
+static int   cache_num_overrides;
+
+// The output stored and loaded
+static char   *saved_data[NUM_FILES] = {"Some results\n", ""};
+static size_t  saved_lengths[NUM_FILES];
+static char   *loaded_data[NUM_FILES];
+static size_t  loaded_lengths[NUM_FILES];
+
+void
+check_spinn_sim_cache_setup(void)
+{
+	// A unique directory for the results and cache entries
+	strcpy(cache_dir, "/tmp/check_spinn_sim_cache_XXXXXX");
+	ck_assert(mkdtemp(cache_dir) != NULL);
+	
+	cache_num_overrides = 0;
+	
+	for (int i = 0; i < NUM_FILES; i++)
+		saved_lengths[i] = strlen(saved_data[i]);
+}
+
+
+void
+check_spinn_sim_cache_teardown(void)
+{
+	for (int i = 0; i < cache_num_overrides; i++)
+		free(cache_overrides[i]);
+	
+	// Remove everything produced
+	DIR *dir = opendir(cache_dir);
+	ck_assert(dir != NULL);
+	struct dirent *entry;
+	while ((entry = readdir(dir)) != NULL) {
+		if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+			continue;
+		char path[sizeof(cache_dir) + 256];
+		snprintf(path, sizeof(path), "%s/%s", cache_dir, entry->d_name);
+		remove(path);
+	}
+	closedir(dir);
+	rmdir(cache_dir);
+}
+
+
+/**
+ * Add a config override of the form "key=value" where value may contain a %s
+ * which is replaced with the test's directory.
+ */
+static void
+cache_override(const char *key, const char *value)
+{
+	ck_assert(cache_num_overrides < MAX_OVERRIDES);
+	
+	char formatted_value[sizeof(cache_dir) + 256];
+	snprintf(formatted_value, sizeof(formatted_value), value, cache_dir);
+	
+	char *override = malloc(strlen(key) + strlen(formatted_value) + 2);
+	ck_assert(override != NULL);
+	sprintf(override, "%s=%s", key, formatted_value);
+	cache_overrides[cache_num_overrides++] = override;
+}
+
+
+/**
+ * Load the config with the overrides given so far and the results and cache in
+ * the test's directory.
+ */
+static void
+init_cache_sim(void)
+{
+	cache_override("measurements.results_directory", "%s/");
+	cache_override("experiment.result_cache.directory", "%s");
+	
+	spinn_sim_init(&cache_sim, TICKYSIM_CONFIG_FILE, cache_num_overrides, cache_overrides);
+	cache_sim.show_progress = false;
+}
+
+
+/**
+ * Load the entry of the given job, checking that, if found, it holds exactly
+ * the output saved by save_job.
+ */
+static bool
+load_job(int group, int sample)
+{
+	if (!spinn_sim_cache_load(&cache_sim, group, sample, NUM_FILES, loaded_data, loaded_lengths))
+		return false;
+	
+	for (int i = 0; i < NUM_FILES; i++) {
+		ck_assert_int_eq(loaded_lengths[i], saved_lengths[i]);
+		ck_assert(memcmp(loaded_data[i], saved_data[i], saved_lengths[i]) == 0);
+		free(loaded_data[i]);
+	}
+	return true;
+}
+
+
+static void
+save_job(int group, int sample)
+{
+	spinn_sim_cache_save(&cache_sim, group, sample, NUM_FILES, saved_data, saved_lengths);
+}
+
+
+/**
+ * Get the filename of the only cache entry (which must exist). The string must
+ * be freed by the caller.
+ */
+static char *
+get_entry_filename(void)
+{
+	char *filename = NULL;
+	
+	DIR *dir = opendir(cache_dir);
+	ck_assert(dir != NULL);
+	struct dirent *entry;
+	while ((entry = readdir(dir)) != NULL) {
+		if (strncmp(entry->d_name, "result_", 7) != 0)
+			continue;
+		ck_assert(filename == NULL);
+		filename = malloc(sizeof(cache_dir) + strlen(entry->d_name) + 1);
+		ck_assert(filename != NULL);
+		sprintf(filename, "%s/%s", cache_dir, entry->d_name);
+	}
+	closedir(dir);
+	
+	ck_assert(filename != NULL);
+	return filename;
+}
+
+
+/**
+ * Read the whole of a file into memory, returning its length. The data must be
+ * freed by the caller.
+ */
+static size_t
+read_file(const char *filename, char **data)
+{
+	FILE *f = fopen(filename, "rb");
+	ck_assert(f != NULL);
+	fseek(f, 0, SEEK_END);
+	size_t length = ftell(f);
+	rewind(f);
+	
+	*data = malloc(length + 1);
+	ck_assert(*data != NULL);
+	ck_assert_int_eq(fread(*data, 1, length, f), length);
+	fclose(f);
+	return length;
+}
+
+
+static void
+write_file(const char *filename, const char *data, size_t length)
+{
+	FILE *f = fopen(filename, "wb");
+	ck_assert(f != NULL);
+	ck_assert_int_eq(fwrite(data, 1, length, f), length);
+	fclose(f);
+}
+
+
+/******************************************************************************
+ * Testcases
+ ******************************************************************************/
+
+/**
+ * Make sure the output saved for a job is loaded back for that job only.
+ */
+START_TEST (test_round_trip)
+{
+	init_cache_sim();
+	
+	ck_assert(!load_job(0, -1));
+	save_job(0, -1);
+	ck_assert(load_job(0, -1));
+	
+	// Other jobs aren't affected
+	ck_assert(!load_job(1, -1));
+	ck_assert(!load_job(0, 0));
+	
+	// A job may be saved again
+	save_job(0, -1);
+	ck_assert(load_job(0, -1));
+	
+	spinn_sim_destroy(&cache_sim);
+}
+END_TEST
+
+
+/**
+ * Make sure changing the seed or the value of an independent variable gives a
+ * different entry.
+ */
+START_TEST (test_key)
+{
+	init_cache_sim();
+	save_job(0, -1);
+	
+	unsigned int seed = cache_sim.seed;
+	cache_sim.seed = seed + 1;
+	ck_assert(!load_job(0, -1));
+	cache_sim.seed = seed;
+	ck_assert(load_job(0, -1));
+	
+	// The last independent variable of the first group (its load)
+	config_setting_t *groups = config_lookup(&(cache_sim.config), "experiment.groups");
+	ck_assert(groups != NULL);
+	config_setting_t *group = config_setting_get_elem(groups, 0);
+	config_setting_t *load  = config_setting_get_elem(group, config_setting_length(group) - 1);
+	double value = config_setting_get_float(load);
+	ck_assert(config_setting_set_float(load, value * 2.0));
+	ck_assert(!load_job(0, -1));
+	ck_assert(config_setting_set_float(load, value));
+	ck_assert(load_job(0, -1));
+	
+	spinn_sim_destroy(&cache_sim);
+}
+END_TEST
+
+
+/**
+ * Make sure damaged entries are ignored (and can be replaced).
+ */
+START_TEST (test_corrupt)
+{
+	init_cache_sim();
+	save_job(0, -1);
+	
+	char *filename = get_entry_filename();
+	char *entry;
+	size_t length = read_file(filename, &entry);
+	
+	// Truncated
+	write_file(filename, entry, length - 1);
+	ck_assert(!load_job(0, -1));
+	
+	// Extended
+	entry[length] = '\n';
+	write_file(filename, entry, length + 1);
+	ck_assert(!load_job(0, -1));
+	
+	// Not an entry
+	entry[0] = 'X';
+	write_file(filename, entry, length);
+	ck_assert(!load_job(0, -1));
+	
+	// Recomputed
+	save_job(0, -1);
+	ck_assert(load_job(0, -1));
+	
+	free(entry);
+	free(filename);
+	spinn_sim_destroy(&cache_sim);
+}
+END_TEST
+
+
+/**
+ * Make sure the side files written by a job are restored with its output and
+ * that an entry can't place side files outside the results directory.
+ */
+START_TEST (test_side_files)
+{
+	cache_override("measurements.flow_matrix.enabled", "True");
+	cache_override("experiment.warmup_duration.cold", "0");
+	cache_override("experiment.sample_duration", "100");
+	cache_override("model.network.torus_width", "4");
+	cache_override("model.network.torus_height", "4");
+	init_cache_sim();
+	
+	// Write a flow matrix (the only side file written) and store it with the
+	// job's output
+	spinn_sim_stat_clear_side_files(&cache_sim);
+	spinn_sim_run_groups(&cache_sim, 0, -1);
+	char **side_files;
+	ck_assert_int_eq(spinn_sim_stat_get_side_files(&cache_sim, &side_files), 1);
+	ck_assert(strcmp(side_files[0], "flow_matrix_g1_s1.bin") == 0);
+	save_job(0, -1);
+	
+	char side_filename[sizeof(cache_dir) + 32];
+	sprintf(side_filename, "%s/flow_matrix_g1_s1.bin", cache_dir);
+	char *side_data;
+	size_t side_length = read_file(side_filename, &side_data);
+	
+	// Restored when loaded
+	ck_assert(remove(side_filename) == 0);
+	ck_assert(load_job(0, -1));
+	char *restored_data;
+	ck_assert_int_eq(read_file(side_filename, &restored_data), side_length);
+	ck_assert(memcmp(restored_data, side_data, side_length) == 0);
+	free(restored_data);
+	
+	// Rename the side file within the entry into a subdirectory
+	ck_assert(remove(side_filename) == 0);
+	char *filename = get_entry_filename();
+	char *entry;
+	size_t length = read_file(filename, &entry);
+	char *name = NULL;
+	for (size_t i = 0; name == NULL && i + 11 <= length; i++)
+		if (memcmp(entry + i, "flow_matrix", 11) == 0)
+			name = entry + i;
+	ck_assert(name != NULL);
+	name[11] = '/';
+	write_file(filename, entry, length);
+	
+	char subdir[sizeof(cache_dir) + 32];
+	sprintf(subdir, "%s/flow_matrix", cache_dir);
+	ck_assert(mkdir(subdir, 0777) == 0);
+	sprintf(side_filename, "%s/flow_matrix/g1_s1.bin", cache_dir);
+	
+	ck_assert(!load_job(0, -1));
+	ck_assert(access(side_filename, F_OK) != 0);
+	
+	free(entry);
+	free(filename);
+	free(side_data);
+	spinn_sim_destroy(&cache_sim);
+}
+END_TEST
+
+
+Suite *
+make_spinn_sim_cache_suite(void)
+{
+	Suite *s = suite_create("spinn_sim_cache");
+	
+	// Add tests to the test case
+	TCase *tc_core = tcase_create("Core");
+	tcase_add_checked_fixture(tc_core, check_spinn_sim_cache_setup, check_spinn_sim_cache_teardown);
+	tcase_add_test(tc_core, test_round_trip);
+	tcase_add_test(tc_core, test_key);
+	tcase_add_test(tc_core, test_corrupt);
+	tcase_add_test(tc_core, test_side_files);
+	
+	// Add each test case to the suite
+	suite_add_tcase(s, tc_core);
+	
+	return s;
+}
@@ -0,0 +1,241 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * check_spinn_sim_cost.c -- Tests of the run time model.
+ */
+
+#include <check.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <dirent.h>
+#include <unistd.h>
+
+#include "config.h"
+
+#include "check_check.h"
+
+#include "../src/spinn.h"
+#include "../src/spinn_sim.h"
+#include "../src/spinn_sim_cost.h"
+
+/******************************************************************************
+ * Testbench
+ ******************************************************************************/
+
+// The config file the models are built from (defined by the build)
+#ifndef TICKYSIM_CONFIG_FILE
+#define TICKYSIM_CONFIG_FILE "../configs/mohsen.config"
+#endif
+
+// The length of a (cold) sample of the simulations whose run time is predicted
+#define SAMPLE_DURATION 1000
+
+// The size and load of the first group of the example experiment
+#define NUM_NODES 16
+#define LOAD      0.00063
+
+static char cost_dir[] = "/tmp/check_spinn_sim_cost_XXXXXX";
+static char cost_filename[sizeof(cost_dir) + 16];
+
+static spinn_sim_t cost_sim;
+
+// The options of the simulations whose run time is predicted
+static char cost_options[SPINN_SIM_COST_MAX_OPTIONS];
+
+void
+check_spinn_sim_cost_setup(void)
+{
+	// A unique directory for the results and cost model file
+	strcpy(cost_dir, "/tmp/check_spinn_sim_cost_XXXXXX");
+	ck_assert(mkdtemp(cost_dir) != NULL);
+	sprintf(cost_filename, "%s/cost.dat", cost_dir);
+	
+	// The overrides are modified when parsed so mustn't be string literals
+	char width[]    = "model.network.torus_width=4";
+	char height[]   = "model.network.torus_height=4";
+	char warmup[]   = "experiment.warmup_duration.cold=0";
+	char duration[32];
+	sprintf(duration, "experiment.sample_duration=%d", SAMPLE_DURATION);
+	char file[sizeof(cost_filename) + 64];
+	sprintf(file, "experiment.cost_model.file=%s", cost_filename);
+	
+	char results_directory[sizeof(cost_dir) + 64];
+	sprintf(results_directory, "measurements.results_directory=%s/", cost_dir);
+	
+	char *overrides[] = {width, height, warmup, duration, file, results_directory};
+	
+	spinn_sim_init(&cost_sim, TICKYSIM_CONFIG_FILE, sizeof(overrides)/sizeof(char *), overrides);
+	cost_sim.show_progress = false;
+	
+	// Find the options recorded for the simulation from a timing of it
+	spinn_sim_cost_record(&cost_sim, 1, 1.0);
+	FILE *f = fopen(cost_filename, "r");
+	ck_assert(f != NULL);
+	char format[16];
+	sprintf(format, "%%%ds", SPINN_SIM_COST_MAX_OPTIONS - 1);
+	ck_assert_int_eq(fscanf(f, format, cost_options), 1);
+	fclose(f);
+	
+	// Start with an empty model
+	f = fopen(cost_filename, "w");
+	ck_assert(f != NULL);
+	fclose(f);
+}
+
+
+void
+check_spinn_sim_cost_teardown(void)
+{
+	spinn_sim_destroy(&cost_sim);
+	
+	// Remove everything produced
+	DIR *dir = opendir(cost_dir);
+	ck_assert(dir != NULL);
+	struct dirent *entry;
+	while ((entry = readdir(dir)) != NULL) {
+		if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+			continue;
+		char path[sizeof(cost_dir) + 256];
+		snprintf(path, sizeof(path), "%s/%s", cost_dir, entry->d_name);
+		remove(path);
+	}
+	closedir(dir);
+	rmdir(cost_dir);
+}
+
+
+/**
+ * Append a timing with the given options whose cost is the given number of ns
+ * per node-tick.
+ */
+static void
+add_timing(const char *options, double num_nodes, double load, double ns)
+{
+	double ticks = 100000.0;
+	
+	FILE *f = fopen(cost_filename, "a");
+	ck_assert(f != NULL);
+	fprintf(f, "%s %.0f %g %.0f %.9f\n", options, num_nodes, load, ticks, ns * 1e-9 * ticks * num_nodes);
+	fclose(f);
+}
+
+
+/**
+ * Predict the cost (ns per node-tick) of a cold sample of the first group from
+ * the timings in the cost model file.
+ */
+static double
+predict_ns(void)
+{
+	spinn_sim_cost_t cost;
+	spinn_sim_cost_init(&cost, &cost_sim);
+	double seconds = spinn_sim_cost_predict(&cost, &cost_sim, 0, 0, false);
+	spinn_sim_cost_destroy(&cost);
+	
+	return seconds * 1e9 / ((double)SAMPLE_DURATION * (double)NUM_NODES);
+}
+
+
+/**
+ * An example cost which varies linearly with the load and the log of the size.
+ */
+static double
+linear_ns(double num_nodes, double load)
+{
+	return 10.0 + 1000.0*load + 5.0*log2(num_nodes);
+}
+
+
+/******************************************************************************
+ * Testcases
+ ******************************************************************************/
+
+/**
+ * Without any timings a default cost is assumed.
+ */
+START_TEST (test_no_timings)
+{
+	double ns = predict_ns();
+	ck_assert(ns > 0.0);
+	
+	// The same as when there is no file at all
+	remove(cost_filename);
+	ck_assert(fabs(predict_ns() - ns) < 1e-9);
+}
+END_TEST
+
+
+/**
+ * A cost which is linear in the load and the log of the size must be predicted
+ * exactly between and beyond the timings.
+ */
+START_TEST (test_linear_fit)
+{
+	double sizes[] = {64, 256, 1024};
+	double loads[] = {0.01, 0.02, 0.04};
+	for (int i = 0; i < 3; i++)
+		for (int j = 0; j < 3; j++)
+			add_timing(cost_options, sizes[i], loads[j], linear_ns(sizes[i], loads[j]));
+	
+	double expected = linear_ns(NUM_NODES, LOAD);
+	ck_assert(fabs(predict_ns() - expected) < expected * 1e-3);
+}
+END_TEST
+
+
+/**
+ * Timings with other options are only used while there are too few timings with
+ * matching options.
+ */
+START_TEST (test_matching_options)
+{
+	add_timing("other", NUM_NODES, LOAD, 1000.0);
+	add_timing(cost_options, NUM_NODES, LOAD, 20.0);
+	add_timing(cost_options, NUM_NODES, LOAD, 20.0);
+	
+	// Too few matching timings: all are used
+	double ns = predict_ns();
+	ck_assert(ns > 20.0 * 1.1);
+	
+	// Enough matching timings: the others are ignored
+	add_timing(cost_options, NUM_NODES, LOAD, 20.0);
+	ck_assert(fabs(predict_ns() - 20.0) < 20.0 * 1e-3);
+}
+END_TEST
+
+
+/**
+ * Timings all of the size and load predicted give their cost (even though the
+ * fit is under-determined).
+ */
+START_TEST (test_constant)
+{
+	for (int i = 0; i < 4; i++)
+		add_timing(cost_options, NUM_NODES, LOAD, 42.0);
+	
+	ck_assert(fabs(predict_ns() - 42.0) < 42.0 * 1e-3);
+}
+END_TEST
+
+
+Suite *
+make_spinn_sim_cost_suite(void)
+{
+	Suite *s = suite_create("spinn_sim_cost");
+	
+	// Add tests to the test case
+	TCase *tc_core = tcase_create("Core");
+	tcase_add_checked_fixture(tc_core, check_spinn_sim_cost_setup, check_spinn_sim_cost_teardown);
+	tcase_add_test(tc_core, test_no_timings);
+	tcase_add_test(tc_core, test_linear_fit);
+	tcase_add_test(tc_core, test_matching_options);
+	tcase_add_test(tc_core, test_constant);
+	
+	// Add each test case to the suite
+	suite_add_tcase(s, tc_core);
+	
+	return s;
+}
@@ -0,0 +1,210 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * check_spinn_sim_model.c -- Regression tests for building SpiNNaker models
+ * from the example config file.
+ */
+
+#include <check.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <unistd.h>
+
+#include "config.h"
+
+#include "check_check.h"
+
+#include "../src/spinn.h"
+#include "../src/spinn_sim.h"
+#include "../src/spinn_sim_model.h"
+#include "../src/spinn_sim_config.h"
+#include "../src/spinn_trace.h"
+
+/******************************************************************************
+ * Testbench
+ ******************************************************************************/
+
+// The config file the models are built from (defined by the build)
+#ifndef TICKYSIM_CONFIG_FILE
+#define TICKYSIM_CONFIG_FILE "../configs/mohsen.config"
+#endif
+
+// The maximum number of overrides given to a model
+#define MAX_OVERRIDES 16
+
+static char model_dir[] = "/tmp/check_spinn_sim_model_XXXXXX";
+
+static spinn_sim_t model_sim;
+
+// The overrides given to the model (and storage for their strings)
+static char *model_overrides[MAX_OVERRIDES];
+static int   model_num_overrides;
+
+void
+check_spinn_sim_model_setup(void)
+{
+	// A unique directory for the results and any input files
+	strcpy(model_dir, "/tmp/check_spinn_sim_model_XXXXXX");
+	ck_assert(mkdtemp(model_dir) != NULL);
+	
+	model_num_overrides = 0;
+}
+
+
+void
+check_spinn_sim_model_teardown(void)
+{
+	for (int i = 0; i < model_num_overrides; i++)
+		free(model_overrides[i]);
+	
+	// Remove everything produced
+	DIR *dir = opendir(model_dir);
+	ck_assert(dir != NULL);
+	struct dirent *entry;
+	while ((entry = readdir(dir)) != NULL) {
+		if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+			continue;
+		char path[sizeof(model_dir) + 256];
+		snprintf(path, sizeof(path), "%s/%s", model_dir, entry->d_name);
+		remove(path);
+	}
+	closedir(dir);
+	rmdir(model_dir);
+}
+
+
+/**
+ * Add a config override of the form "key=value" where value may contain a %s
+ * which is replaced with the test's directory.
+ */
+static void
+add_override(const char *key, const char *value)
+{
+	ck_assert(model_num_overrides < MAX_OVERRIDES);
+	
+	char formatted_value[sizeof(model_dir) + 256];
+	snprintf(formatted_value, sizeof(formatted_value), value, model_dir);
+	
+	char *override = malloc(strlen(key) + strlen(formatted_value) + 2);
+	ck_assert(override != NULL);
+	sprintf(override, "%s=%s", key, formatted_value);
+	model_overrides[model_num_overrides++] = override;
+}
+
+
+/**
+ * Load the config with the overrides given so far and a small board_mesh
+ * topology (where some nodes are disabled) writing its results into the test's
+ * directory.
+ */
+static void
+init_board_mesh_sim(void)
+{
+	add_override("model.network.topology", "board_mesh");
+	add_override("model.network.board_mesh_radius", "1");
+	add_override("measurements.results_directory", "%s/");
+	add_override("experiment.seed", "1");
+	
+	spinn_sim_init(&model_sim, TICKYSIM_CONFIG_FILE, model_num_overrides, model_overrides);
+	model_sim.show_progress = false;
+	spinn_sim_config_set_exp_group(&model_sim, 0);
+}
+
+
+/**
+ * Build the model, update it as is done between groups and run it for a few
+ * ticks, checking that some nodes were disabled.
+ */
+static void
+run_model(void)
+{
+	spinn_sim_model_init(&model_sim);
+	spinn_sim_model_update(&model_sim);
+	
+	int num_disabled = 0;
+	for (int i = 0; i < model_sim.system_size.x * model_sim.system_size.y; i++)
+		if (!model_sim.nodes[i].enabled)
+			num_disabled++;
+	ck_assert(num_disabled > 0);
+	
+	for (int i = 0; i < 100; i++)
+		scheduler_tick_tock(&(model_sim.scheduler));
+	
+	spinn_sim_model_destroy(&model_sim);
+	spinn_sim_destroy(&model_sim);
+}
+
+
+/******************************************************************************
+ * Testcases
+ ******************************************************************************/
+
+START_TEST (test_board_mesh_trace)
+{
+	add_override("model.packet_generator.temporal.dist", "trace");
+	add_override("model.packet_generator.temporal.trace_file", "%s/trace.bin");
+	init_board_mesh_sim();
+	
+	// An empty trace for the system (the generators of disabled nodes must not be
+	// configured to replay it)
+	char trace_filename[sizeof(model_dir) + 16];
+	sprintf(trace_filename, "%s/trace.bin", model_dir);
+	bool use_wrap_around_links;
+	spinn_trace_writer_t w;
+	ck_assert(spinn_trace_writer_open( &w
+	                                 , trace_filename
+	                                 , spinn_sim_model_get_system_size(&model_sim, &use_wrap_around_links)
+	                                 ));
+	ck_assert(spinn_trace_writer_close(&w));
+	
+	run_model();
+}
+END_TEST
+
+
+START_TEST (test_board_mesh_snn)
+{
+	add_override("model.packet_generator.temporal.dist", "snn");
+	add_override("model.packet_generator.temporal.snn.placement_file", "%s/placement.txt");
+	add_override("model.packet_generator.temporal.snn.projection_file", "%s/projections.txt");
+	init_board_mesh_sim();
+	
+	// A pair of populations spiking at each other (the generators of disabled
+	// nodes must not be configured to send spikes)
+	char filename[sizeof(model_dir) + 32];
+	sprintf(filename, "%s/placement.txt", model_dir);
+	FILE *f = fopen(filename, "w");
+	ck_assert(f != NULL);
+	fprintf(f, "a 0 0\nb 1 1\n");
+	fclose(f);
+	
+	sprintf(filename, "%s/projections.txt", model_dir);
+	f = fopen(filename, "w");
+	ck_assert(f != NULL);
+	fprintf(f, "a b 1000.0\nb a 1000.0\n");
+	fclose(f);
+	
+	run_model();
+}
+END_TEST
+
+
+Suite *
+make_spinn_sim_model_suite(void)
+{
+	Suite *s = suite_create("spinn_sim_model");
+	
+	// Add tests to the test case
+	TCase *tc_core = tcase_create("Core");
+	tcase_add_checked_fixture(tc_core, check_spinn_sim_model_setup, check_spinn_sim_model_teardown);
+	tcase_add_test(tc_core, test_board_mesh_trace);
+	tcase_add_test(tc_core, test_board_mesh_snn);
+	
+	// Add each test case to the suite
+	suite_add_tcase(s, tc_core);
+	
+	return s;
+}
@@ -0,0 +1,170 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * check_spinn_sim_parallel.c -- Tests of running experiments in parallel.
+ */
+
+#include <check.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <unistd.h>
+
+#include "config.h"
+
+#include "check_check.h"
+
+#include "../src/spinn.h"
+#include "../src/spinn_sim.h"
+#include "../src/spinn_sim_parallel.h"
+
+/******************************************************************************
+ * Testbench
+ ******************************************************************************/
+
+// The config file the models are built from (defined by the build)
+#ifndef TICKYSIM_CONFIG_FILE
+#define TICKYSIM_CONFIG_FILE "../configs/mohsen.config"
+#endif
+
+// The number of runs compared
+#define NUM_RUNS 2
+
+static char par_dirs[NUM_RUNS][40];
+
+void
+check_spinn_sim_parallel_setup(void)
+{
+	// A unique results directory for each run
+	for (int i = 0; i < NUM_RUNS; i++) {
+		strcpy(par_dirs[i], "/tmp/check_spinn_sim_parallel_XXXXXX");
+		ck_assert(mkdtemp(par_dirs[i]) != NULL);
+	}
+}
+
+
+void
+check_spinn_sim_parallel_teardown(void)
+{
+	// Remove everything produced
+	for (int i = 0; i < NUM_RUNS; i++) {
+		DIR *dir = opendir(par_dirs[i]);
+		ck_assert(dir != NULL);
+		struct dirent *entry;
+		while ((entry = readdir(dir)) != NULL) {
+			if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+				continue;
+			char path[sizeof(par_dirs[i]) + 256];
+			snprintf(path, sizeof(path), "%s/%s", par_dirs[i], entry->d_name);
+			remove(path);
+		}
+		closedir(dir);
+		rmdir(par_dirs[i]);
+	}
+}
+
+
+/**
+ * Run every group of the example experiment for a short time on a small torus
+ * using the given number of workers, writing the results into the given
+ * directory.
+ */
+static void
+run_parallel(const char *results_dir, int num_workers)
+{
+	// The overrides are modified when parsed so mustn't be string literals
+	char width[]    = "model.network.torus_width=4";
+	char height[]   = "model.network.torus_height=4";
+	char warmup[]   = "experiment.warmup_duration.cold=100";
+	char duration[] = "experiment.sample_duration=100";
+	char results_directory[sizeof(par_dirs[0]) + 64];
+	sprintf(results_directory, "measurements.results_directory=%s/", results_dir);
+	
+	char *overrides[] = {width, height, warmup, duration, results_directory};
+	
+	spinn_sim_t sim;
+	spinn_sim_init(&sim, TICKYSIM_CONFIG_FILE, sizeof(overrides)/sizeof(char *), overrides);
+	sim.show_progress = false;
+	spinn_sim_parallel_run(&sim, num_workers);
+	spinn_sim_destroy(&sim);
+}
+
+
+/**
+ * Read the whole of a result file into memory. The data must be freed by the
+ * caller.
+ */
+static char *
+read_results(const char *results_dir, const char *basename)
+{
+	char filename[sizeof(par_dirs[0]) + 64];
+	sprintf(filename, "%s/%s", results_dir, basename);
+	
+	FILE *f = fopen(filename, "r");
+	ck_assert(f != NULL);
+	fseek(f, 0, SEEK_END);
+	size_t length = ftell(f);
+	rewind(f);
+	
+	char *data = malloc(length + 1);
+	ck_assert(data != NULL);
+	ck_assert_int_eq(fread(data, 1, length, f), length);
+	data[length] = '\0';
+	fclose(f);
+	return data;
+}
+
+
+/******************************************************************************
+ * Testcases
+ ******************************************************************************/
+
+/**
+ * Make sure the results of a parallel run are written in group order and don't
+ * depend on the number of workers (and so the order jobs completed in).
+ */
+START_TEST (test_order)
+{
+	run_parallel(par_dirs[0], 1);
+	run_parallel(par_dirs[1], 3);
+	
+	char *results[NUM_RUNS];
+	for (int i = 0; i < NUM_RUNS; i++)
+		results[i] = read_results(par_dirs[i], "global_counters.dat");
+	ck_assert(strcmp(results[0], results[1]) == 0);
+	
+	// After the header, one row per group in order
+	int num_rows = 0;
+	char *row = strchr(results[0], '\n');
+	ck_assert(row != NULL);
+	for (row++; *row != '\0'; row = strchr(row, '\n') + 1) {
+		int group, sample;
+		ck_assert_int_eq(sscanf(row, "%d\t%d", &group, &sample), 2);
+		ck_assert_int_eq(group, ++num_rows);
+		ck_assert_int_eq(sample, 1);
+	}
+	ck_assert(num_rows > 1);
+	
+	for (int i = 0; i < NUM_RUNS; i++)
+		free(results[i]);
+}
+END_TEST
+
+
+Suite *
+make_spinn_sim_parallel_suite(void)
+{
+	Suite *s = suite_create("spinn_sim_parallel");
+	
+	// Add tests to the test case
+	TCase *tc_core = tcase_create("Core");
+	tcase_add_checked_fixture(tc_core, check_spinn_sim_parallel_setup, check_spinn_sim_parallel_teardown);
+	tcase_add_test(tc_core, test_order);
+	
+	// Add each test case to the suite
+	suite_add_tcase(s, tc_core);
+	
+	return s;
+}
@@ -0,0 +1,303 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * check_spinn_snn.c -- Unit tests for spiking neural network workloads.
+ */
+
+#include <check.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+
+#include "config.h"
+
+#include "check_check.h"
+
+#include "../src/spinn.h"
+#include "../src/spinn_snn.h"
+
+/******************************************************************************
+ * Testbench
+ ******************************************************************************/
+
+#define SYSTEM_SIZE_X 4
+#define SYSTEM_SIZE_Y 3
+#define SYSTEM_SIZE ((spinn_coord_t){SYSTEM_SIZE_X,SYSTEM_SIZE_Y})
+
+#define TICKS_PER_SECOND 1000.0
+
+// Number of samples drawn when checking distributions
+#define NUM_SAMPLES 100000
+
+char placement_filename[] = "/tmp/check_spinn_snn_placement_XXXXXX";
+char projection_filename[] = "/tmp/check_spinn_snn_projection_XXXXXX";
+
+spinn_snn_t snn;
+
+void
+check_spinn_snn_setup(void)
+{
+	// Reserve unique filenames for the workload files
+	strcpy(placement_filename, "/tmp/check_spinn_snn_placement_XXXXXX");
+	int fd = mkstemp(placement_filename);
+	ck_assert(fd >= 0);
+	close(fd);
+	
+	strcpy(projection_filename, "/tmp/check_spinn_snn_projection_XXXXXX");
+	fd = mkstemp(projection_filename);
+	ck_assert(fd >= 0);
+	close(fd);
+}
+
+
+void
+check_spinn_snn_teardown(void)
+{
+	remove(placement_filename);
+	remove(projection_filename);
+}
+
+
+/**
+ * Write a string to a file.
+ */
+static void
+write_file(const char *filename, const char *contents)
+{
+	FILE *f = fopen(filename, "w");
+	ck_assert(f != NULL);
+	fputs(contents, f);
+	fclose(f);
+}
+
+
+/**
+ * A small network. Chip (1,0) holds two populations which both project to
+ * populations on (2,1) and (3,2). The projections to (2,1) should be merged.
+ */
+static const char *placement =
+	"# Population placement\n"
+	"input 0 0\n"
+	"\n"
+	"exc 1 0\n"
+	"inh 1 0\n"
+	"   out_a 2 1\n"
+	"out_b 3 2\n";
+
+static const char *projections =
+	"# Projections\n"
+	"input exc 100.0\n"
+	"exc out_a 200.0\n"
+	"inh out_a 100.0\n"
+	"inh out_b 100.0\n"
+	"\n"
+	"out_a out_b 0.0\n";
+
+/******************************************************************************
+ * Tests
+ ******************************************************************************/
+
+/**
+ * Make sure the rates of each chip are the sums of their projections.
+ */
+START_TEST (test_rates)
+{
+	write_file(placement_filename, placement);
+	write_file(projection_filename, projections);
+	ck_assert(spinn_snn_load( &snn
+	                        , placement_filename, projection_filename
+	                        , SYSTEM_SIZE, TICKS_PER_SECOND
+	                        ));
+	
+	for (int y = 0; y < SYSTEM_SIZE_Y; y++) {
+		for (int x = 0; x < SYSTEM_SIZE_X; x++) {
+			const spinn_snn_chip_t *chip = spinn_snn_get_chip(&snn, (spinn_coord_t){x,y});
+			double expected = 0.0;
+			if (x == 0 && y == 0)
+				expected = 100.0 / TICKS_PER_SECOND;
+			else if (x == 1 && y == 0)
+				expected = 400.0 / TICKS_PER_SECOND;
+			
+			ck_assert(fabs(spinn_snn_chip_get_rate(chip) - expected) < 1e-9);
+			
+			// Chips which never spike should never have a next spike
+			if (expected == 0.0)
+				ck_assert(isinf(spinn_snn_chip_next_interval(chip, NULL)));
+		}
+	}
+	
+	spinn_snn_destroy(&snn);
+}
+END_TEST
+
+
+/**
+ * Make sure spike intervals are exponentially distributed with the right mean
+ * and destinations are picked in proportion to the rates of the projections.
+ */
+START_TEST (test_sampling)
+{
+	write_file(placement_filename, placement);
+	write_file(projection_filename, projections);
+	ck_assert(spinn_snn_load( &snn
+	                        , placement_filename, projection_filename
+	                        , SYSTEM_SIZE, TICKS_PER_SECOND
+	                        ));
+	
+	const spinn_snn_chip_t *chip = spinn_snn_get_chip(&snn, (spinn_coord_t){1,0});
+	
+	double total_interval = 0.0;
+	int num_short = 0;
+	int num_to_a = 0;
+	int num_to_b = 0;
+	for (int i = 0; i < NUM_SAMPLES; i++) {
+		double interval = spinn_snn_chip_next_interval(chip, NULL);
+		ck_assert(interval >= 0.0);
+		total_interval += interval;
+		
+		// Count intervals shorter than the mean
+		if (interval < TICKS_PER_SECOND / 400.0)
+			num_short++;
+		
+		spinn_coord_t destination = spinn_snn_chip_pick_destination(chip, NULL);
+		if (destination.x == 2 && destination.y == 1) {
+			num_to_a++;
+		} else {
+			ck_assert_int_eq(destination.x, 3);
+			ck_assert_int_eq(destination.y, 2);
+			num_to_b++;
+		}
+	}
+	
+	// Mean interval within 5% of 1/rate
+	double mean_interval = total_interval / NUM_SAMPLES;
+	ck_assert(mean_interval > (TICKS_PER_SECOND / 400.0) * 0.95);
+	ck_assert(mean_interval < (TICKS_PER_SECOND / 400.0) * 1.05);
+	
+	// For an exponential distribution, 1-1/e of the intervals are below the mean
+	ck_assert(fabs((((double)num_short) / NUM_SAMPLES) - (1.0 - exp(-1.0))) < 0.02);
+	
+	// Three quarters of the spikes go to out_a
+	ck_assert(fabs((((double)num_to_a) / NUM_SAMPLES) - 0.75) < 0.02);
+	ck_assert_int_eq(num_to_a + num_to_b, NUM_SAMPLES);
+	
+	spinn_snn_destroy(&snn);
+}
+END_TEST
+
+
+/**
+ * Make sure a chip with many targets of widely varying rates picks each in the
+ * right proportion.
+ */
+START_TEST (test_many_targets)
+{
+	// Each chip holds one population and chip 0 projects to every chip with a
+	// rate proportional to the chip's index.
+	FILE *f = fopen(placement_filename, "w");
+	ck_assert(f != NULL);
+	for (int i = 0; i < SYSTEM_SIZE_X * SYSTEM_SIZE_Y; i++)
+		fprintf(f, "p%d %d %d\n", i, i % SYSTEM_SIZE_X, i / SYSTEM_SIZE_X);
+	fclose(f);
+	
+	f = fopen(projection_filename, "w");
+	ck_assert(f != NULL);
+	double total_rate = 0.0;
+	for (int i = 0; i < SYSTEM_SIZE_X * SYSTEM_SIZE_Y; i++) {
+		fprintf(f, "p0 p%d %d\n", i, i);
+		total_rate += i;
+	}
+	fclose(f);
+	
+	ck_assert(spinn_snn_load( &snn
+	                        , placement_filename, projection_filename
+	                        , SYSTEM_SIZE, TICKS_PER_SECOND
+	                        ));
+	
+	const spinn_snn_chip_t *chip = spinn_snn_get_chip(&snn, (spinn_coord_t){0,0});
+	ck_assert(fabs(spinn_snn_chip_get_rate(chip) - (total_rate / TICKS_PER_SECOND)) < 1e-9);
+	
+	int num_arrived[SYSTEM_SIZE_X * SYSTEM_SIZE_Y];
+	for (int i = 0; i < SYSTEM_SIZE_X * SYSTEM_SIZE_Y; i++)
+		num_arrived[i] = 0;
+	
+	for (int i = 0; i < NUM_SAMPLES; i++) {
+		spinn_coord_t destination = spinn_snn_chip_pick_destination(chip, NULL);
+		num_arrived[(destination.y * SYSTEM_SIZE_X) + destination.x]++;
+	}
+	
+	for (int i = 0; i < SYSTEM_SIZE_X * SYSTEM_SIZE_Y; i++) {
+		double expected = ((double)i) / total_rate;
+		ck_assert(fabs((((double)num_arrived[i]) / NUM_SAMPLES) - expected) < 0.01);
+	}
+	
+	spinn_snn_destroy(&snn);
+}
+END_TEST
+
+
+/**
+ * Make sure invalid workloads are rejected.
+ */
+static const char *bad_placements[] = {
+	// Malformed line
+	"a 0 0\nb 1\n",
+	// Outside the system
+	"a 0 0\nb 4 0\n",
+	"a 0 0\nb 0 -1\n",
+	// Duplicate placement
+	"a 0 0\nb 1 1\na 2 2\n",
+	// Valid placement, bad projections
+	"a 0 0\nb 1 1\n",
+	"a 0 0\nb 1 1\n",
+	"a 0 0\nb 1 1\n",
+};
+
+static const char *bad_projections[] = {
+	"a b 1.0\n",
+	"a b 1.0\n",
+	"a b 1.0\n",
+	"a b 1.0\n",
+	// Unplaced population
+	"a b 1.0\nb c 1.0\n",
+	// Negative rate
+	"a b -1.0\n",
+	// Malformed line
+	"a b\n",
+};
+
+START_TEST (test_bad_workloads)
+{
+	write_file(placement_filename, bad_placements[_i]);
+	write_file(projection_filename, bad_projections[_i]);
+	ck_assert(!spinn_snn_load( &snn
+	                         , placement_filename, projection_filename
+	                         , SYSTEM_SIZE, TICKS_PER_SECOND
+	                         ));
+}
+END_TEST
+
+
+Suite *
+make_spinn_snn_suite(void)
+{
+	Suite *s = suite_create("spinn_snn");
+	
+	// Add tests to the test case
+	TCase *tc_core = tcase_create("Core");
+	tcase_add_checked_fixture(tc_core, check_spinn_snn_setup, check_spinn_snn_teardown);
+	tcase_add_test(tc_core, test_rates);
+	tcase_add_test(tc_core, test_sampling);
+	tcase_add_test(tc_core, test_many_targets);
+	tcase_add_loop_test( tc_core, test_bad_workloads
+	                   , 0, sizeof(bad_placements)/sizeof(bad_placements[0])
+	                   );
+	
+	// Add each test case to the suite
+	suite_add_tcase(s, tc_core);
+	
+	return s;
+}
@@ -0,0 +1,252 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * check_spinn_trace.c -- Unit tests for packet injection trace files.
+ */
+
+#include <check.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "config.h"
+
+#include "check_check.h"
+
+#include "../src/spinn.h"
+#include "../src/spinn_trace.h"
+
+/******************************************************************************
+ * Testbench
+ ******************************************************************************/
+
+#define SYSTEM_SIZE_X 4
+#define SYSTEM_SIZE_Y 3
+#define SYSTEM_SIZE ((spinn_coord_t){SYSTEM_SIZE_X,SYSTEM_SIZE_Y})
+
+// Number of ticks to record in the round-trip test
+#define NUM_TICKS 100
+
+char trace_filename[] = "/tmp/check_spinn_trace_XXXXXX";
+
+spinn_trace_writer_t w;
+spinn_trace_t t;
+
+void
+check_spinn_trace_setup(void)
+{
+	// Reserve a unique filename for the trace
+	strcpy(trace_filename, "/tmp/check_spinn_trace_XXXXXX");
+	int fd = mkstemp(trace_filename);
+	ck_assert(fd >= 0);
+	close(fd);
+}
+
+
+void
+check_spinn_trace_teardown(void)
+{
+	remove(trace_filename);
+}
+
+
+/**
+ * A deterministic destination for the nth packet sent by a node.
+ */
+static spinn_coord_t
+destination_for(spinn_coord_t source, int n)
+{
+	return (spinn_coord_t){ (source.x + n) % SYSTEM_SIZE_X
+	                      , (source.y + (n/SYSTEM_SIZE_X)) % SYSTEM_SIZE_Y
+	                      };
+}
+
+
+/**
+ * The number of packets a given node sends during a given tick. Nodes send at
+ * differing rates (some never) and may send several packets in a single tick.
+ */
+static int
+num_sent(spinn_coord_t source, int tick, int rate)
+{
+	int node = (source.y * SYSTEM_SIZE_X) + source.x;
+	if (node % 5 == 4)
+		return 0;
+	return ((tick + node) % (rate + node + 1) == 0) ? (1 + (node % 2)) : 0;
+}
+
+/******************************************************************************
+ * Tests
+ ******************************************************************************/
+
+/**
+ * Make sure a trace without any records can be written and read back.
+ */
+START_TEST (test_empty)
+{
+	ck_assert(spinn_trace_writer_open(&w, trace_filename, SYSTEM_SIZE));
+	ck_assert(spinn_trace_writer_close(&w));
+	
+	ck_assert(spinn_trace_open(&t, trace_filename));
+	ck_assert_int_eq(spinn_trace_get_system_size(&t).x, SYSTEM_SIZE_X);
+	ck_assert_int_eq(spinn_trace_get_system_size(&t).y, SYSTEM_SIZE_Y);
+	ck_assert_int_eq(spinn_trace_get_num_records(&t), 0);
+	
+	for (int y = 0; y < SYSTEM_SIZE_Y; y++) {
+		for (int x = 0; x < SYSTEM_SIZE_X; x++) {
+			size_t num_records;
+			spinn_trace_get_records(&t, (spinn_coord_t){x,y}, &num_records);
+			ck_assert_int_eq(num_records, 0);
+		}
+	}
+	
+	spinn_trace_close(&t);
+}
+END_TEST
+
+
+/**
+ * Record interleaved packets from all nodes and make sure each node's slice
+ * contains exactly its own packets in time order.
+ */
+START_TEST (test_round_trip)
+{
+	int rate = _i;
+	
+	// Record the trace
+	ck_assert(spinn_trace_writer_open(&w, trace_filename, SYSTEM_SIZE));
+	size_t total_records = 0;
+	for (int tick = 0; tick < NUM_TICKS; tick++) {
+		for (int y = 0; y < SYSTEM_SIZE_Y; y++) {
+			for (int x = 0; x < SYSTEM_SIZE_X; x++) {
+				spinn_coord_t source = {x,y};
+				for (int n = 0; n < num_sent(source, tick, rate); n++) {
+					spinn_trace_writer_append( &w, tick, source
+					                         , destination_for(source, tick + n)
+					                         );
+					total_records++;
+				}
+			}
+		}
+	}
+	ck_assert(spinn_trace_writer_close(&w));
+	
+	// Read it back
+	ck_assert(spinn_trace_open(&t, trace_filename));
+	ck_assert_int_eq(spinn_trace_get_num_records(&t), total_records);
+	
+	for (int y = 0; y < SYSTEM_SIZE_Y; y++) {
+		for (int x = 0; x < SYSTEM_SIZE_X; x++) {
+			spinn_coord_t source = {x,y};
+			
+			size_t num_records;
+			const spinn_trace_record_t *records = spinn_trace_get_records(&t, source, &num_records);
+			
+			// Walk through the expected packets for this node
+			size_t i = 0;
+			for (int tick = 0; tick < NUM_TICKS; tick++) {
+				for (int n = 0; n < num_sent(source, tick, rate); n++) {
+					spinn_coord_t destination = destination_for(source, tick + n);
+					ck_assert(i < num_records);
+					ck_assert_int_eq(records[i].tick, tick);
+					ck_assert_int_eq(records[i].source_x, x);
+					ck_assert_int_eq(records[i].source_y, y);
+					ck_assert_int_eq(records[i].destination_x, destination.x);
+					ck_assert_int_eq(records[i].destination_y, destination.y);
+					i++;
+				}
+			}
+			ck_assert_int_eq(i, num_records);
+		}
+	}
+	
+	spinn_trace_close(&t);
+	
+	// The spool file should have been removed
+	char spool_filename[sizeof(trace_filename) + 16];
+	sprintf(spool_filename, "%s.spool", trace_filename);
+	ck_assert(access(spool_filename, F_OK) != 0);
+}
+END_TEST
+
+
+/**
+ * Make sure files which aren't traces are rejected.
+ */
+START_TEST (test_not_a_trace)
+{
+	FILE *f = fopen(trace_filename, "w");
+	ck_assert(f != NULL);
+	for (int i = 0; i < 100; i++)
+		fprintf(f, "Not a trace file.\n");
+	fclose(f);
+	
+	ck_assert(!spinn_trace_open(&t, trace_filename));
+}
+END_TEST
+
+
+/**
+ * Make sure truncated traces are rejected.
+ */
+START_TEST (test_truncated)
+{
+	ck_assert(spinn_trace_writer_open(&w, trace_filename, SYSTEM_SIZE));
+	for (int i = 0; i < 10; i++)
+		spinn_trace_writer_append(&w, i, (spinn_coord_t){1,1}, (spinn_coord_t){0,0});
+	ck_assert(spinn_trace_writer_close(&w));
+	
+	// Chop off the last record
+	FILE *f = fopen(trace_filename, "r+");
+	ck_assert(f != NULL);
+	fseek(f, 0, SEEK_END);
+	long size = ftell(f);
+	fclose(f);
+	ck_assert(truncate(trace_filename, size - 1) == 0);
+	
+	ck_assert(!spinn_trace_open(&t, trace_filename));
+}
+END_TEST
+
+
+/**
+ * Make sure a failure to spool a record is reported when the trace is closed
+ * rather than producing a trace with records missing.
+ */
+START_TEST (test_spool_write_error)
+{
+	ck_assert(spinn_trace_writer_open(&w, trace_filename, SYSTEM_SIZE));
+	spinn_trace_writer_append(&w, 0, (spinn_coord_t){1,1}, (spinn_coord_t){0,0});
+	
+	// Make further writes to the spool fail
+	w.spool = freopen(w.spool_filename, "rb", w.spool);
+	ck_assert(w.spool != NULL);
+	spinn_trace_writer_append(&w, 1, (spinn_coord_t){1,1}, (spinn_coord_t){0,0});
+	
+	ck_assert(!spinn_trace_writer_close(&w));
+	ck_assert(!spinn_trace_open(&t, trace_filename));
+}
+END_TEST
+
+
+Suite *
+make_spinn_trace_suite(void)
+{
+	Suite *s = suite_create("spinn_trace");
+	
+	// Add tests to the test case
+	TCase *tc_core = tcase_create("Core");
+	tcase_add_checked_fixture(tc_core, check_spinn_trace_setup, check_spinn_trace_teardown);
+	tcase_add_test(tc_core, test_empty);
+	tcase_add_loop_test(tc_core, test_round_trip, 0, 4);
+	tcase_add_test(tc_core, test_not_a_trace);
+	tcase_add_test(tc_core, test_truncated);
+	tcase_add_test(tc_core, test_spool_write_error);
+	
+	// Add each test case to the suite
+	suite_add_tcase(s, tc_core);
+	
+	return s;
+}
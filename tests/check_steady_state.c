@@ -0,0 +1,144 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * check_steady_state.c -- Unit tests for the MSER steady-state detector.
+ */
+
+#include <check.h>
+
+#include "config.h"
+
+#include "check_check.h"
+
+#include "../src/steady_state.h"
+
+// Batch size used (i.e. MSER-5)
+#define BATCH_SIZE 5
+
+// Length of the transient in the generated series
+#define TRANSIENT_LENGTH 100
+
+// Length of the steady part of the generated series
+#define STEADY_LENGTH 400
+
+steady_state_t ss;
+
+
+void
+check_steady_state_setup(void)
+{
+	steady_state_init(&ss, 2, BATCH_SIZE);
+}
+
+
+void
+check_steady_state_teardown(void)
+{
+	steady_state_destroy(&ss);
+}
+
+
+/**
+ * A deterministic, zero-mean "noise" signal.
+ */
+static double
+noise(int i)
+{
+	return (double)(((i * 7919) % 17) - 8) / 8.0;
+}
+
+
+/**
+ * Test that steady state is never claimed with too few observations.
+ */
+START_TEST (test_too_short)
+{
+	size_t truncation;
+	ck_assert(!steady_state_reached(&ss, &truncation));
+	
+	double values[2] = {1.0, 1.0};
+	for (int i = 0; i < (BATCH_SIZE * 4) - 1; i++) {
+		steady_state_add(&ss, values);
+		ck_assert(!steady_state_reached(&ss, NULL));
+	}
+	ck_assert_int_eq(steady_state_get_num_observations(&ss), (BATCH_SIZE * 4) - 1);
+}
+END_TEST
+
+
+/**
+ * Test that constant series are immediately steady.
+ */
+START_TEST (test_constant)
+{
+	double values[2] = {3.0, 0.0};
+	for (int i = 0; i < BATCH_SIZE * 4; i++)
+		steady_state_add(&ss, values);
+	
+	size_t truncation = 123;
+	ck_assert(steady_state_reached(&ss, &truncation));
+	ck_assert_int_eq(truncation, 0);
+}
+END_TEST
+
+
+/**
+ * Test that the end of a transient followed by a noisy steady state is found.
+ */
+START_TEST (test_transient)
+{
+	for (int i = 0; i < TRANSIENT_LENGTH + STEADY_LENGTH; i++) {
+		double level = (i < TRANSIENT_LENGTH) ? (double)i : (double)TRANSIENT_LENGTH;
+		double values[2] = {level + noise(i), 10.0 + noise(i + 3)};
+		steady_state_add(&ss, values);
+	}
+	
+	size_t truncation;
+	ck_assert(steady_state_reached(&ss, &truncation));
+	ck_assert(truncation >= TRANSIENT_LENGTH - (2 * BATCH_SIZE));
+	ck_assert(truncation <= TRANSIENT_LENGTH + (2 * BATCH_SIZE));
+}
+END_TEST
+
+
+/**
+ * Test that a series which is still changing in one series is not steady.
+ */
+START_TEST (test_ramp)
+{
+	for (int i = 0; i < TRANSIENT_LENGTH + STEADY_LENGTH; i++) {
+		double values[2] = {10.0 + noise(i), (double)i + noise(i + 3)};
+		steady_state_add(&ss, values);
+	}
+	ck_assert(!steady_state_reached(&ss, NULL));
+	
+	// Once reset, a steady series is detected again
+	steady_state_reset(&ss);
+	ck_assert_int_eq(steady_state_get_num_observations(&ss), 0);
+	for (int i = 0; i < STEADY_LENGTH; i++) {
+		double values[2] = {10.0 + noise(i), 5.0 + noise(i + 3)};
+		steady_state_add(&ss, values);
+	}
+	ck_assert(steady_state_reached(&ss, NULL));
+}
+END_TEST
+
+
+Suite *
+make_steady_state_suite(void)
+{
+	Suite *s = suite_create("steady_state");
+	
+	// Add tests to the test case
+	TCase *tc_core = tcase_create("Core");
+	tcase_add_checked_fixture(tc_core, check_steady_state_setup, check_steady_state_teardown);
+	tcase_add_test(tc_core, test_too_short);
+	tcase_add_test(tc_core, test_constant);
+	tcase_add_test(tc_core, test_transient);
+	tcase_add_test(tc_core, test_ramp);
+	
+	// Add each test case to the suite
+	suite_add_tcase(s, tc_core);
+	
+	return s;
+}
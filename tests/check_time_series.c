@@ -0,0 +1,205 @@
+/**
+ * TickySim -- A timing based interconnection network simulator.
+ *
+ * check_time_series.c -- Unit tests for compact binary time series.
+ */
+
+#include <check.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "config.h"
+
+#include "check_check.h"
+
+#include "../src/time_series.h"
+
+/******************************************************************************
+ * Testbench
+ ******************************************************************************/
+
+#define NUM_LABELS  1
+#define NUM_COLUMNS 2
+
+static const char *ts_label_names[NUM_LABELS]   = { "group" };
+static const char *ts_column_names[NUM_COLUMNS] = { "a", "b" };
+
+static time_series_t ts;
+static FILE *ts_file;
+
+// The contents of the file after the test has written it and the position of
+// the next byte to be decoded.
+static uint8_t *ts_data;
+static size_t   ts_data_length;
+static size_t   ts_pos;
+
+void
+check_time_series_setup(void)
+{
+	time_series_init(&ts, NUM_LABELS, ts_label_names, NUM_COLUMNS, ts_column_names);
+	ts_file = tmpfile();
+	ck_assert(ts_file != NULL);
+	ts_data = NULL;
+	ts_pos  = 0;
+}
+
+
+void
+check_time_series_teardown(void)
+{
+	time_series_destroy(&ts);
+	fclose(ts_file);
+	free(ts_data);
+}
+
+
+/**
+ * Read back everything written to the file.
+ */
+static void
+read_back(void)
+{
+	fflush(ts_file);
+	ts_data_length = ftell(ts_file);
+	rewind(ts_file);
+	ts_data = malloc(ts_data_length + 1);
+	ck_assert(ts_data != NULL);
+	ck_assert_int_eq(fread(ts_data, 1, ts_data_length, ts_file), ts_data_length);
+}
+
+
+/**
+ * Decode the next varint.
+ */
+static uint64_t
+next_varint(void)
+{
+	uint64_t value = 0;
+	for (int shift = 0; ; shift += 7) {
+		ck_assert(ts_pos < ts_data_length);
+		uint8_t byte = ts_data[ts_pos++];
+		value |= (uint64_t)(byte & 0x7F) << shift;
+		if (!(byte & 0x80))
+			return value;
+	}
+}
+
+
+/**
+ * Decode the next zig-zag encoded varint.
+ */
+static int64_t
+next_signed(void)
+{
+	uint64_t value = next_varint();
+	return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+
+/**
+ * Check the next NUL-terminated string is as given.
+ */
+static void
+check_string(const char *expected)
+{
+	ck_assert(ts_pos + strlen(expected) < ts_data_length);
+	ck_assert(strcmp((const char *)ts_data + ts_pos, expected) == 0);
+	ts_pos += strlen(expected) + 1;
+}
+
+
+/******************************************************************************
+ * Testcases
+ ******************************************************************************/
+
+START_TEST (test_header)
+{
+	time_series_write_header(&ts, ts_file);
+	read_back();
+	
+	ck_assert(memcmp(ts_data, TIME_SERIES_MAGIC, 8) == 0);
+	ts_pos = 8;
+	ck_assert_int_eq(next_varint(), TIME_SERIES_VERSION);
+	ck_assert_int_eq(next_varint(), NUM_LABELS);
+	ck_assert_int_eq(next_varint(), NUM_COLUMNS);
+	check_string("group");
+	check_string("a");
+	check_string("b");
+	ck_assert_int_eq(ts_pos, ts_data_length);
+}
+END_TEST
+
+
+START_TEST (test_rows)
+{
+	const char *labels[NUM_LABELS] = { "1" };
+	int64_t rows[][NUM_COLUMNS] = { {10, 0}, {12, -1}, {1000000, 5000000000LL} };
+	uint64_t times[] = { 100, 200, 350 };
+	
+	// Two sets of labels with the same rows, the second restarting the deltas
+	for (int j = 0; j < 2; j++) {
+		time_series_set_labels(&ts, ts_file, labels);
+		for (int i = 0; i < 3; i++)
+			time_series_append(&ts, ts_file, times[i], rows[i]);
+	}
+	read_back();
+	
+	for (int j = 0; j < 2; j++) {
+		ck_assert_int_eq(ts_data[ts_pos++], TIME_SERIES_TAG_LABELS);
+		check_string("1");
+		
+		uint64_t time = 0;
+		int64_t  row[NUM_COLUMNS] = {0, 0};
+		for (int i = 0; i < 3; i++) {
+			ck_assert_int_eq(ts_data[ts_pos++], TIME_SERIES_TAG_ROW);
+			time += next_varint();
+			ck_assert(time == times[i]);
+			for (int k = 0; k < NUM_COLUMNS; k++) {
+				row[k] += next_signed();
+				ck_assert(row[k] == rows[i][k]);
+			}
+		}
+	}
+	ck_assert_int_eq(ts_pos, ts_data_length);
+}
+END_TEST
+
+
+/**
+ * Small changes take a single byte per column.
+ */
+START_TEST (test_compact)
+{
+	const char *labels[NUM_LABELS] = { "1" };
+	time_series_set_labels(&ts, ts_file, labels);
+	for (int i = 0; i < 100; i++) {
+		int64_t row[NUM_COLUMNS] = { 50 * i, -10 * i };
+		time_series_append(&ts, ts_file, 100 * i, row);
+	}
+	read_back();
+	
+	ck_assert_int_eq(ts_data_length, 3 + (100 * (1 + 1 + NUM_COLUMNS)));
+}
+END_TEST
+
+
+Suite *
+make_time_series_suite(void)
+{
+	Suite *s = suite_create("time_series");
+	
+	// Add tests to the test case
+	TCase *tc_core = tcase_create("Core");
+	tcase_add_checked_fixture(tc_core, check_time_series_setup, check_time_series_teardown);
+	tcase_add_test(tc_core, test_header);
+	tcase_add_test(tc_core, test_rows);
+	tcase_add_test(tc_core, test_compact);
+	
+	// Add each test case to the suite
+	suite_add_tcase(s, tc_core);
+	
+	return s;
+}
@@ -0,0 +1,99 @@
+#!/usr/bin/env python
+
+r"""
+Convert a binary columnar results file (e.g. packet_details.col, produced when
+measurements.output_format is "columnar") into the equivalent tab-separated
+file (e.g. packet_details.dat).
+
+Usage::
+
+	python columnar_to_tsv.py path/to/packet_details.col > packet_details.dat
+
+The file starts with a header giving the names of the labels (the group, sample
+and independent variables) and the integer columns. This is followed by a
+sequence of records: a labels record gives the value of every label for the
+rows of the blocks which follow it and a block record gives up to block_rows
+rows stored column-by-column as 32-bit little-endian integers. See
+src/columnar.h for details.
+
+The read_columnar function may also be used directly by analysis scripts. Since
+each column of a block is a contiguous, aligned array, numpy users may prefer
+to memory-map the file and use numpy.frombuffer(data, "<i4", num_rows, offset)
+on each column instead.
+"""
+
+import struct
+import sys
+
+HEADER = struct.Struct("<8sIIIIII")
+RECORD = struct.Struct("<4sIII")
+
+MAGIC = b"TICKYCOL"
+VERSION = 1
+
+
+def split_strings(data, num_strings):
+	"""
+	Split the first num_strings NUL-terminated strings out of data.
+	"""
+	return [s.decode("utf-8") for s in data.split(b"\0")[:num_strings]]
+
+
+def read_columnar(f):
+	"""
+	Read a columnar file from the file-like object f. Returns (label_names,
+	column_names, blocks) where blocks is a generator of (label_values, columns)
+	tuples with one list of values in columns for each column.
+	"""
+	header = f.read(HEADER.size)
+	if len(header) != HEADER.size:
+		raise ValueError("File too short for header")
+	magic, version, num_labels, num_columns, block_rows, names_length, _ = \
+		HEADER.unpack(header)
+	if magic != MAGIC or version != VERSION:
+		raise ValueError("Not a version %d columnar file"%VERSION)
+
+	names = split_strings(f.read(names_length), num_labels + num_columns)
+	label_names  = names[:num_labels]
+	column_names = names[num_labels:]
+
+	def blocks():
+		label_values = None
+		while True:
+			record = f.read(RECORD.size)
+			if len(record) == 0:
+				return
+			if len(record) != RECORD.size:
+				raise ValueError("Truncated record")
+			tag, length, num_rows, _ = RECORD.unpack(record)
+			data = f.read(length)
+			if len(data) != length:
+				raise ValueError("Truncated record")
+
+			if tag == b"LBLS":
+				label_values = split_strings(data, num_labels)
+			elif tag == b"BLCK":
+				values = struct.unpack_from("<%di"%(num_rows * num_columns), data)
+				columns = [values[i*num_rows:(i+1)*num_rows]
+				           for i in range(num_columns)]
+				yield (label_values, columns)
+			else:
+				raise ValueError("Unknown record %r"%tag)
+
+	return (label_names, column_names, blocks())
+
+
+if __name__=="__main__":
+	if len(sys.argv) != 2:
+		sys.stderr.write(__doc__)
+		sys.exit(1)
+
+	with open(sys.argv[1], "rb") as f:
+		label_names, column_names, blocks = read_columnar(f)
+
+		out = sys.stdout
+		out.write("\t".join(label_names + column_names) + "\n")
+		for label_values, columns in blocks:
+			prefix = "\t".join(label_values)
+			for row in zip(*columns):
+				out.write(prefix + "\t" + "\t".join(map(str, row)) + "\n")
@@ -0,0 +1,97 @@
+#!/usr/bin/env python
+
+r"""
+Convert a binary flow matrix file (flow_matrix_g*_s*.bin, produced for each
+sample when measurements.flow_matrix.enabled is set) into a tab-separated file
+with one row per source and destination pair which saw any traffic giving the
+number of packets delivered and dropped and the mean and maximum latency (in
+ticks) of the packets delivered.
+
+Usage::
+
+	python flow_matrix_to_tsv.py path/to/flow_matrix_g1_s1.bin > flow_matrix.dat
+
+The file starts with a header giving a magic string, the version, a byte-order
+marker, the width and height of the system and the number of sources (all
+32-bit unsigned integers in the byte order of the machine which wrote the file).
+This is followed by the source number of every node (in row-major order) and
+then four matrices, each with a row per source and a column per destination
+node (in row-major order): the number of packets delivered (32-bit), the number
+dropped (32-bit), the sum of the latencies delivered (64-bit) and the maximum
+latency delivered (32-bit). See src/spinn_flow_matrix.h for details.
+
+The read_flow_matrix function may also be used directly by analysis scripts.
+"""
+
+import sys
+import struct
+
+MAGIC = b"TICKYFLM"
+VERSION = 1
+BYTE_ORDER = 0x01020304
+
+
+def read_flow_matrix(f):
+	"""
+	Read a flow matrix file from the file-like object f. Returns (width, height,
+	source_of, delivered, dropped, latency_sum, latency_max) where source_of gives
+	the source number of each node (indexed by (x, y)) and the remaining values
+	are lists (indexed by source) of lists (indexed by y*width + x of the
+	destination).
+	"""
+	data = f.read()
+	if data[:len(MAGIC)] != MAGIC:
+		raise ValueError("Not a flow matrix file")
+
+	# Determine the byte order of the writer
+	for order in "<>":
+		if struct.unpack_from(order + "I", data, len(MAGIC) + 4)[0] == BYTE_ORDER:
+			break
+	else:
+		raise ValueError("Unknown byte order")
+
+	version, _, width, height, num_sources = struct.unpack_from(order + "5I", data, len(MAGIC))
+	if version != VERSION:
+		raise ValueError("Not a version %d flow matrix file"%VERSION)
+	pos = len(MAGIC) + struct.calcsize("5I")
+
+	num_nodes = width * height
+	def read(fmt, count):
+		values = list(struct.unpack_from("%s%d%s"%(order, count, fmt), data, pos))
+		return (values, pos + struct.calcsize("%d%s"%(count, fmt)))
+
+	source_list, pos = read("I", num_nodes)
+	source_of = dict(((i % width, i // width), s) for i, s in enumerate(source_list))
+
+	matrices = []
+	for fmt in "IIQI":
+		values, pos = read(fmt, num_sources * num_nodes)
+		matrices.append([values[s*num_nodes:(s+1)*num_nodes] for s in range(num_sources)])
+
+	return tuple([width, height, source_of] + matrices)
+
+
+if __name__=="__main__":
+	if len(sys.argv) != 2:
+		sys.stderr.write(__doc__)
+		sys.exit(1)
+
+	with open(sys.argv[1], "rb") as f:
+		width, height, source_of, delivered, dropped, latency_sum, latency_max \
+			= read_flow_matrix(f)
+
+	out = sys.stdout
+	out.write("source\tdest_x\tdest_y\tdelivered\tdropped\tmean_latency\tmax_latency\n")
+	for source in range(len(delivered)):
+		for node in range(width * height):
+			if delivered[source][node] == 0 and dropped[source][node] == 0:
+				continue
+			mean = (float(latency_sum[source][node]) / delivered[source][node]
+			        if delivered[source][node] else 0.0)
+			out.write("%d\t%d\t%d\t%d\t%d\t%f\t%d\n"%( source
+			                                          , node % width, node // width
+			                                          , delivered[source][node]
+			                                          , dropped[source][node]
+			                                          , mean
+			                                          , latency_max[source][node]
+			                                          ))
@@ -0,0 +1,134 @@
+#!/usr/bin/env python
+
+r"""
+Convert a binary time series file (time_series.bin, produced when
+measurements.time_series.enabled is set) into a tab-separated file with one row
+per window giving the labels (the group, sample and independent variables), the
+time since the start of the sample and the value of every column.
+
+Usage::
+
+	python time_series_to_tsv.py [--deltas] path/to/time_series.bin > time_series.dat
+
+With --deltas, each value is given as the change since the previous row of the
+same sample (e.g. the packets arriving during each window) rather than the
+value at the end of the window.
+
+The file starts with a magic string followed by varints giving the version, the
+number of labels and the number of columns and then the NUL-terminated names of
+the labels and columns. This is followed by a sequence of records, each starting
+with a tag byte: a labels record ("L") gives the NUL-terminated value of every
+label for the rows which follow and a row record ("R") gives the time and every
+column as the (zig-zag encoded) change since the previous row, or since zero
+after a labels record. See src/time_series.h for details.
+
+The read_time_series function may also be used directly by analysis scripts.
+"""
+
+import sys
+
+MAGIC = b"TICKYTSS"
+VERSION = 1
+
+
+class Reader(object):
+	"""
+	Decodes the fields of a time series file held in memory.
+	"""
+
+	def __init__(self, data):
+		self.data = data
+		self.pos  = 0
+
+	def at_end(self):
+		return self.pos >= len(self.data)
+
+	def byte(self):
+		if self.at_end():
+			raise ValueError("Truncated file")
+		value = self.data[self.pos:self.pos + 1]
+		self.pos += 1
+		return value
+
+	def varint(self):
+		value = 0
+		shift = 0
+		while True:
+			byte = ord(self.byte())
+			value |= (byte & 0x7F) << shift
+			shift += 7
+			if not byte & 0x80:
+				return value
+
+	def signed(self):
+		value = self.varint()
+		return (value >> 1) ^ -(value & 1)
+
+	def string(self):
+		end = self.data.find(b"\0", self.pos)
+		if end < 0:
+			raise ValueError("Truncated string")
+		value = self.data[self.pos:end].decode("utf-8")
+		self.pos = end + 1
+		return value
+
+
+def read_time_series(f):
+	"""
+	Read a time series file from the file-like object f. Returns (label_names,
+	column_names, rows) where rows is a generator of (label_values, time,
+	values) tuples giving the decoded value of every column.
+	"""
+	r = Reader(f.read())
+	if r.data[:len(MAGIC)] != MAGIC:
+		raise ValueError("Not a time series file")
+	r.pos = len(MAGIC)
+	if r.varint() != VERSION:
+		raise ValueError("Not a version %d time series file"%VERSION)
+	num_labels  = r.varint()
+	num_columns = r.varint()
+	label_names  = [r.string() for _ in range(num_labels)]
+	column_names = [r.string() for _ in range(num_columns)]
+
+	def rows():
+		label_values = None
+		time   = 0
+		values = [0] * num_columns
+		while not r.at_end():
+			tag = r.byte()
+			if tag == b"L":
+				label_values = [r.string() for _ in range(num_labels)]
+				time   = 0
+				values = [0] * num_columns
+			elif tag == b"R":
+				time  += r.varint()
+				values = [v + r.signed() for v in values]
+				yield (label_values, time, values)
+			else:
+				raise ValueError("Unknown record %r"%tag)
+
+	return (label_names, column_names, rows())
+
+
+if __name__=="__main__":
+	args = sys.argv[1:]
+	deltas = "--deltas" in args
+	if deltas:
+		args.remove("--deltas")
+	if len(args) != 1:
+		sys.stderr.write(__doc__)
+		sys.exit(1)
+
+	with open(args[0], "rb") as f:
+		label_names, column_names, rows = read_time_series(f)
+
+		out = sys.stdout
+		out.write("\t".join(label_names + ["time"] + column_names) + "\n")
+		last_labels = None
+		for label_values, time, values in rows:
+			if deltas:
+				if label_values is not last_labels:
+					last_values = [0] * len(values)
+					last_labels = label_values
+				values, last_values = [v - l for v, l in zip(values, last_values)], values
+			out.write("\t".join(label_values + [str(time)] + list(map(str, values))) + "\n")